@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "asset_store.h"
+#include "img_rle.h"
+#include "ui.h"
+
+#define BENCH_PARTITION "storage"
+
+static const char *TAG = "ASSET_STORE_BENCH";
+
+static const esp_partition_t *part = NULL;
+static uint8_t *pack_data = NULL;
+static size_t pack_len = 0;
+
+static uint8_t *bench_read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    *len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = malloc(*len);
+    *len = fread(data, 1, *len, f);
+    fclose(f);
+    return data;
+}
+
+static void bench_flash(const uint8_t *data, size_t len)
+{
+    size_t erase = (len + part->erase_size - 1) / part->erase_size * part->erase_size;
+    ESP_ERROR_CHECK(esp_partition_erase_range(part, 0, erase));
+    ESP_ERROR_CHECK(esp_partition_write(part, 0, data, len));
+}
+
+static asset_store_entry_t *bench_entry(uint8_t *pack, int i)
+{
+    return (asset_store_entry_t *)(pack + sizeof(asset_store_header_t)) + i;
+}
+
+/**
+ * @brief the packed background decodes to the pixels SquareLine exported, the text file is stored as is
+ */
+static uint32_t bench_read_back(void)
+{
+    uint32_t errors = 0;
+    lv_img_dsc_t dsc;
+    const uint8_t *data = NULL;
+    size_t size = 0;
+    size_t text_len = 0;
+    uint8_t *text = bench_read_file(BENCH_TEXT_PATH, &text_len);
+
+    bench_flash(pack_data, pack_len);
+    ESP_ERROR_CHECK(asset_store_init(BENCH_PARTITION));
+
+    if (asset_store_find("hello.txt", &data, &size) != ESP_OK || text == NULL || size != text_len || memcmp(data, text, size) != 0)
+    {
+        ESP_LOGE(TAG, "hello.txt does not read back");
+        errors++;
+    }
+    if (asset_store_get_img("hello.txt", &dsc) != ESP_ERR_INVALID_ARG || asset_store_find("missing", &data, &size) != ESP_ERR_NOT_FOUND)
+    {
+        ESP_LOGE(TAG, "Lookups that must fail did not");
+        errors++;
+    }
+
+    if (asset_store_get_img("ui_img_9460735_png", &dsc) != ESP_OK || dsc.header.cf != IMG_RLE_CF || dsc.header.w != ui_img_9460735_png.header.w ||
+        dsc.header.h != ui_img_9460735_png.header.h)
+    {
+        ESP_LOGE(TAG, "ui_img_9460735_png is not an RLE image of the exported size");
+        errors++;
+    }
+    else
+    {
+        const img_rle_header_t *rle = (const img_rle_header_t *)dsc.data;
+        uint32_t stride = dsc.header.w * rle->pixel_size;
+        uint8_t *line = malloc(stride);
+        for (uint16_t y = 0; y < dsc.header.h; y++)
+        {
+            if (rle->line_offset[y] >= dsc.data_size || img_rle_decode_line(dsc.data + rle->line_offset[y], dsc.data_size - rle->line_offset[y], line, dsc.header.w, rle->pixel_size) == 0 ||
+                memcmp(line, ui_img_9460735_png.data + y * stride, stride) != 0)
+            {
+                ESP_LOGE(TAG, "Line %u of the packed background differs", y);
+                errors++;
+                break;
+            }
+        }
+        free(line);
+    }
+
+    asset_store_deinit();
+    if (asset_store_find("hello.txt", &data, &size) != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE(TAG, "Assets found after deinit");
+        errors++;
+    }
+    free(text);
+    return errors;
+}
+
+/**
+ * @brief every damaged copy of the pack is refused and leaves the store empty
+ */
+static uint32_t bench_damaged(void)
+{
+    enum
+    {
+        BENCH_MAGIC,
+        BENCH_TOO_BIG,
+        BENCH_SHORT_INDEX,
+        BENCH_IN_INDEX,
+        BENCH_PAST_END,
+        BENCH_OFFSET_WRAP,
+        BENCH_SIZE_WRAP,
+        BENCH_UNALIGNED,
+        BENCH_DAMAGE_COUNT,
+    };
+    static const char *names[] = {"bad magic", "larger than the partition", "index past the pack", "asset over the index",
+                                  "asset past the end", "offset wraps", "size wraps", "unaligned asset"};
+    const esp_err_t expect[] = {ESP_ERR_INVALID_VERSION, ESP_ERR_INVALID_SIZE, ESP_ERR_INVALID_SIZE, ESP_ERR_INVALID_SIZE,
+                                ESP_ERR_INVALID_SIZE,    ESP_ERR_INVALID_SIZE, ESP_ERR_INVALID_SIZE, ESP_ERR_INVALID_SIZE};
+    uint8_t *pack = malloc(pack_len);
+    uint32_t errors = 0;
+
+    for (int damage = 0; damage < BENCH_DAMAGE_COUNT; damage++)
+    {
+        memcpy(pack, pack_data, pack_len);
+        asset_store_header_t *header = (asset_store_header_t *)pack;
+        asset_store_entry_t *entry = bench_entry(pack, header->count - 1);
+        switch (damage)
+        {
+        case BENCH_MAGIC:
+            header->magic ^= 1;
+            break;
+        case BENCH_TOO_BIG:
+            header->size = part->size + 1;
+            break;
+        case BENCH_SHORT_INDEX:
+            header->size = sizeof(asset_store_header_t) + header->count * sizeof(asset_store_entry_t) - 1;
+            break;
+        case BENCH_IN_INDEX:
+            entry->offset = 0;
+            entry->size = 16;
+            break;
+        case BENCH_PAST_END:
+            entry->size = header->size - entry->offset + 1;
+            break;
+        case BENCH_OFFSET_WRAP:
+            /*!< offset + size is 16, inside the pack */
+            entry->offset = 0xFFFFFFF0;
+            entry->size = 0x20;
+            break;
+        case BENCH_SIZE_WRAP:
+            entry->size = 0xFFFFFFFF - entry->offset + 1 + 16;
+            break;
+        default:
+            entry->offset += 1;
+            break;
+        }
+        bench_flash(pack, pack_len);
+
+        const uint8_t *data = NULL;
+        size_t size = 0;
+        esp_err_t ret = asset_store_init(BENCH_PARTITION);
+        if (ret != expect[damage] || asset_store_find("hello.txt", &data, &size) != ESP_ERR_INVALID_STATE)
+        {
+            ESP_LOGE(TAG, "Pack with %s: %s", names[damage], esp_err_to_name(ret));
+            errors++;
+        }
+        asset_store_deinit();
+    }
+    free(pack);
+    return errors;
+}
+
+/**
+ * @brief an image entry inside the pack but smaller than its width and height is not handed to LVGL
+ */
+static uint32_t bench_short_img(void)
+{
+    uint8_t *pack = malloc(pack_len);
+    asset_store_header_t *header = (asset_store_header_t *)pack;
+    uint32_t errors = 0;
+    lv_img_dsc_t dsc;
+
+    for (int damage = 0; damage < 2; damage++)
+    {
+        memcpy(pack, pack_data, pack_len);
+        for (int i = 0; i < header->count; i++)
+        {
+            asset_store_entry_t *entry = bench_entry(pack, i);
+            if (entry->format != ASSET_FORMAT_RLE)
+            {
+                continue;
+            }
+            if (damage == 0)
+            {
+                /*!< one line offset short */
+                entry->size = sizeof(img_rle_header_t) + entry->height * sizeof(uint32_t) - 1;
+            }
+            else
+            {
+                /*!< the coded bytes taken as raw pixels */
+                entry->format = ASSET_FORMAT_TRUE_COLOR;
+            }
+        }
+        bench_flash(pack, pack_len);
+        ESP_ERROR_CHECK(asset_store_init(BENCH_PARTITION));
+        if (asset_store_get_img("ui_img_9460735_png", &dsc) != ESP_ERR_INVALID_SIZE)
+        {
+            ESP_LOGE(TAG, "Image with %s was handed out", damage ? "fewer pixels than its size" : "a short line table");
+            errors++;
+        }
+        asset_store_deinit();
+    }
+    free(pack);
+    return errors;
+}
+
+void app_main(void)
+{
+    uint32_t errors = 0;
+
+    /*!< on linux the partition lives in an emulated flash image file, laid out by the board's table */
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, BENCH_PARTITION);
+    pack_data = bench_read_file(BENCH_PACK_PATH, &pack_len);
+    if (part == NULL || pack_data == NULL || pack_len > part->size)
+    {
+        ESP_LOGE(TAG, "No %s partition or no pack at %s", BENCH_PARTITION, BENCH_PACK_PATH);
+        exit(1);
+    }
+
+    errors += bench_read_back();
+    errors += bench_damaged();
+    errors += bench_short_img();
+
+    ESP_LOGI(TAG, "%lu byte pack, %s, %lu errors", (unsigned long)pack_len, errors ? "FAIL" : "PASS", (unsigned long)errors);
+    free(pack_data);
+    exit(errors ? 1 : 0);
+}
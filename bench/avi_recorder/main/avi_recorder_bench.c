@@ -0,0 +1,430 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "esp_log.h"
+#include "esp_vfs_fat.h"
+#include "diskio_impl.h"
+#include "ff.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "avi_recorder.h"
+
+#define BENCH_IMAGE "/tmp/avi_recorder_bench.img"
+#define BENCH_IMAGE_SIZE (32 * 1024 * 1024)
+#define BENCH_SECTOR_SIZE 512
+#define BENCH_CLUSTER_SIZE (16 * 1024) /*!< the allocation unit sd_card_init formats with */
+#define BENCH_BASE_PATH "/fat"
+#define BENCH_PATH BENCH_BASE_PATH "/REC.AVI"
+#define BENCH_PREALLOC (4 * 1024 * 1024)
+#define BENCH_HOLES 24 /*!< small free gaps in front of the large free space, a growing file would fill them first */
+#define BENCH_FRAMES 48
+#define BENCH_MAX_FRAMES 40 /*!< smaller than BENCH_FRAMES, the last frames find the index full */
+#define BENCH_FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+typedef struct
+{
+    uint8_t *data;
+    size_t len;
+    bool queued;   /*!< accepted by avi_recorder_add_frame */
+    bool released; /*!< handed back by the writer */
+} bench_frame_t;
+
+static const char *TAG = "AVI_RECORDER_BENCH";
+
+static bench_frame_t frames[BENCH_FRAMES];
+static uint8_t *file_data;
+static size_t file_len;
+static int image_fd = -1;
+static BYTE image_pdrv;
+static char image_drive[4];
+static FATFS *image_fs;
+
+static DSTATUS bench_disk_init(BYTE pdrv)
+{
+    return 0;
+}
+
+static DSTATUS bench_disk_status(BYTE pdrv)
+{
+    return 0;
+}
+
+static DRESULT bench_disk_read(BYTE pdrv, BYTE *buff, uint32_t sector, unsigned count)
+{
+    size_t len = (size_t)count * BENCH_SECTOR_SIZE;
+    return pread(image_fd, buff, len, (off_t)sector * BENCH_SECTOR_SIZE) == (ssize_t)len ? RES_OK : RES_ERROR;
+}
+
+static DRESULT bench_disk_write(BYTE pdrv, const BYTE *buff, uint32_t sector, unsigned count)
+{
+    size_t len = (size_t)count * BENCH_SECTOR_SIZE;
+    return pwrite(image_fd, buff, len, (off_t)sector * BENCH_SECTOR_SIZE) == (ssize_t)len ? RES_OK : RES_ERROR;
+}
+
+static DRESULT bench_disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    switch (cmd)
+    {
+    case CTRL_SYNC:
+        return RES_OK;
+    case GET_SECTOR_COUNT:
+        *(LBA_t *)buff = BENCH_IMAGE_SIZE / BENCH_SECTOR_SIZE;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD *)buff = BENCH_SECTOR_SIZE;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buff = 1;
+        return RES_OK;
+    default:
+        return RES_ERROR;
+    }
+}
+
+/**
+ * @brief format a FAT image in a plain file and mount it on BENCH_BASE_PATH, the recorder then goes through VFS and FatFs as on the card
+ */
+static esp_err_t bench_mount_image(const char *image)
+{
+    static const ff_diskio_impl_t disk = {
+        .init = bench_disk_init,
+        .status = bench_disk_status,
+        .read = bench_disk_read,
+        .write = bench_disk_write,
+        .ioctl = bench_disk_ioctl,
+    };
+    const MKFS_PARM opt = {.fmt = FM_ANY | FM_SFD, .au_size = BENCH_CLUSTER_SIZE};
+    void *work = malloc(FF_MAX_SS);
+    esp_err_t ret = ESP_FAIL;
+
+    image_fd = open(image, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (image_fd < 0 || ftruncate(image_fd, BENCH_IMAGE_SIZE) != 0 || work == NULL || ff_diskio_get_drive(&image_pdrv) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "No image %s", image);
+        goto out;
+    }
+    ff_diskio_register(image_pdrv, &disk);
+    snprintf(image_drive, sizeof(image_drive), "%u:", image_pdrv);
+    if (esp_vfs_fat_register(BENCH_BASE_PATH, image_drive, 4, &image_fs) != ESP_OK || f_mkfs(image_drive, &opt, work, FF_MAX_SS) != FR_OK ||
+        f_mount(image_fs, image_drive, 1) != FR_OK)
+    {
+        ESP_LOGE(TAG, "Format %s failed", image);
+        goto out;
+    }
+    ret = ESP_OK;
+out:
+    free(work);
+    return ret;
+}
+
+static void bench_unmount_image(void)
+{
+    f_mount(NULL, image_drive, 0);
+    esp_vfs_fat_unregister_path(BENCH_BASE_PATH);
+    ff_diskio_unregister(image_pdrv);
+    close(image_fd);
+}
+
+static uint32_t bench_free_clusters(void)
+{
+    DWORD free_clusters = 0;
+    FATFS *fs;
+    f_getfree(image_drive, &free_clusters, &fs);
+    return free_clusters;
+}
+
+/**
+ * @brief leave BENCH_HOLES single cluster gaps at the start of the volume
+ */
+static uint32_t bench_fragment(void)
+{
+    static uint8_t cluster[BENCH_CLUSTER_SIZE];
+    char path[32];
+    uint32_t errors = 0;
+
+    for (int i = 0; i < BENCH_HOLES * 2; i++)
+    {
+        snprintf(path, sizeof(path), BENCH_BASE_PATH "/F%02d.BIN", i);
+        FILE *f = fopen(path, "wb");
+        if (f == NULL || fwrite(cluster, 1, sizeof(cluster), f) != sizeof(cluster))
+        {
+            errors++;
+        }
+        if (f)
+        {
+            fclose(f);
+        }
+    }
+    for (int i = 0; i < BENCH_HOLES * 2; i += 2)
+    {
+        snprintf(path, sizeof(path), BENCH_BASE_PATH "/F%02d.BIN", i);
+        errors += unlink(path) != 0;
+    }
+    /*!< FatFs looks for free clusters after the last one it allocated, a fresh mount starts at the gaps */
+    f_mount(NULL, image_drive, 0);
+    errors += f_mount(image_fs, image_drive, 1) != FR_OK;
+    if (errors)
+    {
+        ESP_LOGE(TAG, "Fragmenting the volume failed");
+    }
+    return errors;
+}
+
+/**
+ * @brief the recording must sit in one cluster chain and hold no more clusters than its size needs
+ */
+static uint32_t bench_check_clusters(uint32_t free_before)
+{
+    uint32_t errors = 0;
+    char path[32];
+    FIL fil;
+
+    snprintf(path, sizeof(path), "%s/REC.AVI", image_drive);
+    if (f_open(&fil, path, FA_READ) != FR_OK)
+    {
+        ESP_LOGE(TAG, "%s not on the volume", path);
+        return 1;
+    }
+    FSIZE_t cluster_bytes = (FSIZE_t)fil.obj.fs->csize * BENCH_SECTOR_SIZE;
+    FSIZE_t clusters = (f_size(&fil) + cluster_bytes - 1) / cluster_bytes;
+    for (FSIZE_t i = 1; i < clusters; i++)
+    {
+        /*!< as sd_card_file_contiguous, clust is the cluster holding the offset after the seek */
+        if (f_lseek(&fil, i * cluster_bytes + 1) != FR_OK || fil.clust != fil.obj.sclust + i)
+        {
+            ESP_LOGE(TAG, "Recording is in pieces, cluster %lu is not after cluster %lu", (unsigned long)i, (unsigned long)(i - 1));
+            errors++;
+            break;
+        }
+    }
+    if (fil.obj.sclust < 2 + BENCH_HOLES * 2)
+    {
+        ESP_LOGE(TAG, "Recording starts in cluster %lu, inside the gaps", (unsigned long)fil.obj.sclust);
+        errors++;
+    }
+    f_close(&fil);
+
+    /*!< ftruncate in avi_recorder_finish hands the unused preallocation back to the FAT */
+    uint32_t used = free_before - bench_free_clusters();
+    if (used != clusters)
+    {
+        ESP_LOGE(TAG, "Recording holds %lu clusters, %lu bytes need %lu", (unsigned long)used, (unsigned long)file_len, (unsigned long)clusters);
+        errors++;
+    }
+    return errors;
+}
+
+static size_t bench_frame_len(int i)
+{
+    /*!< odd sizes need a pad byte, the large ones span several allocation units */
+    static const size_t sizes[] = {1, 2, 999, 16383, 16384, 16385, 40001, 12288};
+    return sizes[i % (sizeof(sizes) / sizeof(sizes[0]))] + i;
+}
+
+static void bench_release_cb(void *user_ctx)
+{
+    bench_frame_t *frame = (bench_frame_t *)user_ctx;
+    frame->released = true;
+    /*!< like a camera buffer that is refilled at once, anything the writer reads later is garbage */
+    memset(frame->data, 0xEE, frame->len);
+}
+
+static uint32_t bench_u32(size_t pos)
+{
+    uint32_t v = 0;
+    if (pos + 4 <= file_len)
+    {
+        memcpy(&v, file_data + pos, 4);
+    }
+    return v;
+}
+
+static bool bench_frame_matches(int i, const uint8_t *data)
+{
+    for (size_t k = 0; k < frames[i].len; k++)
+    {
+        if (data[k] != (uint8_t)(i * 31 + k * 7))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief walk RIFF, hdrl, movi and idx1, every queued frame must be in the file once, in order
+ */
+static uint32_t bench_parse(uint32_t queued)
+{
+    uint32_t errors = 0;
+    size_t movi_pos = 0;
+    uint32_t movi_size = 0;
+    size_t idx1_pos = 0;
+    uint32_t idx1_size = 0;
+
+    if (bench_u32(0) != BENCH_FOURCC('R', 'I', 'F', 'F') || bench_u32(8) != BENCH_FOURCC('A', 'V', 'I', ' ') || bench_u32(4) + 8 != file_len)
+    {
+        ESP_LOGE(TAG, "Bad RIFF header, size %lu, file %lu", (unsigned long)bench_u32(4), (unsigned long)file_len);
+        return 1;
+    }
+    if (bench_u32(12) != BENCH_FOURCC('L', 'I', 'S', 'T') || bench_u32(20) != BENCH_FOURCC('h', 'd', 'r', 'l') || bench_u32(24) != BENCH_FOURCC('a', 'v', 'i', 'h'))
+    {
+        ESP_LOGE(TAG, "No hdrl list");
+        errors++;
+    }
+    if (bench_u32(48) != queued || !(bench_u32(44) & 0x10))
+    {
+        ESP_LOGE(TAG, "avih says %lu frames, flags %lx", (unsigned long)bench_u32(48), (unsigned long)bench_u32(44));
+        errors++;
+    }
+
+    /*!< top level chunks */
+    for (size_t pos = 12; pos + 8 <= file_len;)
+    {
+        uint32_t id = bench_u32(pos);
+        uint32_t size = bench_u32(pos + 4);
+        if (id == BENCH_FOURCC('L', 'I', 'S', 'T') && bench_u32(pos + 8) == BENCH_FOURCC('m', 'o', 'v', 'i'))
+        {
+            movi_pos = pos + 8;
+            movi_size = size;
+        }
+        else if (id == BENCH_FOURCC('i', 'd', 'x', '1'))
+        {
+            idx1_pos = pos + 8;
+            idx1_size = size;
+        }
+        pos += 8 + size + (size & 1);
+        if (pos > file_len)
+        {
+            ESP_LOGE(TAG, "Chunk %.4s runs past the end of the file", (const char *)&id);
+            errors++;
+        }
+    }
+    if (movi_pos == 0 || idx1_pos == 0 || idx1_size != queued * 16)
+    {
+        ESP_LOGE(TAG, "movi at %lu, idx1 at %lu with %lu bytes", (unsigned long)movi_pos, (unsigned long)idx1_pos, (unsigned long)idx1_size);
+        return errors + 1;
+    }
+
+    /*!< movi chunks against the frames, and the index entry of each */
+    size_t pos = movi_pos + 4;
+    uint32_t n = 0;
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        if (!frames[i].queued)
+        {
+            continue;
+        }
+        size_t entry = idx1_pos + n * 16;
+        if (pos + 8 > movi_pos + movi_size || bench_u32(pos) != BENCH_FOURCC('0', '0', 'd', 'c') || bench_u32(pos + 4) != frames[i].len ||
+            pos + 8 + frames[i].len > file_len || !bench_frame_matches(i, file_data + pos + 8))
+        {
+            ESP_LOGE(TAG, "Frame %d: bad movi chunk at %lu", i, (unsigned long)pos);
+            return errors + 1;
+        }
+        if (bench_u32(entry) != BENCH_FOURCC('0', '0', 'd', 'c') || bench_u32(entry + 4) != 0x10 || movi_pos + bench_u32(entry + 8) != pos ||
+            bench_u32(entry + 12) != frames[i].len)
+        {
+            ESP_LOGE(TAG, "Frame %d: index entry points at %lu, chunk is at %lu", i, (unsigned long)(movi_pos + bench_u32(entry + 8)), (unsigned long)pos);
+            errors++;
+        }
+        pos += 8 + frames[i].len + (frames[i].len & 1);
+        n++;
+    }
+    if (pos != movi_pos + movi_size)
+    {
+        ESP_LOGE(TAG, "movi list is %lu bytes, chunks end after %lu", (unsigned long)movi_size, (unsigned long)(pos - movi_pos));
+        errors++;
+    }
+    return errors;
+}
+
+void app_main(void)
+{
+    const char *image = getenv("AVI_RECORDER_BENCH_IMAGE") ? getenv("AVI_RECORDER_BENCH_IMAGE") : BENCH_IMAGE;
+    const char *path = BENCH_PATH;
+    const avi_recorder_config_t config = {
+        .base_path = BENCH_BASE_PATH,
+        .path = path,
+        .width = 240,
+        .height = 240,
+        .fps = 25,
+        .max_frames = BENCH_MAX_FRAMES,
+        .prealloc_size = BENCH_PREALLOC,
+        .queue_depth = 2, /*!< short, so add_frame also meets a full queue */
+        .task_priority = 5,
+    };
+    avi_recorder_stats_t stats;
+    uint32_t queued = 0;
+    uint32_t busy = 0;
+    uint32_t errors = 0;
+
+    ESP_ERROR_CHECK(bench_mount_image(image));
+    errors += bench_fragment();
+    uint32_t free_before = bench_free_clusters();
+
+    ESP_ERROR_CHECK(avi_recorder_start(config));
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        frames[i].len = bench_frame_len(i);
+        frames[i].data = malloc(frames[i].len);
+        for (size_t k = 0; k < frames[i].len; k++)
+        {
+            frames[i].data[k] = (uint8_t)(i * 31 + k * 7);
+        }
+
+        esp_err_t ret;
+        while ((ret = avi_recorder_add_frame(frames[i].data, frames[i].len, bench_release_cb, &frames[i])) == ESP_ERR_TIMEOUT)
+        {
+            /*!< still the caller's buffer, try again */
+            if (frames[i].released)
+            {
+                ESP_LOGE(TAG, "Frame %d released although it was refused", i);
+                errors++;
+            }
+            busy++;
+            vTaskDelay(1);
+        }
+        frames[i].queued = ret == ESP_OK;
+        queued += frames[i].queued;
+    }
+    ESP_ERROR_CHECK(avi_recorder_stop());
+    avi_recorder_get_stats(&stats);
+
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        if (frames[i].queued != frames[i].released)
+        {
+            ESP_LOGE(TAG, "Frame %d queued %d, released %d", i, frames[i].queued, frames[i].released);
+            errors++;
+        }
+    }
+    if (queued != BENCH_MAX_FRAMES || stats.frames_written != queued)
+    {
+        ESP_LOGE(TAG, "%lu frames queued, %lu written, index holds %d", (unsigned long)queued, (unsigned long)stats.frames_written, BENCH_MAX_FRAMES);
+        errors++;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        ESP_LOGE(TAG, "%s not written", path);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    file_len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    file_data = malloc(file_len);
+    file_len = fread(file_data, 1, file_len, f);
+    fclose(f);
+    errors += bench_parse(queued);
+    errors += bench_check_clusters(free_before);
+    bench_unmount_image();
+
+    ESP_LOGI(TAG, "%lu frames written, %lu dropped, %lu retries on a full queue, %lu bytes, slowest write %lu us", (unsigned long)stats.frames_written,
+             (unsigned long)stats.frames_dropped, (unsigned long)busy, (unsigned long)file_len, (unsigned long)stats.max_write_time);
+    ESP_LOGI(TAG, "%s, %lu errors", errors ? "FAIL" : "PASS", (unsigned long)errors);
+    exit(errors ? 1 : 0);
+}
@@ -0,0 +1,218 @@
+#include "camera_fake.h"
+#include "esp_jpg_decode.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define CAMERA_FAKE_MCU 16
+
+typedef struct
+{
+    camera_fb_t fb;
+    uint32_t seq;
+    bool out; /*!< handed to the application */
+} camera_fake_slot_t;
+
+static const char *TAG = "CAMERA_FAKE";
+
+static camera_fake_config_t fake_config;
+static camera_fake_stats_t fake_stats;
+static camera_fake_slot_t slots[CAMERA_FB_COUNT];
+static SemaphoreHandle_t slot_free = NULL;
+static SemaphoreHandle_t slot_lock = NULL;
+
+uint16_t camera_fake_color(uint32_t seq)
+{
+    /*!< never 0, the colour of a panel nothing was drawn on */
+    return (uint16_t)(seq % 0xFFFF + 1);
+}
+
+void camera_fake_rgb(uint16_t x, uint16_t y, uint32_t seq, uint8_t rgb[3])
+{
+    rgb[0] = x * 3 + seq;
+    rgb[1] = y * 5;
+    rgb[2] = x ^ y;
+}
+
+esp_err_t camera_init(pixformat_t pixel_format, framesize_t frame_size)
+{
+    return ESP_OK;
+}
+
+esp_err_t camera_fake_start(camera_fake_config_t config)
+{
+    ESP_RETURN_ON_FALSE(config.width && config.height && slot_free == NULL, ESP_ERR_INVALID_STATE, TAG, "Invalid argument");
+    fake_config = config;
+    fake_stats = (camera_fake_stats_t){0};
+
+    slot_free = xSemaphoreCreateCounting(CAMERA_FB_COUNT, CAMERA_FB_COUNT);
+    slot_lock = xSemaphoreCreateMutex();
+    ESP_RETURN_ON_FALSE(slot_free && slot_lock, ESP_ERR_NO_MEM, TAG, "Semaphore create failed");
+    for (int i = 0; i < CAMERA_FB_COUNT; i++)
+    {
+        slots[i] = (camera_fake_slot_t){
+            .fb = {
+                .len = config.format == PIXFORMAT_JPEG ? sizeof(camera_fake_jpeg_t) + config.width * config.height * 3 : config.width * config.height * sizeof(uint16_t),
+                .width = config.width,
+                .height = config.height,
+                .format = config.format,
+            },
+        };
+        slots[i].fb.buf = malloc(slots[i].fb.len);
+        ESP_RETURN_ON_FALSE(slots[i].fb.buf, ESP_ERR_NO_MEM, TAG, "No mem for frame");
+    }
+    return ESP_OK;
+}
+
+void camera_fake_stop(void)
+{
+    for (int i = 0; i < CAMERA_FB_COUNT; i++)
+    {
+        if (slots[i].out)
+        {
+            ESP_LOGE(TAG, "Frame %lu was never given back", (unsigned long)slots[i].seq);
+        }
+        free(slots[i].fb.buf);
+        slots[i].fb.buf = NULL;
+    }
+    vSemaphoreDelete(slot_free);
+    vSemaphoreDelete(slot_lock);
+    slot_free = NULL;
+    slot_lock = NULL;
+}
+
+camera_fb_t *esp_camera_fb_get(void)
+{
+    camera_fake_slot_t *slot = NULL;
+
+    if (xSemaphoreTake(slot_free, pdMS_TO_TICKS(1000)) != pdTRUE)
+    {
+        return NULL;
+    }
+    vTaskDelay(pdMS_TO_TICKS(fake_config.frame_interval_ms));
+
+    xSemaphoreTake(slot_lock, portMAX_DELAY);
+    for (int i = 0; i < CAMERA_FB_COUNT && slot == NULL; i++)
+    {
+        if (!slots[i].out)
+        {
+            slot = &slots[i];
+        }
+    }
+    slot->out = true;
+    slot->seq = fake_stats.captured++;
+    xSemaphoreGive(slot_lock);
+
+    if (slot->fb.format == PIXFORMAT_JPEG)
+    {
+        camera_fake_jpeg_t header = {
+            .magic = CAMERA_FAKE_JPEG_MAGIC,
+            .width = fake_config.width,
+            .height = fake_config.height,
+        };
+        memcpy(slot->fb.buf, &header, sizeof(header));
+        uint8_t *p = slot->fb.buf + sizeof(header);
+        for (uint16_t y = 0; y < header.height; y++)
+        {
+            for (uint16_t x = 0; x < header.width; x++, p += 3)
+            {
+                camera_fake_rgb(x, y, slot->seq, p);
+            }
+        }
+    }
+    else
+    {
+        uint16_t color = camera_fake_color(slot->seq);
+        for (size_t i = 0; i < slot->fb.len; i += 2)
+        {
+            slot->fb.buf[i] = color >> 8;
+            slot->fb.buf[i + 1] = color & 0xFF;
+        }
+    }
+    gettimeofday(&slot->fb.timestamp, NULL);
+    return &slot->fb;
+}
+
+void esp_camera_fb_return(camera_fb_t *fb)
+{
+    camera_fake_slot_t *slot = NULL;
+
+    xSemaphoreTake(slot_lock, portMAX_DELAY);
+    for (int i = 0; i < CAMERA_FB_COUNT; i++)
+    {
+        if (fb == &slots[i].fb && slots[i].out)
+        {
+            slot = &slots[i];
+        }
+    }
+    if (slot == NULL)
+    {
+        fake_stats.bad_returns++;
+        xSemaphoreGive(slot_lock);
+        return;
+    }
+    xSemaphoreGive(slot_lock);
+
+    /*!< before the buffer is free again, the callback may still read it */
+    if (fake_config.on_return)
+    {
+        fake_config.on_return(fb, slot->seq, fake_config.user_ctx);
+    }
+    xSemaphoreTake(slot_lock, portMAX_DELAY);
+    slot->out = false;
+    fake_stats.returned++;
+    xSemaphoreGive(slot_lock);
+    xSemaphoreGive(slot_free);
+}
+
+esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader, jpg_writer_cb writer, void *arg)
+{
+    camera_fake_jpeg_t header;
+    uint8_t block[CAMERA_FAKE_MCU * CAMERA_FAKE_MCU * 3];
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(len >= sizeof(header) && reader(arg, 0, (uint8_t *)&header, sizeof(header)) == sizeof(header) && header.magic == CAMERA_FAKE_JPEG_MAGIC,
+                        ESP_ERR_INVALID_ARG, TAG, "Not a fake JPEG");
+    ESP_RETURN_ON_FALSE(len >= sizeof(header) + header.width * header.height * 3, ESP_ERR_INVALID_SIZE, TAG, "Fake JPEG is short");
+    uint8_t *pixels = malloc(header.width * header.height * 3);
+    ESP_RETURN_ON_FALSE(pixels, ESP_ERR_NO_MEM, TAG, "No mem for pixels");
+    reader(arg, sizeof(header), pixels, header.width * header.height * 3);
+
+    uint16_t step = 1 << scale;
+    uint16_t w = header.width / step;
+    uint16_t h = header.height / step;
+    ESP_GOTO_ON_FALSE(writer(arg, 0, 0, w, h, NULL), ESP_FAIL, out, TAG, "Start rejected");
+    for (uint16_t by = 0; by < h; by += CAMERA_FAKE_MCU)
+    {
+        uint16_t bh = by + CAMERA_FAKE_MCU < h ? CAMERA_FAKE_MCU : h - by;
+        for (uint16_t bx = 0; bx < w; bx += CAMERA_FAKE_MCU)
+        {
+            uint16_t bw = bx + CAMERA_FAKE_MCU < w ? CAMERA_FAKE_MCU : w - bx;
+            uint8_t *o = block;
+            for (uint16_t y = by; y < by + bh; y++)
+            {
+                for (uint16_t x = bx; x < bx + bw; x++, o += 3)
+                {
+                    memcpy(o, pixels + ((y * step) * header.width + x * step) * 3, 3);
+                }
+            }
+            ESP_GOTO_ON_FALSE(writer(arg, bx, by, bw, bh, block), ESP_FAIL, out, TAG, "Block rejected");
+        }
+    }
+    ESP_GOTO_ON_FALSE(writer(arg, w, h, 0, 0, NULL), ESP_FAIL, out, TAG, "End rejected");
+
+out:
+    free(pixels);
+    return ret;
+}
+
+void camera_fake_get_stats(camera_fake_stats_t *stats)
+{
+    xSemaphoreTake(slot_lock, portMAX_DELAY);
+    *stats = fake_stats;
+    xSemaphoreGive(slot_lock);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_camera.h"
+
+#define CAMERA_FB_COUNT 3
+
+/**
+ * @brief camera init, the fake ignores the arguments, see camera_fake_start
+ *
+ * @param pixel_format PIXFORMAT_RGB565 or PIXFORMAT_JPEG
+ * @param frame_size
+ * @return esp_err_t
+ */
+esp_err_t camera_init(pixformat_t pixel_format, framesize_t frame_size);
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "esp_err.h"
+#include "camera.h"
+
+#define CAMERA_FAKE_JPEG_MAGIC 0x47504A46 /*!< "FJPG" */
+
+/**
+ * @brief header of the JPEG stand-in, followed by width * height rgb888 pixels
+ *
+ * esp_jpg_decode of this component hands them to the writer in 16x16 blocks like the real decoder,
+ * downscaled by keeping every 2nd, 4th or 8th pixel.
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+} camera_fake_jpeg_t;
+
+/**
+ * @brief called with every frame given back, from the task that gave it back
+ */
+typedef void (*camera_fake_return_cb_t)(const camera_fb_t *fb, uint32_t seq, void *user_ctx);
+
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    pixformat_t format; /*!< PIXFORMAT_RGB565 or PIXFORMAT_JPEG */
+    uint32_t frame_interval_ms; /*!< time the sensor takes per frame */
+    camera_fake_return_cb_t on_return;
+    void *user_ctx;
+} camera_fake_config_t;
+
+typedef struct
+{
+    uint32_t captured;
+    uint32_t returned;
+    uint32_t bad_returns; /*!< buffers given back twice or not handed out by the fake */
+} camera_fake_stats_t;
+
+/**
+ * @brief serve frames from CAMERA_FB_COUNT buffers, the counters and the sequence start at zero
+ *
+ * Every pixel of an RGB565 frame is camera_fake_color(seq), big endian as the sensor sends it.
+ * JPEG frames carry camera_fake_rgb(x, y, seq) in a camera_fake_jpeg_t.
+ *
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t camera_fake_start(camera_fake_config_t config);
+
+/**
+ * @brief free the buffers, every frame must have been given back
+ */
+void camera_fake_stop(void);
+
+/**
+ * @brief native rgb565 colour of frame seq
+ *
+ * @param seq
+ * @return uint16_t
+ */
+uint16_t camera_fake_color(uint32_t seq);
+
+/**
+ * @brief pixel x, y of JPEG frame seq
+ *
+ * @param x
+ * @param y
+ * @param seq
+ * @param rgb
+ */
+void camera_fake_rgb(uint16_t x, uint16_t y, uint32_t seq, uint8_t rgb[3]);
+
+/**
+ * @brief get frame counters
+ *
+ * @param stats
+ */
+void camera_fake_get_stats(camera_fake_stats_t *stats);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sys/time.h"
+
+/**
+ * The subset of esp32-camera the pipeline uses, served by camera_fake.c
+ */
+
+typedef enum
+{
+    PIXFORMAT_RGB565,
+    PIXFORMAT_YUV422,
+    PIXFORMAT_JPEG,
+} pixformat_t;
+
+typedef enum
+{
+    FRAMESIZE_240X240,
+    FRAMESIZE_QVGA,
+    FRAMESIZE_HVGA,
+    FRAMESIZE_VGA,
+} framesize_t;
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t len;
+    size_t width;
+    size_t height;
+    pixformat_t format;
+    struct timeval timestamp;
+} camera_fb_t;
+
+/**
+ * @brief take the next frame, waits for a free buffer like the driver
+ *
+ * @return camera_fb_t* NULL if no buffer came back within a second
+ */
+camera_fb_t *esp_camera_fb_get(void);
+
+/**
+ * @brief give a frame buffer back
+ *
+ * @param fb
+ */
+void esp_camera_fb_return(camera_fb_t *fb);
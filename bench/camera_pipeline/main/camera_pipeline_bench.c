@@ -0,0 +1,284 @@
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "camera_pipeline.h"
+#include "camera_fake.h"
+#include "lcd_mock.h"
+
+#define LCD_H_RES 240 /*!< same panel as the board build */
+#define LCD_V_RES 240
+#define MAX_FRAMES 512
+#define CAPTURE_MS 10
+#define DISPLAY_MS 25 /*!< slower than the sensor, so the drop policies have to act */
+#define RUN_MS 1000
+#define JPEG_RUN_MS 300
+#define BORDER_COLOR 0xFFFF /*!< drawn before every JPEG case, the pipeline must clear what it does not cover */
+
+typedef struct
+{
+    const char *name;
+    camera_pipeline_drop_policy_t drop_policy;
+    uint16_t frame_width;
+    uint16_t frame_height;
+    pixel_ops_scale_mode_t scale_mode;
+} pipeline_case_t;
+
+typedef struct
+{
+    SemaphoreHandle_t lock;
+    uint32_t displayed[MAX_FRAMES]; /*!< sequence numbers in the order they reached the panel */
+    uint32_t displayed_count;
+    uint32_t discarded_count; /*!< given back without reaching the panel */
+} pipeline_log_t;
+
+typedef struct
+{
+    const char *name;
+    uint16_t width;
+    uint16_t height;
+    jpg_scale_t scale;
+} jpeg_case_t;
+
+static const char *TAG = "CAMERA_PIPELINE_BENCH";
+
+static const pipeline_case_t cases[] = {
+    {"block", CAMERA_PIPELINE_BLOCK, LCD_H_RES, LCD_V_RES, PIXEL_OPS_SCALE_NEAREST},
+    {"drop oldest", CAMERA_PIPELINE_DROP_OLDEST, LCD_H_RES, LCD_V_RES, PIXEL_OPS_SCALE_NEAREST},
+    {"drop newest", CAMERA_PIPELINE_DROP_NEWEST, LCD_H_RES, LCD_V_RES, PIXEL_OPS_SCALE_NEAREST},
+    {"drop oldest, 320x240 bilinear", CAMERA_PIPELINE_DROP_OLDEST, 320, 240, PIXEL_OPS_SCALE_BILINEAR},
+};
+
+static const jpeg_case_t jpeg_cases[] = {
+    {"jpeg 240x240", 240, 240, JPG_SCALE_NONE},
+    {"jpeg 320x240, cropped", 320, 240, JPG_SCALE_NONE},
+    {"jpeg 160x120, centred", 160, 120, JPG_SCALE_NONE},
+    {"jpeg 200x250, both", 200, 250, JPG_SCALE_NONE},
+    {"jpeg 640x480 / 2, cropped", 640, 480, JPG_SCALE_2X},
+    {"jpeg 320x240 / 2, centred", 320, 240, JPG_SCALE_2X},
+};
+
+static pipeline_log_t frame_log;
+
+/**
+ * @brief a frame given back with its colour on the panel was displayed, any other was dropped
+ */
+static void pipeline_return_cb(const camera_fb_t *fb, uint32_t seq, void *user_ctx)
+{
+    bool shown = lcd_mock_get_pixel(lcd_io, 0, 0) == camera_fake_color(seq) && lcd_mock_get_pixel(lcd_io, LCD_H_RES - 1, LCD_V_RES - 1) == camera_fake_color(seq);
+
+    xSemaphoreTake(frame_log.lock, portMAX_DELAY);
+    if (shown && frame_log.displayed_count < MAX_FRAMES)
+    {
+        frame_log.displayed[frame_log.displayed_count++] = seq;
+    }
+    else if (!shown)
+    {
+        frame_log.discarded_count++;
+    }
+    xSemaphoreGive(frame_log.lock);
+
+    if (shown)
+    {
+        vTaskDelay(pdMS_TO_TICKS(DISPLAY_MS));
+    }
+}
+
+static uint32_t pipeline_case_run(const pipeline_case_t *c)
+{
+    uint32_t failures = 0;
+    camera_pipeline_stats_t stats;
+    camera_fake_stats_t fake;
+    camera_fake_config_t fake_config = {
+        .width = c->frame_width,
+        .height = c->frame_height,
+        .frame_interval_ms = CAPTURE_MS,
+        .on_return = pipeline_return_cb,
+    };
+    camera_pipeline_config_t pipeline_config = {
+        .panel_width = LCD_H_RES,
+        .panel_height = LCD_V_RES,
+        .queue_depth = 1, /*!< as main, deeper queues hold every buffer and the sensor waits instead of dropping */
+        .drop_policy = c->drop_policy,
+        .task_priority = 5,
+        .scale_mode = c->scale_mode,
+    };
+
+    frame_log.displayed_count = 0;
+    frame_log.discarded_count = 0;
+    lcd_fill_rect((lcd_region_t){0, 0, LCD_H_RES, LCD_V_RES}, 0);
+    lcd_draw_wait(portMAX_DELAY);
+    ESP_ERROR_CHECK(camera_fake_start(fake_config));
+    ESP_ERROR_CHECK(camera_pipeline_start(pipeline_config));
+    vTaskDelay(pdMS_TO_TICKS(RUN_MS));
+    ESP_ERROR_CHECK(camera_pipeline_stop());
+    camera_pipeline_get_stats(&stats);
+    camera_fake_get_stats(&fake);
+    camera_fake_stop();
+
+    const uint32_t *shown = frame_log.displayed;
+    uint32_t shown_count = frame_log.displayed_count;
+    ESP_LOGI(TAG, "%-30s captured %3lu displayed %3lu dropped %3lu", c->name, (unsigned long)stats.captured, (unsigned long)stats.displayed, (unsigned long)stats.dropped);
+
+    /*!< every frame went back exactly once, and the pipeline counted what the panel saw */
+    if (fake.returned != fake.captured || fake.bad_returns)
+    {
+        ESP_LOGE(TAG, "%lu frames handed out, %lu given back, %lu bad returns", (unsigned long)fake.captured, (unsigned long)fake.returned, (unsigned long)fake.bad_returns);
+        failures++;
+    }
+    if (stats.displayed + stats.dropped != stats.captured || stats.displayed != shown_count)
+    {
+        ESP_LOGE(TAG, "Counters do not add up, %lu frames reached the panel", (unsigned long)shown_count);
+        failures++;
+    }
+    /*!< the frame the capture task held when it was stopped is discarded without being counted */
+    if (frame_log.discarded_count < stats.dropped || frame_log.discarded_count > stats.dropped + 1)
+    {
+        ESP_LOGE(TAG, "%lu frames discarded, %lu counted as dropped", (unsigned long)frame_log.discarded_count, (unsigned long)stats.dropped);
+        failures++;
+    }
+    for (uint32_t i = 1; i < shown_count; i++)
+    {
+        if (shown[i] <= shown[i - 1])
+        {
+            ESP_LOGE(TAG, "Frame %lu displayed after frame %lu", (unsigned long)shown[i], (unsigned long)shown[i - 1]);
+            failures++;
+        }
+    }
+    if (shown_count == 0)
+    {
+        ESP_LOGE(TAG, "Nothing displayed");
+        return failures + 1;
+    }
+
+    switch (c->drop_policy)
+    {
+    case CAMERA_PIPELINE_BLOCK:
+        /*!< nothing is lost, the sensor waits */
+        if (stats.dropped || shown[shown_count - 1] != shown_count - 1)
+        {
+            ESP_LOGE(TAG, "Blocking pipeline lost frames");
+            failures++;
+        }
+        break;
+    case CAMERA_PIPELINE_DROP_OLDEST:
+        /*!< the newest frame always survives, so the last one captured is the last one shown */
+        if (stats.dropped == 0 || shown[shown_count - 1] != stats.captured - 1)
+        {
+            ESP_LOGE(TAG, "Last frame shown is %lu, %lu captured", (unsigned long)shown[shown_count - 1], (unsigned long)stats.captured);
+            failures++;
+        }
+        break;
+    case CAMERA_PIPELINE_DROP_NEWEST:
+        /*!< the frames already queued survive, so the first queue_depth + 1 are all shown */
+        if (stats.dropped == 0 || shown_count <= pipeline_config.queue_depth || shown[pipeline_config.queue_depth] != pipeline_config.queue_depth)
+        {
+            ESP_LOGE(TAG, "Queued frames were dropped");
+            failures++;
+        }
+        break;
+    }
+    return failures;
+}
+
+/**
+ * @brief what the panel shows for JPEG frame seq: the decoded image centred, cropped where it is larger and black around it
+ */
+static uint16_t pipeline_jpeg_expected(const jpeg_case_t *c, uint32_t seq, uint16_t px, uint16_t py)
+{
+    uint16_t step = 1 << c->scale;
+    int w = c->width / step;
+    int h = c->height / step;
+    /*!< decoded pixel that lands on px, py */
+    int sx = px - (LCD_H_RES - w) / 2;
+    int sy = py - (LCD_V_RES - h) / 2;
+    uint8_t rgb[3];
+
+    if (sx < 0 || sx >= w || sy < 0 || sy >= h)
+    {
+        return 0;
+    }
+    camera_fake_rgb(sx * step, sy * step, seq, rgb);
+    return rgb565(rgb[0], rgb[1], rgb[2]);
+}
+
+static uint32_t pipeline_jpeg_run(const jpeg_case_t *c)
+{
+    camera_pipeline_stats_t stats;
+    camera_fake_config_t fake_config = {
+        .width = c->width,
+        .height = c->height,
+        .format = PIXFORMAT_JPEG,
+        .frame_interval_ms = 20,
+    };
+    camera_pipeline_config_t pipeline_config = {
+        .panel_width = LCD_H_RES,
+        .panel_height = LCD_V_RES,
+        .queue_depth = 1,
+        .drop_policy = CAMERA_PIPELINE_BLOCK,
+        .task_priority = 5,
+        .jpeg_scale = c->scale,
+    };
+    uint32_t bad = 0;
+
+    lcd_fill_rect((lcd_region_t){0, 0, LCD_H_RES, LCD_V_RES}, BORDER_COLOR);
+    lcd_draw_wait(portMAX_DELAY);
+    ESP_ERROR_CHECK(camera_fake_start(fake_config));
+    ESP_ERROR_CHECK(camera_pipeline_start(pipeline_config));
+    vTaskDelay(pdMS_TO_TICKS(JPEG_RUN_MS));
+    ESP_ERROR_CHECK(camera_pipeline_stop());
+    camera_pipeline_get_stats(&stats);
+    camera_fake_stop();
+    lcd_draw_wait(portMAX_DELAY);
+
+    /*!< nothing is dropped while blocking, the last frame shown is the last one counted */
+    if (stats.displayed == 0)
+    {
+        ESP_LOGE(TAG, "%s: nothing displayed", c->name);
+        return 1;
+    }
+    uint32_t seq = stats.displayed - 1;
+    for (uint16_t y = 0; y < LCD_V_RES; y++)
+    {
+        for (uint16_t x = 0; x < LCD_H_RES; x++)
+        {
+            uint16_t want = pipeline_jpeg_expected(c, seq, x, y);
+            uint16_t got = lcd_mock_get_pixel(lcd_io, x, y);
+            if (got != want && bad++ == 0)
+            {
+                ESP_LOGE(TAG, "%s: pixel %d,%d is %04x, expected %04x", c->name, x, y, got, want);
+            }
+        }
+    }
+    ESP_LOGI(TAG, "%-30s displayed %3lu, %lu bad pixels", c->name, (unsigned long)stats.displayed, (unsigned long)bad);
+    return bad ? 1 : 0;
+}
+
+void app_main(void)
+{
+    const lcd_config_t lcd_config = {
+        .lcd_height_res = LCD_H_RES,
+        .lcd_vertical_res = LCD_V_RES,
+        .lcd_draw_buffer_height = 50,
+        .lcd_bits_per_pixel = 16,
+        .lcd_color_space = LCD_RGB_ELEMENT_ORDER_RGB,
+    };
+    uint32_t failures = 0;
+
+    frame_log.lock = xSemaphoreCreateMutex();
+    ESP_ERROR_CHECK(lcd_init(lcd_config));
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        failures += pipeline_case_run(&cases[i]);
+    }
+    for (size_t i = 0; i < sizeof(jpeg_cases) / sizeof(jpeg_cases[0]); i++)
+    {
+        failures += pipeline_jpeg_run(&jpeg_cases[i]);
+    }
+    ESP_ERROR_CHECK(lcd_deinit());
+
+    ESP_LOGI(TAG, "%s, %lu failures", failures ? "FAIL" : "PASS", (unsigned long)failures);
+    exit(failures ? 1 : 0);
+}
@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "frame_broker.h"
+#include "camera_fake.h"
+
+#define BENCH_CONSUMERS FRAME_BROKER_MAX_CONSUMERS
+#define BENCH_RUN_MS 2000
+
+typedef struct
+{
+    const char *name;
+    frame_broker_drop_policy_t drop_policy;
+    bool relay; /*!< every other frame is released by the relay task instead */
+} bench_consumer_t;
+
+static const char *TAG = "FRAME_BROKER_BENCH";
+
+static const bench_consumer_t bench_consumers[BENCH_CONSUMERS] = {
+    {"drop oldest", FRAME_BROKER_DROP_OLDEST, false},
+    {"drop oldest, relay", FRAME_BROKER_DROP_OLDEST, true},
+    {"drop newest", FRAME_BROKER_DROP_NEWEST, false},
+    {"drop newest, relay", FRAME_BROKER_DROP_NEWEST, true},
+};
+
+static QueueHandle_t relay_queue;
+static atomic_bool running = true;
+static atomic_uint corrupted = 0;
+static atomic_uint tasks_done = 0;
+
+/**
+ * @brief a frame someone holds a reference to keeps its buffer, which the fake camera would refill otherwise
+ */
+static void bench_check(const frame_broker_frame_t *frame, const camera_fb_t *fb, uint8_t first)
+{
+    if (frame->fb != fb || fb == NULL || fb->buf[0] != first)
+    {
+        atomic_fetch_add(&corrupted, 1);
+    }
+}
+
+static void bench_consumer_task(void *arg)
+{
+    const bench_consumer_t *config = &bench_consumers[(intptr_t)arg];
+    frame_broker_consumer_t consumer = (intptr_t)arg;
+    uint32_t n = 0;
+
+    while (atomic_load(&running))
+    {
+        frame_broker_frame_t *frame = frame_broker_take(consumer, pdMS_TO_TICKS(10));
+        if (frame == NULL)
+        {
+            continue;
+        }
+        camera_fb_t *fb = frame->fb;
+        uint8_t first = fb ? fb->buf[0] : 0;
+        taskYIELD();
+        bench_check(frame, fb, first);
+
+        /*!< a second reference released on another thread, racing the first one */
+        if (config->relay && (n++ & 1))
+        {
+            frame_broker_retain(frame);
+            if (xQueueSend(relay_queue, &frame, 0) != pdTRUE)
+            {
+                frame_broker_release(frame);
+            }
+        }
+        frame_broker_release(frame);
+    }
+    atomic_fetch_add(&tasks_done, 1);
+    vTaskDelete(NULL);
+}
+
+static void bench_relay_task(void *arg)
+{
+    frame_broker_frame_t *frame = NULL;
+
+    while (atomic_load(&running) || uxQueueMessagesWaiting(relay_queue))
+    {
+        if (xQueueReceive(relay_queue, &frame, pdMS_TO_TICKS(10)) == pdTRUE)
+        {
+            frame_broker_release(frame);
+        }
+    }
+    atomic_fetch_add(&tasks_done, 1);
+    vTaskDelete(NULL);
+}
+
+void app_main(void)
+{
+    const camera_fake_config_t fake_config = {
+        .width = 16,
+        .height = 16,
+        .frame_interval_ms = 0, /*!< as fast as the buffers come back */
+    };
+    const frame_broker_config_t broker_config = {
+        .task_priority = 5,
+        .task_core = tskNO_AFFINITY,
+    };
+    frame_broker_stats_t stats;
+    camera_fake_stats_t fake;
+    uint32_t failures = 0;
+
+    relay_queue = xQueueCreate(8, sizeof(frame_broker_frame_t *));
+    ESP_ERROR_CHECK(camera_fake_start(fake_config));
+    for (intptr_t i = 0; i < BENCH_CONSUMERS; i++)
+    {
+        frame_broker_consumer_t consumer;
+        const frame_broker_consumer_config_t config = {
+            .name = bench_consumers[i].name,
+            .queue_depth = 1,
+            .drop_policy = bench_consumers[i].drop_policy,
+        };
+        ESP_ERROR_CHECK(frame_broker_subscribe(config, &consumer));
+        xTaskCreate(bench_consumer_task, "consumer", 4096, (void *)i, 5, NULL);
+    }
+    xTaskCreate(bench_relay_task, "relay", 4096, NULL, 5, NULL);
+    ESP_ERROR_CHECK(frame_broker_start(broker_config));
+
+    vTaskDelay(pdMS_TO_TICKS(BENCH_RUN_MS));
+    atomic_store(&running, false);
+    while (atomic_load(&tasks_done) < BENCH_CONSUMERS + 1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    /*!< the capture task keeps running, frames still queued hold at most every buffer */
+    frame_broker_get_stats(&stats);
+    camera_fake_get_stats(&fake);
+
+    for (int i = 0; i < BENCH_CONSUMERS; i++)
+    {
+        frame_broker_consumer_stats_t consumer;
+        frame_broker_get_consumer_stats(i, &consumer);
+        ESP_LOGI(TAG, "%-20s received %6lu dropped %6lu max lag %lu", bench_consumers[i].name, (unsigned long)consumer.received, (unsigned long)consumer.dropped,
+                 (unsigned long)consumer.max_lag);
+    }
+    ESP_LOGI(TAG, "captured %lu, returned %lu, camera saw %lu returns, %lu bad", (unsigned long)stats.captured, (unsigned long)stats.returned, (unsigned long)fake.returned,
+             (unsigned long)fake.bad_returns);
+    if (fake.bad_returns)
+    {
+        ESP_LOGE(TAG, "%lu buffers given back twice or while another frame owned them", (unsigned long)fake.bad_returns);
+        failures++;
+    }
+    if (atomic_load(&corrupted))
+    {
+        ESP_LOGE(TAG, "%u frames changed while a consumer held them", atomic_load(&corrupted));
+        failures++;
+    }
+    if (stats.captured - stats.returned > CAMERA_FB_COUNT || stats.returned > stats.captured)
+    {
+        ESP_LOGE(TAG, "%lu frames unaccounted for", (unsigned long)(stats.captured - stats.returned));
+        failures++;
+    }
+
+    ESP_LOGI(TAG, "%s, %lu failures", failures ? "FAIL" : "PASS", (unsigned long)failures);
+    exit(failures ? 1 : 0);
+}
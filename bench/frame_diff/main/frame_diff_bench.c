@@ -0,0 +1,192 @@
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "st7789.h"
+#include "lcd_mock.h"
+#include "frame_diff.h"
+
+#define LCD_H_RES 240 /*!< same panel as the board build */
+#define LCD_V_RES 240
+#define TILE_SIZE 16
+#define IGNORE_BITS 1
+#define TILE_THRESHOLD 8
+
+/**
+ * @brief a run of frames with the same kind of motion
+ */
+typedef enum
+{
+    SCENE_STILL,  /*!< fixed scene, the sensor noise flips the lowest bit of each channel */
+    SCENE_OBJECT, /*!< a 40x40 square crosses the fixed scene */
+    SCENE_FLICKER, /*!< a few pixels per tile change, below the threshold */
+    SCENE_CUT,    /*!< every frame a different scene */
+    SCENE_PAN,    /*!< the whole scene moves a pixel per frame */
+} scene_kind_t;
+
+typedef struct
+{
+    const char *name;
+    scene_kind_t kind;
+    uint16_t frames;
+} scene_t;
+
+static const char *TAG = "FRAME_DIFF_BENCH";
+
+static const scene_t scenes[] = {
+    {"still + noise", SCENE_STILL, 20},
+    {"moving object", SCENE_OBJECT, 20},
+    {"flicker", SCENE_FLICKER, 10},
+    {"scene cuts", SCENE_CUT, 5},
+    {"pan", SCENE_PAN, 10},
+};
+
+static uint16_t frame[LCD_H_RES * LCD_V_RES];
+static uint32_t rng = 1;
+
+static uint32_t bench_rand(void)
+{
+    rng = rng * 1103515245 + 12345;
+    return rng >> 8;
+}
+
+static uint16_t scene_pixel(uint16_t x, uint16_t y, uint16_t seed)
+{
+    uint8_t r = (x * 2 + seed * 37) & 0xFF;
+    uint8_t g = (y * 3 + seed * 11) & 0xFF;
+    uint8_t b = ((x ^ y) + seed * 5) & 0xFF;
+    return rgb565(r, g, b);
+}
+
+/**
+ * @brief render frame n of a scene, byte swapped as the camera delivers it
+ */
+static void scene_render(const scene_t *scene, uint16_t n)
+{
+    uint16_t seed = scene->kind == SCENE_CUT ? n + 1 : 0;
+    uint16_t pan = scene->kind == SCENE_PAN ? n + 1 : 0;
+    uint16_t obj_x = 10 + n * 9;
+    uint16_t obj_y = 100;
+
+    for (uint16_t y = 0; y < LCD_V_RES; y++)
+    {
+        for (uint16_t x = 0; x < LCD_H_RES; x++)
+        {
+            uint16_t c = scene_pixel(x + pan, y, seed);
+            if (scene->kind == SCENE_OBJECT && x >= obj_x && x < obj_x + 40 && y >= obj_y && y < obj_y + 40)
+            {
+                c = 0xF800;
+            }
+            /*!< noise in the lowest bit of red, green and blue */
+            c ^= bench_rand() & 0x0821;
+            frame[y * LCD_H_RES + x] = swap_hex(c);
+        }
+    }
+    if (scene->kind == SCENE_FLICKER)
+    {
+        for (uint16_t ty = 0; ty < LCD_V_RES; ty += TILE_SIZE)
+        {
+            for (uint16_t tx = 0; tx < LCD_H_RES; tx += TILE_SIZE)
+            {
+                for (int i = 0; i < TILE_THRESHOLD / 2; i++)
+                {
+                    frame[(ty + bench_rand() % TILE_SIZE) * LCD_H_RES + tx + bench_rand() % TILE_SIZE] ^= 0xFFFF;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief the panel may differ from the frame only in ignored bits, and in at most TILE_THRESHOLD pixels per tile
+ */
+static uint32_t scene_check(void)
+{
+    const uint16_t low = (1 << IGNORE_BITS) - 1;
+    const uint16_t mask = ~((low << 11) | (low << 5) | low);
+    uint32_t bad_tiles = 0;
+
+    for (uint16_t ty = 0; ty < LCD_V_RES; ty += TILE_SIZE)
+    {
+        for (uint16_t tx = 0; tx < LCD_H_RES; tx += TILE_SIZE)
+        {
+            uint32_t changes = 0;
+            for (uint16_t y = ty; y < ty + TILE_SIZE; y++)
+            {
+                for (uint16_t x = tx; x < tx + TILE_SIZE; x++)
+                {
+                    uint16_t want = swap_hex(frame[y * LCD_H_RES + x]);
+                    changes += ((lcd_mock_get_pixel(lcd_io, x, y) ^ want) & mask) != 0;
+                }
+            }
+            bad_tiles += changes > TILE_THRESHOLD;
+        }
+    }
+    return bad_tiles;
+}
+
+void app_main(void)
+{
+    const lcd_config_t lcd_config = {
+        .lcd_height_res = LCD_H_RES,
+        .lcd_vertical_res = LCD_V_RES,
+        .lcd_draw_buffer_height = 50,
+        .lcd_bits_per_pixel = 16,
+        .lcd_color_space = LCD_RGB_ELEMENT_ORDER_RGB,
+        .pclk_hz = 40 * 1000 * 1000,
+    };
+    const frame_diff_config_t diff_config = {
+        .width = LCD_H_RES,
+        .height = LCD_V_RES,
+        .tile_size = TILE_SIZE,
+        .ignore_bits = IGNORE_BITS,
+        .tile_threshold = TILE_THRESHOLD,
+    };
+    const uint32_t frame_bytes = LCD_H_RES * LCD_V_RES * sizeof(uint16_t);
+    frame_diff_stats_t before;
+    frame_diff_stats_t after;
+    lcd_mock_stats_t bus;
+    uint32_t failures = 0;
+
+    ESP_ERROR_CHECK(lcd_init(lcd_config));
+    ESP_ERROR_CHECK(frame_diff_init(diff_config));
+
+    /*!< the first frame has no reference and goes out whole */
+    scene_render(&scenes[0], 0);
+    ESP_ERROR_CHECK(frame_diff_draw(frame));
+    lcd_draw_wait(portMAX_DELAY);
+    lcd_mock_frame_end(lcd_io, NULL, NULL);
+
+    ESP_LOGI(TAG, "%-14s %6s %12s %10s %7s %12s", "scene", "frames", "tiles sent", "KB sent", "saved", "bus us/frame");
+    for (size_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++)
+    {
+        const scene_t *scene = &scenes[i];
+        uint32_t bad_tiles = 0;
+
+        frame_diff_get_stats(&before);
+        for (uint16_t n = 0; n < scene->frames; n++)
+        {
+            scene_render(scene, n);
+            ESP_ERROR_CHECK(frame_diff_draw(frame));
+            lcd_draw_wait(portMAX_DELAY);
+            bad_tiles += scene_check();
+        }
+        frame_diff_get_stats(&after);
+        lcd_mock_frame_end(lcd_io, &bus, NULL);
+
+        uint32_t tiles = after.tiles_total - before.tiles_total;
+        uint32_t sent = after.tiles_sent - before.tiles_sent;
+        uint32_t bytes = after.bytes_sent - before.bytes_sent;
+        uint32_t full = frame_bytes * scene->frames;
+        ESP_LOGI(TAG, "%-14s %6d %5lu/%-6lu %10lu %6lu%% %12lu", scene->name, scene->frames, (unsigned long)sent, (unsigned long)tiles, (unsigned long)(bytes / 1024),
+                 (unsigned long)((full - bytes) * 100ULL / full), (unsigned long)(bus.bus_time_ns / 1000 / scene->frames));
+        if (bad_tiles)
+        {
+            ESP_LOGE(TAG, "%s: %lu tiles on the panel differ from the frame beyond the threshold", scene->name, (unsigned long)bad_tiles);
+            failures++;
+        }
+    }
+    ESP_ERROR_CHECK(lcd_deinit());
+
+    ESP_LOGI(TAG, "%s, %lu failures", failures ? "FAIL" : "PASS", (unsigned long)failures);
+    exit(failures ? 1 : 0);
+}
@@ -0,0 +1,196 @@
+// Test image for the img_rle bench, in the layout of the LVGL image converter
+// 300x6 LV_IMG_CF_TRUE_COLOR_ALPHA: long runs, long literals, short runs and runs that differ in alpha only
+
+#include "lvgl.h"
+
+const uint8_t img_rle_alpha_map[] = {
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,0x34,0x12,0xFF,
+    0x00,0x00,0x00,0xF3,0x6E,0x01,0xE6,0xDD,0x02,0xDA,0x4C,0x03,0xCD,0xBB,0x04,0xC0,0x2A,0x05,0xB4,0x99,0x06,0xA7,0x08,0x07,0x9B,0x77,0x08,0x8E,0xE6,0x09,
+    0x81,0x55,0x0A,0x75,0xC4,0x0B,0x68,0x33,0x0C,0x5B,0xA2,0x0D,0x4F,0x11,0x0E,0x42,0x80,0x0F,0x36,0xEF,0x10,0x29,0x5E,0x11,0x1C,0xCD,0x12,0x10,0x3C,0x13,
+    0x03,0xAB,0x14,0xF7,0x19,0x15,0xEA,0x88,0x16,0xDD,0xF7,0x17,0xD1,0x66,0x18,0xC4,0xD5,0x19,0xB7,0x44,0x1A,0xAB,0xB3,0x1B,0x9E,0x22,0x1C,0x92,0x91,0x1D,
+    0x85,0x00,0x1E,0x78,0x6F,0x1F,0x6C,0xDE,0x20,0x5F,0x4D,0x21,0x53,0xBC,0x22,0x46,0x2B,0x23,0x39,0x9A,0x24,0x2D,0x09,0x25,0x20,0x78,0x26,0x13,0xE7,0x27,
+    0x07,0x56,0x28,0xFA,0xC4,0x29,0xEE,0x33,0x2A,0xE1,0xA2,0x2B,0xD4,0x11,0x2C,0xC8,0x80,0x2D,0xBB,0xEF,0x2E,0xAE,0x5E,0x2F,0xA2,0xCD,0x30,0x95,0x3C,0x31,
+    0x89,0xAB,0x32,0x7C,0x1A,0x33,0x6F,0x89,0x34,0x63,0xF8,0x35,0x56,0x67,0x36,0x4A,0xD6,0x37,0x3D,0x45,0x38,0x30,0xB4,0x39,0x24,0x23,0x3A,0x17,0x92,0x3B,
+    0x0A,0x01,0x3C,0xFE,0x6F,0x3D,0xF1,0xDE,0x3E,0xE5,0x4D,0x3F,0xD8,0xBC,0x40,0xCB,0x2B,0x41,0xBF,0x9A,0x42,0xB2,0x09,0x43,0xA6,0x78,0x44,0x99,0xE7,0x45,
+    0x8C,0x56,0x46,0x80,0xC5,0x47,0x73,0x34,0x48,0x66,0xA3,0x49,0x5A,0x12,0x4A,0x4D,0x81,0x4B,0x41,0xF0,0x4C,0x34,0x5F,0x4D,0x27,0xCE,0x4E,0x1B,0x3D,0x4F,
+    0x0E,0xAC,0x50,0x02,0x1B,0x51,0xF5,0x89,0x52,0xE8,0xF8,0x53,0xDC,0x67,0x54,0xCF,0xD6,0x55,0xC2,0x45,0x56,0xB6,0xB4,0x57,0xA9,0x23,0x58,0x9D,0x92,0x59,
+    0x90,0x01,0x5A,0x83,0x70,0x5B,0x77,0xDF,0x5C,0x6A,0x4E,0x5D,0x5D,0xBD,0x5E,0x51,0x2C,0x5F,0x44,0x9B,0x60,0x38,0x0A,0x61,0x2B,0x79,0x62,0x1E,0xE8,0x63,
+    0x12,0x57,0x64,0x05,0xC6,0x65,0xF9,0x34,0x66,0xEC,0xA3,0x67,0xDF,0x12,0x68,0xD3,0x81,0x69,0xC6,0xF0,0x6A,0xB9,0x5F,0x6B,0xAD,0xCE,0x6C,0xA0,0x3D,0x6D,
+    0x94,0xAC,0x6E,0x87,0x1B,0x6F,0x7A,0x8A,0x70,0x6E,0xF9,0x71,0x61,0x68,0x72,0x55,0xD7,0x73,0x48,0x46,0x74,0x3B,0xB5,0x75,0x2F,0x24,0x76,0x22,0x93,0x77,
+    0x15,0x02,0x78,0x09,0x71,0x79,0xFC,0xDF,0x7A,0xF0,0x4E,0x7B,0xE3,0xBD,0x7C,0xD6,0x2C,0x7D,0xCA,0x9B,0x7E,0xBD,0x0A,0x7F,0xB1,0x79,0x80,0xA4,0xE8,0x81,
+    0x97,0x57,0x82,0x8B,0xC6,0x83,0x7E,0x35,0x84,0x71,0xA4,0x85,0x65,0x13,0x86,0x58,0x82,0x87,0x4C,0xF1,0x88,0x3F,0x60,0x89,0x32,0xCF,0x8A,0x26,0x3E,0x8B,
+    0x19,0xAD,0x8C,0x0C,0x1C,0x8D,0x00,0x8B,0x8E,0xF3,0xF9,0x8F,0xE7,0x68,0x90,0xDA,0xD7,0x91,0xCD,0x46,0x92,0xC1,0xB5,0x93,0xB4,0x24,0x94,0xA8,0x93,0x95,
+    0x9B,0x02,0x96,0x8E,0x71,0x97,0x82,0xE0,0x98,0x75,0x4F,0x99,0x68,0xBE,0x9A,0x5C,0x2D,0x9B,0x4F,0x9C,0x9C,0x43,0x0B,0x9D,0x36,0x7A,0x9E,0x29,0xE9,0x9F,
+    0x1D,0x58,0xA0,0x10,0xC7,0xA1,0x04,0x36,0xA2,0xF7,0xA4,0xA3,0xEA,0x13,0xA4,0xDE,0x82,0xA5,0xD1,0xF1,0xA6,0xC4,0x60,0xA7,0xB8,0xCF,0xA8,0xAB,0x3E,0xA9,
+    0x9F,0xAD,0xAA,0x92,0x1C,0xAB,0x85,0x8B,0xAC,0x79,0xFA,0xAD,0x6C,0x69,0xAE,0x5F,0xD8,0xAF,0x53,0x47,0xB0,0x46,0xB6,0xB1,0x3A,0x25,0xB2,0x2D,0x94,0xB3,
+    0x20,0x03,0xB4,0x14,0x72,0xB5,0x07,0xE1,0xB6,0xFB,0x4F,0xB7,0xEE,0xBE,0xB8,0xE1,0x2D,0xB9,0xD5,0x9C,0xBA,0xC8,0x0B,0xBB,0xBB,0x7A,0xBC,0xAF,0xE9,0xBD,
+    0xA2,0x58,0xBE,0x96,0xC7,0xBF,0x89,0x36,0xC0,0x7C,0xA5,0xC1,0x70,0x14,0xC2,0x63,0x83,0xC3,0x57,0xF2,0xC4,0x4A,0x61,0xC5,0x3D,0xD0,0xC6,0x31,0x3F,0xC7,
+    0x24,0xAE,0xC8,0x17,0x1D,0xC9,0x0B,0x8C,0xCA,0xFE,0xFA,0xCB,0xF2,0x69,0xCC,0xE5,0xD8,0xCD,0xD8,0x47,0xCE,0xCC,0xB6,0xCF,0xBF,0x25,0xD0,0xB3,0x94,0xD1,
+    0xA6,0x03,0xD2,0x99,0x72,0xD3,0x8D,0xE1,0xD4,0x80,0x50,0xD5,0x73,0xBF,0xD6,0x67,0x2E,0xD7,0x5A,0x9D,0xD8,0x4E,0x0C,0xD9,0x41,0x7B,0xDA,0x34,0xEA,0xDB,
+    0x28,0x59,0xDC,0x1B,0xC8,0xDD,0x0E,0x37,0xDE,0x02,0xA6,0xDF,0xF5,0x14,0xE0,0xE9,0x83,0xE1,0xDC,0xF2,0xE2,0xCF,0x61,0xE3,0xC3,0xD0,0xE4,0xB6,0x3F,0xE5,
+    0xAA,0xAE,0xE6,0x9D,0x1D,0xE7,0x90,0x8C,0xE8,0x84,0xFB,0xE9,0x77,0x6A,0xEA,0x6A,0xD9,0xEB,0x5E,0x48,0xEC,0x51,0xB7,0xED,0x45,0x26,0xEE,0x38,0x95,0xEF,
+    0x2B,0x04,0xF0,0x1F,0x73,0xF1,0x12,0xE2,0xF2,0x06,0x51,0xF3,0xF9,0xBF,0xF4,0xEC,0x2E,0xF5,0xE0,0x9D,0xF6,0xD3,0x0C,0xF7,0xC6,0x7B,0xF8,0xBA,0xEA,0xF9,
+    0xAD,0x59,0xFA,0xA1,0xC8,0xFB,0x94,0x37,0xFC,0x87,0xA6,0xFD,0x7B,0x15,0xFE,0x6E,0x84,0xFF,0x62,0xF3,0x00,0x55,0x62,0x01,0x48,0xD1,0x02,0x3C,0x40,0x03,
+    0x2F,0xAF,0x04,0x22,0x1E,0x05,0x16,0x8D,0x06,0x09,0xFC,0x07,0xFD,0x6A,0x08,0xF0,0xD9,0x09,0xE3,0x48,0x0A,0xD7,0xB7,0x0B,0xCA,0x26,0x0C,0xBD,0x95,0x0D,
+    0xB1,0x04,0x0E,0xA4,0x73,0x0F,0x98,0xE2,0x10,0x8B,0x51,0x11,0x7E,0xC0,0x12,0x72,0x2F,0x13,0x65,0x9E,0x14,0x59,0x0D,0x15,0x4C,0x7C,0x16,0x3F,0xEB,0x17,
+    0x33,0x5A,0x18,0x26,0xC9,0x19,0x19,0x38,0x1A,0x0D,0xA7,0x1B,0x00,0x16,0x1C,0xF4,0x84,0x1D,0xE7,0xF3,0x1E,0xDA,0x62,0x1F,0xCE,0xD1,0x20,0xC1,0x40,0x21,
+    0xB5,0xAF,0x22,0xA8,0x1E,0x23,0x9B,0x8D,0x24,0x8F,0xFC,0x25,0x82,0x6B,0x26,0x75,0xDA,0x27,0x69,0x49,0x28,0x5C,0xB8,0x29,0x50,0x27,0x2A,0x43,0x96,0x2B,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,
+    0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,
+    0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0xE0,0x07,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,0x00,0xF8,0x80,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,0xCD,0xAB,0xFF,0xCD,0xAB,0x00,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,0x00,0x00,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,0x11,0x11,0x40,
+    0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,
+    0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,
+    0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,
+    0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,0x22,0x22,0x40,
+    0x00,0x00,0xFF,0x01,0x00,0xFF,0x04,0x00,0xFF,0x09,0x00,0xFF,0x10,0x00,0xFF,0x00,0x00,0xFF,0x24,0x00,0xFF,0x31,0x00,0xFF,0x40,0x00,0xFF,0x51,0x00,0xFF,
+    0x00,0x00,0xFF,0x79,0x00,0xFF,0x90,0x00,0xFF,0xA9,0x00,0xFF,0xC4,0x00,0xFF,0x00,0x00,0xFF,0x00,0x01,0xFF,0x21,0x01,0xFF,0x44,0x01,0xFF,0x69,0x01,0xFF,
+    0x00,0x00,0xFF,0xB9,0x01,0xFF,0xE4,0x01,0xFF,0x11,0x02,0xFF,0x40,0x02,0xFF,0x00,0x00,0xFF,0xA4,0x02,0xFF,0xD9,0x02,0xFF,0x10,0x03,0xFF,0x49,0x03,0xFF,
+    0x00,0x00,0xFF,0xC1,0x03,0xFF,0x00,0x04,0xFF,0x41,0x04,0xFF,0x84,0x04,0xFF,0x00,0x00,0xFF,0x10,0x05,0xFF,0x59,0x05,0xFF,0xA4,0x05,0xFF,0xF1,0x05,0xFF,
+    0x00,0x00,0xFF,0x91,0x06,0xFF,0xE4,0x06,0xFF,0x39,0x07,0xFF,0x90,0x07,0xFF,0x00,0x00,0xFF,0x44,0x08,0xFF,0xA1,0x08,0xFF,0x00,0x09,0xFF,0x61,0x09,0xFF,
+    0x00,0x00,0xFF,0x29,0x0A,0xFF,0x90,0x0A,0xFF,0xF9,0x0A,0xFF,0x64,0x0B,0xFF,0x00,0x00,0xFF,0x40,0x0C,0xFF,0xB1,0x0C,0xFF,0x24,0x0D,0xFF,0x99,0x0D,0xFF,
+    0x00,0x00,0xFF,0x89,0x0E,0xFF,0x04,0x0F,0xFF,0x81,0x0F,0xFF,0x00,0x10,0xFF,0x00,0x00,0xFF,0x04,0x11,0xFF,0x89,0x11,0xFF,0x10,0x12,0xFF,0x99,0x12,0xFF,
+    0x00,0x00,0xFF,0xB1,0x13,0xFF,0x40,0x14,0xFF,0xD1,0x14,0xFF,0x64,0x15,0xFF,0x00,0x00,0xFF,0x90,0x16,0xFF,0x29,0x17,0xFF,0xC4,0x17,0xFF,0x61,0x18,0xFF,
+    0x00,0x00,0xFF,0xA1,0x19,0xFF,0x44,0x1A,0xFF,0xE9,0x1A,0xFF,0x90,0x1B,0xFF,0x00,0x00,0xFF,0xE4,0x1C,0xFF,0x91,0x1D,0xFF,0x40,0x1E,0xFF,0xF1,0x1E,0xFF,
+    0x00,0x00,0xFF,0x59,0x20,0xFF,0x10,0x21,0xFF,0xC9,0x21,0xFF,0x84,0x22,0xFF,0x00,0x00,0xFF,0x00,0x24,0xFF,0xC1,0x24,0xFF,0x84,0x25,0xFF,0x49,0x26,0xFF,
+    0x00,0x00,0xFF,0xD9,0x27,0xFF,0xA4,0x28,0xFF,0x71,0x29,0xFF,0x40,0x2A,0xFF,0x00,0x00,0xFF,0xE4,0x2B,0xFF,0xB9,0x2C,0xFF,0x90,0x2D,0xFF,0x69,0x2E,0xFF,
+    0x00,0x00,0xFF,0x21,0x30,0xFF,0x00,0x31,0xFF,0xE1,0x31,0xFF,0xC4,0x32,0xFF,0x00,0x00,0xFF,0x90,0x34,0xFF,0x79,0x35,0xFF,0x64,0x36,0xFF,0x51,0x37,0xFF,
+    0x00,0x00,0xFF,0x31,0x39,0xFF,0x24,0x3A,0xFF,0x19,0x3B,0xFF,0x10,0x3C,0xFF,0x00,0x00,0xFF,0x04,0x3E,0xFF,0x01,0x3F,0xFF,0x00,0x40,0xFF,0x01,0x41,0xFF,
+    0x00,0x00,0xFF,0x09,0x43,0xFF,0x10,0x44,0xFF,0x19,0x45,0xFF,0x24,0x46,0xFF,0x00,0x00,0xFF,0x40,0x48,0xFF,0x51,0x49,0xFF,0x64,0x4A,0xFF,0x79,0x4B,0xFF,
+    0x00,0x00,0xFF,0xA9,0x4D,0xFF,0xC4,0x4E,0xFF,0xE1,0x4F,0xFF,0x00,0x51,0xFF,0x00,0x00,0xFF,0x44,0x53,0xFF,0x69,0x54,0xFF,0x90,0x55,0xFF,0xB9,0x56,0xFF,
+    0x00,0x00,0xFF,0x11,0x59,0xFF,0x40,0x5A,0xFF,0x71,0x5B,0xFF,0xA4,0x5C,0xFF,0x00,0x00,0xFF,0x10,0x5F,0xFF,0x49,0x60,0xFF,0x84,0x61,0xFF,0xC1,0x62,0xFF,
+    0x00,0x00,0xFF,0x41,0x65,0xFF,0x84,0x66,0xFF,0xC9,0x67,0xFF,0x10,0x69,0xFF,0x00,0x00,0xFF,0xA4,0x6B,0xFF,0xF1,0x6C,0xFF,0x40,0x6E,0xFF,0x91,0x6F,0xFF,
+    0x00,0x00,0xFF,0x39,0x72,0xFF,0x90,0x73,0xFF,0xE9,0x74,0xFF,0x44,0x76,0xFF,0x00,0x00,0xFF,0x00,0x79,0xFF,0x61,0x7A,0xFF,0xC4,0x7B,0xFF,0x29,0x7D,0xFF,
+    0x00,0x00,0xFF,0xF9,0x7F,0xFF,0x64,0x81,0xFF,0xD1,0x82,0xFF,0x40,0x84,0xFF,0x00,0x00,0xFF,0x24,0x87,0xFF,0x99,0x88,0xFF,0x10,0x8A,0xFF,0x89,0x8B,0xFF,
+    0x00,0x00,0xFF,0x81,0x8E,0xFF,0x00,0x90,0xFF,0x81,0x91,0xFF,0x04,0x93,0xFF,0x00,0x00,0xFF,0x10,0x96,0xFF,0x99,0x97,0xFF,0x24,0x99,0xFF,0xB1,0x9A,0xFF,
+    0x00,0x00,0xFF,0xD1,0x9D,0xFF,0x64,0x9F,0xFF,0xF9,0xA0,0xFF,0x90,0xA2,0xFF,0x00,0x00,0xFF,0xC4,0xA5,0xFF,0x61,0xA7,0xFF,0x00,0xA9,0xFF,0xA1,0xAA,0xFF,
+    0x00,0x00,0xFF,0xE9,0xAD,0xFF,0x90,0xAF,0xFF,0x39,0xB1,0xFF,0xE4,0xB2,0xFF,0x00,0x00,0xFF,0x40,0xB6,0xFF,0xF1,0xB7,0xFF,0xA4,0xB9,0xFF,0x59,0xBB,0xFF,
+    0x00,0x00,0xFF,0xC9,0xBE,0xFF,0x84,0xC0,0xFF,0x41,0xC2,0xFF,0x00,0xC4,0xFF,0x00,0x00,0xFF,0x84,0xC7,0xFF,0x49,0xC9,0xFF,0x10,0xCB,0xFF,0xD9,0xCC,0xFF,
+    0x00,0x00,0xFF,0x71,0xD0,0xFF,0x40,0xD2,0xFF,0x11,0xD4,0xFF,0xE4,0xD5,0xFF,0x00,0x00,0xFF,0x90,0xD9,0xFF,0x69,0xDB,0xFF,0x44,0xDD,0xFF,0x21,0xDF,0xFF,
+    0x00,0x00,0xFF,0xE1,0xE2,0xFF,0xC4,0xE4,0xFF,0xA9,0xE6,0xFF,0x90,0xE8,0xFF,0x00,0x00,0xFF,0x64,0xEC,0xFF,0x51,0xEE,0xFF,0x40,0xF0,0xFF,0x31,0xF2,0xFF,
+    0x00,0x00,0xFF,0x19,0xF6,0xFF,0x10,0xF8,0xFF,0x09,0xFA,0xFF,0x04,0xFC,0xFF,0x00,0x00,0xFF,0x00,0x00,0xFF,0x01,0x02,0xFF,0x04,0x04,0xFF,0x09,0x06,0xFF,
+    0x00,0x00,0xFF,0x19,0x0A,0xFF,0x24,0x0C,0xFF,0x31,0x0E,0xFF,0x40,0x10,0xFF,0x00,0x00,0xFF,0x64,0x14,0xFF,0x79,0x16,0xFF,0x90,0x18,0xFF,0xA9,0x1A,0xFF,
+    0x00,0x00,0xFF,0xE1,0x1E,0xFF,0x00,0x21,0xFF,0x21,0x23,0xFF,0x44,0x25,0xFF,0x00,0x00,0xFF,0x90,0x29,0xFF,0xB9,0x2B,0xFF,0xE4,0x2D,0xFF,0x11,0x30,0xFF,
+    0x00,0x00,0xFF,0x71,0x34,0xFF,0xA4,0x36,0xFF,0xD9,0x38,0xFF,0x10,0x3B,0xFF,0x00,0x00,0xFF,0x84,0x3F,0xFF,0xC1,0x41,0xFF,0x00,0x44,0xFF,0x41,0x46,0xFF,
+    0x00,0x00,0xFF,0xC9,0x4A,0xFF,0x10,0x4D,0xFF,0x59,0x4F,0xFF,0xA4,0x51,0xFF,0x00,0x00,0xFF,0x40,0x56,0xFF,0x91,0x58,0xFF,0xE4,0x5A,0xFF,0x39,0x5D,0xFF,
+};
+
+const lv_img_dsc_t img_rle_alpha = {
+    .header.always_zero = 0,
+    .header.w = 300,
+    .header.h = 6,
+    .data_size = sizeof(img_rle_alpha_map),
+    .header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA,
+    .data = img_rle_alpha_map,
+};
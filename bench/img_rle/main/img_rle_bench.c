@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+#include "img_rle.h"
+
+#define BENCH_DECODE_RUNS 20
+
+typedef struct
+{
+    const char *name;
+    const lv_img_dsc_t *raw;   /*!< as the image converter wrote it */
+    const lv_img_dsc_t *coded; /*!< the same image through tools/img_rle.py */
+} bench_image_t;
+
+extern const lv_img_dsc_t img_rle_alpha;
+extern const lv_img_dsc_t img_rle_alpha_rle;
+extern const lv_img_dsc_t ui_img_9460735_png;
+extern const lv_img_dsc_t ui_img_9460735_png_rle;
+
+static const char *TAG = "IMG_RLE_BENCH";
+
+static uint32_t bench_line_end(const img_rle_header_t *rle, size_t data_size, uint16_t y)
+{
+    return (y + 1 < rle->height) ? rle->line_offset[y + 1] : data_size;
+}
+
+/**
+ * @brief every line decodes to the source pixels, uses up its coded bytes, and codes the same in C
+ */
+static uint32_t bench_round_trip(const bench_image_t *image)
+{
+    const img_rle_header_t *rle = (const img_rle_header_t *)image->coded->data;
+    uint8_t pixel_size = image->raw->header.cf == LV_IMG_CF_TRUE_COLOR_ALPHA ? 3 : 2;
+    uint32_t stride = image->raw->header.w * pixel_size;
+    uint8_t *line = malloc(stride);
+    uint8_t *coded = malloc(image->raw->header.w * (pixel_size + 1));
+    uint32_t errors = 0;
+
+    if (rle->magic != IMG_RLE_MAGIC || rle->width != image->raw->header.w || rle->height != image->raw->header.h || rle->pixel_size != pixel_size ||
+        image->coded->header.cf != IMG_RLE_CF)
+    {
+        ESP_LOGE(TAG, "%s: bad header", image->name);
+        free(line);
+        free(coded);
+        return 1;
+    }
+    for (uint16_t y = 0; y < rle->height; y++)
+    {
+        const uint8_t *src = image->coded->data + rle->line_offset[y];
+        uint32_t size = bench_line_end(rle, image->coded->data_size, y) - rle->line_offset[y];
+
+        memset(line, 0xA5, stride);
+        if (img_rle_decode_line(src, size, line, rle->width, pixel_size) != size || memcmp(line, image->raw->data + y * stride, stride) != 0)
+        {
+            ESP_LOGE(TAG, "%s: line %u does not decode to its pixels", image->name, y);
+            errors++;
+        }
+        if (img_rle_encode_line(image->raw->data + y * stride, coded, rle->width, pixel_size) != size || memcmp(coded, src, size) != 0)
+        {
+            ESP_LOGE(TAG, "%s: line %u codes differently in img_rle_encode_line", image->name, y);
+            errors++;
+        }
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (int run = 0; run < BENCH_DECODE_RUNS; run++)
+    {
+        for (uint16_t y = 0; y < rle->height; y++)
+        {
+            img_rle_decode_line(image->coded->data + rle->line_offset[y], image->coded->data_size - rle->line_offset[y], line, rle->width, pixel_size);
+        }
+    }
+    int64_t us = esp_timer_get_time() - start;
+    ESP_LOGI(TAG, "%s: %ux%u, %lu bytes coded into %lu, decode %lu ns per pixel", image->name, rle->width, rle->height,
+             (unsigned long)(stride * rle->height), (unsigned long)image->coded->data_size,
+             (unsigned long)(us * 1000 / ((int64_t)BENCH_DECODE_RUNS * rle->width * rle->height)));
+
+    free(line);
+    free(coded);
+    return errors;
+}
+
+/**
+ * @brief a run past the end of the line, or a line past the end of its source, is refused, not written
+ */
+static uint32_t bench_corrupt(void)
+{
+    const uint8_t run[] = {0x80 | 9, 0x12, 0x34};             /*!< 10 pixels */
+    const uint8_t literal[] = {4, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}; /*!< 5 pixels */
+    uint8_t line[9 * 2 + 1];
+    uint32_t errors = 0;
+
+    line[sizeof(line) - 1] = 0x5A;
+    if (img_rle_decode_line(run, sizeof(run), line, 9, 2) != 0 || img_rle_decode_line(literal, sizeof(literal), line, 4, 2) != 0 ||
+        line[sizeof(line) - 1] != 0x5A)
+    {
+        ESP_LOGE(TAG, "Line longer than the image was decoded");
+        errors++;
+    }
+    if (img_rle_decode_line(run, sizeof(run) - 1, line, 9, 2) != 0 || img_rle_decode_line(literal, sizeof(literal) - 1, line, 5, 2) != 0 ||
+        img_rle_decode_line(literal, 0, line, 5, 2) != 0 || img_rle_decode_line(literal, sizeof(literal), line, 5, 2) != sizeof(literal))
+    {
+        ESP_LOGE(TAG, "Truncated line was decoded");
+        errors++;
+    }
+    return errors;
+}
+
+/**
+ * @brief a truncated image fails on its last line, a line offset past the data fails to open
+ */
+static uint32_t bench_truncated(const bench_image_t *image)
+{
+    lv_img_dsc_t damaged = *image->coded;
+    uint8_t *data = malloc(damaged.data_size);
+    img_rle_header_t *rle = (img_rle_header_t *)data;
+    uint8_t *buf = malloc(damaged.header.w * LV_IMG_PX_SIZE_ALPHA_BYTE);
+    lv_img_decoder_dsc_t dsc;
+    uint32_t errors = 0;
+
+    memcpy(data, image->coded->data, damaged.data_size);
+    damaged.data = data;
+    damaged.data_size--;
+    if (lv_img_decoder_open(&dsc, &damaged, lv_color_black(), 0) != LV_RES_OK)
+    {
+        ESP_LOGE(TAG, "%s: one byte short does not open", image->name);
+        errors++;
+    }
+    else
+    {
+        if (lv_img_decoder_read_line(&dsc, 0, rle->height - 2, rle->width, buf) != LV_RES_OK ||
+            lv_img_decoder_read_line(&dsc, 0, rle->height - 1, rle->width, buf) == LV_RES_OK)
+        {
+            ESP_LOGE(TAG, "%s: one byte short, the last line decoded or the one before did not", image->name);
+            errors++;
+        }
+        lv_img_decoder_close(&dsc);
+    }
+
+    damaged.data_size++;
+    rle->line_offset[rle->height / 2] = damaged.data_size;
+    if (lv_img_decoder_open(&dsc, &damaged, lv_color_black(), 0) == LV_RES_OK)
+    {
+        ESP_LOGE(TAG, "%s: opened with a line past the data", image->name);
+        errors++;
+        lv_img_decoder_close(&dsc);
+    }
+
+    free(buf);
+    free(data);
+    return errors;
+}
+
+/**
+ * @brief the registered decoder reports a RAW format and reads lines as LVGL draws them
+ */
+static uint32_t bench_lvgl(const bench_image_t *image)
+{
+    bool alpha = image->raw->header.cf == LV_IMG_CF_TRUE_COLOR_ALPHA;
+    uint8_t px_size = alpha ? LV_IMG_PX_SIZE_ALPHA_BYTE : LV_COLOR_SIZE / 8;
+    uint16_t width = image->raw->header.w;
+    uint16_t height = image->raw->header.h;
+    uint8_t *buf = malloc(width * LV_IMG_PX_SIZE_ALPHA_BYTE);
+    lv_img_header_t header;
+    lv_img_decoder_dsc_t dsc;
+    uint32_t errors = 0;
+
+    if (lv_img_decoder_get_info(image->coded, &header) != LV_RES_OK || header.cf != (alpha ? LV_IMG_CF_RAW_ALPHA : LV_IMG_CF_RAW) ||
+        header.w != width || header.h != height)
+    {
+        ESP_LOGE(TAG, "%s: decoder reports format %u, %ux%u", image->name, header.cf, header.w, header.h);
+        free(buf);
+        return 1;
+    }
+    if (lv_img_decoder_open(&dsc, image->coded, lv_color_black(), 0) != LV_RES_OK)
+    {
+        ESP_LOGE(TAG, "%s: decoder open failed", image->name);
+        free(buf);
+        return 1;
+    }
+
+    /*!< bottom up in partial lines, every line misses the cache once and hits it after */
+    for (int y = height - 1; y >= 0; y--)
+    {
+        for (lv_coord_t x = 0; x < width; x += width / 3)
+        {
+            lv_coord_t len = (x + width / 3 <= width) ? width / 3 : width - x;
+            if (lv_img_decoder_read_line(&dsc, x, y, len, buf) != LV_RES_OK || memcmp(buf, image->raw->data + (y * width + x) * px_size, len * px_size) != 0)
+            {
+                ESP_LOGE(TAG, "%s: line %d from %d does not read back", image->name, y, x);
+                errors++;
+            }
+        }
+    }
+    if (lv_img_decoder_read_line(&dsc, 1, 0, width, buf) == LV_RES_OK)
+    {
+        ESP_LOGE(TAG, "%s: read past the end of a line", image->name);
+        errors++;
+    }
+    lv_img_decoder_close(&dsc);
+
+    free(buf);
+    return errors;
+}
+
+void app_main(void)
+{
+    const bench_image_t images[] = {
+        {"ui_img_9460735_png", &ui_img_9460735_png, &ui_img_9460735_png_rle},
+        {"img_rle_alpha", &img_rle_alpha, &img_rle_alpha_rle},
+    };
+    uint32_t errors = bench_corrupt();
+
+    lv_init();
+    ESP_ERROR_CHECK(img_rle_decoder_init());
+    for (int i = 0; i < sizeof(images) / sizeof(images[0]); i++)
+    {
+        errors += bench_round_trip(&images[i]);
+        errors += bench_lvgl(&images[i]);
+        errors += bench_truncated(&images[i]);
+    }
+
+    ESP_LOGI(TAG, "%s, %lu errors", errors ? "FAIL" : "PASS", (unsigned long)errors);
+    exit(errors ? 1 : 0);
+}
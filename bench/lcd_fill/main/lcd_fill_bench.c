@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "st7789.h"
+#include "lcd_mock.h"
+#include "pixel_ops.h"
+
+#define LCD_H_RES 240 /*!< same panel as the board build */
+#define LCD_V_RES 240
+#define STRIP_HEIGHT 50
+
+typedef enum
+{
+    FILL_ROWS,   /*!< one draw_bitmap per row from a line buffer, as lcd_fullclean used to */
+    FILL_STRIPS, /*!< lcd_draw_strips with a solid fill callback */
+    FILL_RECT,   /*!< lcd_fill_rect, one window and the reused pattern */
+    FILL_MAX,
+} fill_method_t;
+
+typedef struct
+{
+    const char *name;
+    lcd_region_t region;
+} fill_case_t;
+
+static const char *TAG = "LCD_FILL";
+
+static const char *method_name[FILL_MAX] = {"rows", "strips", "fill_rect"};
+
+static const fill_case_t cases[] = {
+    {"full panel", {0, 0, LCD_H_RES, LCD_V_RES}},
+    {"100x100", {70, 70, 170, 170}},
+    {"text line 240x8", {0, 100, LCD_H_RES, 108}},
+    {"column 1x240", {120, 0, 121, LCD_V_RES}},
+};
+
+static uint16_t line[LCD_H_RES];
+
+static void fill_strip_cb(uint16_t *strip, lcd_region_t region, void *user_ctx)
+{
+    pixel_ops_fill(strip, swap_hex(*(const uint16_t *)user_ctx), (region.x2 - region.x1) * (region.y2 - region.y1));
+}
+
+static esp_err_t fill_run(fill_method_t method, lcd_region_t region, uint16_t color)
+{
+    switch (method)
+    {
+    case FILL_ROWS:
+        pixel_ops_fill(line, swap_hex(color), region.x2 - region.x1);
+        for (uint16_t y = region.y1; y < region.y2; y++)
+        {
+            ESP_RETURN_ON_ERROR(esp_lcd_panel_draw_bitmap(lcd_panel, region.x1, y, region.x2, y + 1, line), TAG, "Draw row failed");
+        }
+        return ESP_OK;
+    case FILL_STRIPS:
+        return lcd_draw_strips(region, STRIP_HEIGHT, fill_strip_cb, &color);
+    default:
+        return lcd_fill_rect(region, color);
+    }
+}
+
+/**
+ * @brief the region holds color, the pixels around it kept the background
+ */
+static bool fill_check(lcd_region_t region, uint16_t color, uint16_t background)
+{
+    for (uint16_t y = 0; y < LCD_V_RES; y++)
+    {
+        for (uint16_t x = 0; x < LCD_H_RES; x++)
+        {
+            bool inside = x >= region.x1 && x < region.x2 && y >= region.y1 && y < region.y2;
+            if (lcd_mock_get_pixel(lcd_io, x, y) != (inside ? color : background))
+            {
+                ESP_LOGE(TAG, "Pixel %d,%d is %04x", x, y, lcd_mock_get_pixel(lcd_io, x, y));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void app_main(void)
+{
+    const lcd_config_t lcd_config = {
+        .lcd_height_res = LCD_H_RES,
+        .lcd_vertical_res = LCD_V_RES,
+        .lcd_draw_buffer_height = STRIP_HEIGHT,
+        .lcd_bits_per_pixel = 16,
+        .lcd_color_space = LCD_RGB_ELEMENT_ORDER_RGB,
+        .pclk_hz = 40 * 1000 * 1000,
+        .trans_queue_depth = 2, /*!< the smallest queue, every chunk of a fill waits for a free slot */
+    };
+    const lcd_region_t panel = {0, 0, LCD_H_RES, LCD_V_RES};
+    lcd_mock_stats_t stats;
+    uint32_t failures = 0;
+    uint16_t color = 0x1234;
+
+    ESP_ERROR_CHECK(lcd_init(lcd_config));
+    ESP_LOGI(TAG, "%-16s %-10s %6s %6s %9s %8s", "region", "method", "trans", "cmds", "bytes", "bus us");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        for (fill_method_t method = FILL_ROWS; method < FILL_MAX; method++)
+        {
+            const uint16_t background = 0;
+            ESP_ERROR_CHECK(lcd_fill_rect(panel, background));
+            lcd_draw_wait(portMAX_DELAY);
+            lcd_mock_frame_end(lcd_io, NULL, NULL);
+
+            /*!< a new colour each run, so fill_rect rewrites its pattern every time */
+            color += 0x0841;
+            ESP_ERROR_CHECK(fill_run(method, cases[i].region, color));
+            lcd_draw_wait(portMAX_DELAY);
+            lcd_mock_frame_end(lcd_io, &stats, NULL);
+
+            ESP_LOGI(TAG, "%-16s %-10s %6lu %6lu %9lu %8lu", cases[i].name, method_name[method], (unsigned long)stats.transactions, (unsigned long)stats.commands,
+                     (unsigned long)(stats.param_bytes + stats.color_bytes), (unsigned long)(stats.bus_time_ns / 1000));
+            if (!fill_check(cases[i].region, color, background))
+            {
+                failures++;
+            }
+        }
+    }
+    ESP_ERROR_CHECK(lcd_deinit());
+
+    ESP_LOGI(TAG, "%s, %lu failures", failures ? "FAIL" : "PASS", (unsigned long)failures);
+    exit(failures ? 1 : 0);
+}
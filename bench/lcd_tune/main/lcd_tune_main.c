@@ -0,0 +1,45 @@
+#include <stdlib.h>
+#include "esp_log.h"
+#include "lcd_tune.h"
+
+#define TUNE_FRAMES 20
+
+static const char *TAG = "LCD_TUNE_MAIN";
+
+void app_main(void)
+{
+    /*!< same panel as the board build, the pins are not used on the host */
+    const lcd_config_t lcd_config = {
+        .lcd_height_res = 240,
+        .lcd_vertical_res = 240,
+        .lcd_draw_buffer_height = 50,
+        .lcd_bits_per_pixel = 16,
+        .lcd_color_space = LCD_RGB_ELEMENT_ORDER_RGB,
+    };
+    /*!< 80 MHz is the fastest on the mock and above the panel's rating, it must be skipped */
+    const uint32_t pclk_hz[] = {20 * 1000 * 1000, 40 * 1000 * 1000, 80 * 1000 * 1000};
+    const uint8_t queue_depth[] = {2, 10};
+    const uint16_t strip_height[] = {10, 25, 50, 80};
+    const lcd_tune_config_t tune_config = {
+        .pclk_hz = pclk_hz,
+        .pclk_count = sizeof(pclk_hz) / sizeof(pclk_hz[0]),
+        .queue_depth = queue_depth,
+        .queue_depth_count = sizeof(queue_depth) / sizeof(queue_depth[0]),
+        .strip_height = strip_height,
+        .strip_height_count = sizeof(strip_height) / sizeof(strip_height[0]),
+        .frames = TUNE_FRAMES,
+    };
+    lcd_bus_params_t best;
+
+    if (lcd_tune_sweep(lcd_config, &tune_config, NULL, NULL, &best) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Sweep failed");
+        exit(1);
+    }
+    if (best.pclk_hz > LCD_PCLK_MAX_HZ)
+    {
+        ESP_LOGE(TAG, "Picked pclk %lu Hz, the panel is rated for %lu Hz", (unsigned long)best.pclk_hz, (unsigned long)LCD_PCLK_MAX_HZ);
+        exit(1);
+    }
+    exit(0);
+}
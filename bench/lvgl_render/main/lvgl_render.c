@@ -0,0 +1,40 @@
+#include <stdlib.h>
+#include "esp_log.h"
+#include "lvgl_bench.h"
+#include "img_rle.h"
+#include "ui.h"
+
+#define LCD_H_RES 240 /*!< same panel as the board build */
+#define LCD_V_RES 240
+#define BENCH_FRAMES 50
+
+static const char *TAG = "LVGL_RENDER";
+
+/**
+ * @brief the UI as app_main builds it, the background image is RLE coded
+ */
+static void lvgl_render_scene(void)
+{
+    static bool decoder_ready = false;
+
+    /*!< once, LVGL stays initialized between runs */
+    if (!decoder_ready)
+    {
+        ESP_ERROR_CHECK(img_rle_decoder_init());
+        decoder_ready = true;
+    }
+    ui_init();
+}
+
+void app_main(void)
+{
+    /*!< 50 lines is what the board build uses */
+    const uint16_t heights[] = {10, 25, 50, 120, 240};
+
+    if (lvgl_bench_sweep(LCD_H_RES, LCD_V_RES, heights, sizeof(heights) / sizeof(heights[0]), BENCH_FRAMES, lvgl_render_scene) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Bench failed");
+        exit(1);
+    }
+    exit(0);
+}
@@ -0,0 +1,359 @@
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "pixel_ops.h"
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_cpu.h"
+#endif
+
+#define BENCH_WIDTH 240
+#define BENCH_HEIGHT 240
+#define BENCH_PIXELS (BENCH_WIDTH * BENCH_HEIGHT)
+#define BENCH_REPEAT 20
+#define BENCH_GUARD 0xA5A5
+
+#if CONFIG_IDF_TARGET_LINUX
+#define BENCH_UNIT "ns"
+#else
+#define BENCH_UNIT "cycles"
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#define BENCH_KERNELS "PIE kernels for swap_bytes, fill, blend, mirror_h and rotate90"
+#else
+#define BENCH_KERNELS "no vector kernels on this target"
+#endif
+
+typedef struct
+{
+    const char *name;
+    uint16_t src_width;
+    uint16_t src_height;
+} scale_case_t;
+
+typedef enum
+{
+    KERNEL_SWAP,
+    KERNEL_SWAP_IN_PLACE,
+    KERNEL_FILL,
+    KERNEL_BLEND,
+    KERNEL_MIRROR_H,
+    KERNEL_MIRROR_V,
+    KERNEL_ROTATE90,
+    KERNEL_ROTATE180,
+    KERNEL_MAX,
+} bench_kernel_t;
+
+static const char *TAG = "PIXEL_OPS_BENCH";
+
+static const char *kernel_name[KERNEL_MAX] = {"swap_bytes", "swap_bytes in place", "fill", "blend", "mirror_h", "mirror_v", "rotate90", "rotate180"};
+
+/*!< camera frame sizes resampled onto the panel */
+static const scale_case_t scale_cases[] = {
+    {"160x120 up", 160, 120},
+    {"320x240 down", 320, 240},
+    {"640x480 down", 640, 480},
+};
+
+/*!< 16 byte aligned, the PIE loads and stores need it */
+static uint16_t src[BENCH_PIXELS + 16] __attribute__((aligned(16)));
+static uint16_t dst[BENCH_PIXELS + 16] __attribute__((aligned(16)));
+static uint16_t ref[BENCH_PIXELS + 16] __attribute__((aligned(16)));
+static uint16_t frame[640 * 480];
+
+static inline uint32_t bench_now(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    return (uint32_t)(esp_timer_get_time() * 1000);
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+static void bench_pattern(uint16_t *buf, size_t count, uint16_t seed)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        buf[i] = (uint16_t)(i * 2654435761u >> 7) ^ seed;
+    }
+}
+
+/**
+ * @brief the dispatching kernels against the scalar ones, for every alignment and the lengths around a vector block
+ */
+static uint32_t bench_check(void)
+{
+    static const size_t lengths[] = {0, 1, 2, 15, 16, 17, 31, 32, 33, 47, 48, 63, 64, 65, 100, 1023, BENCH_PIXELS - 16};
+    uint32_t failures = 0;
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+    {
+        size_t n = lengths[l];
+        for (size_t so = 0; so < 8; so++)
+        {
+            for (size_t d = 0; d < 8; d++)
+            {
+                bench_pattern(src, BENCH_PIXELS + 16, so);
+                pixel_ops_fill_scalar(dst, BENCH_GUARD, BENCH_PIXELS + 16);
+                pixel_ops_fill_scalar(ref, BENCH_GUARD, BENCH_PIXELS + 16);
+                pixel_ops_swap_bytes(dst + d, src + so, n);
+                pixel_ops_swap_bytes_scalar(ref + d, src + so, n);
+                if (memcmp(dst, ref, sizeof(dst)) != 0)
+                {
+                    ESP_LOGE(TAG, "swap_bytes %u pixels, src +%u dst +%u differs", (unsigned)n, (unsigned)so, (unsigned)d);
+                    failures++;
+                }
+
+                /*!< in place */
+                memcpy(dst, src, sizeof(dst));
+                memcpy(ref, src, sizeof(ref));
+                pixel_ops_swap_bytes(dst + d, dst + d, n);
+                pixel_ops_swap_bytes_scalar(ref + d, ref + d, n);
+                if (memcmp(dst, ref, sizeof(dst)) != 0)
+                {
+                    ESP_LOGE(TAG, "swap_bytes in place %u pixels, +%u differs", (unsigned)n, (unsigned)d);
+                    failures++;
+                }
+            }
+
+            bench_pattern(src, BENCH_PIXELS + 16, so);
+            bench_pattern(dst, BENCH_PIXELS + 16, 0x5A5A);
+            memcpy(ref, dst, sizeof(ref));
+            pixel_ops_blend(dst + so, src + so, n, so * 37);
+            pixel_ops_blend_scalar(ref + so, src + so, n, so * 37);
+            if (memcmp(dst, ref, sizeof(dst)) != 0)
+            {
+                ESP_LOGE(TAG, "blend %u pixels, +%u alpha %u differs", (unsigned)n, (unsigned)so, (unsigned)(so * 37));
+                failures++;
+            }
+
+            pixel_ops_fill_scalar(dst, BENCH_GUARD, BENCH_PIXELS + 16);
+            pixel_ops_fill_scalar(ref, BENCH_GUARD, BENCH_PIXELS + 16);
+            pixel_ops_fill(dst + so, 0x1234 + so, n);
+            pixel_ops_fill_scalar(ref + so, 0x1234 + so, n);
+            if (memcmp(dst, ref, sizeof(dst)) != 0)
+            {
+                ESP_LOGE(TAG, "fill %u pixels, +%u differs", (unsigned)n, (unsigned)so);
+                failures++;
+            }
+        }
+    }
+    for (int alpha = 0; alpha < 256; alpha++)
+    {
+        bench_pattern(src, 64, alpha);
+        bench_pattern(dst, 64, ~alpha);
+        memcpy(ref, dst, 64 * sizeof(uint16_t));
+        pixel_ops_blend(dst, src, 64, alpha);
+        pixel_ops_blend_scalar(ref, src, 64, alpha);
+        if (memcmp(dst, ref, 64 * sizeof(uint16_t)) != 0)
+        {
+            ESP_LOGE(TAG, "blend alpha %d differs", alpha);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief mirror_h and rotate90 against the scalar ones, on sizes that take the vector tiles and sizes that cannot
+ */
+static uint32_t bench_check_2d(void)
+{
+    static const uint16_t sizes[][2] = {{8, 8}, {16, 8}, {8, 16}, {24, 8}, {40, 24}, {7, 5}, {9, 8}, {8, 12}, {120, 280}, {280, 120}, {BENCH_WIDTH, BENCH_HEIGHT}};
+    /*!< 1 keeps the buffers off the 16 byte grid, 8 puts them back on it */
+    static const size_t offsets[] = {0, 1, 8};
+    uint32_t failures = 0;
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        uint16_t w = sizes[i][0];
+        uint16_t h = sizes[i][1];
+        for (size_t o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++)
+        {
+            size_t off = offsets[o];
+            bench_pattern(dst, BENCH_PIXELS + 16, w + off);
+            memcpy(ref, dst, sizeof(ref));
+            pixel_ops_mirror_h(dst + off, w, h);
+            pixel_ops_mirror_h_scalar(ref + off, w, h);
+            if (memcmp(dst, ref, sizeof(dst)) != 0)
+            {
+                ESP_LOGE(TAG, "mirror_h %ux%u +%u differs", w, h, (unsigned)off);
+                failures++;
+            }
+
+            for (int clockwise = 0; clockwise < 2; clockwise++)
+            {
+                bench_pattern(src, BENCH_PIXELS + 16, h + off);
+                pixel_ops_fill_scalar(dst, BENCH_GUARD, BENCH_PIXELS + 16);
+                pixel_ops_fill_scalar(ref, BENCH_GUARD, BENCH_PIXELS + 16);
+                pixel_ops_rotate90(dst + off, src + off, w, h, clockwise);
+                pixel_ops_rotate90_scalar(ref + off, src + off, w, h, clockwise);
+                if (memcmp(dst, ref, sizeof(dst)) != 0)
+                {
+                    ESP_LOGE(TAG, "rotate90 %ux%u +%u %s differs", w, h, (unsigned)off, clockwise ? "clockwise" : "counter-clockwise");
+                    failures++;
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+static void bench_kernel(bench_kernel_t kernel, bool scalar)
+{
+    switch (kernel)
+    {
+    case KERNEL_SWAP:
+        (scalar ? pixel_ops_swap_bytes_scalar : pixel_ops_swap_bytes)(dst, src, BENCH_PIXELS);
+        break;
+    case KERNEL_SWAP_IN_PLACE:
+        (scalar ? pixel_ops_swap_bytes_scalar : pixel_ops_swap_bytes)(dst, dst, BENCH_PIXELS);
+        break;
+    case KERNEL_FILL:
+        (scalar ? pixel_ops_fill_scalar : pixel_ops_fill)(dst, 0xF800, BENCH_PIXELS);
+        break;
+    case KERNEL_BLEND:
+        (scalar ? pixel_ops_blend_scalar : pixel_ops_blend)(dst, src, BENCH_PIXELS, 100);
+        break;
+    case KERNEL_MIRROR_H:
+        (scalar ? pixel_ops_mirror_h_scalar : pixel_ops_mirror_h)(dst, BENCH_WIDTH, BENCH_HEIGHT);
+        break;
+    case KERNEL_MIRROR_V:
+        pixel_ops_mirror_v(dst, BENCH_WIDTH, BENCH_HEIGHT);
+        break;
+    case KERNEL_ROTATE90:
+        (scalar ? pixel_ops_rotate90_scalar : pixel_ops_rotate90)(dst, src, BENCH_WIDTH, BENCH_HEIGHT, true);
+        break;
+    default:
+        pixel_ops_rotate180(dst, src, BENCH_PIXELS);
+        break;
+    }
+}
+
+/**
+ * @brief best of BENCH_REPEAT runs, per pixel
+ */
+static float bench_time(bench_kernel_t kernel, bool scalar)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (int i = 0; i < BENCH_REPEAT; i++)
+    {
+        uint32_t start = bench_now();
+        bench_kernel(kernel, scalar);
+        uint32_t elapsed = bench_now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return (float)best / BENCH_PIXELS;
+}
+
+/**
+ * @brief configs pixel_ops_scale_init must refuse, and rows it must not write
+ */
+static uint32_t bench_scale_check(void)
+{
+    const pixel_ops_scale_t good = {
+        .src = frame,
+        .src_stride = 320,
+        .crop = {0, 0, 320, 240},
+        .dst_width = BENCH_WIDTH,
+        .dst_height = BENCH_HEIGHT,
+        .mode = PIXEL_OPS_SCALE_BILINEAR,
+    };
+    pixel_ops_scale_t bad[4] = {good, good, good, good};
+    uint32_t failures = 0;
+
+    bad[0].dst_width = 0;
+    bad[1].crop.height = 0;
+    bad[2].crop.x = 1;
+    bad[3].dst_width = 1000; /*!< wider than the old fixed tables, must work now */
+    for (int i = 0; i < 4; i++)
+    {
+        esp_err_t ret = pixel_ops_scale_init(&bad[i]);
+        if ((ret == ESP_OK) != (i == 3))
+        {
+            ESP_LOGE(TAG, "Scale config %d returned %s", i, esp_err_to_name(ret));
+            failures++;
+        }
+        pixel_ops_scale_deinit(&bad[i]);
+    }
+
+    pixel_ops_scale_t scale = good;
+    if (pixel_ops_scale_rows(&scale, dst, 0, 1) != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE(TAG, "Scale rows ran without tables");
+        failures++;
+    }
+    ESP_ERROR_CHECK(pixel_ops_scale_init(&scale));
+    if (pixel_ops_scale_rows(&scale, dst, 0, BENCH_HEIGHT + 1) != ESP_ERR_INVALID_ARG)
+    {
+        ESP_LOGE(TAG, "Scale rows ran past dst_height");
+        failures++;
+    }
+    pixel_ops_scale_deinit(&scale);
+    return failures;
+}
+
+/**
+ * @brief best of BENCH_REPEAT whole frame resamples, in destination Mpixel/s
+ */
+static float bench_scale_time(const scale_case_t *c, pixel_ops_scale_mode_t mode)
+{
+    pixel_ops_scale_t scale = {
+        .src = frame,
+        .src_stride = c->src_width,
+        .crop = pixel_ops_crop_to_fill(c->src_width, c->src_height, BENCH_WIDTH, BENCH_HEIGHT),
+        .dst_width = BENCH_WIDTH,
+        .dst_height = BENCH_HEIGHT,
+        .mode = mode,
+        .swapped = true,
+    };
+    uint64_t best = UINT64_MAX;
+
+    ESP_ERROR_CHECK(pixel_ops_scale_init(&scale));
+    for (int i = 0; i < BENCH_REPEAT; i++)
+    {
+        int64_t start = esp_timer_get_time();
+        ESP_ERROR_CHECK(pixel_ops_scale_rows(&scale, dst, 0, BENCH_HEIGHT));
+        uint64_t elapsed = esp_timer_get_time() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    pixel_ops_scale_deinit(&scale);
+    return best ? (float)BENCH_PIXELS / best : 0;
+}
+
+void app_main(void)
+{
+    uint32_t failures = bench_check();
+    failures += bench_check_2d();
+    failures += bench_scale_check();
+
+    bench_pattern(src, BENCH_PIXELS, 0);
+    memcpy(dst, src, sizeof(dst));
+    ESP_LOGI(TAG, "%ux%u frame, %s per pixel, %s", BENCH_WIDTH, BENCH_HEIGHT, BENCH_UNIT, BENCH_KERNELS);
+    ESP_LOGI(TAG, "%-20s %8s %8s", "kernel", "scalar", "default");
+    for (bench_kernel_t kernel = KERNEL_SWAP; kernel < KERNEL_MAX; kernel++)
+    {
+        float scalar = bench_time(kernel, true);
+        float vector = bench_time(kernel, false);
+        ESP_LOGI(TAG, "%-20s %8.2f %8.2f", kernel_name[kernel], scalar, vector);
+    }
+
+
+    bench_pattern(frame, sizeof(frame) / sizeof(frame[0]), 0);
+    ESP_LOGI(TAG, "scale to %ux%u, Mpixel/s", BENCH_WIDTH, BENCH_HEIGHT);
+    ESP_LOGI(TAG, "%-20s %8s %8s", "source", "nearest", "bilinear");
+    for (size_t i = 0; i < sizeof(scale_cases) / sizeof(scale_cases[0]); i++)
+    {
+        float nearest = bench_scale_time(&scale_cases[i], PIXEL_OPS_SCALE_NEAREST);
+        float bilinear = bench_scale_time(&scale_cases[i], PIXEL_OPS_SCALE_BILINEAR);
+        ESP_LOGI(TAG, "%-20s %8.2f %8.2f", scale_cases[i].name, nearest, bilinear);
+    }
+
+    ESP_LOGI(TAG, "%s, %lu failures", failures ? "FAIL" : "PASS", (unsigned long)failures);
+#if CONFIG_IDF_TARGET_LINUX
+    exit(failures ? 1 : 0);
+#endif
+}
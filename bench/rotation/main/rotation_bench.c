@@ -0,0 +1,262 @@
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "st7789.h"
+#include "lcd_mock.h"
+#include "pixel_ops.h"
+#include "esp_lcd_panel_commands.h"
+
+#define LCD_H_RES 240 /*!< same panel as the board build */
+#define LCD_V_RES 240
+#define LCD_V_RES_TALL 280 /*!< the 240x280 variant, a rotated row is longer than an unrotated one */
+#define STRIP_HEIGHT 50
+#define BENCH_FRAMES 20
+
+/**
+ * @brief where the first pixel of a window lands and where the second one follows, per MADCTL
+ */
+typedef struct
+{
+    uint8_t madctl;
+    bool right;  /*!< starts in the last column of the frame memory */
+    bool bottom; /*!< starts in the last row */
+    int8_t dx;   /*!< step to the second pixel */
+    int8_t dy;
+} rotation_scan_t;
+
+typedef struct
+{
+    uint64_t bus_ns;
+    uint64_t cpu_us;
+} rotation_frame_t;
+
+static const char *TAG = "ROTATION";
+
+/*!< the MADCTL scan order table of the ST7789V datasheet: MV exchanges the counters, MX and MY mirror the physical axes */
+static const rotation_scan_t scan_order[] = {
+    {0, false, false, 1, 0},
+    {LCD_CMD_MY_BIT, false, true, 1, 0},
+    {LCD_CMD_MX_BIT, true, false, -1, 0},
+    {LCD_CMD_MX_BIT | LCD_CMD_MY_BIT, true, true, -1, 0},
+    {LCD_CMD_MV_BIT, false, false, 0, 1},
+    {LCD_CMD_MV_BIT | LCD_CMD_MY_BIT, false, true, 0, -1},
+    {LCD_CMD_MV_BIT | LCD_CMD_MX_BIT, true, false, 0, 1},
+    {LCD_CMD_MV_BIT | LCD_CMD_MX_BIT | LCD_CMD_MY_BIT, true, true, 0, -1},
+};
+
+static uint16_t frame[LCD_H_RES * LCD_V_RES];
+static uint16_t panel_h_res = LCD_H_RES; /*!< of the panel rotation_run and rotation_check work on */
+static uint16_t panel_v_res = LCD_V_RES;
+static uint16_t panel[2][LCD_PANEL_MEM_WIDTH * LCD_PANEL_MEM_HEIGHT];
+
+static uint16_t rotation_pixel(uint16_t x, uint16_t y)
+{
+    return (uint16_t)(x * 31 + y * 2047 + 7);
+}
+
+static void rotation_fill_cb(uint16_t *strip, lcd_region_t region, void *user_ctx)
+{
+    for (uint16_t y = region.y1; y < region.y2; y++)
+    {
+        for (uint16_t x = region.x1; x < region.x2; x++)
+        {
+            *strip++ = swap_hex(rotation_pixel(x, y));
+        }
+    }
+}
+
+/**
+ * @brief the transpose without tiles, for comparison
+ */
+static void rotation_naive90(uint16_t *dst, const uint16_t *src, uint16_t width, uint16_t height)
+{
+    for (uint16_t y = 0; y < height; y++)
+    {
+        for (uint16_t x = 0; x < width; x++)
+        {
+            dst[x * height + (height - 1 - y)] = src[y * width + x];
+        }
+    }
+}
+
+static void rotation_kernels(void)
+{
+    static uint16_t dst[LCD_H_RES * LCD_V_RES];
+    int64_t start = esp_timer_get_time();
+
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        rotation_naive90(dst, frame, LCD_H_RES, LCD_V_RES);
+    }
+    int64_t naive = esp_timer_get_time() - start;
+    start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        pixel_ops_rotate90(dst, frame, LCD_H_RES, LCD_V_RES, true);
+    }
+    int64_t tiled = esp_timer_get_time() - start;
+    start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        pixel_ops_rotate180(dst, frame, LCD_H_RES * LCD_V_RES);
+    }
+    int64_t half_turn = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "per frame: naive 90 %lld us, tiled 90 %lld us, 180 %lld us", naive / BENCH_FRAMES, tiled / BENCH_FRAMES, half_turn / BENCH_FRAMES);
+}
+
+/**
+ * @brief write two pixels at window 0,0 under every MADCTL setting and compare with the datasheet
+ *
+ * The rotation check below trusts the mock's MADCTL model, this pins the model itself down.
+ */
+static uint32_t rotation_scan_check(void)
+{
+    lcd_mock_config_t mock_config = {
+        .width = LCD_PANEL_MEM_WIDTH,
+        .height = LCD_PANEL_MEM_HEIGHT,
+        .pclk_hz = 40 * 1000 * 1000,
+    };
+    const uint8_t window[] = {0, 0, 0, 1};
+    const uint16_t pixels[] = {swap_hex(0x1111), swap_hex(0x2222)};
+    uint32_t errors = 0;
+
+    for (size_t i = 0; i < sizeof(scan_order) / sizeof(scan_order[0]); i++)
+    {
+        const rotation_scan_t *scan = &scan_order[i];
+        esp_lcd_panel_io_handle_t io = NULL;
+        ESP_ERROR_CHECK(lcd_mock_new_panel_io(&mock_config, &io));
+        ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io, LCD_CMD_MADCTL, &scan->madctl, 1));
+        ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io, LCD_CMD_CASET, window, sizeof(window)));
+        ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io, LCD_CMD_RASET, window, sizeof(window)));
+        ESP_ERROR_CHECK(esp_lcd_panel_io_tx_color(io, LCD_CMD_RAMWR, pixels, sizeof(pixels)));
+
+        uint16_t x = scan->right ? LCD_PANEL_MEM_WIDTH - 1 : 0;
+        uint16_t y = scan->bottom ? LCD_PANEL_MEM_HEIGHT - 1 : 0;
+        bool ok = lcd_mock_get_pixel(io, x, y) == 0x1111 && lcd_mock_get_pixel(io, x + scan->dx, y + scan->dy) == 0x2222;
+        if (!ok)
+        {
+            ESP_LOGE(TAG, "MADCTL 0x%02x does not scan as the datasheet says", scan->madctl);
+            errors++;
+        }
+        esp_lcd_panel_io_del(io);
+    }
+
+    return errors;
+}
+
+/**
+ * @brief draw BENCH_FRAMES frames at one rotation and keep what reached the panel memory
+ */
+static esp_err_t rotation_run(lcd_rotation_t rotation, bool software, uint16_t *snapshot, rotation_frame_t *result)
+{
+    lcd_config_t lcd_config = {
+        .lcd_height_res = panel_h_res,
+        .lcd_vertical_res = panel_v_res,
+        .lcd_draw_buffer_height = STRIP_HEIGHT,
+        .lcd_bits_per_pixel = 16,
+        .lcd_color_space = LCD_RGB_ELEMENT_ORDER_RGB,
+    };
+    lcd_region_t region = {0};
+    lcd_mock_stats_t stats;
+
+    ESP_RETURN_ON_ERROR(lcd_init(lcd_config), TAG, "LCD init failed");
+    ESP_RETURN_ON_ERROR(lcd_set_rotation(rotation, software), TAG, "Set rotation failed");
+    lcd_get_resolution(&region.x2, &region.y2);
+    lcd_mock_frame_end(lcd_io, NULL, NULL);
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        ESP_RETURN_ON_ERROR(lcd_draw_strips(region, STRIP_HEIGHT, rotation_fill_cb, NULL), TAG, "Draw failed");
+    }
+    lcd_draw_wait(portMAX_DELAY);
+    result->cpu_us = (esp_timer_get_time() - start) / BENCH_FRAMES;
+    lcd_mock_frame_end(lcd_io, NULL, &stats);
+    result->bus_ns = stats.bus_time_ns / BENCH_FRAMES;
+
+    for (uint16_t y = 0; y < LCD_PANEL_MEM_HEIGHT; y++)
+    {
+        for (uint16_t x = 0; x < LCD_PANEL_MEM_WIDTH; x++)
+        {
+            snapshot[y * LCD_PANEL_MEM_WIDTH + x] = lcd_mock_get_pixel(lcd_io, x, y);
+        }
+    }
+
+    return lcd_deinit();
+}
+
+/**
+ * @brief count panel pixels that differ from where the rotation must put the logical pixel
+ */
+static uint32_t rotation_check(lcd_rotation_t rotation, const uint16_t *snapshot)
+{
+    uint32_t errors = 0;
+
+    uint16_t width = (rotation == LCD_ROTATION_90 || rotation == LCD_ROTATION_270) ? panel_v_res : panel_h_res;
+    uint16_t height = (rotation == LCD_ROTATION_90 || rotation == LCD_ROTATION_270) ? panel_h_res : panel_v_res;
+
+    for (uint16_t y = 0; y < height; y++)
+    {
+        for (uint16_t x = 0; x < width; x++)
+        {
+            uint16_t px = x;
+            uint16_t py = y;
+            switch (rotation)
+            {
+            case LCD_ROTATION_90:
+                px = panel_h_res - 1 - y;
+                py = x;
+                break;
+            case LCD_ROTATION_180:
+                px = panel_h_res - 1 - x;
+                py = panel_v_res - 1 - y;
+                break;
+            case LCD_ROTATION_270:
+                px = y;
+                py = panel_v_res - 1 - x;
+                break;
+            default:
+                break;
+            }
+            errors += snapshot[py * LCD_PANEL_MEM_WIDTH + px] != rotation_pixel(x, y);
+        }
+    }
+
+    return errors;
+}
+
+void app_main(void)
+{
+    uint32_t errors = 0;
+
+    for (uint32_t i = 0; i < LCD_H_RES * LCD_V_RES; i++)
+    {
+        frame[i] = i;
+    }
+    rotation_kernels();
+    errors += rotation_scan_check();
+
+    /*!< at 90 and 270 degrees the tall panel draws strips wider than its unrotated rows */
+    for (int tall = 0; tall < 2; tall++)
+    {
+        panel_v_res = tall ? LCD_V_RES_TALL : LCD_V_RES;
+        for (lcd_rotation_t rotation = LCD_ROTATION_0; rotation <= LCD_ROTATION_270; rotation++)
+        {
+            rotation_frame_t hw;
+            rotation_frame_t sw;
+            if (rotation_run(rotation, false, panel[0], &hw) != ESP_OK || rotation_run(rotation, true, panel[1], &sw) != ESP_OK)
+            {
+                ESP_LOGE(TAG, "Run failed");
+                exit(1);
+            }
+            uint32_t hw_errors = rotation_check(rotation, panel[0]);
+            uint32_t sw_errors = rotation_check(rotation, panel[1]);
+            errors += hw_errors + sw_errors;
+            ESP_LOGI(TAG, "%ux%u %3d deg: MADCTL bus %llu us cpu %llu us, %lu bad pixels | software bus %llu us cpu %llu us, %lu bad pixels", panel_h_res,
+                     panel_v_res, rotation * 90, hw.bus_ns / 1000, hw.cpu_us, (unsigned long)hw_errors, sw.bus_ns / 1000, sw.cpu_us, (unsigned long)sw_errors);
+        }
+    }
+    exit(errors ? 1 : 0);
+}
@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "sd_bus.h"
+
+#define BENCH_SECTORS 256
+#define BENCH_SCRATCH_SECTOR 192
+#define BENCH_SCRATCH_SECTORS 32
+
+/**
+ * @brief a card in RAM, the faults are what a bad card, socket or layout does at a given mode
+ */
+typedef struct
+{
+    uint32_t card_id;
+    uint32_t max_freq_khz;  /*!< 20000 for a card without high speed */
+    uint32_t crc_khz;       /*!< reads above this clock fail the CRC, 0 for never */
+    uint32_t corrupt_khz;   /*!< writes above this clock land with a flipped bit and no error, 0 for never */
+    bool broken_wide;       /*!< D1-D3 not connected, data transfers on 4 lines time out */
+    bool dead;              /*!< does not come up at all */
+    sd_bus_mode_t mode;
+    bool attached;
+    uint32_t attaches;
+    uint8_t data[BENCH_SECTORS * SD_BUS_SECTOR_SIZE];
+} bench_card_t;
+
+typedef struct
+{
+    const char *name;
+    bench_card_t card;
+    esp_err_t expect_err;
+    sd_bus_mode_t expect;
+} bench_case_t;
+
+static const char *TAG = "SD_BUS_BENCH";
+
+static const sd_bus_mode_t modes[] = {
+    {40000, 4},
+    {20000, 4},
+    {40000, 1},
+    {20000, 1},
+};
+
+static bench_case_t cases[] = {
+    {.name = "Clean", .card = {.card_id = 0x1001, .max_freq_khz = 40000}, .expect = {40000, 4}},
+    {.name = "No high speed", .card = {.card_id = 0x1002, .max_freq_khz = 20000}, .expect = {20000, 4}},
+    {.name = "CRC at 40 MHz", .card = {.card_id = 0x1003, .max_freq_khz = 40000, .crc_khz = 20000}, .expect = {20000, 4}},
+    {.name = "Broken D1-D3", .card = {.card_id = 0x1004, .max_freq_khz = 40000, .broken_wide = true}, .expect = {40000, 1}},
+    {.name = "Silent corruption", .card = {.card_id = 0x1005, .max_freq_khz = 40000, .corrupt_khz = 20000}, .expect = {20000, 4}},
+    {.name = "Dead", .card = {.card_id = 0x1006, .dead = true}, .expect_err = ESP_ERR_NOT_FOUND},
+};
+
+/**
+ * @brief the time the data phase takes on the bus, so the measured speed follows the mode
+ */
+static void bench_card_transfer(bench_card_t *card, uint32_t count)
+{
+    uint64_t bits = (uint64_t)count * SD_BUS_SECTOR_SIZE * 8;
+    usleep(bits * 1000 / ((uint64_t)card->mode.freq_khz * card->mode.width));
+}
+
+static esp_err_t bench_card_attach(void *ctx, sd_bus_mode_t *mode, uint32_t *card_id)
+{
+    bench_card_t *card = (bench_card_t *)ctx;
+    card->attaches++;
+    if (card->dead)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    /*!< the bus width switch is a command, it goes through even without D1-D3 */
+    if (mode->freq_khz > card->max_freq_khz)
+    {
+        mode->freq_khz = card->max_freq_khz;
+    }
+    card->mode = *mode;
+    card->attached = true;
+    *card_id = card->card_id;
+    return ESP_OK;
+}
+
+static esp_err_t bench_card_read(void *ctx, uint32_t sector, void *buf, uint32_t count)
+{
+    bench_card_t *card = (bench_card_t *)ctx;
+    if (!card->attached || sector + count > BENCH_SECTORS)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (card->broken_wide && card->mode.width == 4)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    bench_card_transfer(card, count);
+    if (card->crc_khz && card->mode.freq_khz > card->crc_khz)
+    {
+        return ESP_ERR_INVALID_CRC;
+    }
+    memcpy(buf, &card->data[sector * SD_BUS_SECTOR_SIZE], count * SD_BUS_SECTOR_SIZE);
+    return ESP_OK;
+}
+
+static esp_err_t bench_card_write(void *ctx, uint32_t sector, const void *buf, uint32_t count)
+{
+    bench_card_t *card = (bench_card_t *)ctx;
+    if (!card->attached || sector + count > BENCH_SECTORS)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (card->broken_wide && card->mode.width == 4)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    bench_card_transfer(card, count);
+    memcpy(&card->data[sector * SD_BUS_SECTOR_SIZE], buf, count * SD_BUS_SECTOR_SIZE);
+    if (card->corrupt_khz && card->mode.freq_khz > card->corrupt_khz)
+    {
+        card->data[sector * SD_BUS_SECTOR_SIZE + 77] ^= 0x10;
+    }
+    return ESP_OK;
+}
+
+static void bench_card_detach(void *ctx)
+{
+    bench_card_t *card = (bench_card_t *)ctx;
+    card->attached = false;
+}
+
+static void bench_probe_cb(const sd_bus_probe_result_t *result, void *user_ctx)
+{
+    uint32_t *tried = (uint32_t *)user_ctx;
+    (*tried)++;
+}
+
+static uint8_t bench_card_byte(uint32_t i)
+{
+    return (uint8_t)(i * 13 + 5);
+}
+
+/**
+ * @brief the sectors outside the scratch area still hold what was there
+ */
+static uint32_t bench_card_untouched(const bench_card_t *card)
+{
+    for (uint32_t i = 0; i < BENCH_SCRATCH_SECTOR * SD_BUS_SECTOR_SIZE; i++)
+    {
+        if (card->data[i] != bench_card_byte(i))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void app_main(void)
+{
+    uint32_t errors = 0;
+    sd_bus_driver_t driver = {
+        .attach = bench_card_attach,
+        .read = bench_card_read,
+        .write = bench_card_write,
+        .detach = bench_card_detach,
+    };
+    sd_bus_probe_config_t config = {
+        .modes = modes,
+        .mode_count = sizeof(modes) / sizeof(modes[0]),
+        .scratch_sector = BENCH_SCRATCH_SECTOR,
+        .scratch_sectors = BENCH_SCRATCH_SECTORS,
+        .rounds = 4,
+    };
+
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        bench_case_t *test = &cases[c];
+        bench_card_t *card = &test->card;
+        sd_bus_params_t best = {0};
+        uint32_t tried = 0;
+
+        for (uint32_t i = 0; i < sizeof(card->data); i++)
+        {
+            card->data[i] = bench_card_byte(i);
+        }
+        ret = sd_bus_negotiate(&driver, card, &config, bench_probe_cb, &tried, &best);
+
+        uint32_t failed = ret != test->expect_err || bench_card_untouched(card) || card->attached || card->attaches != tried;
+        if (ret == ESP_OK)
+        {
+            failed |= best.mode.freq_khz != test->expect.freq_khz || best.mode.width != test->expect.width || best.card_id != card->card_id ||
+                      best.read_kb_per_sec == 0 || best.write_kb_per_sec == 0;
+        }
+        ESP_LOGI(TAG, "%s: %s, %lu kHz %d bit after %lu modes, read %lu KB/s, write %lu KB/s%s", test->name, esp_err_to_name(ret), (unsigned long)best.mode.freq_khz,
+                 best.mode.width, (unsigned long)tried, (unsigned long)best.read_kb_per_sec, (unsigned long)best.write_kb_per_sec, failed ? ", FAILED" : "");
+        errors += failed;
+
+        /*!< what the next boot reads back instead of probing */
+        if (ret == ESP_OK)
+        {
+            sd_bus_params_t stored = {0};
+            ESP_ERROR_CHECK(sd_bus_params_save(&best));
+            ESP_ERROR_CHECK(sd_bus_params_load(&stored));
+            errors += memcmp(&stored, &best, sizeof(sd_bus_params_t)) != 0;
+        }
+    }
+
+    ESP_LOGI(TAG, "%lu errors", (unsigned long)errors);
+    exit(errors ? 1 : 0);
+}
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sd_index.h"
+
+#define BENCH_DIR "/tmp/sd_index_bench"
+#define BENCH_FILES 2000
+#define BENCH_NEW_FILE "NEWFILE.TXT"
+#define BENCH_PATH_MAX 300
+
+static const char *TAG = "SD_INDEX_BENCH";
+
+static const char *bench_dir;
+static int bench_files;
+
+static void bench_name(int i, char *name, size_t len)
+{
+    snprintf(name, len, "IMG%05d.JPG", i);
+}
+
+static void bench_populate(void)
+{
+    char path[BENCH_PATH_MAX];
+    char name[16];
+
+    mkdir(bench_dir, 0755);
+    for (int i = 0; i < bench_files; i++)
+    {
+        bench_name(i, name, sizeof(name));
+        snprintf(path, sizeof(path), "%s/%s", bench_dir, name);
+        FILE *f = fopen(path, "ab");
+        if (f)
+        {
+            /*!< distinct sizes so a stale entry would show */
+            if (ftell(f) == 0)
+            {
+                fwrite(path, 1, i % 200, f);
+            }
+            fclose(f);
+        }
+    }
+}
+
+/**
+ * @brief what sd_card_init used to do before returning: read the whole directory
+ */
+static uint32_t bench_scan(int64_t *us)
+{
+    uint32_t count = 0;
+    int64_t start = esp_timer_get_time();
+    DIR *dir = opendir(bench_dir);
+    struct dirent *entry;
+
+    while (dir && (entry = readdir(dir)) != NULL)
+    {
+        count++;
+    }
+    if (dir)
+    {
+        closedir(dir);
+    }
+    *us = esp_timer_get_time() - start;
+    return count;
+}
+
+static uint32_t bench_lookups(bool indexed, int64_t *us)
+{
+    char path[BENCH_PATH_MAX];
+    char name[16];
+    uint32_t errors = 0;
+    struct stat st;
+    sd_index_info_t info;
+    int64_t start = esp_timer_get_time();
+
+    for (int i = 0; i < bench_files; i++)
+    {
+        bench_name(i, name, sizeof(name));
+        if (indexed)
+        {
+            errors += sd_index_lookup(name, &info) != ESP_OK || info.size != i % 200;
+        }
+        else
+        {
+            snprintf(path, sizeof(path), "%s/%s", bench_dir, name);
+            errors += stat(path, &st) != 0 || st.st_size != i % 200;
+        }
+    }
+    *us = esp_timer_get_time() - start;
+    return errors;
+}
+
+static uint32_t bench_fnv(uint32_t hash, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief damage the index file left by the last run, the sum is fixed up where only the fields are wrong
+ *
+ * 1 a count far beyond the file, 2 names larger than the file, 3 a name offset past the names,
+ * 4 a last name without its NUL, 5 an entry under the wrong hash.
+ */
+static esp_err_t bench_damage(int damage)
+{
+    char path[BENCH_PATH_MAX];
+    sd_index_header_t header;
+
+    snprintf(path, sizeof(path), "%s/%s", bench_dir, SD_INDEX_FILE);
+    FILE *f = fopen(path, "r+b");
+    if (f == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    fseek(f, 0, SEEK_END);
+    size_t len = ftell(f);
+    uint8_t *data = malloc(len);
+    fseek(f, 0, SEEK_SET);
+    if (len < sizeof(header) || fread(data, 1, len, f) != len)
+    {
+        fclose(f);
+        free(data);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(&header, data, sizeof(header));
+    sd_index_entry_t *entries = (sd_index_entry_t *)(data + sizeof(header));
+    uint8_t *names = data + sizeof(header) + header.count * sizeof(sd_index_entry_t);
+
+    switch (damage)
+    {
+    case 1:
+        header.count = 0x10000000;
+        break;
+    case 2:
+        header.names_size = 0xFFFFFFF0;
+        break;
+    case 3:
+        entries[header.count / 2].name_offset = header.names_size + 100;
+        break;
+    case 4:
+        names[header.names_size - 1] = 'X';
+        break;
+    default:
+        entries[header.count / 2].hash ^= 1;
+        break;
+    }
+    if (damage >= 3)
+    {
+        header.file_sum = bench_fnv(bench_fnv(2166136261u, (const uint8_t *)entries, header.count * sizeof(sd_index_entry_t)), names, header.names_size);
+    }
+    memcpy(data, &header, sizeof(header));
+    fseek(f, 0, SEEK_SET);
+    fwrite(data, 1, len, f);
+    fclose(f);
+    free(data);
+    return ESP_OK;
+}
+
+static esp_err_t bench_change(bool create)
+{
+    char path[BENCH_PATH_MAX];
+
+    snprintf(path, sizeof(path), "%s/%s", bench_dir, BENCH_NEW_FILE);
+    if (create)
+    {
+        FILE *f = fopen(path, "wb");
+        if (f)
+        {
+            fclose(f);
+        }
+    }
+    else
+    {
+        remove(path);
+    }
+    sd_index_invalidate();
+    if (sd_index_wait(pdMS_TO_TICKS(10000)) != ESP_OK)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t ret = sd_index_lookup(BENCH_NEW_FILE, NULL);
+
+    return (ret == ESP_OK) == create ? ESP_OK : ESP_FAIL;
+}
+
+void app_main(void)
+{
+    sd_index_stats_t stats;
+    int64_t scan_us;
+    int64_t index_us;
+    int64_t stat_us;
+    uint32_t errors = 0;
+
+    bench_dir = getenv("SD_INDEX_BENCH_DIR") ? getenv("SD_INDEX_BENCH_DIR") : BENCH_DIR;
+    bench_files = getenv("SD_INDEX_BENCH_FILES") ? atoi(getenv("SD_INDEX_BENCH_FILES")) : BENCH_FILES;
+    bench_populate();
+
+    /*!< a damaged index must be refused at boot and rebuilt by the walk, lookups stay right */
+    int damage = getenv("SD_INDEX_BENCH_DAMAGE") ? atoi(getenv("SD_INDEX_BENCH_DAMAGE")) : 0;
+    if (damage && bench_damage(damage) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "No index file to damage, run once without SD_INDEX_BENCH_DAMAGE");
+        exit(1);
+    }
+
+    uint32_t scanned = bench_scan(&scan_us);
+    ESP_LOGI(TAG, "Directory scan: %lu entries in %lld us", (unsigned long)scanned, scan_us);
+
+    sd_index_config_t config = {
+        .path = bench_dir,
+        .fatfs_path = "0:/",
+        .task_priority = 1,
+        .task_core = tskNO_AFFINITY,
+    };
+    ESP_ERROR_CHECK(sd_index_start(config));
+    sd_index_get_stats(&stats);
+    ESP_LOGI(TAG, "Boot: index %s, %lu entries in %lu us", stats.loaded ? "loaded" : "missing", (unsigned long)stats.entries, (unsigned long)stats.load_us);
+    if (damage && stats.loaded)
+    {
+        ESP_LOGE(TAG, "Damaged index %d was loaded", damage);
+        errors++;
+    }
+
+    /*!< lookups before the walk finished are answered from the loaded index, or by stat without one */
+    errors += bench_lookups(true, &index_us);
+
+    ESP_ERROR_CHECK(sd_index_wait(pdMS_TO_TICKS(10000)));
+    sd_index_get_stats(&stats);
+    ESP_LOGI(TAG, "Background walk: %lu entries in %lu us, index %s", (unsigned long)stats.entries, (unsigned long)stats.scan_us, stats.rebuilt ? "rewritten" : "kept");
+
+    errors += bench_lookups(true, &index_us);
+    errors += bench_lookups(false, &stat_us);
+    ESP_LOGI(TAG, "%d lookups: index %lld us, stat %lld us", bench_files, index_us, stat_us);
+
+    if (bench_change(true) != ESP_OK || bench_change(false) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Index missed a change");
+        errors++;
+    }
+    sd_index_get_stats(&stats);
+    ESP_LOGI(TAG, "%lu lookups, %lu hits, %lu fallbacks, %lu errors", (unsigned long)stats.lookups, (unsigned long)stats.hits, (unsigned long)stats.fallbacks,
+             (unsigned long)errors);
+    exit(errors ? 1 : 0);
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sd_log.h"
+
+#define BENCH_PATH "/tmp/sd_log_bench.txt"
+#define BENCH_PRODUCERS 16
+#define BENCH_RECORDS 20000 /*!< per producer */
+
+typedef struct
+{
+    int id;
+    uint32_t accepted;
+    int64_t max_us; /*!< slowest sd_log_write or sd_log_printf */
+} bench_producer_t;
+
+static const char *TAG = "SD_LOG_BENCH";
+
+static const char *bench_path;
+
+static void *bench_producer(void *arg)
+{
+    bench_producer_t *producer = (bench_producer_t *)arg;
+    char line[40];
+
+    for (uint32_t seq = 0; seq < BENCH_RECORDS; seq++)
+    {
+        /*!< varying lengths so records wrap the ring at every offset, odd producers format in place */
+        int64_t start = esp_timer_get_time();
+        if (producer->id & 1)
+        {
+            if (sd_log_printf("P%02d %08lu %.*s\n", producer->id, (unsigned long)seq, (int)(seq % 17), "abcdefghijklmnopq") > 0)
+            {
+                producer->accepted++;
+            }
+        }
+        else
+        {
+            int len = snprintf(line, sizeof(line), "P%02d %08lu %.*s\n", producer->id, (unsigned long)seq, (int)(seq % 17), "abcdefghijklmnopq");
+            if (sd_log_write(line, len) == ESP_OK)
+            {
+                producer->accepted++;
+            }
+        }
+        int64_t us = esp_timer_get_time() - start;
+        producer->max_us = us > producer->max_us ? us : producer->max_us;
+    }
+    return NULL;
+}
+
+/**
+ * @brief every line must be whole, and every producer's lines in order without duplicates
+ */
+static uint32_t bench_check(bench_producer_t *producers, bool complete)
+{
+    long next[BENCH_PRODUCERS] = {0};
+    uint32_t count[BENCH_PRODUCERS] = {0};
+    uint32_t errors = 0;
+    char line[64];
+    int id;
+    unsigned long seq;
+    char pad[32];
+
+    FILE *f = fopen(bench_path, "r");
+    if (f == NULL)
+    {
+        return 1;
+    }
+    while (fgets(line, sizeof(line), f))
+    {
+        pad[0] = '\0';
+        if (sscanf(line, "P%d %lu %31s", &id, &seq, pad) < 2 || id < 0 || id >= BENCH_PRODUCERS || strlen(pad) != seq % 17 ||
+            (long)seq < next[id] || (complete && (long)seq != next[id]))
+        {
+            errors++;
+            continue;
+        }
+        next[id] = seq + 1;
+        count[id]++;
+    }
+    fclose(f);
+
+    for (int i = 0; i < BENCH_PRODUCERS; i++)
+    {
+        errors += count[i] != producers[i].accepted;
+    }
+    return errors;
+}
+
+static uint32_t bench_run(sd_log_overflow_t overflow, size_t ring_size)
+{
+    bench_producer_t producers[BENCH_PRODUCERS] = {0};
+    pthread_t threads[BENCH_PRODUCERS];
+    sd_log_stats_t stats;
+    int64_t max_us = 0;
+
+    remove(bench_path);
+    sd_log_config_t config = {
+        .path = bench_path,
+        .ring_size = ring_size,
+        .overflow = overflow,
+        .poll_ms = 5,
+        .sync_ms = 200,
+        .task_priority = 1,
+        .task_core = tskNO_AFFINITY,
+    };
+    ESP_ERROR_CHECK(sd_log_start(config));
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_PRODUCERS; i++)
+    {
+        producers[i].id = i;
+        pthread_create(&threads[i], NULL, bench_producer, &producers[i]);
+    }
+    for (int i = 0; i < BENCH_PRODUCERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        max_us = producers[i].max_us > max_us ? producers[i].max_us : max_us;
+    }
+    int64_t time_us = esp_timer_get_time() - start;
+    ESP_ERROR_CHECK(sd_log_stop());
+    sd_log_get_stats(&stats);
+
+    uint32_t errors = bench_check(producers, overflow == SD_LOG_OVERFLOW_BLOCK);
+    ESP_LOGI(TAG, "%s, %u byte ring: %lu records in %lld us, %lu dropped, %lu blocked, high water %lu, slowest write %lld us", overflow == SD_LOG_OVERFLOW_BLOCK ? "block" : "drop ",
+             (unsigned)ring_size, (unsigned long)stats.records, time_us, (unsigned long)stats.dropped, (unsigned long)stats.blocked, (unsigned long)stats.high_water, max_us);
+    ESP_LOGI(TAG, "%llu bytes in %lu cluster writes, slowest write and sync %lu us, %lu errors", (unsigned long long)stats.flushed, (unsigned long)stats.writes,
+             (unsigned long)stats.max_write_us, (unsigned long)errors);
+    if (overflow == SD_LOG_OVERFLOW_BLOCK && stats.records != BENCH_PRODUCERS * BENCH_RECORDS)
+    {
+        errors++;
+    }
+    return errors;
+}
+
+void app_main(void)
+{
+    uint32_t errors = 0;
+
+    bench_path = getenv("SD_LOG_BENCH_PATH") ? getenv("SD_LOG_BENCH_PATH") : BENCH_PATH;
+    errors += bench_run(SD_LOG_OVERFLOW_BLOCK, 16 * 1024);
+    errors += bench_run(SD_LOG_OVERFLOW_BLOCK, 256 * 1024);
+    /*!< a ring smaller than a cluster, so producers outrun the flush task and drop */
+    errors += bench_run(SD_LOG_OVERFLOW_DROP, 4 * 1024);
+    errors += bench_run(SD_LOG_OVERFLOW_DROP, 256 * 1024);
+    exit(errors ? 1 : 0);
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "sd_raw_log.h"
+
+#define BENCH_IMAGE "/tmp/sd_raw_log.img"
+#define BENCH_EXPORT "/tmp/sd_raw_log.bin"
+#define BENCH_SECTORS 8192 /*!< 4 MB */
+#define BENCH_CHUNK_SECTORS 128
+#define BENCH_RECORD_MAX 3000
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t first;
+    uint32_t next; /*!< payload index expected next */
+    uint32_t errors;
+    uint64_t bytes;
+} bench_check_t;
+
+static const char *TAG = "SD_RAW_LOG_BENCH";
+
+static uint8_t record[BENCH_RECORD_MAX];
+
+/**
+ * @brief payload i starts with i, its length and the rest only depend on i
+ */
+static size_t bench_record(uint32_t i)
+{
+    size_t len = sizeof(i) + (i * 7919) % (BENCH_RECORD_MAX - sizeof(i));
+    for (size_t j = 0; j < len; j++)
+    {
+        record[j] = (uint8_t)(i + j * 31);
+    }
+    memcpy(record, &i, sizeof(i));
+    return len;
+}
+
+static bool bench_visit(const sd_raw_log_header_t *header, const void *data, void *user_ctx)
+{
+    bench_check_t *check = (bench_check_t *)user_ctx;
+    uint32_t i = 0;
+
+    memcpy(&i, data, sizeof(i));
+    if (check->count == 0)
+    {
+        check->first = i;
+        check->next = i;
+    }
+    size_t len = bench_record(check->next);
+    if (i != check->next || header->len != len || memcmp(data, record, len) != 0)
+    {
+        check->errors++;
+    }
+    check->next = i + 1;
+    check->count++;
+    check->bytes += header->len;
+    return true;
+}
+
+static esp_err_t bench_append(sd_raw_log_handle_t log, uint32_t from, uint32_t to, uint32_t sync_every, int64_t *us)
+{
+    int64_t start = esp_timer_get_time();
+
+    for (uint32_t i = from; i < to; i++)
+    {
+        size_t len = bench_record(i);
+        ESP_RETURN_ON_ERROR(sd_raw_log_append(log, record, len), TAG, "Append %lu failed", (unsigned long)i);
+        if (sync_every && i % sync_every == 0)
+        {
+            ESP_RETURN_ON_ERROR(sd_raw_log_sync(log), TAG, "Sync failed");
+        }
+    }
+    *us = esp_timer_get_time() - start;
+    return ESP_OK;
+}
+
+/**
+ * @brief reopen, then read every record back, they must be consecutive payloads
+ */
+static uint32_t bench_reopen(sd_raw_dev_handle_t dev, sd_raw_log_config_t config, sd_raw_log_handle_t *log, bench_check_t *check, const char *what)
+{
+    sd_raw_log_stats_t stats;
+
+    if (*log)
+    {
+        sd_raw_log_close(*log);
+        *log = NULL;
+    }
+    memset(check, 0, sizeof(bench_check_t));
+    if (sd_raw_log_open(dev, config, log) != ESP_OK)
+    {
+        return 1;
+    }
+    sd_raw_log_get_stats(*log, &stats);
+    sd_raw_log_foreach(*log, bench_visit, check);
+    ESP_LOGI(TAG, "%s: payloads %lu..%lu, %lu sector reads in %lu us to recover, %lu dropped, %lu errors", what, (unsigned long)check->first, (unsigned long)(check->next - 1),
+             (unsigned long)stats.recovery_reads, (unsigned long)stats.recovery_us, (unsigned long)stats.dropped, (unsigned long)check->errors);
+    return check->errors;
+}
+
+/**
+ * @brief lose the log without closing it, as a power cut would, its memory is leaked on purpose
+ */
+static void bench_power_cut(sd_raw_log_handle_t *log)
+{
+    *log = NULL;
+}
+
+void app_main(void)
+{
+    sd_raw_dev_handle_t dev = NULL;
+    sd_raw_log_handle_t log = NULL;
+    sd_raw_log_stats_t stats;
+    sd_raw_log_config_t config = {
+        .chunk_sectors = BENCH_CHUNK_SECTORS,
+    };
+    bench_check_t check;
+    uint32_t errors = 0;
+    int64_t us;
+
+    remove(BENCH_IMAGE);
+    ESP_ERROR_CHECK(sd_raw_dev_new_file(BENCH_IMAGE, BENCH_SECTORS, &dev));
+    if (sd_raw_log_open(dev, config, &log) != ESP_ERR_NOT_FOUND)
+    {
+        ESP_LOGE(TAG, "Found a log on a blank device");
+        errors++;
+    }
+    /*!< as a region off a chunk boundary on the card would be, chunks would straddle erase blocks */
+    dev->first_sector = BENCH_CHUNK_SECTORS / 2;
+    if (sd_raw_log_format(dev, config) != ESP_ERR_INVALID_SIZE)
+    {
+        ESP_LOGE(TAG, "Formatted a device that does not start on a chunk");
+        errors++;
+    }
+    dev->first_sector = 0;
+    ESP_ERROR_CHECK(sd_raw_log_format(dev, config));
+    ESP_ERROR_CHECK(sd_raw_log_open(dev, config, &log));
+
+    /*!< about a third of the device, synced now and then so the head chunk is partly on the card */
+    ESP_ERROR_CHECK(bench_append(log, 0, 1000, 97, &us));
+    sd_raw_log_get_stats(log, &stats);
+    ESP_LOGI(TAG, "1000 records in %lld us, %lu chunk writes, %llu sectors", us, (unsigned long)stats.chunk_writes, (unsigned long long)stats.sectors_written);
+    errors += bench_reopen(dev, config, &log, &check, "Reopen");
+    errors += check.first != 0 || check.next != 1000;
+
+    /*!< records after the last sync are lost, unless a full chunk took them to the card */
+    ESP_ERROR_CHECK(bench_append(log, 1000, 1050, 0, &us));
+    ESP_ERROR_CHECK(sd_raw_log_sync(log));
+    ESP_ERROR_CHECK(bench_append(log, 1050, 1060, 0, &us));
+    bench_power_cut(&log);
+    errors += bench_reopen(dev, config, &log, &check, "Power cut");
+    errors += check.first != 0 || check.next < 1050 || check.next > 1060;
+
+    /*!< several laps, the oldest chunks are overwritten */
+    ESP_ERROR_CHECK(bench_append(log, check.next, 6000, 0, &us));
+    errors += bench_reopen(dev, config, &log, &check, "Wrapped");
+    errors += check.first == 0 || check.next != 6000;
+
+    /*!< damage the head chunk on the card, as if power went mid write */
+    sd_raw_log_get_stats(log, &stats);
+    uint8_t sector[SD_RAW_SECTOR_SIZE];
+    uint32_t torn = stats.head_chunk * BENCH_CHUNK_SECTORS + 1;
+    ESP_ERROR_CHECK(sd_raw_log_sync(log));
+    ESP_ERROR_CHECK(sd_raw_dev_read(dev, torn, sector, 1));
+    sector[100] ^= 0xff;
+    ESP_ERROR_CHECK(sd_raw_dev_write(dev, torn, sector, 1));
+    bench_power_cut(&log);
+    errors += bench_reopen(dev, config, &log, &check, "Torn");
+    sd_raw_log_get_stats(log, &stats);
+    errors += stats.dropped != 1 || check.next >= 6000;
+
+    /*!< carries on after the last good record */
+    ESP_ERROR_CHECK(bench_append(log, check.next, check.next + 500, 0, &us));
+    uint32_t next = check.next + 500;
+    errors += bench_reopen(dev, config, &log, &check, "After torn");
+    errors += check.next != next;
+
+    ESP_ERROR_CHECK(sd_raw_log_export(log, BENCH_EXPORT, false));
+    FILE *f = fopen(BENCH_EXPORT, "rb");
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    ESP_LOGI(TAG, "Exported %ld bytes, %llu expected", size, (unsigned long long)check.bytes);
+    errors += (uint64_t)size != check.bytes;
+
+    sd_raw_log_close(log);
+    sd_raw_dev_del(dev);
+    ESP_LOGI(TAG, "%lu errors", (unsigned long)errors);
+    exit(errors ? 1 : 0);
+}
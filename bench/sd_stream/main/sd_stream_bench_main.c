@@ -0,0 +1,28 @@
+#include <stdlib.h>
+#include "esp_log.h"
+#include "sd_stream.h"
+
+#define BENCH_PATH "/tmp/sd_stream_bench.bin"
+#define BENCH_FILE_SIZE (8 * 1024 * 1024)
+
+static const char *TAG = "SD_STREAM_MAIN";
+
+void app_main(void)
+{
+    const char *path = getenv("SD_STREAM_BENCH_PATH") ? getenv("SD_STREAM_BENCH_PATH") : BENCH_PATH;
+    sd_stream_config_t config = {
+        .access = SD_STREAM_SEQUENTIAL,
+        .task_priority = 5,
+        .task_core = tskNO_AFFINITY,
+    };
+    esp_err_t ret = sd_stream_bench(path, BENCH_FILE_SIZE, config, NULL, NULL);
+
+    /*!< random access reads without read ahead, the difference is what the overlap buys */
+    if (ret == ESP_OK)
+    {
+        config.access = SD_STREAM_RANDOM;
+        ret = sd_stream_bench(path, BENCH_FILE_SIZE, config, NULL, NULL);
+    }
+    ESP_LOGI(TAG, "Done: %s", esp_err_to_name(ret));
+    exit(ret == ESP_OK ? 0 : 1);
+}
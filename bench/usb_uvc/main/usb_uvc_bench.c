@@ -0,0 +1,81 @@
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "usb_uvc_payload.h"
+
+#define BENCH_MAX_FRAME (240 * 240 * 2 * 2)
+
+static const char *TAG = "USB_UVC_BENCH";
+
+static uint8_t frame[BENCH_MAX_FRAME];
+static uint8_t wire[BENCH_MAX_FRAME + USB_UVC_HEADER_SIZE];
+
+/**
+ * @brief send one frame as the pump does and check what reaches the bus
+ */
+static uint32_t bench_frame(size_t len)
+{
+    usb_uvc_payload_t payload;
+    const uint8_t *data = NULL;
+    size_t xfer = 0;
+    size_t used = 0;
+    uint32_t transfers = 1;
+    uint32_t errors = 0;
+
+    usb_uvc_payload_prepare(&payload, frame, len, 1, 1234);
+    memcpy(wire, payload.head, payload.head_len);
+    used = payload.head_len;
+    if (payload.body_len && payload.head_len != USB_UVC_PACKET_SIZE)
+    {
+        ESP_LOGE(TAG, "%u bytes: short head packet ends the payload early", (unsigned)len);
+        errors++;
+    }
+    while ((xfer = usb_uvc_payload_next(&payload, &data)) != 0)
+    {
+        bool last = payload.body_sent == payload.body_len;
+        if (xfer > UINT16_MAX || (!last && xfer % USB_UVC_PACKET_SIZE))
+        {
+            ESP_LOGE(TAG, "%u bytes: transfer %lu is %u bytes", (unsigned)len, (unsigned long)transfers, (unsigned)xfer);
+            errors++;
+        }
+        memcpy(wire + used, data, xfer);
+        used += xfer;
+        transfers++;
+    }
+    if (used != len + USB_UVC_HEADER_SIZE || memcmp(wire + USB_UVC_HEADER_SIZE, frame, len) != 0)
+    {
+        ESP_LOGE(TAG, "%u bytes: %u reached the bus or the frame differs", (unsigned)len, (unsigned)(used - USB_UVC_HEADER_SIZE));
+        errors++;
+    }
+    if (payload.zlp != (used % USB_UVC_PACKET_SIZE == 0))
+    {
+        ESP_LOGE(TAG, "%u bytes: zero length packet %s", (unsigned)len, payload.zlp ? "sent but not needed" : "missing");
+        errors++;
+    }
+    if (wire[1] != 0x8F)
+    {
+        ESP_LOGE(TAG, "%u bytes: header flags %02x", (unsigned)len, wire[1]);
+        errors++;
+    }
+    ESP_LOGD(TAG, "%u bytes in %lu transfers", (unsigned)len, (unsigned long)transfers);
+    return errors;
+}
+
+void app_main(void)
+{
+    /*!< around the head packet, the 16 bit limit and an uncompressed 240x240 frame */
+    static const size_t lengths[] = {1, 51, 52, 53, 116, 5000, USB_UVC_XFER_MAX, USB_UVC_XFER_MAX + 52, USB_UVC_XFER_MAX + 53, UINT16_MAX, UINT16_MAX + 1,
+                                     240 * 240 * 2, 2 * USB_UVC_XFER_MAX + 52, BENCH_MAX_FRAME};
+    uint32_t errors = 0;
+
+    for (size_t i = 0; i < sizeof(frame); i++)
+    {
+        frame[i] = (uint8_t)(i * 131 >> 3);
+    }
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        errors += bench_frame(lengths[i]);
+    }
+    ESP_LOGI(TAG, "%u frame sizes, %s, %lu errors", (unsigned)(sizeof(lengths) / sizeof(lengths[0])), errors ? "FAIL" : "PASS", (unsigned long)errors);
+    exit(errors ? 1 : 0);
+}
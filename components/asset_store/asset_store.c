@@ -0,0 +1,121 @@
+#include "asset_store.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_partition.h"
+#include "string.h"
+#include "img_rle.h"
+
+static const char *TAG = "ASSET_STORE";
+
+static const uint8_t *pack = NULL;
+static const asset_store_entry_t *entries = NULL;
+static uint16_t entry_count = 0;
+static esp_partition_mmap_handle_t pack_handle;
+
+esp_err_t asset_store_init(const char *partition_label)
+{
+    asset_store_header_t header;
+    ESP_RETURN_ON_FALSE(pack == NULL, ESP_ERR_INVALID_STATE, TAG, "Already initialized");
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partition_label);
+    ESP_RETURN_ON_FALSE(part, ESP_ERR_NOT_FOUND, TAG, "Partition %s not found", partition_label);
+
+    /*!< read the header first, only the used part of the partition is mapped */
+    ESP_RETURN_ON_ERROR(esp_partition_read(part, 0, &header, sizeof(header)), TAG, "Read header failed");
+    ESP_RETURN_ON_FALSE(header.magic == ASSET_STORE_MAGIC && header.version == ASSET_STORE_VERSION, ESP_ERR_INVALID_VERSION, TAG, "No asset pack in %s", partition_label);
+    ESP_RETURN_ON_FALSE(header.size <= part->size && header.size >= sizeof(header) + header.count * sizeof(asset_store_entry_t), ESP_ERR_INVALID_SIZE, TAG, "Bad pack size");
+
+    const void *ptr = NULL;
+    ESP_RETURN_ON_ERROR(esp_partition_mmap(part, 0, header.size, ESP_PARTITION_MMAP_DATA, &ptr, &pack_handle), TAG, "Map failed");
+
+    const asset_store_entry_t *index = (const asset_store_entry_t *)((const uint8_t *)ptr + sizeof(header));
+    uint32_t index_end = sizeof(header) + header.count * sizeof(asset_store_entry_t);
+    for (uint16_t i = 0; i < header.count; i++)
+    {
+        /*!< no sums, a size near 4 GiB must not wrap back into the pack */
+        if (index[i].offset < index_end || index[i].offset > header.size || index[i].size > header.size - index[i].offset ||
+            index[i].offset % ASSET_STORE_ALIGN)
+        {
+            ESP_LOGE(TAG, "Asset %d out of bounds", i);
+            esp_partition_munmap(pack_handle);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    pack = ptr;
+    entries = index;
+    entry_count = header.count;
+
+    ESP_LOGI(TAG, "%d assets, %lu bytes mapped from %s", entry_count, (unsigned long)header.size, partition_label);
+    return ESP_OK;
+}
+
+void asset_store_deinit(void)
+{
+    if (pack)
+    {
+        esp_partition_munmap(pack_handle);
+        pack = NULL;
+        entries = NULL;
+        entry_count = 0;
+    }
+}
+
+static const asset_store_entry_t *asset_store_entry(const char *name)
+{
+    for (uint16_t i = 0; i < entry_count; i++)
+    {
+        if (strncmp(entries[i].name, name, ASSET_STORE_NAME_LEN) == 0)
+        {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t asset_store_find(const char *name, const uint8_t **data, size_t *size)
+{
+    ESP_RETURN_ON_FALSE(pack, ESP_ERR_INVALID_STATE, TAG, "Not initialized");
+    const asset_store_entry_t *entry = asset_store_entry(name);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Asset %s not found", name);
+
+    *data = pack + entry->offset;
+    *size = entry->size;
+    return ESP_OK;
+}
+
+esp_err_t asset_store_get_img(const char *name, lv_img_dsc_t *dsc)
+{
+    ESP_RETURN_ON_FALSE(pack, ESP_ERR_INVALID_STATE, TAG, "Not initialized");
+    const asset_store_entry_t *entry = asset_store_entry(name);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Asset %s not found", name);
+
+    /*!< the pack is flashed on its own, LVGL reads as much as the header promises */
+    uint64_t min_size = 0;
+    memset(dsc, 0, sizeof(lv_img_dsc_t));
+    switch (entry->format)
+    {
+    case ASSET_FORMAT_TRUE_COLOR:
+        dsc->header.cf = LV_IMG_CF_TRUE_COLOR;
+        min_size = (uint64_t)entry->width * entry->height * (LV_COLOR_SIZE / 8);
+        break;
+    case ASSET_FORMAT_TRUE_COLOR_ALPHA:
+        dsc->header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+        min_size = (uint64_t)entry->width * entry->height * LV_IMG_PX_SIZE_ALPHA_BYTE;
+        break;
+    case ASSET_FORMAT_RLE:
+        dsc->header.cf = IMG_RLE_CF;
+        /*!< the lines themselves are bounded by the decoder */
+        min_size = sizeof(img_rle_header_t) + (uint64_t)entry->height * sizeof(uint32_t);
+        break;
+    default:
+        ESP_LOGE(TAG, "Asset %s is not an image", name);
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_RETURN_ON_FALSE(entry->size >= min_size, ESP_ERR_INVALID_SIZE, TAG, "Asset %s is smaller than its %ux%u image", name, entry->width, entry->height);
+    dsc->header.w = entry->width;
+    dsc->header.h = entry->height;
+    dsc->data_size = entry->size;
+    dsc->data = pack + entry->offset;
+
+    return ESP_OK;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "stddef.h"
+#include "lvgl.h"
+
+#define ASSET_STORE_MAGIC 0x314B5041 /*!< "APK1" */
+#define ASSET_STORE_VERSION 1
+#define ASSET_STORE_NAME_LEN 24
+#define ASSET_STORE_ALIGN 16 /*!< every asset starts on this boundary inside the pack */
+
+typedef enum
+{
+    ASSET_FORMAT_RAW,              /*!< any file */
+    ASSET_FORMAT_TRUE_COLOR,       /*!< LV_IMG_CF_TRUE_COLOR pixels */
+    ASSET_FORMAT_TRUE_COLOR_ALPHA, /*!< LV_IMG_CF_TRUE_COLOR_ALPHA pixels */
+    ASSET_FORMAT_RLE,              /*!< img_rle coded image */
+} asset_format_t;
+
+/**
+ * @brief pack layout, written by tools/asset_pack.py, little endian
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t size; /*!< whole pack, header and index included */
+    uint32_t reserved;
+} asset_store_header_t;
+
+typedef struct __attribute__((packed))
+{
+    char name[ASSET_STORE_NAME_LEN]; /*!< NUL terminated */
+    uint32_t offset;                 /*!< from the start of the pack */
+    uint32_t size;
+    uint16_t width;
+    uint16_t height;
+    uint8_t format; /*!< asset_format_t */
+    uint8_t reserved[3];
+} asset_store_entry_t;
+
+/**
+ * @brief map the asset pack of a data partition, nothing is copied to RAM
+ *
+ * @param partition_label
+ * @return esp_err_t ESP_ERR_NOT_FOUND if there is no partition, ESP_ERR_INVALID_VERSION if it holds no pack
+ */
+esp_err_t asset_store_init(const char *partition_label);
+
+/**
+ * @brief unmap the pack, pointers handed out before become invalid
+ */
+void asset_store_deinit(void);
+
+/**
+ * @brief find an asset by name
+ *
+ * @param name
+ * @param data points into mapped flash
+ * @param size
+ * @return esp_err_t
+ */
+esp_err_t asset_store_find(const char *name, const uint8_t **data, size_t *size);
+
+/**
+ * @brief fill an LVGL image descriptor whose data points into mapped flash
+ *
+ * @param name
+ * @param dsc must stay valid while LVGL uses the image
+ * @return esp_err_t ESP_ERR_INVALID_ARG if the asset is not an image, ESP_ERR_INVALID_SIZE if it holds fewer bytes than its width and height need
+ */
+esp_err_t asset_store_get_img(const char *name, lv_img_dsc_t *dsc);
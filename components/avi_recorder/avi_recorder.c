@@ -0,0 +1,441 @@
+#include <stdio.h>
+#include <unistd.h>
+#include "avi_recorder.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "string.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "sd_index.h"
+#include "esp_vfs_fat.h"
+
+#define AVI_RECORDER_ALIGN (16 * 1024) /*!< allocation_unit_size used by sd_card_init */
+#define AVI_RECORDER_HEADER_SIZE AVI_RECORDER_ALIGN
+#define AVI_FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+#define AVI_INDEX_KEYFRAME 0x10
+
+typedef struct __attribute__((packed))
+{
+    uint32_t riff;
+    uint32_t riff_size;
+    uint32_t avi;
+    uint32_t list_hdrl;
+    uint32_t hdrl_size;
+    uint32_t hdrl;
+
+    uint32_t avih;
+    uint32_t avih_size;
+    uint32_t us_per_frame;
+    uint32_t max_bytes_per_sec;
+    uint32_t padding_granularity;
+    uint32_t flags;
+    uint32_t total_frames;
+    uint32_t initial_frames;
+    uint32_t streams;
+    uint32_t suggested_buffer_size;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved[4];
+
+    uint32_t list_strl;
+    uint32_t strl_size;
+    uint32_t strl;
+
+    uint32_t strh;
+    uint32_t strh_size;
+    uint32_t fcc_type;
+    uint32_t fcc_handler;
+    uint32_t strh_flags;
+    uint16_t priority;
+    uint16_t language;
+    uint32_t strh_initial_frames;
+    uint32_t scale;
+    uint32_t rate;
+    uint32_t start;
+    uint32_t length;
+    uint32_t strh_suggested_buffer_size;
+    uint32_t quality;
+    uint32_t sample_size;
+    int16_t frame_rect[4];
+
+    uint32_t strf;
+    uint32_t strf_size;
+    uint32_t bi_size;
+    int32_t bi_width;
+    int32_t bi_height;
+    uint16_t bi_planes;
+    uint16_t bi_bit_count;
+    uint32_t bi_compression;
+    uint32_t bi_size_image;
+    int32_t bi_x_pels_per_meter;
+    int32_t bi_y_pels_per_meter;
+    uint32_t bi_clr_used;
+    uint32_t bi_clr_important;
+
+    uint32_t junk;
+    uint32_t junk_size;
+} avi_header_t;
+
+typedef struct
+{
+    uint32_t fourcc;
+    uint32_t flags;
+    uint32_t offset; /*!< from the 'movi' fourcc */
+    uint32_t size;
+} avi_index_t;
+
+typedef struct
+{
+    const uint8_t *data; /*!< NULL asks the writer to finish */
+    size_t len;
+    avi_recorder_release_cb_t release;
+    void *user_ctx;
+} avi_frame_t;
+
+static const char *TAG = "AVI_RECORDER";
+
+static avi_recorder_config_t rec_cfg;
+static avi_recorder_stats_t rec_stats;
+static QueueHandle_t frame_queue = NULL;
+static SemaphoreHandle_t writer_done = NULL;
+static FILE *rec_file = NULL;
+static avi_index_t *rec_index = NULL;
+static uint8_t *stage = NULL; /*!< one allocation unit, written out only when full */
+static size_t stage_used = 0;
+static uint32_t file_pos = 0; /*!< offset where the next stage write lands */
+static uint32_t movi_end = 0;
+static uint32_t max_frame_size = 0;
+static uint32_t frames_accepted = 0; /*!< queued by avi_recorder_add_frame, the index holds max_frames */
+static int64_t first_frame_time = 0;
+static esp_err_t writer_result = ESP_OK;
+
+static void avi_recorder_fill_header(avi_header_t *h, uint32_t frames, uint32_t us_per_frame)
+{
+    memset(h, 0, sizeof(avi_header_t));
+    h->riff = AVI_FOURCC('R', 'I', 'F', 'F');
+    /*!< everything after the RIFF size field: movi data, idx1 header and entries */
+    h->riff_size = movi_end + frames * sizeof(avi_index_t);
+    h->avi = AVI_FOURCC('A', 'V', 'I', ' ');
+    h->list_hdrl = AVI_FOURCC('L', 'I', 'S', 'T');
+    h->hdrl_size = offsetof(avi_header_t, junk) - offsetof(avi_header_t, hdrl);
+    h->hdrl = AVI_FOURCC('h', 'd', 'r', 'l');
+
+    h->avih = AVI_FOURCC('a', 'v', 'i', 'h');
+    h->avih_size = offsetof(avi_header_t, list_strl) - offsetof(avi_header_t, us_per_frame);
+    h->us_per_frame = us_per_frame;
+    h->max_bytes_per_sec = max_frame_size * (1000000 / us_per_frame);
+    h->flags = 0x10; /*!< AVIF_HASINDEX */
+    h->total_frames = frames;
+    h->streams = 1;
+    h->suggested_buffer_size = max_frame_size;
+    h->width = rec_cfg.width;
+    h->height = rec_cfg.height;
+
+    h->list_strl = AVI_FOURCC('L', 'I', 'S', 'T');
+    h->strl_size = offsetof(avi_header_t, junk) - offsetof(avi_header_t, strl);
+    h->strl = AVI_FOURCC('s', 't', 'r', 'l');
+
+    h->strh = AVI_FOURCC('s', 't', 'r', 'h');
+    h->strh_size = offsetof(avi_header_t, strf) - offsetof(avi_header_t, fcc_type);
+    h->fcc_type = AVI_FOURCC('v', 'i', 'd', 's');
+    h->fcc_handler = AVI_FOURCC('M', 'J', 'P', 'G');
+    h->scale = us_per_frame;
+    h->rate = 1000000;
+    h->length = frames;
+    h->strh_suggested_buffer_size = max_frame_size;
+    h->quality = 0xFFFFFFFF;
+    h->frame_rect[2] = rec_cfg.width;
+    h->frame_rect[3] = rec_cfg.height;
+
+    h->strf = AVI_FOURCC('s', 't', 'r', 'f');
+    h->strf_size = offsetof(avi_header_t, junk) - offsetof(avi_header_t, bi_size);
+    h->bi_size = h->strf_size;
+    h->bi_width = rec_cfg.width;
+    h->bi_height = rec_cfg.height;
+    h->bi_planes = 1;
+    h->bi_bit_count = 24;
+    h->bi_compression = AVI_FOURCC('M', 'J', 'P', 'G');
+    h->bi_size_image = rec_cfg.width * rec_cfg.height * 3;
+
+    /*!< pad the header so the movi data starts on an allocation unit */
+    h->junk = AVI_FOURCC('J', 'U', 'N', 'K');
+    h->junk_size = AVI_RECORDER_HEADER_SIZE - 12 - sizeof(avi_header_t);
+}
+
+static esp_err_t avi_recorder_write(const void *data, size_t len)
+{
+    int64_t start = esp_timer_get_time();
+    if (fwrite(data, 1, len, rec_file) != len)
+    {
+        ESP_LOGE(TAG, "Write failed at %lu", (unsigned long)file_pos);
+        return ESP_FAIL;
+    }
+    uint32_t elapsed = esp_timer_get_time() - start;
+    if (elapsed > rec_stats.max_write_time)
+    {
+        rec_stats.max_write_time = elapsed;
+    }
+    file_pos += len;
+    rec_stats.bytes_written += len;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief append to the stage buffer, writing it out each time it holds a full allocation unit
+ */
+static esp_err_t avi_recorder_append(const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        size_t n = AVI_RECORDER_ALIGN - stage_used;
+        n = n < len ? n : len;
+        memcpy(stage + stage_used, data, n);
+        stage_used += n;
+        data += n;
+        len -= n;
+        if (stage_used == AVI_RECORDER_ALIGN)
+        {
+            ESP_RETURN_ON_ERROR(avi_recorder_write(stage, AVI_RECORDER_ALIGN), TAG, "Stage write failed");
+            stage_used = 0;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t avi_recorder_write_frame(const avi_frame_t *frame)
+{
+    uint32_t chunk[2] = {AVI_FOURCC('0', '0', 'd', 'c'), frame->len};
+    uint8_t pad = 0;
+
+    rec_index[rec_stats.frames_written] = (avi_index_t){
+        .fourcc = chunk[0],
+        .flags = AVI_INDEX_KEYFRAME,
+        .offset = movi_end - (AVI_RECORDER_HEADER_SIZE - 4),
+        .size = frame->len,
+    };
+    ESP_RETURN_ON_ERROR(avi_recorder_append((const uint8_t *)chunk, sizeof(chunk)), TAG, "Chunk header failed");
+    ESP_RETURN_ON_ERROR(avi_recorder_append(frame->data, frame->len), TAG, "Chunk data failed");
+    movi_end += sizeof(chunk) + frame->len;
+    if (frame->len & 1)
+    {
+        /*!< RIFF chunks are word aligned */
+        ESP_RETURN_ON_ERROR(avi_recorder_append(&pad, 1), TAG, "Chunk pad failed");
+        movi_end++;
+    }
+    if (frame->len > max_frame_size)
+    {
+        max_frame_size = frame->len;
+    }
+    rec_stats.frames_written++;
+
+    return ESP_OK;
+}
+
+static esp_err_t avi_recorder_finish(void)
+{
+    avi_header_t header;
+    uint32_t frames = rec_stats.frames_written;
+    uint32_t movi_list[3] = {AVI_FOURCC('L', 'I', 'S', 'T'), 0, AVI_FOURCC('m', 'o', 'v', 'i')};
+    uint32_t idx1[2] = {AVI_FOURCC('i', 'd', 'x', '1'), frames * sizeof(avi_index_t)};
+    int64_t elapsed = esp_timer_get_time() - first_frame_time;
+    uint32_t us_per_frame = (frames > 1) ? elapsed / (frames - 1) : 1000000 / rec_cfg.fps;
+    us_per_frame = us_per_frame ? us_per_frame : 1;
+
+    /*!< the tail of the last allocation unit and the index go out unaligned, once */
+    ESP_RETURN_ON_ERROR(avi_recorder_append((const uint8_t *)idx1, sizeof(idx1)), TAG, "Index header failed");
+    ESP_RETURN_ON_ERROR(avi_recorder_append((const uint8_t *)rec_index, frames * sizeof(avi_index_t)), TAG, "Index failed");
+    if (stage_used)
+    {
+        ESP_RETURN_ON_ERROR(avi_recorder_write(stage, stage_used), TAG, "Tail write failed");
+        stage_used = 0;
+    }
+
+    avi_recorder_fill_header(&header, frames, us_per_frame);
+    movi_list[1] = movi_end - (AVI_RECORDER_HEADER_SIZE - 4);
+    fflush(rec_file);
+    ESP_RETURN_ON_FALSE(fseek(rec_file, 0, SEEK_SET) == 0, ESP_FAIL, TAG, "Seek failed");
+    ESP_RETURN_ON_FALSE(fwrite(&header, 1, sizeof(header), rec_file) == sizeof(header), ESP_FAIL, TAG, "Header write failed");
+    ESP_RETURN_ON_FALSE(fseek(rec_file, AVI_RECORDER_HEADER_SIZE - sizeof(movi_list), SEEK_SET) == 0, ESP_FAIL, TAG, "Seek failed");
+    ESP_RETURN_ON_FALSE(fwrite(movi_list, 1, sizeof(movi_list), rec_file) == sizeof(movi_list), ESP_FAIL, TAG, "Movi header write failed");
+    fflush(rec_file);
+
+    /*!< give back the part of the preallocation that was not used */
+    ftruncate(fileno(rec_file), file_pos);
+    ESP_LOGI(TAG, "%s: %lu frames, %lu bytes, %lu us per frame", rec_cfg.path, (unsigned long)frames, (unsigned long)file_pos, (unsigned long)us_per_frame);
+
+    return ESP_OK;
+}
+
+static void avi_recorder_task(void *arg)
+{
+    avi_frame_t frame;
+
+    while (1)
+    {
+        xQueueReceive(frame_queue, &frame, portMAX_DELAY);
+        if (frame.data == NULL)
+        {
+            break;
+        }
+        if (writer_result == ESP_OK)
+        {
+            writer_result = avi_recorder_write_frame(&frame);
+            int64_t elapsed = esp_timer_get_time() - first_frame_time;
+            if (elapsed > 0)
+            {
+                rec_stats.write_rate = rec_stats.bytes_written * 1000000 / elapsed;
+            }
+        }
+        /*!< written or skipped after an error, the caller gets its buffer back either way */
+        frame.release(frame.user_ctx);
+    }
+
+    if (writer_result == ESP_OK)
+    {
+        writer_result = avi_recorder_finish();
+    }
+    xSemaphoreGive(writer_done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t avi_recorder_start(avi_recorder_config_t config)
+{
+    esp_err_t ret = ESP_OK;
+    avi_header_t header;
+    ESP_RETURN_ON_FALSE(rec_file == NULL, ESP_ERR_INVALID_STATE, TAG, "Recorder already running");
+    ESP_RETURN_ON_FALSE(config.path && config.base_path && config.fps && config.max_frames, ESP_ERR_INVALID_ARG, TAG, "Invalid config");
+    rec_cfg = config;
+    memset(&rec_stats, 0, sizeof(rec_stats));
+
+    /*!< one contiguous chain up front, so no FAT updates happen while recording */
+    ret = esp_vfs_fat_create_contiguous_file(config.base_path, config.path, config.prealloc_size, true);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Contiguous preallocation failed (%s), recording into a growing file", esp_err_to_name(ret));
+        rec_file = fopen(config.path, "wb");
+    }
+    else
+    {
+        rec_file = fopen(config.path, "r+b");
+    }
+    ESP_RETURN_ON_FALSE(rec_file, ESP_FAIL, TAG, "Open %s failed", config.path);
+    /*!< the recording is a new file for the directory index */
+    sd_index_invalidate();
+    /*!< writes are already allocation unit sized, skip the stdio buffer */
+    setvbuf(rec_file, NULL, _IONBF, 0);
+
+    rec_index = heap_caps_malloc(config.max_frames * sizeof(avi_index_t), MALLOC_CAP_SPIRAM);
+    stage = heap_caps_malloc(AVI_RECORDER_ALIGN, MALLOC_CAP_DMA);
+    frame_queue = xQueueCreate(config.queue_depth, sizeof(avi_frame_t));
+    writer_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(rec_index && stage && frame_queue && writer_done, ESP_ERR_NO_MEM, err, TAG, "Alloc failed");
+
+    movi_end = AVI_RECORDER_HEADER_SIZE;
+    max_frame_size = 0;
+    frames_accepted = 0;
+    first_frame_time = 0;
+    writer_result = ESP_OK;
+
+    /*!< placeholder header, patched on stop */
+    avi_recorder_fill_header(&header, 0, 1000000 / config.fps);
+    uint32_t movi_list[3] = {AVI_FOURCC('L', 'I', 'S', 'T'), 4, AVI_FOURCC('m', 'o', 'v', 'i')};
+    memset(stage, 0, AVI_RECORDER_ALIGN);
+    memcpy(stage, &header, sizeof(header));
+    memcpy(stage + AVI_RECORDER_HEADER_SIZE - sizeof(movi_list), movi_list, sizeof(movi_list));
+    file_pos = 0;
+    ESP_GOTO_ON_ERROR(avi_recorder_write(stage, AVI_RECORDER_HEADER_SIZE), err, TAG, "Header write failed");
+    stage_used = 0;
+
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(avi_recorder_task, "avi_writer", 4096, NULL, config.task_priority, NULL, config.task_core) == pdPASS,
+                      ESP_ERR_NO_MEM, err, TAG, "Writer task create failed");
+    ESP_LOGI(TAG, "Recording %s, %dx%d", config.path, config.width, config.height);
+    return ESP_OK;
+
+err:
+    fclose(rec_file);
+    rec_file = NULL;
+    heap_caps_free(rec_index);
+    rec_index = NULL;
+    heap_caps_free(stage);
+    stage = NULL;
+    if (frame_queue)
+    {
+        vQueueDelete(frame_queue);
+        frame_queue = NULL;
+    }
+    if (writer_done)
+    {
+        vSemaphoreDelete(writer_done);
+        writer_done = NULL;
+    }
+    return ret;
+}
+
+esp_err_t avi_recorder_add_frame(const uint8_t *jpeg, size_t len, avi_recorder_release_cb_t release, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(frame_queue, ESP_ERR_INVALID_STATE, TAG, "Recorder not running");
+    ESP_RETURN_ON_FALSE(jpeg && len && release, ESP_ERR_INVALID_ARG, TAG, "Empty frame");
+
+    if (first_frame_time == 0)
+    {
+        first_frame_time = esp_timer_get_time();
+    }
+    /*!< the index is full, counted here because the writer only counts a frame once it is written */
+    if (frames_accepted >= rec_cfg.max_frames)
+    {
+        rec_stats.frames_dropped++;
+        return ESP_ERR_NO_MEM;
+    }
+    /*!< no copy, the writer reads the caller's buffer until it releases it */
+    avi_frame_t frame = {
+        .data = jpeg,
+        .len = len,
+        .release = release,
+        .user_ctx = user_ctx,
+    };
+    if (xQueueSend(frame_queue, &frame, 0) != pdTRUE)
+    {
+        rec_stats.frames_dropped++;
+        return ESP_ERR_TIMEOUT;
+    }
+    frames_accepted++;
+
+    return ESP_OK;
+}
+
+esp_err_t avi_recorder_stop(void)
+{
+    avi_frame_t stop = {
+        .data = NULL,
+        .len = 0,
+    };
+    ESP_RETURN_ON_FALSE(frame_queue, ESP_ERR_INVALID_STATE, TAG, "Recorder not running");
+
+    xQueueSend(frame_queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(writer_done, portMAX_DELAY);
+    esp_err_t ret = writer_result;
+
+    fclose(rec_file);
+    rec_file = NULL;
+    sd_index_invalidate();
+    heap_caps_free(rec_index);
+    rec_index = NULL;
+    heap_caps_free(stage);
+    stage = NULL;
+    vQueueDelete(frame_queue);
+    frame_queue = NULL;
+    vSemaphoreDelete(writer_done);
+    writer_done = NULL;
+
+    return ret;
+}
+
+void avi_recorder_get_stats(avi_recorder_stats_t *stats)
+{
+    *stats = rec_stats;
+}
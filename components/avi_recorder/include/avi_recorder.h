@@ -0,0 +1,69 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "stddef.h"
+
+typedef struct
+{
+    const char *base_path; /*!< mount point of the card, e.g. "/data" */
+    const char *path;      /*!< full file path under base_path */
+    uint16_t width;
+    uint16_t height;
+    uint8_t fps;            /*!< nominal rate, the header is patched with the measured one on stop */
+    uint32_t max_frames;    /*!< index capacity, frames beyond it are dropped */
+    uint32_t prealloc_size; /*!< bytes reserved as one contiguous cluster chain */
+    uint8_t queue_depth;
+    uint8_t task_priority;
+    int task_core;
+} avi_recorder_config_t;
+
+/**
+ * @brief called from the writer task once a frame buffer is no longer read, e.g. to return it to the camera driver
+ */
+typedef void (*avi_recorder_release_cb_t)(void *user_ctx);
+
+typedef struct
+{
+    uint32_t frames_written;
+    uint32_t frames_dropped;
+    uint64_t bytes_written;
+    uint32_t write_rate;     /*!< bytes per second since the first frame */
+    uint32_t max_write_time; /*!< slowest single chunk write in us */
+} avi_recorder_stats_t;
+
+/**
+ * @brief preallocate the file and start the writer task
+ *
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t avi_recorder_start(avi_recorder_config_t config);
+
+/**
+ * @brief queue a JPEG frame for writing without copying it, counted as dropped if the queue is full
+ *
+ * On ESP_OK the buffer must stay valid until release is called. On any error release is not
+ * called and the caller still owns the buffer.
+ *
+ * @param jpeg
+ * @param len
+ * @param release
+ * @param user_ctx passed to release
+ * @return esp_err_t
+ */
+esp_err_t avi_recorder_add_frame(const uint8_t *jpeg, size_t len, avi_recorder_release_cb_t release, void *user_ctx);
+
+/**
+ * @brief write the remaining frames and the index, patch the header and close the file
+ *
+ * @return esp_err_t
+ */
+esp_err_t avi_recorder_stop(void);
+
+/**
+ * @brief get recorder counters
+ *
+ * @param stats
+ */
+void avi_recorder_get_stats(avi_recorder_stats_t *stats);
@@ -26,12 +26,15 @@ static camera_config_t camera_config = {
     .pixel_format = PIXFORMAT_RGB565,
     .frame_size = FRAMESIZE_240X240,
     .jpeg_quality = 12, // 0-63 lower number means higher quality
-    .fb_count = 1,
-    .grab_mode = CAMERA_GRAB_WHEN_EMPTY,
+    .fb_location = CAMERA_FB_IN_PSRAM,
+    .fb_count = CAMERA_FB_COUNT, // capture, queue and display each hold one buffer
+    .grab_mode = CAMERA_GRAB_LATEST, // a slow display gets the newest frame, not one queued in the driver
 };
 
-esp_err_t camera_init()
+esp_err_t camera_init(pixformat_t pixel_format, framesize_t frame_size)
 {
+    camera_config.pixel_format = pixel_format;
+    camera_config.frame_size = frame_size;
     esp_err_t err = esp_camera_init(&camera_config);
     if (err != ESP_OK)
     {
@@ -3,4 +3,13 @@
 #include "esp_err.h"
 #include "esp_camera.h"
 
-esp_err_t camera_init();
+#define CAMERA_FB_COUNT 3
+
+/**
+ * @brief camera init
+ *
+ * @param pixel_format PIXFORMAT_RGB565 or PIXFORMAT_JPEG
+ * @param frame_size
+ * @return esp_err_t
+ */
+esp_err_t camera_init(pixformat_t pixel_format, framesize_t frame_size);
@@ -0,0 +1,453 @@
+#include "camera_pipeline.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_jpg_decode.h"
+#include "string.h"
+
+#define CAMERA_PIPELINE_TASK_STACK 4096 /*!< the scaler's column tables are on the heap, see pixel_ops_scale_init */
+
+static const char *TAG = "CAMERA_PIPELINE";
+
+typedef struct
+{
+    const camera_fb_t *pic;
+    uint16_t *strip;
+    uint16_t strip_mcu_y; /*!< decoded row of the MCU row the strip holds */
+    uint16_t strip_y;     /*!< panel row of the strip */
+    uint16_t strip_h;
+    uint16_t src_x; /*!< visible window of the decoded image, centred on it when it is larger than the panel */
+    uint16_t src_y;
+    uint16_t dst_x; /*!< where the window lands, centred on the panel when the image is smaller */
+    uint16_t dst_y;
+    uint16_t width;
+    uint16_t height;
+} camera_pipeline_jpeg_t;
+
+static camera_pipeline_config_t pipeline_config;
+static camera_pipeline_stats_t pipeline_stats;
+static QueueHandle_t frame_queue = NULL;
+static SemaphoreHandle_t flush_done = NULL;
+static SemaphoreHandle_t task_exit = NULL;
+static SemaphoreHandle_t record_done = NULL;
+static volatile bool pipeline_stopping = false;
+static uint32_t jpeg_last_size = 0; /*!< decoded width << 16 | height of the previous JPEG frame */
+static pixel_ops_scale_t frame_scale;   /*!< column tables of the scaler, rebuilt when the frame size changes */
+static uint32_t frame_scale_size = 0;   /*!< width << 16 | height the tables were built for */
+
+static void camera_pipeline_flush_done_cb(void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(flush_done, &need_yield);
+    portYIELD_FROM_ISR(need_yield);
+}
+
+static size_t camera_pipeline_jpeg_read(void *arg, size_t index, uint8_t *buf, size_t len)
+{
+    camera_pipeline_jpeg_t *jpeg = (camera_pipeline_jpeg_t *)arg;
+    if (index + len > jpeg->pic->len)
+    {
+        len = jpeg->pic->len - index;
+    }
+    if (buf)
+    {
+        memcpy(buf, jpeg->pic->buf + index, len);
+    }
+    return len;
+}
+
+static bool camera_pipeline_jpeg_flush(camera_pipeline_jpeg_t *jpeg)
+{
+    if (jpeg->strip == NULL)
+    {
+        return true;
+    }
+    lcd_region_t region = {
+        .x1 = jpeg->dst_x,
+        .y1 = jpeg->strip_y,
+        .x2 = jpeg->dst_x + jpeg->width,
+        .y2 = jpeg->strip_y + jpeg->strip_h,
+    };
+    esp_err_t ret = lcd_strip_draw(region, jpeg->strip);
+    jpeg->strip = NULL;
+    return ret == ESP_OK;
+}
+
+/**
+ * @brief decoder output, one MCU block of rgb888 at a time in raster order, cropped or placed centred on the panel
+ */
+static bool camera_pipeline_jpeg_write(void *arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t *data)
+{
+    camera_pipeline_jpeg_t *jpeg = (camera_pipeline_jpeg_t *)arg;
+
+    uint16_t panel_w = pipeline_config.panel_width;
+    uint16_t panel_h = pipeline_config.panel_height;
+
+    if (!data)
+    {
+        if (x == 0 && y == 0)
+        {
+            /*!< start of image, w and h are the decoded size, centre it as the scaler does */
+            jpeg->width = w < panel_w ? w : panel_w;
+            jpeg->height = h < panel_h ? h : panel_h;
+            jpeg->src_x = (w - jpeg->width) / 2;
+            jpeg->src_y = (h - jpeg->height) / 2;
+            jpeg->dst_x = (panel_w - jpeg->width) / 2;
+            jpeg->dst_y = (panel_h - jpeg->height) / 2;
+
+            /*!< a smaller image leaves a border, clear it whenever the size changes */
+            uint32_t size = ((uint32_t)w << 16) | h;
+            if (size != jpeg_last_size && (jpeg->width < panel_w || jpeg->height < panel_h))
+            {
+                lcd_region_t panel = {
+                    .x1 = 0,
+                    .y1 = 0,
+                    .x2 = panel_w,
+                    .y2 = panel_h,
+                };
+                lcd_fill_rect(panel, 0);
+            }
+            jpeg_last_size = size;
+            return true;
+        }
+        /*!< end of image */
+        return camera_pipeline_jpeg_flush(jpeg);
+    }
+
+    /*!< the part of the MCU block inside the visible window */
+    uint16_t x0 = x > jpeg->src_x ? x : jpeg->src_x;
+    uint16_t x1 = (x + w < jpeg->src_x + jpeg->width) ? x + w : jpeg->src_x + jpeg->width;
+    uint16_t y0 = y > jpeg->src_y ? y : jpeg->src_y;
+    uint16_t y1 = (y + h < jpeg->src_y + jpeg->height) ? y + h : jpeg->src_y + jpeg->height;
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return true;
+    }
+
+    /*!< a new MCU row starts, the previous one is complete */
+    if (jpeg->strip && y != jpeg->strip_mcu_y)
+    {
+        if (!camera_pipeline_jpeg_flush(jpeg))
+        {
+            return false;
+        }
+    }
+    if (jpeg->strip == NULL)
+    {
+        jpeg->strip = lcd_strip_get(portMAX_DELAY);
+        jpeg->strip_mcu_y = y;
+        jpeg->strip_y = jpeg->dst_y + y0 - jpeg->src_y;
+        jpeg->strip_h = y1 - y0;
+    }
+
+    for (uint16_t row = y0; row < y1; row++)
+    {
+        uint16_t *o = jpeg->strip + (row - y0) * jpeg->width + (x0 - jpeg->src_x);
+        const uint8_t *c = data + ((row - y) * w + (x0 - x)) * 3;
+        for (uint16_t col = x0; col < x1; col++, c += 3)
+        {
+            *o++ = swap_hex(rgb565(c[0], c[1], c[2]));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief decode a JPEG frame MCU row by MCU row straight into LCD strip buffers
+ */
+static esp_err_t camera_pipeline_draw_jpeg(const camera_fb_t *pic)
+{
+    camera_pipeline_jpeg_t jpeg = {
+        .pic = pic,
+    };
+    esp_err_t ret = esp_jpg_decode(pic->len, pipeline_config.jpeg_scale, camera_pipeline_jpeg_read, camera_pipeline_jpeg_write, &jpeg);
+    /*!< decode aborted half way through a strip, hand the buffer back */
+    camera_pipeline_jpeg_flush(&jpeg);
+    return ret;
+}
+
+static void camera_pipeline_scale_fill(uint16_t *strip, lcd_region_t region, void *user_ctx)
+{
+    if (pixel_ops_scale_rows((const pixel_ops_scale_t *)user_ctx, strip, region.y1, region.y2) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Scale rows %d-%d failed", region.y1, region.y2);
+    }
+}
+
+/**
+ * @brief build the scaler tables for a frame size, only when it differs from the previous frame
+ */
+static esp_err_t camera_pipeline_scale_prepare(const camera_fb_t *pic)
+{
+    uint32_t size = (uint32_t)pic->width << 16 | pic->height;
+    if (size == frame_scale_size)
+    {
+        return ESP_OK;
+    }
+    pixel_ops_scale_deinit(&frame_scale);
+    frame_scale_size = 0;
+
+    frame_scale = (pixel_ops_scale_t){
+        .src_stride = pic->width,
+        .crop = {
+            .x = 0,
+            .y = 0,
+            .width = pic->width,
+            .height = pic->height,
+        },
+        .dst_width = pipeline_config.panel_width,
+        .dst_height = pipeline_config.panel_height,
+        .mode = pipeline_config.scale_mode,
+        .swapped = true,
+    };
+    if (pipeline_config.crop_to_fill)
+    {
+        frame_scale.crop = pixel_ops_crop_to_fill(pic->width, pic->height, frame_scale.dst_width, frame_scale.dst_height);
+    }
+    ESP_RETURN_ON_ERROR(pixel_ops_scale_init(&frame_scale), TAG, "Scale %dx%d to %dx%d failed", pic->width, pic->height, frame_scale.dst_width, frame_scale.dst_height);
+    frame_scale_size = size;
+    return ESP_OK;
+}
+
+/**
+ * @brief resample a frame of any size onto the whole panel, one strip at a time
+ */
+static esp_err_t camera_pipeline_draw_scaled(const camera_fb_t *pic)
+{
+    ESP_RETURN_ON_ERROR(camera_pipeline_scale_prepare(pic), TAG, "Frame skipped");
+    frame_scale.src = (const uint16_t *)pic->buf;
+    lcd_region_t region = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = frame_scale.dst_width,
+        .y2 = frame_scale.dst_height,
+    };
+
+    /*!< strips hold resampled copies, the frame is not needed once this returns */
+    return lcd_draw_strips(region, 0, camera_pipeline_scale_fill, &frame_scale);
+}
+
+static void camera_pipeline_record_release(void *user_ctx)
+{
+    xSemaphoreGive(record_done);
+}
+
+static void camera_pipeline_capture_task(void *arg)
+{
+    camera_fb_t *pic = NULL;
+    camera_fb_t *old = NULL;
+
+    while (!pipeline_stopping)
+    {
+        pic = esp_camera_fb_get();
+        if (!pic)
+        {
+            ESP_LOGW(TAG, "Frame capture failed");
+            continue;
+        }
+        if (pipeline_stopping)
+        {
+            esp_camera_fb_return(pic);
+            break;
+        }
+        pipeline_stats.captured++;
+
+        if (pipeline_config.drop_policy == CAMERA_PIPELINE_BLOCK)
+        {
+            xQueueSend(frame_queue, &pic, portMAX_DELAY);
+            continue;
+        }
+        if (xQueueSend(frame_queue, &pic, 0) == pdTRUE)
+        {
+            continue;
+        }
+
+        /*!< queue is full, the display task is behind */
+        if (pipeline_config.drop_policy == CAMERA_PIPELINE_DROP_NEWEST)
+        {
+            esp_camera_fb_return(pic);
+            pipeline_stats.dropped++;
+            continue;
+        }
+        if (xQueueReceive(frame_queue, &old, 0) == pdTRUE)
+        {
+            esp_camera_fb_return(old);
+            pipeline_stats.dropped++;
+        }
+        xQueueSend(frame_queue, &pic, portMAX_DELAY);
+    }
+    xSemaphoreGive(task_exit);
+    vTaskDelete(NULL);
+}
+
+static void camera_pipeline_display_task(void *arg)
+{
+    camera_fb_t *pic = NULL;
+
+    while (1)
+    {
+        xQueueReceive(frame_queue, &pic, portMAX_DELAY);
+        if (pic == NULL)
+        {
+            /*!< queued by camera_pipeline_stop behind the last frame */
+            break;
+        }
+        if (pic->format == PIXFORMAT_JPEG)
+        {
+            /*!< the recorder writes straight from the frame buffer while it is decoded */
+            bool recording = pipeline_config.record && pipeline_config.record(pic->buf, pic->len, camera_pipeline_record_release, NULL) == ESP_OK;
+            /*!< strips are decoded into their own buffers, the frame can go back once the recorder is done with it */
+            if (camera_pipeline_draw_jpeg(pic) != ESP_OK)
+            {
+                ESP_LOGW(TAG, "JPEG decode failed");
+            }
+            if (recording)
+            {
+                xSemaphoreTake(record_done, portMAX_DELAY);
+            }
+            esp_camera_fb_return(pic);
+            pipeline_stats.displayed++;
+            continue;
+        }
+        if (pic->width != pipeline_config.panel_width || pic->height != pipeline_config.panel_height)
+        {
+            esp_err_t ret = camera_pipeline_draw_scaled(pic);
+            esp_camera_fb_return(pic);
+            if (ret == ESP_OK)
+            {
+                pipeline_stats.displayed++;
+            }
+            else
+            {
+                pipeline_stats.dropped++;
+            }
+            continue;
+        }
+        if (pipeline_config.delta_update)
+        {
+            /*!< changed tiles are copied out, the frame can go straight back */
+            frame_diff_draw((const uint16_t *)pic->buf);
+            esp_camera_fb_return(pic);
+            pipeline_stats.displayed++;
+            continue;
+        }
+
+        lcd_region_t region = {
+            .x1 = 0,
+            .y1 = 0,
+            .x2 = pic->width,
+            .y2 = pic->height,
+        };
+        if (lcd_draw_async(region, pic->buf, camera_pipeline_flush_done_cb, NULL) != ESP_OK)
+        {
+            esp_camera_fb_return(pic);
+            continue;
+        }
+
+        /*!< the frame buffer can only go back to the driver once the DMA has read it */
+        xSemaphoreTake(flush_done, portMAX_DELAY);
+        esp_camera_fb_return(pic);
+        pipeline_stats.displayed++;
+    }
+    xSemaphoreGive(task_exit);
+    vTaskDelete(NULL);
+}
+
+esp_err_t camera_pipeline_start(camera_pipeline_config_t config)
+{
+    ESP_RETURN_ON_FALSE(lcd_panel, ESP_ERR_INVALID_STATE, TAG, "LCD not initialized");
+    ESP_RETURN_ON_FALSE(frame_queue == NULL, ESP_ERR_INVALID_STATE, TAG, "Pipeline already started");
+
+    if (config.queue_depth == 0 || config.queue_depth > CAMERA_FB_COUNT - 1)
+    {
+        config.queue_depth = CAMERA_FB_COUNT - 1;
+    }
+    pipeline_config = config;
+    pipeline_stats = (camera_pipeline_stats_t){0};
+    pipeline_stopping = false;
+    jpeg_last_size = 0;
+
+    esp_err_t ret = ESP_OK;
+    bool display_started = false;
+    frame_queue = xQueueCreate(config.queue_depth, sizeof(camera_fb_t *));
+    flush_done = xSemaphoreCreateBinary();
+    task_exit = xSemaphoreCreateCounting(2, 0);
+    record_done = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(frame_queue && flush_done && task_exit && record_done, ESP_ERR_NO_MEM, err, TAG, "Queue create failed");
+
+    ESP_LOGI(TAG, "Start pipeline, queue depth %d, drop policy %d", config.queue_depth, config.drop_policy);
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(camera_pipeline_display_task, "cam_display", CAMERA_PIPELINE_TASK_STACK, NULL, config.task_priority, NULL,
+                                              config.display_core) == pdPASS,
+                      ESP_ERR_NO_MEM, err, TAG, "Display task create failed");
+    display_started = true;
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(camera_pipeline_capture_task, "cam_capture", CAMERA_PIPELINE_TASK_STACK, NULL, config.task_priority, NULL,
+                                              config.capture_core) == pdPASS,
+                      ESP_ERR_NO_MEM, err, TAG, "Capture task create failed");
+
+    return ESP_OK;
+
+err:
+    if (display_started)
+    {
+        /*!< nothing was queued yet, the stop marker is the first thing the display task sees */
+        camera_fb_t *stop = NULL;
+        xQueueSend(frame_queue, &stop, portMAX_DELAY);
+        xSemaphoreTake(task_exit, portMAX_DELAY);
+    }
+    if (frame_queue)
+    {
+        vQueueDelete(frame_queue);
+    }
+    if (flush_done)
+    {
+        vSemaphoreDelete(flush_done);
+    }
+    if (task_exit)
+    {
+        vSemaphoreDelete(task_exit);
+    }
+    if (record_done)
+    {
+        vSemaphoreDelete(record_done);
+    }
+    frame_queue = NULL;
+    flush_done = NULL;
+    task_exit = NULL;
+    record_done = NULL;
+    return ret;
+}
+
+esp_err_t camera_pipeline_stop(void)
+{
+    camera_fb_t *stop = NULL;
+    ESP_RETURN_ON_FALSE(frame_queue, ESP_ERR_INVALID_STATE, TAG, "Pipeline not started");
+
+    /*!< the capture task finishes the frame it is waiting for, then the display task drains the queue */
+    pipeline_stopping = true;
+    xSemaphoreTake(task_exit, portMAX_DELAY);
+    xQueueSend(frame_queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(task_exit, portMAX_DELAY);
+
+    pixel_ops_scale_deinit(&frame_scale);
+    frame_scale_size = 0;
+    vQueueDelete(frame_queue);
+    vSemaphoreDelete(flush_done);
+    vSemaphoreDelete(task_exit);
+    vSemaphoreDelete(record_done);
+    frame_queue = NULL;
+    flush_done = NULL;
+    task_exit = NULL;
+    record_done = NULL;
+    ESP_LOGI(TAG, "Stopped, %lu captured, %lu displayed, %lu dropped", (unsigned long)pipeline_stats.captured, (unsigned long)pipeline_stats.displayed,
+             (unsigned long)pipeline_stats.dropped);
+
+    return ESP_OK;
+}
+
+void camera_pipeline_get_stats(camera_pipeline_stats_t *stats)
+{
+    *stats = pipeline_stats;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "esp_err.h"
+#include "camera.h"
+#include "st7789.h"
+#include "frame_diff.h"
+#include "esp_jpg_decode.h"
+#include "pixel_ops.h"
+
+typedef enum
+{
+    CAMERA_PIPELINE_DROP_OLDEST, /*!< queue full: return the oldest queued frame and keep the new one */
+    CAMERA_PIPELINE_DROP_NEWEST, /*!< queue full: return the frame that was just captured */
+    CAMERA_PIPELINE_BLOCK,       /*!< queue full: capture waits for the display task */
+} camera_pipeline_drop_policy_t;
+
+/**
+ * @brief takes a JPEG frame without copying it and calls release once it no longer reads it, avi_recorder_add_frame fits
+ */
+typedef esp_err_t (*camera_pipeline_record_cb_t)(const uint8_t *jpeg, size_t len, void (*release)(void *user_ctx), void *user_ctx);
+
+typedef struct
+{
+    uint16_t panel_width;
+    uint16_t panel_height;
+    uint8_t queue_depth; /*!< frames waiting for display, at most CAMERA_FB_COUNT - 1, frames are only dropped below that */
+    camera_pipeline_drop_policy_t drop_policy;
+    uint8_t task_priority;
+    int capture_core;
+    int display_core;
+    bool delta_update;                 /*!< send only changed tiles of RGB565 frames, frame_diff_init must be called first */
+    jpg_scale_t jpeg_scale;            /*!< downscale applied while decoding JPEG frames */
+    pixel_ops_scale_mode_t scale_mode; /*!< used for RGB565 frames that do not match the panel */
+    bool crop_to_fill;                 /*!< crop the frame to the panel aspect ratio instead of stretching it */
+    camera_pipeline_record_cb_t record; /*!< gets every displayed JPEG frame, the frame goes back to the driver once it is released, NULL to not record */
+} camera_pipeline_config_t;
+
+typedef struct
+{
+    uint32_t captured;
+    uint32_t displayed;
+    uint32_t dropped;
+} camera_pipeline_stats_t;
+
+/**
+ * @brief start the capture task and the display task, the frame counters start at zero
+ *
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t camera_pipeline_start(camera_pipeline_config_t config);
+
+/**
+ * @brief stop both tasks, frames still queued are displayed and every frame is returned to the driver
+ *
+ * @return esp_err_t
+ */
+esp_err_t camera_pipeline_stop(void);
+
+/**
+ * @brief get frame counters
+ *
+ * @param stats
+ */
+void camera_pipeline_get_stats(camera_pipeline_stats_t *stats);
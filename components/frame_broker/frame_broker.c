@@ -0,0 +1,248 @@
+#include "frame_broker.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "stdatomic.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#define FRAME_BROKER_SLOT_NUM CAMERA_FB_COUNT /*!< the driver never hands out more buffers than it owns */
+
+typedef struct
+{
+    frame_broker_frame_t frame; /*!< first member, consumers only see this part */
+    atomic_int refs;            /*!< -1 while the slot is claimed by capture or being released */
+} frame_broker_slot_t;
+
+typedef struct
+{
+    frame_broker_consumer_config_t config;
+    QueueHandle_t queue;
+    frame_broker_consumer_stats_t stats;
+} frame_broker_consumer_ctx_t;
+
+static const char *TAG = "FRAME_BROKER";
+
+static frame_broker_config_t broker_cfg;
+static frame_broker_stats_t broker_stats;
+static frame_broker_slot_t slots[FRAME_BROKER_SLOT_NUM];
+static frame_broker_consumer_ctx_t consumers[FRAME_BROKER_MAX_CONSUMERS];
+static atomic_int consumer_count = 0;
+static SemaphoreHandle_t subscribe_lock = NULL;
+static SemaphoreHandle_t slot_free = NULL; /*!< counts slots that are not holding a frame */
+static volatile uint32_t latest_seq = 0;
+static atomic_uint returned_count = 0; /*!< released from any consumer task */
+static TaskHandle_t capture_task = NULL;
+
+static frame_broker_slot_t *frame_broker_slot_get(void)
+{
+    xSemaphoreTake(slot_free, portMAX_DELAY);
+    for (int i = 0; i < FRAME_BROKER_SLOT_NUM; i++)
+    {
+        int expected = 0;
+        /*!< -1 marks a slot as claimed by the capture task until the frame is set */
+        if (atomic_compare_exchange_strong(&slots[i].refs, &expected, -1))
+        {
+            return &slots[i];
+        }
+    }
+    /*!< unreachable, slot_free counts free slots */
+    xSemaphoreGive(slot_free);
+    return NULL;
+}
+
+void frame_broker_retain(frame_broker_frame_t *frame)
+{
+    frame_broker_slot_t *slot = (frame_broker_slot_t *)frame;
+    atomic_fetch_add(&slot->refs, 1);
+}
+
+void frame_broker_release(frame_broker_frame_t *frame)
+{
+    frame_broker_slot_t *slot = (frame_broker_slot_t *)frame;
+    int refs = atomic_load(&slot->refs);
+    int next = 0;
+
+    /*!< the last reference moves the slot to -1, not 0, so the capture task can not claim it before fb is returned */
+    do
+    {
+        next = (refs == 1) ? -1 : refs - 1;
+    } while (!atomic_compare_exchange_weak(&slot->refs, &refs, next));
+    if (next != -1)
+    {
+        return;
+    }
+    camera_fb_t *fb = slot->frame.fb;
+    slot->frame.fb = NULL;
+    esp_camera_fb_return(fb);
+    atomic_fetch_add(&returned_count, 1);
+    atomic_store(&slot->refs, 0);
+    xSemaphoreGive(slot_free);
+}
+
+/**
+ * @brief hand one frame to a consumer, applying its drop policy
+ */
+static void frame_broker_deliver(frame_broker_consumer_ctx_t *consumer, frame_broker_slot_t *slot)
+{
+    frame_broker_frame_t *frame = &slot->frame;
+
+    /*!< the reference is taken before the frame becomes visible to the consumer */
+    frame_broker_retain(frame);
+    switch (consumer->config.drop_policy)
+    {
+    case FRAME_BROKER_BLOCK:
+        xQueueSend(consumer->queue, &frame, portMAX_DELAY);
+        return;
+    case FRAME_BROKER_DROP_NEWEST:
+        if (xQueueSend(consumer->queue, &frame, 0) != pdTRUE)
+        {
+            frame_broker_release(frame);
+            consumer->stats.dropped++;
+        }
+        return;
+    case FRAME_BROKER_DROP_OLDEST:
+    default:
+        while (xQueueSend(consumer->queue, &frame, 0) != pdTRUE)
+        {
+            frame_broker_frame_t *old = NULL;
+            /*!< the consumer may have taken it in the meantime, then the send just retries */
+            if (xQueueReceive(consumer->queue, &old, 0) == pdTRUE)
+            {
+                frame_broker_release(old);
+                consumer->stats.dropped++;
+            }
+        }
+        return;
+    }
+}
+
+static void frame_broker_capture_task(void *arg)
+{
+    while (1)
+    {
+        frame_broker_slot_t *slot = frame_broker_slot_get();
+        if (slot == NULL)
+        {
+            continue;
+        }
+        camera_fb_t *pic = esp_camera_fb_get();
+        if (!pic)
+        {
+            atomic_store(&slot->refs, 0);
+            xSemaphoreGive(slot_free);
+            continue;
+        }
+        slot->frame.fb = pic;
+        slot->frame.seq = ++latest_seq;
+        broker_stats.captured++;
+
+        /*!< the capture task holds a reference while delivering, so an early release can not return the buffer */
+        atomic_store(&slot->refs, 1);
+        int count = atomic_load(&consumer_count);
+        for (int i = 0; i < count; i++)
+        {
+            frame_broker_deliver(&consumers[i], slot);
+        }
+        if (atomic_load(&slot->refs) == 1)
+        {
+            broker_stats.unconsumed++;
+        }
+        frame_broker_release(&slot->frame);
+    }
+}
+
+esp_err_t frame_broker_start(frame_broker_config_t config)
+{
+    ESP_RETURN_ON_FALSE(capture_task == NULL, ESP_ERR_INVALID_STATE, TAG, "Already started");
+    broker_cfg = config;
+
+    if (subscribe_lock == NULL)
+    {
+        subscribe_lock = xSemaphoreCreateMutex();
+        ESP_RETURN_ON_FALSE(subscribe_lock, ESP_ERR_NO_MEM, TAG, "Mutex create failed");
+    }
+    slot_free = xSemaphoreCreateCounting(FRAME_BROKER_SLOT_NUM, FRAME_BROKER_SLOT_NUM);
+    ESP_RETURN_ON_FALSE(slot_free, ESP_ERR_NO_MEM, TAG, "Semaphore create failed");
+    for (int i = 0; i < FRAME_BROKER_SLOT_NUM; i++)
+    {
+        slots[i].frame.fb = NULL;
+        atomic_store(&slots[i].refs, 0);
+    }
+    atomic_store(&returned_count, 0);
+
+    ESP_LOGI(TAG, "Start broker, %d consumers", atomic_load(&consumer_count));
+    ESP_RETURN_ON_FALSE(xTaskCreatePinnedToCore(frame_broker_capture_task, "frame_broker", 4096, NULL, config.task_priority, &capture_task, config.task_core) == pdPASS,
+                        ESP_ERR_NO_MEM, TAG, "Capture task create failed");
+
+    return ESP_OK;
+}
+
+esp_err_t frame_broker_subscribe(frame_broker_consumer_config_t config, frame_broker_consumer_t *consumer)
+{
+    ESP_RETURN_ON_FALSE(consumer, ESP_ERR_INVALID_ARG, TAG, "Consumer is NULL");
+    if (subscribe_lock == NULL)
+    {
+        subscribe_lock = xSemaphoreCreateMutex();
+        ESP_RETURN_ON_FALSE(subscribe_lock, ESP_ERR_NO_MEM, TAG, "Mutex create failed");
+    }
+    if (config.queue_depth == 0 || config.queue_depth > CAMERA_FB_COUNT - 1)
+    {
+        config.queue_depth = CAMERA_FB_COUNT - 1;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(subscribe_lock, portMAX_DELAY);
+    int index = atomic_load(&consumer_count);
+    ESP_GOTO_ON_FALSE(index < FRAME_BROKER_MAX_CONSUMERS, ESP_ERR_NO_MEM, err, TAG, "Too many consumers");
+    consumers[index].config = config;
+    consumers[index].queue = xQueueCreate(config.queue_depth, sizeof(frame_broker_frame_t *));
+    ESP_GOTO_ON_FALSE(consumers[index].queue, ESP_ERR_NO_MEM, err, TAG, "Queue create failed");
+
+    /*!< published last, the capture task only walks fully set up consumers */
+    atomic_store(&consumer_count, index + 1);
+    *consumer = index;
+    ESP_LOGI(TAG, "Consumer %s, queue depth %d, drop policy %d", config.name ? config.name : "-", config.queue_depth, config.drop_policy);
+
+err:
+    xSemaphoreGive(subscribe_lock);
+    return ret;
+}
+
+frame_broker_frame_t *frame_broker_take(frame_broker_consumer_t consumer, TickType_t ticks_to_wait)
+{
+    frame_broker_frame_t *frame = NULL;
+
+    if (consumer < 0 || consumer >= atomic_load(&consumer_count))
+    {
+        return NULL;
+    }
+    frame_broker_consumer_ctx_t *ctx = &consumers[consumer];
+    if (xQueueReceive(ctx->queue, &frame, ticks_to_wait) != pdTRUE)
+    {
+        return NULL;
+    }
+
+    ctx->stats.received++;
+    ctx->stats.lag = latest_seq - frame->seq;
+    if (ctx->stats.lag > ctx->stats.max_lag)
+    {
+        ctx->stats.max_lag = ctx->stats.lag;
+    }
+
+    return frame;
+}
+
+esp_err_t frame_broker_get_consumer_stats(frame_broker_consumer_t consumer, frame_broker_consumer_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(consumer >= 0 && consumer < atomic_load(&consumer_count), ESP_ERR_INVALID_ARG, TAG, "Unknown consumer");
+    *stats = consumers[consumer].stats;
+
+    return ESP_OK;
+}
+
+void frame_broker_get_stats(frame_broker_stats_t *stats)
+{
+    *stats = broker_stats;
+    stats->returned = atomic_load(&returned_count);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "esp_err.h"
+#include "camera.h"
+#include "freertos/FreeRTOS.h"
+
+#define FRAME_BROKER_MAX_CONSUMERS 4
+
+typedef enum
+{
+    FRAME_BROKER_DROP_OLDEST, /*!< consumer queue full: release its oldest frame and queue the new one */
+    FRAME_BROKER_DROP_NEWEST, /*!< consumer queue full: the consumer skips the new frame */
+    FRAME_BROKER_BLOCK,       /*!< consumer queue full: capture waits, every other consumer waits with it */
+} frame_broker_drop_policy_t;
+
+typedef struct
+{
+    uint8_t task_priority;
+    int task_core;
+} frame_broker_config_t;
+
+typedef struct
+{
+    const char *name;
+    uint8_t queue_depth; /*!< frames held for the consumer, at most CAMERA_FB_COUNT - 1 */
+    frame_broker_drop_policy_t drop_policy;
+} frame_broker_consumer_config_t;
+
+typedef int frame_broker_consumer_t;
+
+/**
+ * @brief a camera frame shared by every consumer that received it, returned to the driver on the last release
+ */
+typedef struct
+{
+    camera_fb_t *fb;
+    uint32_t seq; /*!< capture sequence number */
+} frame_broker_frame_t;
+
+typedef struct
+{
+    uint32_t received;
+    uint32_t dropped;
+    uint32_t lag;     /*!< frames captured after the last frame this consumer took */
+    uint32_t max_lag;
+} frame_broker_consumer_stats_t;
+
+typedef struct
+{
+    uint32_t captured;
+    uint32_t returned;
+    uint32_t unconsumed; /*!< frames no consumer accepted */
+} frame_broker_stats_t;
+
+/**
+ * @brief start the capture task, the camera must be initialized
+ *
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t frame_broker_start(frame_broker_config_t config);
+
+/**
+ * @brief add a consumer, it receives every frame captured from now on
+ *
+ * @param config
+ * @param consumer
+ * @return esp_err_t
+ */
+esp_err_t frame_broker_subscribe(frame_broker_consumer_config_t config, frame_broker_consumer_t *consumer);
+
+/**
+ * @brief wait for the next frame of a consumer, the caller owns one reference
+ *
+ * @param consumer
+ * @param ticks_to_wait
+ * @return frame_broker_frame_t* NULL on timeout
+ */
+frame_broker_frame_t *frame_broker_take(frame_broker_consumer_t consumer, TickType_t ticks_to_wait);
+
+/**
+ * @brief take one more reference, e.g. to hand the frame to another task
+ *
+ * @param frame
+ */
+void frame_broker_retain(frame_broker_frame_t *frame);
+
+/**
+ * @brief drop one reference, the last one returns the buffer to the camera driver
+ *
+ * @param frame
+ */
+void frame_broker_release(frame_broker_frame_t *frame);
+
+/**
+ * @brief get counters of one consumer
+ *
+ * @param consumer
+ * @param stats
+ * @return esp_err_t
+ */
+esp_err_t frame_broker_get_consumer_stats(frame_broker_consumer_t consumer, frame_broker_consumer_stats_t *stats);
+
+/**
+ * @brief get capture counters
+ *
+ * @param stats
+ */
+void frame_broker_get_stats(frame_broker_stats_t *stats);
@@ -0,0 +1,194 @@
+#include "frame_diff.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "string.h"
+#include "stdlib.h"
+#include "freertos/queue.h"
+
+#define FRAME_DIFF_SPAN_BUFFER_NUM 2
+
+static const char *TAG = "FRAME_DIFF";
+
+static frame_diff_config_t diff_cfg;
+static frame_diff_stats_t diff_stats;
+static uint16_t *reference = NULL; /*!< what the panel currently shows */
+static bool reference_valid = false;
+static uint8_t *tile_dirty = NULL;
+static uint32_t compare_mask = 0;
+static QueueHandle_t span_free = NULL;
+static uint16_t *span_buffer[FRAME_DIFF_SPAN_BUFFER_NUM];
+
+static void frame_diff_span_done_cb(void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    xQueueSendFromISR(span_free, &user_ctx, &need_yield);
+    portYIELD_FROM_ISR(need_yield);
+}
+
+/**
+ * @brief count pixels of a tile that differ beyond ignore_bits, two pixels per 32 bit word
+ *
+ * The reference lives in PSRAM, the loop waits on its reads rather than on the XOR.
+ */
+static uint32_t frame_diff_tile_changes(const uint16_t *frame, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    uint32_t changes = 0;
+
+    for (uint16_t row = 0; row < h; row++)
+    {
+        const uint32_t *a = (const uint32_t *)(frame + (y + row) * diff_cfg.width + x);
+        const uint32_t *b = (const uint32_t *)(reference + (y + row) * diff_cfg.width + x);
+        for (uint16_t i = 0; i < w / 2; i++)
+        {
+            uint32_t d = (a[i] ^ b[i]) & compare_mask;
+            if (d)
+            {
+                changes += ((d & 0xFFFF) != 0) + ((d >> 16) != 0);
+            }
+        }
+        if (changes > diff_cfg.tile_threshold)
+        {
+            break;
+        }
+    }
+
+    return changes;
+}
+
+static esp_err_t frame_diff_send_span(const uint16_t *frame, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+    uint16_t *span = NULL;
+    uint16_t w = x2 - x1;
+    esp_err_t ret = ESP_OK;
+
+    /*!< the span is copied, so the camera buffer can be returned before the DMA is done */
+    xQueueReceive(span_free, &span, portMAX_DELAY);
+    for (uint16_t row = 0; row < y2 - y1; row++)
+    {
+        const uint16_t *src = frame + (y1 + row) * diff_cfg.width + x1;
+        memcpy(span + row * w, src, w * sizeof(uint16_t));
+        memcpy(reference + (y1 + row) * diff_cfg.width + x1, src, w * sizeof(uint16_t));
+    }
+
+    lcd_region_t region = {
+        .x1 = x1,
+        .y1 = y1,
+        .x2 = x2,
+        .y2 = y2,
+    };
+    ret = lcd_draw_async(region, span, frame_diff_span_done_cb, span);
+    if (ret != ESP_OK)
+    {
+        xQueueSend(span_free, &span, 0);
+        return ret;
+    }
+    diff_stats.bytes_sent += w * (y2 - y1) * sizeof(uint16_t);
+
+    return ESP_OK;
+}
+
+esp_err_t frame_diff_init(frame_diff_config_t config)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(reference == NULL, ESP_ERR_INVALID_STATE, TAG, "Already initialized");
+    ESP_RETURN_ON_FALSE(config.width % 2 == 0 && config.tile_size % 2 == 0 && config.tile_size > 0, ESP_ERR_INVALID_ARG, TAG, "Width and tile size must be even");
+    ESP_RETURN_ON_FALSE(config.ignore_bits <= 3, ESP_ERR_INVALID_ARG, TAG, "Too many ignored bits");
+    diff_cfg = config;
+
+    reference = heap_caps_malloc(config.width * config.height * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    tile_dirty = heap_caps_malloc((config.width + config.tile_size - 1) / config.tile_size, MALLOC_CAP_INTERNAL);
+    span_free = xQueueCreate(FRAME_DIFF_SPAN_BUFFER_NUM, sizeof(uint16_t *));
+    ESP_GOTO_ON_FALSE(reference && tile_dirty && span_free, ESP_ERR_NO_MEM, err, TAG, "Alloc failed");
+    for (int i = 0; i < FRAME_DIFF_SPAN_BUFFER_NUM; i++)
+    {
+        span_buffer[i] = heap_caps_malloc(config.width * config.tile_size * sizeof(uint16_t), MALLOC_CAP_DMA);
+        ESP_GOTO_ON_FALSE(span_buffer[i], ESP_ERR_NO_MEM, err, TAG, "Span buffer alloc failed");
+        xQueueSend(span_free, &span_buffer[i], 0);
+    }
+
+    /*!< frames are byte swapped, so is the mask */
+    uint16_t low = (1 << config.ignore_bits) - 1;
+    uint16_t mask = swap_hex((uint16_t) ~((low << 11) | (low << 5) | low));
+    compare_mask = ((uint32_t)mask << 16) | mask;
+    reference_valid = false;
+
+    ESP_LOGI(TAG, "Tile %dx%d, ignore %d bits, threshold %d pixels", config.tile_size, config.tile_size, config.ignore_bits, config.tile_threshold);
+    return ESP_OK;
+
+err:
+    /*!< nothing was drawn yet, so no span buffer is out with the DMA */
+    for (int i = 0; i < FRAME_DIFF_SPAN_BUFFER_NUM; i++)
+    {
+        free(span_buffer[i]);
+        span_buffer[i] = NULL;
+    }
+    if (span_free)
+    {
+        vQueueDelete(span_free);
+        span_free = NULL;
+    }
+    free(tile_dirty);
+    tile_dirty = NULL;
+    free(reference);
+    reference = NULL;
+    return ret;
+}
+
+esp_err_t frame_diff_draw(const uint16_t *frame)
+{
+    ESP_RETURN_ON_FALSE(reference, ESP_ERR_INVALID_STATE, TAG, "Not initialized");
+    uint16_t tile = diff_cfg.tile_size;
+    uint16_t cols = (diff_cfg.width + tile - 1) / tile;
+
+    for (uint16_t y = 0; y < diff_cfg.height; y += tile)
+    {
+        uint16_t h = (y + tile < diff_cfg.height) ? tile : diff_cfg.height - y;
+        for (uint16_t col = 0; col < cols; col++)
+        {
+            uint16_t x = col * tile;
+            uint16_t w = (x + tile < diff_cfg.width) ? tile : diff_cfg.width - x;
+            tile_dirty[col] = !reference_valid || frame_diff_tile_changes(frame, x, y, w, h) > diff_cfg.tile_threshold;
+        }
+        diff_stats.tiles_total += cols;
+
+        /*!< neighbouring dirty tiles of a tile row go out as one window */
+        for (uint16_t col = 0; col < cols;)
+        {
+            if (!tile_dirty[col])
+            {
+                col++;
+                continue;
+            }
+            uint16_t end = col;
+            while (end < cols && tile_dirty[end])
+            {
+                end++;
+            }
+            uint16_t x2 = (end * tile < diff_cfg.width) ? end * tile : diff_cfg.width;
+            esp_err_t ret = frame_diff_send_span(frame, col * tile, y, x2, y + h);
+            if (ret != ESP_OK)
+            {
+                /*!< the reference no longer matches the panel */
+                reference_valid = false;
+                ESP_LOGE(TAG, "Send span failed");
+                return ret;
+            }
+            diff_stats.tiles_sent += end - col;
+            col = end;
+        }
+    }
+    reference_valid = true;
+    diff_stats.frames++;
+
+    return ESP_OK;
+}
+
+void frame_diff_invalidate(void)
+{
+    reference_valid = false;
+}
+
+void frame_diff_get_stats(frame_diff_stats_t *stats)
+{
+    *stats = diff_stats;
+}
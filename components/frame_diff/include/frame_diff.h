@@ -0,0 +1,51 @@
+#pragma once
+
+#include "esp_err.h"
+#include "st7789.h"
+
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint8_t tile_size;       /*!< tile edge in pixels, must be even */
+    uint8_t ignore_bits;     /*!< low bits of each colour channel ignored when comparing, 0-3 */
+    uint16_t tile_threshold; /*!< changed pixels a tile may have and still be skipped */
+} frame_diff_config_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t tiles_total;
+    uint32_t tiles_sent;
+    uint32_t bytes_sent;
+} frame_diff_stats_t;
+
+/**
+ * @brief allocate the reference frame and the tile transfer buffers
+ *
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t frame_diff_init(frame_diff_config_t config);
+
+/**
+ * @brief send only the tiles of frame that changed since the last frame sent
+ *
+ * frame is no longer referenced when this returns.
+ *
+ * @param frame rgb565, byte swapped as sent to the panel
+ * @return esp_err_t
+ */
+esp_err_t frame_diff_draw(const uint16_t *frame);
+
+/**
+ * @brief force the next frame to be sent completely
+ */
+void frame_diff_invalidate(void);
+
+/**
+ * @brief get tile counters
+ *
+ * @param stats
+ */
+void frame_diff_get_stats(frame_diff_stats_t *stats);
@@ -0,0 +1,83 @@
+#include "img_rle.h"
+#include "string.h"
+
+static uint16_t img_rle_run(const uint8_t *src, uint16_t left, uint8_t pixel_size)
+{
+    uint16_t run = 1;
+    while (run < left && run < IMG_RLE_MAX_RUN && memcmp(src, src + run * pixel_size, pixel_size) == 0)
+    {
+        run++;
+    }
+    return run;
+}
+
+size_t img_rle_encode_line(const uint8_t *src, uint8_t *dst, uint16_t width, uint8_t pixel_size)
+{
+    uint8_t *out = dst;
+    uint16_t x = 0;
+
+    while (x < width)
+    {
+        uint16_t run = img_rle_run(src + x * pixel_size, width - x, pixel_size);
+        if (run >= 2)
+        {
+            *out++ = 0x80 | (run - 1);
+            memcpy(out, src + x * pixel_size, pixel_size);
+            out += pixel_size;
+            x += run;
+            continue;
+        }
+
+        /*!< collect literals up to the next repeated pixel */
+        uint16_t count = 1;
+        while (x + count < width && count < IMG_RLE_MAX_RUN && img_rle_run(src + (x + count) * pixel_size, width - x - count, pixel_size) < 2)
+        {
+            count++;
+        }
+        *out++ = count - 1;
+        memcpy(out, src + x * pixel_size, count * pixel_size);
+        out += count * pixel_size;
+        x += count;
+    }
+
+    return out - dst;
+}
+
+size_t img_rle_decode_line(const uint8_t *src, size_t src_size, uint8_t *dst, uint16_t width, uint8_t pixel_size)
+{
+    const uint8_t *in = src;
+    const uint8_t *end = src + src_size;
+    uint16_t x = 0;
+
+    while (x < width)
+    {
+        if (in == end)
+        {
+            return 0;
+        }
+        uint8_t c = *in++;
+        uint16_t count = (c & 0x7F) + 1;
+        /*!< a run carries one pixel, a literal count pixels */
+        size_t coded = (c & 0x80) ? pixel_size : count * pixel_size;
+        if (x + count > width || coded > (size_t)(end - in))
+        {
+            return 0;
+        }
+        if (c & 0x80)
+        {
+            for (uint16_t i = 0; i < count; i++)
+            {
+                memcpy(dst + (x + i) * pixel_size, in, pixel_size);
+            }
+            in += pixel_size;
+        }
+        else
+        {
+            memcpy(dst + x * pixel_size, in, count * pixel_size);
+            in += count * pixel_size;
+        }
+        x += count;
+    }
+
+    return in - src;
+}
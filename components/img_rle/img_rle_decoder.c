@@ -0,0 +1,165 @@
+#include "img_rle.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "string.h"
+#include "lvgl.h"
+
+typedef struct
+{
+    const img_rle_header_t *rle;
+    uint32_t data_size;             /*!< of the whole image, every line offset is below it */
+    int32_t y[IMG_RLE_CACHE_LINES]; /*!< line held by each cache slot, -1 when empty */
+    uint8_t next;                   /*!< slot replaced on the next miss */
+    uint8_t px_size;                /*!< bytes per pixel handed to LVGL */
+    uint8_t *lines;                 /*!< IMG_RLE_CACHE_LINES lines in LV_IMG_CF_TRUE_COLOR or LV_IMG_CF_TRUE_COLOR_ALPHA */
+} img_rle_cache_t;
+
+static const char *TAG = "IMG_RLE";
+
+static bool img_rle_has_alpha(const img_rle_header_t *rle)
+{
+    return rle->pixel_size > LV_COLOR_SIZE / 8;
+}
+
+static lv_res_t img_rle_info_cb(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header)
+{
+    if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE)
+    {
+        return LV_RES_INV;
+    }
+    const lv_img_dsc_t *img = (const lv_img_dsc_t *)src;
+    if (img->header.cf != IMG_RLE_CF)
+    {
+        return LV_RES_INV;
+    }
+    /*!< like lv_png, a RAW format tells LVGL to draw the lines read_line_cb returns as
+     * LV_IMG_CF_TRUE_COLOR, or as LV_IMG_CF_TRUE_COLOR_ALPHA for the alpha variant */
+    const img_rle_header_t *rle = (const img_rle_header_t *)img->data;
+    if (img->data_size < sizeof(img_rle_header_t))
+    {
+        return LV_RES_INV;
+    }
+    header->w = img->header.w;
+    header->h = img->header.h;
+    header->cf = img_rle_has_alpha(rle) ? LV_IMG_CF_RAW_ALPHA : LV_IMG_CF_RAW;
+
+    return LV_RES_OK;
+}
+
+static lv_res_t img_rle_open_cb(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+    const lv_img_dsc_t *img = (const lv_img_dsc_t *)dsc->src;
+    const img_rle_header_t *rle = (const img_rle_header_t *)img->data;
+    if (rle->magic != IMG_RLE_MAGIC || rle->width != img->header.w || rle->height != img->header.h ||
+        (rle->pixel_size != LV_COLOR_SIZE / 8 && rle->pixel_size != LV_IMG_PX_SIZE_ALPHA_BYTE) ||
+        img->data_size < sizeof(img_rle_header_t) + rle->height * sizeof(uint32_t))
+    {
+        ESP_LOGE(TAG, "Bad image header");
+        return LV_RES_INV;
+    }
+    /*!< the image may come from a separately flashed pack, every line must start after the table and inside the data */
+    uint32_t table_end = sizeof(img_rle_header_t) + rle->height * sizeof(uint32_t);
+    for (uint16_t y = 0; y < rle->height; y++)
+    {
+        if (rle->line_offset[y] < table_end || rle->line_offset[y] >= img->data_size)
+        {
+            ESP_LOGE(TAG, "Line %u is outside the image", y);
+            return LV_RES_INV;
+        }
+    }
+
+    img_rle_cache_t *cache = lv_mem_alloc(sizeof(img_rle_cache_t));
+    if (cache == NULL)
+    {
+        return LV_RES_INV;
+    }
+    cache->rle = rle;
+    cache->data_size = img->data_size;
+    cache->next = 0;
+    cache->px_size = img_rle_has_alpha(rle) ? LV_IMG_PX_SIZE_ALPHA_BYTE : LV_COLOR_SIZE / 8;
+    cache->lines = lv_mem_alloc(rle->width * cache->px_size * IMG_RLE_CACHE_LINES);
+    if (cache->lines == NULL)
+    {
+        lv_mem_free(cache);
+        return LV_RES_INV;
+    }
+    for (int i = 0; i < IMG_RLE_CACHE_LINES; i++)
+    {
+        cache->y[i] = -1;
+    }
+
+    /*!< no img_data, LVGL asks for the image line by line */
+    dsc->img_data = NULL;
+    dsc->user_data = cache;
+    return LV_RES_OK;
+}
+
+static const uint8_t *img_rle_line_get(img_rle_cache_t *cache, lv_coord_t y)
+{
+    const img_rle_header_t *rle = cache->rle;
+    uint32_t line_bytes = rle->width * cache->px_size;
+
+    for (int i = 0; i < IMG_RLE_CACHE_LINES; i++)
+    {
+        if (cache->y[i] == y)
+        {
+            return cache->lines + i * line_bytes;
+        }
+    }
+
+    uint8_t slot = cache->next;
+    cache->next = (cache->next + 1) % IMG_RLE_CACHE_LINES;
+    const uint8_t *src = (const uint8_t *)rle + rle->line_offset[y];
+    uint8_t *line = cache->lines + slot * line_bytes;
+
+    /*!< coded pixels are already colour, followed by an alpha byte if the image has one */
+    cache->y[slot] = -1;
+    if (img_rle_decode_line(src, cache->data_size - rle->line_offset[y], line, rle->width, rle->pixel_size) == 0)
+    {
+        return NULL;
+    }
+    cache->y[slot] = y;
+
+    return line;
+}
+
+static lv_res_t img_rle_read_line_cb(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc, lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t *buf)
+{
+    img_rle_cache_t *cache = (img_rle_cache_t *)dsc->user_data;
+    if (y < 0 || y >= cache->rle->height || x < 0 || x + len > cache->rle->width)
+    {
+        return LV_RES_INV;
+    }
+    const uint8_t *line = img_rle_line_get(cache, y);
+    if (line == NULL)
+    {
+        return LV_RES_INV;
+    }
+    memcpy(buf, line + x * cache->px_size, len * cache->px_size);
+
+    return LV_RES_OK;
+}
+
+static void img_rle_close_cb(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+    img_rle_cache_t *cache = (img_rle_cache_t *)dsc->user_data;
+    if (cache)
+    {
+        lv_mem_free(cache->lines);
+        lv_mem_free(cache);
+        dsc->user_data = NULL;
+    }
+}
+
+esp_err_t img_rle_decoder_init(void)
+{
+    lv_img_decoder_t *decoder = lv_img_decoder_create();
+    ESP_RETURN_ON_FALSE(decoder, ESP_ERR_NO_MEM, TAG, "Decoder create failed");
+
+    lv_img_decoder_set_info_cb(decoder, img_rle_info_cb);
+    lv_img_decoder_set_open_cb(decoder, img_rle_open_cb);
+    lv_img_decoder_set_read_line_cb(decoder, img_rle_read_line_cb);
+    lv_img_decoder_set_close_cb(decoder, img_rle_close_cb);
+
+    return ESP_OK;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "stddef.h"
+
+#define IMG_RLE_MAGIC 0x31454C52 /*!< "RLE1" */
+#define IMG_RLE_CF LV_IMG_CF_USER_ENCODED_0
+#define IMG_RLE_CACHE_LINES 4 /*!< decoded lines kept per open image */
+#define IMG_RLE_MAX_RUN 128
+
+/**
+ * @brief data of an RLE image, followed by the line offset table and the coded lines
+ *
+ * Every line is coded on its own so any line can be decoded without the ones before it.
+ * A control byte c is followed by one pixel repeated (c & 0x7F) + 1 times when bit 7 is set,
+ * otherwise by c + 1 literal pixels. Pixels keep the byte order of the source image.
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+    uint8_t pixel_size; /*!< 2 for true color, 3 for true color with alpha */
+    uint8_t reserved[3];
+    uint32_t line_offset[]; /*!< from the start of the header */
+} img_rle_header_t;
+
+/**
+ * @brief code one line
+ *
+ * @param src width * pixel_size bytes
+ * @param dst room for width * (pixel_size + 1) bytes in the worst case
+ * @param width
+ * @param pixel_size
+ * @return size_t coded bytes
+ */
+size_t img_rle_encode_line(const uint8_t *src, uint8_t *dst, uint16_t width, uint8_t pixel_size);
+
+/**
+ * @brief decode one line
+ *
+ * @param src
+ * @param src_size bytes readable from src, a line that needs more is corrupt
+ * @param dst width * pixel_size bytes
+ * @param width
+ * @param pixel_size
+ * @return size_t coded bytes consumed, 0 if the line is corrupt
+ */
+size_t img_rle_decode_line(const uint8_t *src, size_t src_size, uint8_t *dst, uint16_t width, uint8_t pixel_size);
+
+/**
+ * @brief register the LVGL decoder for IMG_RLE_CF images, call after lv_init
+ *
+ * @return esp_err_t
+ */
+esp_err_t img_rle_decoder_init(void);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+
+typedef struct
+{
+    uint16_t width;  /*!< panel memory size, 240x320 for the st7789 */
+    uint16_t height;
+    uint32_t pclk_hz;           /*!< bus clock the transfer time is modelled at */
+    uint32_t trans_overhead_ns; /*!< fixed cost of queueing one SPI transaction */
+    size_t max_transfer_sz;     /*!< pixel data is split into transactions of this size, 0 for no limit */
+} lcd_mock_config_t;
+
+typedef struct
+{
+    uint32_t transactions; /*!< SPI transactions the same calls would queue on hardware */
+    uint32_t commands;
+    uint32_t param_bytes;
+    uint32_t color_bytes;
+    uint32_t pixels_written; /*!< pixels that landed inside the panel memory */
+    uint64_t bus_time_ns;    /*!< modelled wire time, command byte, parameters and pixels */
+} lcd_mock_stats_t;
+
+/**
+ * @brief create a panel IO that decodes the MIPI DCS stream into a RAM framebuffer
+ *
+ * Any vendor panel driver can be installed on top of it, e.g. esp_lcd_new_panel_st7789.
+ * on_color_trans_done is called synchronously at the end of every tx_color.
+ *
+ * @param config
+ * @param ret_io
+ * @return esp_err_t
+ */
+esp_err_t lcd_mock_new_panel_io(const lcd_mock_config_t *config, esp_lcd_panel_io_handle_t *ret_io);
+
+/**
+ * @brief framebuffer of the mock, rgb565 in the byte order sent on the wire
+ *
+ * @param io
+ * @return const uint16_t*
+ */
+const uint16_t *lcd_mock_get_framebuffer(esp_lcd_panel_io_handle_t io);
+
+/**
+ * @brief read one pixel of the panel memory as native rgb565
+ *
+ * @param io
+ * @param x
+ * @param y
+ * @return uint16_t
+ */
+uint16_t lcd_mock_get_pixel(esp_lcd_panel_io_handle_t io, uint16_t x, uint16_t y);
+
+/**
+ * @brief get the counters accumulated since the last lcd_mock_frame_end
+ *
+ * @param io
+ * @param stats
+ * @return esp_err_t
+ */
+esp_err_t lcd_mock_get_stats(esp_lcd_panel_io_handle_t io, lcd_mock_stats_t *stats);
+
+/**
+ * @brief close a frame: copy its counters out, add them to the totals and start a new frame
+ *
+ * @param io
+ * @param frame counters of the frame that ended, may be NULL
+ * @param total counters since the IO was created, may be NULL
+ * @return esp_err_t
+ */
+esp_err_t lcd_mock_frame_end(esp_lcd_panel_io_handle_t io, lcd_mock_stats_t *frame, lcd_mock_stats_t *total);
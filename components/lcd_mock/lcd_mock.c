@@ -0,0 +1,261 @@
+#include "lcd_mock.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_io_interface.h"
+#include "esp_lcd_panel_commands.h"
+#include "string.h"
+#include "stdlib.h"
+
+#define LCD_MOCK_MADCTL_MY BIT(7)
+#define LCD_MOCK_MADCTL_MX BIT(6)
+#define LCD_MOCK_MADCTL_MV BIT(5)
+
+typedef struct
+{
+    esp_lcd_panel_io_t base;
+    lcd_mock_config_t config;
+    uint16_t *framebuffer;
+    uint16_t col_start;
+    uint16_t col_end; /*!< inclusive, as sent in CASET */
+    uint16_t row_start;
+    uint16_t row_end;
+    uint16_t col;
+    uint16_t row;
+    uint8_t madctl;
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+    void *user_ctx;
+    lcd_mock_stats_t frame;
+    lcd_mock_stats_t total;
+} lcd_mock_io_t;
+
+static const char *TAG = "LCD_MOCK";
+
+static void lcd_mock_account(lcd_mock_io_t *mock, size_t param_bytes, size_t color_bytes)
+{
+    /*!< like the SPI IO: the command, the parameters and every max_transfer_sz chunk of pixels are separate transactions */
+    uint32_t trans = 1 + (param_bytes ? 1 : 0);
+    if (color_bytes)
+    {
+        size_t chunk = mock->config.max_transfer_sz ? mock->config.max_transfer_sz : color_bytes;
+        trans += (color_bytes + chunk - 1) / chunk;
+    }
+    mock->frame.transactions += trans;
+    mock->frame.commands++;
+    mock->frame.param_bytes += param_bytes;
+    mock->frame.color_bytes += color_bytes;
+
+    /*!< one command byte plus the data phase, clocked one bit per pclk */
+    uint64_t bits = (1 + param_bytes + color_bytes) * 8;
+    mock->frame.bus_time_ns += trans * mock->config.trans_overhead_ns + bits * 1000000000ULL / mock->config.pclk_hz;
+}
+
+static uint16_t lcd_mock_param16(const uint8_t *p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+/**
+ * @brief store one pixel at the current address and advance it the way the panel does
+ *
+ * MV decides which counter drives which axis of the frame memory, MX and MY then mirror the
+ * physical columns and rows, as in the MADCTL scan order table of the ST7789V datasheet.
+ */
+static void lcd_mock_write_pixel(lcd_mock_io_t *mock, uint16_t pixel)
+{
+    bool mv = mock->madctl & LCD_MOCK_MADCTL_MV;
+    uint16_t x = mv ? mock->row : mock->col;
+    uint16_t y = mv ? mock->col : mock->row;
+
+    if (x < mock->config.width && y < mock->config.height)
+    {
+        if (mock->madctl & LCD_MOCK_MADCTL_MX)
+        {
+            x = mock->config.width - 1 - x;
+        }
+        if (mock->madctl & LCD_MOCK_MADCTL_MY)
+        {
+            y = mock->config.height - 1 - y;
+        }
+        mock->framebuffer[y * mock->config.width + x] = pixel;
+        mock->frame.pixels_written++;
+    }
+
+    if (mock->col < mock->col_end)
+    {
+        mock->col++;
+        return;
+    }
+    mock->col = mock->col_start;
+    mock->row = (mock->row < mock->row_end) ? mock->row + 1 : mock->row_start;
+}
+
+static esp_err_t lcd_mock_rx_param(esp_lcd_panel_io_t *io, int lcd_cmd, void *param, size_t param_size)
+{
+    lcd_mock_io_t *mock = __containerof(io, lcd_mock_io_t, base);
+    if (param && param_size)
+    {
+        memset(param, 0, param_size);
+    }
+    lcd_mock_account(mock, param_size, 0);
+
+    return ESP_OK;
+}
+
+static esp_err_t lcd_mock_tx_param(esp_lcd_panel_io_t *io, int lcd_cmd, const void *param, size_t param_size)
+{
+    lcd_mock_io_t *mock = __containerof(io, lcd_mock_io_t, base);
+    const uint8_t *p = (const uint8_t *)param;
+
+    switch (lcd_cmd)
+    {
+    case LCD_CMD_CASET:
+        ESP_RETURN_ON_FALSE(param_size == 4, ESP_ERR_INVALID_SIZE, TAG, "CASET needs 4 bytes");
+        mock->col_start = lcd_mock_param16(p);
+        mock->col_end = lcd_mock_param16(p + 2);
+        break;
+    case LCD_CMD_RASET:
+        ESP_RETURN_ON_FALSE(param_size == 4, ESP_ERR_INVALID_SIZE, TAG, "RASET needs 4 bytes");
+        mock->row_start = lcd_mock_param16(p);
+        mock->row_end = lcd_mock_param16(p + 2);
+        break;
+    case LCD_CMD_MADCTL:
+        if (param_size >= 1)
+        {
+            mock->madctl = p[0];
+        }
+        break;
+    default:
+        break;
+    }
+    lcd_mock_account(mock, param_size, 0);
+
+    return ESP_OK;
+}
+
+static esp_err_t lcd_mock_tx_color(esp_lcd_panel_io_t *io, int lcd_cmd, const void *color, size_t color_size)
+{
+    lcd_mock_io_t *mock = __containerof(io, lcd_mock_io_t, base);
+    const uint16_t *pixels = (const uint16_t *)color;
+
+    if (lcd_cmd == LCD_CMD_RAMWR)
+    {
+        mock->col = mock->col_start;
+        mock->row = mock->row_start;
+    }
+    /*!< RAMWRC and data without a command carry on from the last address */
+    for (size_t i = 0; i < color_size / sizeof(uint16_t); i++)
+    {
+        lcd_mock_write_pixel(mock, pixels[i]);
+    }
+    lcd_mock_account(mock, 0, color_size);
+
+    if (mock->on_color_trans_done)
+    {
+        mock->on_color_trans_done(io, NULL, mock->user_ctx);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t lcd_mock_register_event_callbacks(esp_lcd_panel_io_t *io, const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx)
+{
+    lcd_mock_io_t *mock = __containerof(io, lcd_mock_io_t, base);
+    mock->on_color_trans_done = cbs->on_color_trans_done;
+    mock->user_ctx = user_ctx;
+
+    return ESP_OK;
+}
+
+static esp_err_t lcd_mock_del(esp_lcd_panel_io_t *io)
+{
+    lcd_mock_io_t *mock = __containerof(io, lcd_mock_io_t, base);
+    free(mock->framebuffer);
+    free(mock);
+
+    return ESP_OK;
+}
+
+esp_err_t lcd_mock_new_panel_io(const lcd_mock_config_t *config, esp_lcd_panel_io_handle_t *ret_io)
+{
+    esp_err_t ret = ESP_OK;
+    lcd_mock_io_t *mock = NULL;
+    ESP_RETURN_ON_FALSE(config && ret_io && config->width && config->height && config->pclk_hz, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    mock = calloc(1, sizeof(lcd_mock_io_t));
+    ESP_GOTO_ON_FALSE(mock, ESP_ERR_NO_MEM, err, TAG, "No mem for mock IO");
+    mock->framebuffer = calloc(config->width * config->height, sizeof(uint16_t));
+    ESP_GOTO_ON_FALSE(mock->framebuffer, ESP_ERR_NO_MEM, err, TAG, "No mem for framebuffer");
+
+    mock->config = *config;
+    mock->col_end = config->width - 1;
+    mock->row_end = config->height - 1;
+    mock->base.rx_param = lcd_mock_rx_param;
+    mock->base.tx_param = lcd_mock_tx_param;
+    mock->base.tx_color = lcd_mock_tx_color;
+    mock->base.del = lcd_mock_del;
+    mock->base.register_event_callbacks = lcd_mock_register_event_callbacks;
+    *ret_io = &mock->base;
+
+    ESP_LOGI(TAG, "Mock panel %dx%d, pclk %lu Hz", config->width, config->height, (unsigned long)config->pclk_hz);
+    return ESP_OK;
+
+err:
+    if (mock)
+    {
+        free(mock->framebuffer);
+        free(mock);
+    }
+    return ret;
+}
+
+const uint16_t *lcd_mock_get_framebuffer(esp_lcd_panel_io_handle_t io)
+{
+    lcd_mock_io_t *mock = __containerof(io, lcd_mock_io_t, base);
+    return mock->framebuffer;
+}
+
+uint16_t lcd_mock_get_pixel(esp_lcd_panel_io_handle_t io, uint16_t x, uint16_t y)
+{
+    lcd_mock_io_t *mock = __containerof(io, lcd_mock_io_t, base);
+    if (x >= mock->config.width || y >= mock->config.height)
+    {
+        return 0;
+    }
+    /*!< the first byte on the wire is the high byte */
+    const uint8_t *p = (const uint8_t *)&mock->framebuffer[y * mock->config.width + x];
+    return (p[0] << 8) | p[1];
+}
+
+esp_err_t lcd_mock_get_stats(esp_lcd_panel_io_handle_t io, lcd_mock_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(io && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    lcd_mock_io_t *mock = __containerof(io, lcd_mock_io_t, base);
+    *stats = mock->frame;
+
+    return ESP_OK;
+}
+
+esp_err_t lcd_mock_frame_end(esp_lcd_panel_io_handle_t io, lcd_mock_stats_t *frame, lcd_mock_stats_t *total)
+{
+    ESP_RETURN_ON_FALSE(io, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    lcd_mock_io_t *mock = __containerof(io, lcd_mock_io_t, base);
+
+    mock->total.transactions += mock->frame.transactions;
+    mock->total.commands += mock->frame.commands;
+    mock->total.param_bytes += mock->frame.param_bytes;
+    mock->total.color_bytes += mock->frame.color_bytes;
+    mock->total.pixels_written += mock->frame.pixels_written;
+    mock->total.bus_time_ns += mock->frame.bus_time_ns;
+    if (frame)
+    {
+        *frame = mock->frame;
+    }
+    if (total)
+    {
+        *total = mock->total;
+    }
+    memset(&mock->frame, 0, sizeof(lcd_mock_stats_t));
+
+    return ESP_OK;
+}
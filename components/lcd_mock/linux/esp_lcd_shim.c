@@ -0,0 +1,127 @@
+#include "esp_lcd_panel_io_interface.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_vendor.h"
+#include "esp_lcd_panel_commands.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "stdlib.h"
+
+/*!< what esp_lcd_new_panel_st7789 sends, without the reset GPIO and the delays */
+struct esp_lcd_panel_t
+{
+    esp_lcd_panel_io_handle_t io;
+    int x_gap;
+    int y_gap;
+    uint8_t madctl;
+    uint8_t colmod;
+};
+
+static const char *TAG = "LCD_SHIM";
+
+esp_err_t esp_lcd_panel_io_rx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, void *param, size_t param_size)
+{
+    ESP_RETURN_ON_FALSE(io && io->rx_param, ESP_ERR_NOT_SUPPORTED, TAG, "rx_param not supported");
+    return io->rx_param(io, lcd_cmd, param, param_size);
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size)
+{
+    ESP_RETURN_ON_FALSE(io, ESP_ERR_INVALID_ARG, TAG, "Invalid IO");
+    return io->tx_param(io, lcd_cmd, param, param_size);
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size)
+{
+    ESP_RETURN_ON_FALSE(io, ESP_ERR_INVALID_ARG, TAG, "Invalid IO");
+    return io->tx_color(io, lcd_cmd, color, color_size);
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io)
+{
+    return io ? io->del(io) : ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io, const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(io && cbs, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    return io->register_event_callbacks(io, cbs, user_ctx);
+}
+
+esp_err_t esp_lcd_new_panel_st7789(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel)
+{
+    ESP_RETURN_ON_FALSE(io && panel_dev_config && ret_panel, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(panel_dev_config->bits_per_pixel == 16, ESP_ERR_NOT_SUPPORTED, TAG, "Only RGB565");
+
+    struct esp_lcd_panel_t *panel = calloc(1, sizeof(struct esp_lcd_panel_t));
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_NO_MEM, TAG, "No mem for panel");
+    panel->io = io;
+    panel->madctl = (panel_dev_config->color_space == LCD_RGB_ELEMENT_ORDER_BGR) ? LCD_CMD_BGR_BIT : 0;
+    panel->colmod = 0x55;
+    *ret_panel = panel;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t panel)
+{
+    return esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_SWRESET, NULL, 0);
+}
+
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel)
+{
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_SLPOUT, NULL, 0), TAG, "SLPOUT failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_MADCTL, &panel->madctl, 1), TAG, "MADCTL failed");
+    return esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_COLMOD, &panel->colmod, 1);
+}
+
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel)
+{
+    free(panel);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    ESP_RETURN_ON_FALSE(panel && x_start < x_end && y_start < y_end, ESP_ERR_INVALID_ARG, TAG, "Invalid region");
+    x_start += panel->x_gap;
+    x_end += panel->x_gap;
+    y_start += panel->y_gap;
+    y_end += panel->y_gap;
+
+    uint8_t caset[] = {x_start >> 8, x_start & 0xFF, (x_end - 1) >> 8, (x_end - 1) & 0xFF};
+    uint8_t raset[] = {y_start >> 8, y_start & 0xFF, (y_end - 1) >> 8, (y_end - 1) & 0xFF};
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_CASET, caset, sizeof(caset)), TAG, "CASET failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_RASET, raset, sizeof(raset)), TAG, "RASET failed");
+    return esp_lcd_panel_io_tx_color(panel->io, LCD_CMD_RAMWR, color_data, (x_end - x_start) * (y_end - y_start) * sizeof(uint16_t));
+}
+
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x, bool mirror_y)
+{
+    panel->madctl &= ~(LCD_CMD_MX_BIT | LCD_CMD_MY_BIT);
+    panel->madctl |= (mirror_x ? LCD_CMD_MX_BIT : 0) | (mirror_y ? LCD_CMD_MY_BIT : 0);
+    return esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_MADCTL, &panel->madctl, 1);
+}
+
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes)
+{
+    panel->madctl &= ~LCD_CMD_MV_BIT;
+    panel->madctl |= swap_axes ? LCD_CMD_MV_BIT : 0;
+    return esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_MADCTL, &panel->madctl, 1);
+}
+
+esp_err_t esp_lcd_panel_set_gap(esp_lcd_panel_handle_t panel, int x_gap, int y_gap)
+{
+    panel->x_gap = x_gap;
+    panel->y_gap = y_gap;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_invert_color(esp_lcd_panel_handle_t panel, bool invert_color_data)
+{
+    return esp_lcd_panel_io_tx_param(panel->io, invert_color_data ? LCD_CMD_INVON : LCD_CMD_INVOFF, NULL, 0);
+}
+
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off)
+{
+    return esp_lcd_panel_io_tx_param(panel->io, on_off ? LCD_CMD_DISPON : LCD_CMD_DISPOFF, NULL, 0);
+}
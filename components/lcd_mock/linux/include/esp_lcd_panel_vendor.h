@@ -0,0 +1,20 @@
+#pragma once
+
+#include "esp_lcd_types.h"
+
+typedef struct
+{
+    int reset_gpio_num;
+    lcd_rgb_element_order_t color_space;
+    unsigned int bits_per_pixel;
+    struct
+    {
+        unsigned int reset_active_high : 1;
+    } flags;
+    void *vendor_config;
+} esp_lcd_panel_dev_config_t;
+
+/**
+ * @brief the st7789 command sequence of esp_lcd, sent to any panel IO, e.g. lcd_mock
+ */
+esp_err_t esp_lcd_new_panel_st7789(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel);
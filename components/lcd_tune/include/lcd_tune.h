@@ -0,0 +1,58 @@
+#pragma once
+
+#include "esp_err.h"
+#include "st7789.h"
+
+typedef struct
+{
+    const uint32_t *pclk_hz;      /*!< candidate SPI clocks, those above LCD_PCLK_MAX_HZ are skipped */
+    size_t pclk_count;
+    const uint8_t *queue_depth;   /*!< candidate trans_queue_depth values */
+    size_t queue_depth_count;
+    const uint16_t *strip_height; /*!< candidate strip heights, each sets max_transfer_sz */
+    size_t strip_height_count;
+    uint32_t frames;              /*!< full screen frames drawn per candidate */
+} lcd_tune_config_t;
+
+typedef struct
+{
+    lcd_bus_params_t params;
+    uint32_t frames;
+    uint32_t errors;  /*!< failed or timed out transfers, and on the host pixels that did not arrive */
+    uint64_t time_us; /*!< wall time on the board, modelled bus time on the host */
+    uint32_t fps_x10;
+} lcd_tune_result_t;
+
+/**
+ * @brief called after every candidate, e.g. to log or plot the sweep
+ */
+typedef void (*lcd_tune_result_cb_t)(const lcd_tune_result_t *result, void *user_ctx);
+
+/**
+ * @brief bring the panel up with every combination of the candidates and measure a synthetic workload
+ *
+ * The LCD must not be initialized, it is initialized and released for every candidate.
+ * Candidates with any error are never picked. On the board the sweep measures throughput only:
+ * nothing is read back, so a clock the panel does not latch cleanly is not caught, which is
+ * why the clocks are capped at the rated LCD_PCLK_MAX_HZ. On the host the mock panel IO is used,
+ * pixels are read back and the bus time comes from its model, so the queue depth makes no
+ * difference there.
+ *
+ * @param lcd_config pins and resolution, the bus fields are overridden
+ * @param config
+ * @param cb may be NULL
+ * @param user_ctx
+ * @param best fastest error free candidate
+ * @return esp_err_t ESP_ERR_NOT_FOUND if every candidate failed
+ */
+esp_err_t lcd_tune_sweep(lcd_config_t lcd_config, const lcd_tune_config_t *config, lcd_tune_result_cb_t cb, void *user_ctx, lcd_bus_params_t *best);
+
+/**
+ * @brief sweep and store the winner in NVS for lcd_init, nvs_flash_init must have been called
+ *
+ * @param lcd_config
+ * @param config
+ * @param best may be NULL
+ * @return esp_err_t
+ */
+esp_err_t lcd_tune_run(lcd_config_t lcd_config, const lcd_tune_config_t *config, lcd_bus_params_t *best);
@@ -0,0 +1,177 @@
+#include "lcd_tune.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "lcd_mock.h"
+#endif
+
+#define LCD_TUNE_WAIT_MS 1000 /*!< a frame that is not on the panel by then counts as failed */
+#define LCD_TUNE_CHECK_STEP 7 /*!< host only, every 7th pixel is read back */
+
+typedef struct
+{
+    uint32_t frame;
+    uint16_t width;
+} lcd_tune_pattern_t;
+
+static const char *TAG = "LCD_TUNE";
+
+/**
+ * @brief pixel of the synthetic workload, changes every frame so stale strips are caught
+ */
+static uint16_t lcd_tune_pixel(uint16_t x, uint16_t y, uint32_t frame)
+{
+    return (uint16_t)(x * 31 + y * 2047 + frame * 1009);
+}
+
+static void lcd_tune_fill_cb(uint16_t *strip, lcd_region_t region, void *user_ctx)
+{
+    lcd_tune_pattern_t *pattern = (lcd_tune_pattern_t *)user_ctx;
+
+    for (uint16_t y = region.y1; y < region.y2; y++)
+    {
+        for (uint16_t x = region.x1; x < region.x2; x++)
+        {
+            *strip++ = swap_hex(lcd_tune_pixel(x, y, pattern->frame));
+        }
+    }
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+static uint32_t lcd_tune_check(lcd_region_t region, uint32_t frame)
+{
+    uint32_t errors = 0;
+
+    for (uint32_t i = 0; i < (region.x2 - region.x1) * (region.y2 - region.y1); i += LCD_TUNE_CHECK_STEP)
+    {
+        uint16_t x = region.x1 + i % (region.x2 - region.x1);
+        uint16_t y = region.y1 + i / (region.x2 - region.x1);
+        errors += lcd_mock_get_pixel(lcd_io, x, y) != lcd_tune_pixel(x, y, frame);
+    }
+
+    return errors;
+}
+#endif
+
+/**
+ * @brief draw config->frames full screen frames with one set of bus parameters
+ */
+static esp_err_t lcd_tune_measure(lcd_config_t lcd_config, uint32_t frames, lcd_tune_result_t *result)
+{
+    lcd_region_t region = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = lcd_config.lcd_height_res,
+        .y2 = lcd_config.lcd_vertical_res,
+    };
+    lcd_tune_pattern_t pattern = {0};
+
+    lcd_config.pclk_hz = result->params.pclk_hz;
+    lcd_config.trans_queue_depth = result->params.trans_queue_depth;
+    lcd_config.lcd_draw_buffer_height = result->params.draw_buffer_height;
+    ESP_RETURN_ON_ERROR(lcd_init(lcd_config), TAG, "LCD init failed");
+#if CONFIG_IDF_TARGET_LINUX
+    lcd_mock_stats_t stats;
+    /*!< the panel init sequence is not part of the workload */
+    lcd_mock_frame_end(lcd_io, NULL, NULL);
+#endif
+
+    int64_t start = esp_timer_get_time();
+    for (pattern.frame = 0; pattern.frame < frames; pattern.frame++)
+    {
+        if (lcd_draw_strips(region, lcd_config.lcd_draw_buffer_height, lcd_tune_fill_cb, &pattern) != ESP_OK)
+        {
+            result->errors++;
+            continue;
+        }
+#if CONFIG_IDF_TARGET_LINUX
+        /*!< the mock completes every transfer before returning, the frame is already in its memory */
+        result->errors += lcd_tune_check(region, pattern.frame);
+        lcd_mock_frame_end(lcd_io, &stats, NULL);
+        result->time_us += stats.bus_time_ns / 1000;
+#endif
+        result->frames++;
+    }
+    if (lcd_draw_wait(pdMS_TO_TICKS(LCD_TUNE_WAIT_MS)) != ESP_OK)
+    {
+        result->errors++;
+    }
+#if !CONFIG_IDF_TARGET_LINUX
+    result->time_us = esp_timer_get_time() - start;
+#else
+    (void)start;
+#endif
+    if (result->time_us)
+    {
+        result->fps_x10 = (uint64_t)result->frames * 10000000 / result->time_us;
+    }
+
+    return lcd_deinit();
+}
+
+esp_err_t lcd_tune_sweep(lcd_config_t lcd_config, const lcd_tune_config_t *config, lcd_tune_result_cb_t cb, void *user_ctx, lcd_bus_params_t *best)
+{
+    uint32_t best_fps_x10 = 0;
+    ESP_RETURN_ON_FALSE(config && best && config->pclk_count && config->queue_depth_count && config->strip_height_count && config->frames,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(lcd_io == NULL, ESP_ERR_INVALID_STATE, TAG, "LCD is in use");
+
+    for (size_t p = 0; p < config->pclk_count; p++)
+    {
+        if (config->pclk_hz[p] > LCD_PCLK_MAX_HZ)
+        {
+            ESP_LOGW(TAG, "pclk %lu Hz is above the panel's %lu Hz, skipped", (unsigned long)config->pclk_hz[p], (unsigned long)LCD_PCLK_MAX_HZ);
+            continue;
+        }
+        for (size_t q = 0; q < config->queue_depth_count; q++)
+        {
+            for (size_t h = 0; h < config->strip_height_count; h++)
+            {
+                lcd_tune_result_t result = {
+                    .params = {
+                        .pclk_hz = config->pclk_hz[p],
+                        .trans_queue_depth = config->queue_depth[q],
+                        .draw_buffer_height = config->strip_height[h],
+                    },
+                };
+
+                if (lcd_tune_measure(lcd_config, config->frames, &result) != ESP_OK)
+                {
+                    result.errors++;
+                }
+                ESP_LOGI(TAG, "pclk %lu Hz, queue %d, strip %d: %lu.%lu fps, %lu errors", (unsigned long)result.params.pclk_hz, result.params.trans_queue_depth,
+                         result.params.draw_buffer_height, (unsigned long)(result.fps_x10 / 10), (unsigned long)(result.fps_x10 % 10), (unsigned long)result.errors);
+                if (cb)
+                {
+                    cb(&result, user_ctx);
+                }
+                /*!< ties keep the earlier candidate, list the safer settings first */
+                if (result.errors == 0 && result.frames == config->frames && result.fps_x10 > best_fps_x10)
+                {
+                    best_fps_x10 = result.fps_x10;
+                    *best = result.params;
+                }
+            }
+        }
+    }
+    ESP_RETURN_ON_FALSE(best_fps_x10, ESP_ERR_NOT_FOUND, TAG, "No candidate ran without errors");
+    ESP_LOGI(TAG, "Best: pclk %lu Hz, queue %d, strip %d, %lu.%lu fps", (unsigned long)best->pclk_hz, best->trans_queue_depth, best->draw_buffer_height,
+             (unsigned long)(best_fps_x10 / 10), (unsigned long)(best_fps_x10 % 10));
+
+    return ESP_OK;
+}
+
+esp_err_t lcd_tune_run(lcd_config_t lcd_config, const lcd_tune_config_t *config, lcd_bus_params_t *best)
+{
+    lcd_bus_params_t params;
+
+    ESP_RETURN_ON_ERROR(lcd_tune_sweep(lcd_config, config, NULL, NULL, &params), TAG, "Sweep failed");
+    ESP_RETURN_ON_ERROR(lcd_bus_params_save(&params), TAG, "Save failed");
+    if (best)
+    {
+        *best = params;
+    }
+
+    return ESP_OK;
+}
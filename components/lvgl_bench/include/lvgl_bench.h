@@ -0,0 +1,54 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+/**
+ * @brief builds the screen under test on the default display, e.g. ui_init
+ */
+typedef void (*lvgl_bench_scene_cb_t)(void);
+
+typedef struct
+{
+    uint16_t hres;
+    uint16_t vres;
+    uint16_t draw_buffer_height; /*!< lines per draw buffer, as lcd_draw_buffer_height */
+    bool double_buffer;
+    uint32_t frames; /*!< full screen refreshes to measure */
+} lvgl_bench_config_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t render_us_avg; /*!< lv_refr_now time per frame, flushing is free */
+    uint32_t render_us_max;
+    uint32_t flushes;       /*!< flush_cb calls per frame */
+    uint32_t flushed_area;  /*!< pixels handed to flush_cb per frame */
+} lvgl_bench_result_t;
+
+/**
+ * @brief render a scene on a virtual display and measure every refresh
+ *
+ * The display only counts what it is given, so the numbers are LVGL's share of a frame.
+ *
+ * @param config
+ * @param scene_cb
+ * @param result
+ * @return esp_err_t
+ */
+esp_err_t lvgl_bench_run(lvgl_bench_config_t config, lvgl_bench_scene_cb_t scene_cb, lvgl_bench_result_t *result);
+
+/**
+ * @brief run the scene for every draw buffer height and both buffer modes, log one line per setting
+ *
+ * @param hres
+ * @param vres
+ * @param heights
+ * @param height_count
+ * @param frames
+ * @param scene_cb
+ * @return esp_err_t
+ */
+esp_err_t lvgl_bench_sweep(uint16_t hres, uint16_t vres, const uint16_t *heights, size_t height_count, uint32_t frames, lvgl_bench_scene_cb_t scene_cb);
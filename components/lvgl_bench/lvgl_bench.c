@@ -0,0 +1,117 @@
+#include "lvgl_bench.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "stdlib.h"
+#include "lvgl.h"
+
+typedef struct
+{
+    uint32_t flushes;
+    uint32_t area;
+} lvgl_bench_counter_t;
+
+static const char *TAG = "LVGL_BENCH";
+
+static void lvgl_bench_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    lvgl_bench_counter_t *counter = (lvgl_bench_counter_t *)drv->user_data;
+    counter->flushes++;
+    counter->area += lv_area_get_size(area);
+    lv_disp_flush_ready(drv);
+}
+
+esp_err_t lvgl_bench_run(lvgl_bench_config_t config, lvgl_bench_scene_cb_t scene_cb, lvgl_bench_result_t *result)
+{
+    esp_err_t ret = ESP_OK;
+    lv_color_t *buf1 = NULL;
+    lv_color_t *buf2 = NULL;
+    lv_disp_t *disp = NULL;
+    static lv_disp_draw_buf_t draw_buf;
+    static lv_disp_drv_t disp_drv;
+    lvgl_bench_counter_t counter = {0};
+    ESP_RETURN_ON_FALSE(scene_cb && result && config.frames && config.draw_buffer_height, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    if (!lv_is_initialized())
+    {
+        lv_init();
+    }
+    size_t pixels = config.hres * config.draw_buffer_height;
+    buf1 = malloc(pixels * sizeof(lv_color_t));
+    ESP_GOTO_ON_FALSE(buf1, ESP_ERR_NO_MEM, err, TAG, "No mem for draw buffer");
+    if (config.double_buffer)
+    {
+        buf2 = malloc(pixels * sizeof(lv_color_t));
+        ESP_GOTO_ON_FALSE(buf2, ESP_ERR_NO_MEM, err, TAG, "No mem for draw buffer");
+    }
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, pixels);
+
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = config.hres;
+    disp_drv.ver_res = config.vres;
+    disp_drv.flush_cb = lvgl_bench_flush_cb;
+    disp_drv.draw_buf = &draw_buf;
+    disp_drv.user_data = &counter;
+    disp = lv_disp_drv_register(&disp_drv);
+    ESP_GOTO_ON_FALSE(disp, ESP_ERR_NO_MEM, err, TAG, "Display register failed");
+    /*!< only the refreshes below are measured */
+    lv_timer_pause(disp->refr_timer);
+    lv_disp_set_default(disp);
+
+    scene_cb();
+    lv_refr_now(disp);
+
+    counter.flushes = 0;
+    counter.area = 0;
+    uint64_t total_us = 0;
+    uint32_t max_us = 0;
+    for (uint32_t i = 0; i < config.frames; i++)
+    {
+        lv_obj_invalidate(lv_scr_act());
+        int64_t start = esp_timer_get_time();
+        lv_refr_now(disp);
+        uint32_t elapsed = esp_timer_get_time() - start;
+        total_us += elapsed;
+        max_us = elapsed > max_us ? elapsed : max_us;
+    }
+
+    result->frames = config.frames;
+    result->render_us_avg = total_us / config.frames;
+    result->render_us_max = max_us;
+    result->flushes = counter.flushes / config.frames;
+    result->flushed_area = counter.area / config.frames;
+
+err:
+    if (disp)
+    {
+        lv_disp_remove(disp);
+    }
+    free(buf1);
+    free(buf2);
+    return ret;
+}
+
+esp_err_t lvgl_bench_sweep(uint16_t hres, uint16_t vres, const uint16_t *heights, size_t height_count, uint32_t frames, lvgl_bench_scene_cb_t scene_cb)
+{
+    ESP_LOGI(TAG, "%dx%d, %lu frames per setting", hres, vres, (unsigned long)frames);
+    ESP_LOGI(TAG, "lines  double  avg us  max us  flushes  area");
+    for (size_t i = 0; i < height_count; i++)
+    {
+        for (int double_buffer = 0; double_buffer <= 1; double_buffer++)
+        {
+            lvgl_bench_result_t result = {0};
+            lvgl_bench_config_t config = {
+                .hres = hres,
+                .vres = vres,
+                .draw_buffer_height = heights[i],
+                .double_buffer = double_buffer,
+                .frames = frames,
+            };
+            ESP_RETURN_ON_ERROR(lvgl_bench_run(config, scene_cb, &result), TAG, "Bench run failed");
+            ESP_LOGI(TAG, "%5d  %6d  %6lu  %6lu  %7lu  %lu", heights[i], double_buffer, (unsigned long)result.render_us_avg, (unsigned long)result.render_us_max,
+                     (unsigned long)result.flushes, (unsigned long)result.flushed_area);
+        }
+    }
+
+    return ESP_OK;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "lvgl.h"
+#include "st7789.h"
+
+typedef enum
+{
+    LVGL_FLUSH_BUFFER_STRIPS, /*!< draw_buffer_height line strips, sent straight from the draw buffer */
+    LVGL_FLUSH_BUFFER_DIRECT, /*!< full frame in PSRAM with LVGL direct mode, dirty areas go out through the bounce buffers */
+    LVGL_FLUSH_BUFFER_HYBRID, /*!< strips rendered in PSRAM, copied into the bounce buffers to be sent */
+} lvgl_flush_buffer_mode_t;
+
+/**
+ * @brief runs on the flush core on every strip before it is sent, in direct mode buf is the whole frame
+ */
+typedef void (*lvgl_flush_post_cb_t)(lv_color_t *buf, const lv_area_t *area, void *user_ctx);
+
+typedef struct
+{
+    uint16_t hres;
+    uint16_t vres;
+    lvgl_flush_buffer_mode_t buffer_mode;
+    uint16_t draw_buffer_height; /*!< strips and hybrid mode */
+    uint16_t bounce_lines;       /*!< lines per internal DMA bounce buffer, direct and hybrid mode */
+    bool double_buffer;
+    bool buff_dma; /*!< strips mode, draw buffers in DMA capable internal RAM */
+    uint32_t pclk_hz;             /*!< SPI clock, prices a pixel on the wire */
+    uint32_t trans_overhead_ns;   /*!< fixed cost of one SPI transaction */
+    uint32_t render_ns_per_pixel; /*!< LVGL cost of redrawing one more pixel */
+    int flush_core;               /*!< -1 flushes in the LVGL task, otherwise a flush task on this core runs post_cb, bounce copies and queueing */
+    uint8_t flush_task_priority;
+    lvgl_flush_post_cb_t post_cb; /*!< may be NULL */
+    void *post_ctx;
+} lvgl_flush_config_t;
+
+typedef struct
+{
+    uint32_t refreshes;
+    uint32_t areas_in;  /*!< invalidated areas LVGL collected */
+    uint32_t areas_out; /*!< areas left after coalescing */
+    uint32_t flushes;   /*!< flush_cb calls */
+    uint32_t windows;   /*!< flushes that had to open a CASET/RASET window */
+    uint64_t render_us; /*!< LVGL task refreshing, waiting for a free buffer excluded */
+    uint64_t flush_us;  /*!< post processing and queueing strips */
+    uint64_t elapsed_us;
+    uint32_t render_busy_permille; /*!< render_us against elapsed_us, the LVGL task only, not the load of its core */
+    uint32_t flush_busy_permille;  /*!< flush_us against elapsed_us, the flushing task only, not the load of its core */
+    uint32_t core_load_permille[portNUM_PROCESSORS]; /*!< each core busy outside its idle task, 0 without CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS */
+    uint64_t copy_us;         /*!< PSRAM to bounce buffer copies */
+    uint64_t copy_bytes;
+    uint64_t spi_us;          /*!< time the panel IO had at least one flush in flight */
+} lvgl_flush_stats_t;
+
+/**
+ * @brief register an LVGL display that coalesces invalidated areas and streams contiguous strips
+ *
+ * lcd_init must have been called. Call with the LVGL lock held, and do not add the same
+ * panel through esp_lvgl_port, it takes over the panel IO transfer callback.
+ *
+ * @param config
+ * @return lv_disp_t* NULL on failure
+ */
+lv_disp_t *lvgl_flush_add_disp(lvgl_flush_config_t config);
+
+/**
+ * @brief get flush counters
+ *
+ * @param stats
+ */
+void lvgl_flush_get_stats(lvgl_flush_stats_t *stats);
+
+/**
+ * @brief clear flush counters and restart the utilization window, e.g. before measuring an animation
+ */
+void lvgl_flush_reset_stats(void);
@@ -0,0 +1,462 @@
+#include "lvgl_flush.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "string.h"
+#include "stdatomic.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#define LVGL_FLUSH_WINDOW_TRANS 5   /*!< CASET, its parameters, RASET, its parameters, RAMWR */
+#define LVGL_FLUSH_WINDOW_BYTES 11  /*!< three command bytes and eight parameter bytes */
+#define LVGL_FLUSH_QUEUE_DEPTH 2    /*!< one strip per draw buffer */
+#define LVGL_FLUSH_BOUNCE_NUM 2     /*!< one bounce buffer is copied while the other is on the wire */
+
+typedef struct
+{
+    lv_disp_drv_t *drv;
+    lv_area_t area;
+    lv_color_t *buf;
+} lvgl_flush_strip_t;
+
+typedef struct
+{
+    lv_color_t *buf;
+    lv_disp_drv_t *drv; /*!< set on the last chunk of a flush, it releases the draw buffer */
+} lvgl_flush_bounce_t;
+
+static const char *TAG = "LVGL_FLUSH";
+
+static lvgl_flush_config_t flush_cfg;
+static lvgl_flush_stats_t flush_stats;
+static lv_disp_draw_buf_t draw_buf;
+static lv_disp_drv_t disp_drv;
+static QueueHandle_t strip_queue = NULL;
+static SemaphoreHandle_t buffer_free = NULL; /*!< given when a strip is on the panel */
+static int64_t stats_start = 0;
+static int64_t spi_start = 0;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED; /*!< the stats are written from the LVGL task, the flush task and the SPI ISR */
+static atomic_int spi_busy = 0; /*!< flushes handed to the panel IO and not done yet */
+static QueueHandle_t bounce_free = NULL;
+static lvgl_flush_bounce_t bounce[LVGL_FLUSH_BOUNCE_NUM];
+static uint64_t wait_us = 0; /*!< LVGL blocked on a buffer during the current refresh */
+static uint32_t idle_start[portNUM_PROCESSORS]; /*!< idle task run time of each core when the window started */
+static uint32_t run_time_start = 0;
+
+/**
+ * @brief FreeRTOS run time counters, the idle tasks' time is what the cores did not spend on work
+ */
+static void lvgl_flush_run_time(uint32_t *idle, uint32_t *total)
+{
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    *total = portGET_RUN_TIME_COUNTER_VALUE();
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        idle[core] = ulTaskGetIdleRunTimeCounterForCore(core);
+    }
+#else
+    *total = 0;
+    memset(idle, 0, portNUM_PROCESSORS * sizeof(uint32_t));
+#endif
+}
+
+/**
+ * @brief nanoseconds to render and send an area in its own window
+ */
+static uint64_t lvgl_flush_area_cost(const lv_area_t *area)
+{
+    uint64_t window = LVGL_FLUSH_WINDOW_TRANS * flush_cfg.trans_overhead_ns + LVGL_FLUSH_WINDOW_BYTES * 8000000000ULL / flush_cfg.pclk_hz;
+    uint64_t pixel = 16000000000ULL / flush_cfg.pclk_hz + flush_cfg.render_ns_per_pixel;
+
+    return window + lv_area_get_size(area) * pixel;
+}
+
+/**
+ * @brief merge invalidated areas whenever one window is cheaper than two
+ *
+ * LVGL only joins areas that overlap and save pixels, here neighbours are merged too
+ * once the saved window setup outweighs the extra pixels. Overlapping areas go through
+ * the same cost check, two thin crossing areas stay apart when their bounding box costs more.
+ */
+static void lvgl_flush_coalesce(lv_disp_t *disp)
+{
+    bool merged = true;
+    uint32_t areas_in = 0;
+    uint32_t areas_out = 0;
+
+    for (uint16_t i = 0; i < disp->inv_p; i++)
+    {
+        areas_in += !disp->inv_area_joined[i];
+    }
+    while (merged)
+    {
+        merged = false;
+        for (uint16_t i = 0; i < disp->inv_p; i++)
+        {
+            if (disp->inv_area_joined[i])
+            {
+                continue;
+            }
+            for (uint16_t j = i + 1; j < disp->inv_p; j++)
+            {
+                if (disp->inv_area_joined[j])
+                {
+                    continue;
+                }
+                lv_area_t joined;
+                _lv_area_join(&joined, &disp->inv_areas[i], &disp->inv_areas[j]);
+                if (lvgl_flush_area_cost(&joined) <= lvgl_flush_area_cost(&disp->inv_areas[i]) + lvgl_flush_area_cost(&disp->inv_areas[j]))
+                {
+                    lv_area_copy(&disp->inv_areas[i], &joined);
+                    disp->inv_area_joined[j] = 1;
+                    merged = true;
+                }
+            }
+        }
+    }
+    for (uint16_t i = 0; i < disp->inv_p; i++)
+    {
+        areas_out += !disp->inv_area_joined[i];
+    }
+    portENTER_CRITICAL(&stats_lock);
+    flush_stats.areas_in += areas_in;
+    flush_stats.areas_out += areas_out;
+    flush_stats.refreshes++;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+static void lvgl_flush_refr_timer(lv_timer_t *tmr)
+{
+    lv_disp_t *disp = (lv_disp_t *)tmr->user_data;
+    int64_t start = esp_timer_get_time();
+
+    if (disp->inv_p)
+    {
+        lvgl_flush_coalesce(disp);
+    }
+    wait_us = 0;
+    _lv_disp_refr_timer(tmr);
+    int64_t render_us = esp_timer_get_time() - start - wait_us;
+    portENTER_CRITICAL(&stats_lock);
+    flush_stats.render_us += render_us;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+static void lvgl_flush_ready_cb(void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    int64_t now = esp_timer_get_time();
+    lv_disp_flush_ready((lv_disp_drv_t *)user_ctx);
+    /*!< flushes overlap on the queue, count the time the bus had any of them */
+    portENTER_CRITICAL_ISR(&stats_lock);
+    if (atomic_fetch_sub(&spi_busy, 1) == 1)
+    {
+        flush_stats.spi_us += now - spi_start;
+    }
+    portEXIT_CRITICAL_ISR(&stats_lock);
+    xSemaphoreGiveFromISR(buffer_free, &need_yield);
+    portYIELD_FROM_ISR(need_yield);
+}
+
+static void lvgl_flush_bounce_done_cb(void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    lvgl_flush_bounce_t *b = (lvgl_flush_bounce_t *)user_ctx;
+
+    if (b->drv)
+    {
+        lvgl_flush_ready_cb(b->drv);
+    }
+    xQueueSendFromISR(bounce_free, &b, &need_yield);
+    portYIELD_FROM_ISR(need_yield);
+}
+
+/**
+ * @brief copy an area out of PSRAM chunk by chunk into internal DMA buffers and stream it
+ */
+static esp_err_t lvgl_flush_bounce(lvgl_flush_strip_t *strip, const lv_color_t *src, uint16_t stride, bool *continued)
+{
+    uint16_t width = lv_area_get_width(&strip->area);
+    uint16_t lines = (flush_cfg.hres * flush_cfg.bounce_lines) / width;
+    bool cont = false;
+
+    for (lv_coord_t y = strip->area.y1; y <= strip->area.y2; y += lines)
+    {
+        lvgl_flush_bounce_t *b = NULL;
+        uint16_t h = (y + lines <= strip->area.y2 + 1) ? lines : strip->area.y2 + 1 - y;
+        bool last = (y + h > strip->area.y2);
+
+        xQueueReceive(bounce_free, &b, portMAX_DELAY);
+        int64_t start = esp_timer_get_time();
+        for (uint16_t row = 0; row < h; row++)
+        {
+            memcpy(b->buf + row * width, src + (y - strip->area.y1 + row) * stride, width * sizeof(lv_color_t));
+        }
+        int64_t copy_us = esp_timer_get_time() - start;
+        portENTER_CRITICAL(&stats_lock);
+        flush_stats.copy_us += copy_us;
+        flush_stats.copy_bytes += width * h * sizeof(lv_color_t);
+        portEXIT_CRITICAL(&stats_lock);
+
+        lcd_region_t region = {
+            .x1 = strip->area.x1,
+            .y1 = y,
+            .x2 = strip->area.x2 + 1,
+            .y2 = y + h,
+        };
+        b->drv = last ? strip->drv : NULL;
+        /*!< the chunks of one area continue a single RAMWR stream */
+        esp_err_t ret = lcd_draw_stream(region, b->buf, lvgl_flush_bounce_done_cb, b, &cont);
+        if (ret != ESP_OK)
+        {
+            xQueueSend(bounce_free, &b, 0);
+            return ret;
+        }
+        if (y == strip->area.y1)
+        {
+            *continued = cont;
+        }
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief LVGL waits here for a draw buffer instead of spinning, the core is free meanwhile
+ */
+static void lvgl_flush_wait_cb(lv_disp_drv_t *drv)
+{
+    int64_t start = esp_timer_get_time();
+    /*!< a give may have landed before the take, so wake up once a tick and let LVGL check again */
+    xSemaphoreTake(buffer_free, 1);
+    wait_us += esp_timer_get_time() - start;
+}
+
+static void lvgl_flush_send(lvgl_flush_strip_t *strip)
+{
+    bool continued = false;
+    int64_t start = esp_timer_get_time();
+    lcd_region_t region = {
+        .x1 = strip->area.x1,
+        .y1 = strip->area.y1,
+        .x2 = strip->area.x2 + 1,
+        .y2 = strip->area.y2 + 1,
+    };
+
+    esp_err_t ret = ESP_OK;
+
+    if (flush_cfg.post_cb)
+    {
+        flush_cfg.post_cb(strip->buf, &strip->area, flush_cfg.post_ctx);
+    }
+    portENTER_CRITICAL(&stats_lock);
+    if (atomic_fetch_add(&spi_busy, 1) == 0)
+    {
+        spi_start = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    switch (flush_cfg.buffer_mode)
+    {
+    case LVGL_FLUSH_BUFFER_DIRECT:
+        /*!< the buffer is the whole frame, the area sits at its own position in it */
+        ret = lvgl_flush_bounce(strip, strip->buf + strip->area.y1 * flush_cfg.hres + strip->area.x1, flush_cfg.hres, &continued);
+        break;
+    case LVGL_FLUSH_BUFFER_HYBRID:
+        ret = lvgl_flush_bounce(strip, strip->buf, lv_area_get_width(&strip->area), &continued);
+        break;
+    default:
+        /*!< strips of one area, and areas stacked on each other, share a single RAMWR stream */
+        ret = lcd_draw_stream(region, strip->buf, lvgl_flush_ready_cb, strip->drv, &continued);
+        break;
+    }
+    if (ret != ESP_OK)
+    {
+        portENTER_CRITICAL(&stats_lock);
+        atomic_fetch_sub(&spi_busy, 1);
+        portEXIT_CRITICAL(&stats_lock);
+        lv_disp_flush_ready(strip->drv);
+        xSemaphoreGive(buffer_free);
+        return;
+    }
+    int64_t flush_us = esp_timer_get_time() - start;
+    portENTER_CRITICAL(&stats_lock);
+    flush_stats.flushes++;
+    flush_stats.windows += !continued;
+    flush_stats.flush_us += flush_us;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+static void lvgl_flush_task(void *arg)
+{
+    lvgl_flush_strip_t strip;
+
+    while (1)
+    {
+        if (xQueueReceive(strip_queue, &strip, portMAX_DELAY) == pdTRUE)
+        {
+            lvgl_flush_send(&strip);
+        }
+    }
+}
+
+static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    lvgl_flush_strip_t strip = {
+        .drv = drv,
+        .area = *area,
+        .buf = color_map,
+    };
+
+    if (strip_queue)
+    {
+        /*!< the flush task prepares and queues this buffer, the transfer itself is DMA in either mode */
+        xQueueSend(strip_queue, &strip, portMAX_DELAY);
+        return;
+    }
+    lvgl_flush_send(&strip);
+}
+
+lv_disp_t *lvgl_flush_add_disp(lvgl_flush_config_t config)
+{
+    esp_err_t ret = ESP_OK;
+    lv_color_t *buf1 = NULL;
+    lv_color_t *buf2 = NULL;
+    lv_disp_t *disp = NULL;
+    ESP_RETURN_ON_FALSE(lcd_io, NULL, TAG, "LCD not initialized");
+    ESP_RETURN_ON_FALSE(config.pclk_hz && (config.draw_buffer_height || config.buffer_mode == LVGL_FLUSH_BUFFER_DIRECT), NULL, TAG, "Invalid config");
+    flush_cfg = config;
+
+    size_t pixels = config.hres * config.draw_buffer_height;
+    uint32_t caps = config.buff_dma ? MALLOC_CAP_DMA : MALLOC_CAP_DEFAULT;
+    if (config.buffer_mode != LVGL_FLUSH_BUFFER_STRIPS)
+    {
+        /*!< render in PSRAM, only the bounce buffers take internal RAM */
+        ESP_RETURN_ON_FALSE(config.bounce_lines, NULL, TAG, "Bounce lines not set");
+        caps = MALLOC_CAP_SPIRAM;
+        bounce_free = xQueueCreate(LVGL_FLUSH_BOUNCE_NUM, sizeof(lvgl_flush_bounce_t *));
+        ESP_GOTO_ON_FALSE(bounce_free, ESP_ERR_NO_MEM, err, TAG, "Bounce queue create failed");
+        for (int i = 0; i < LVGL_FLUSH_BOUNCE_NUM; i++)
+        {
+            bounce[i].buf = heap_caps_malloc(config.hres * config.bounce_lines * sizeof(lv_color_t), MALLOC_CAP_DMA);
+            ESP_GOTO_ON_FALSE(bounce[i].buf, ESP_ERR_NO_MEM, err, TAG, "No mem for bounce buffer");
+            lvgl_flush_bounce_t *b = &bounce[i];
+            xQueueSend(bounce_free, &b, 0);
+        }
+    }
+    if (config.buffer_mode == LVGL_FLUSH_BUFFER_DIRECT)
+    {
+        pixels = config.hres * config.vres;
+    }
+    buf1 = heap_caps_malloc(pixels * sizeof(lv_color_t), caps);
+    ESP_GOTO_ON_FALSE(buf1, ESP_ERR_NO_MEM, err, TAG, "No mem for draw buffer");
+    if (config.double_buffer)
+    {
+        buf2 = heap_caps_malloc(pixels * sizeof(lv_color_t), caps);
+        ESP_GOTO_ON_FALSE(buf2, ESP_ERR_NO_MEM, err, TAG, "No mem for draw buffer");
+    }
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, pixels);
+
+    buffer_free = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(buffer_free, ESP_ERR_NO_MEM, err, TAG, "Semaphore create failed");
+    if (config.flush_core >= 0)
+    {
+        strip_queue = xQueueCreate(LVGL_FLUSH_QUEUE_DEPTH, sizeof(lvgl_flush_strip_t));
+        ESP_GOTO_ON_FALSE(strip_queue, ESP_ERR_NO_MEM, err, TAG, "Queue create failed");
+    }
+
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = config.hres;
+    disp_drv.ver_res = config.vres;
+    disp_drv.flush_cb = lvgl_flush_cb;
+    disp_drv.wait_cb = lvgl_flush_wait_cb;
+    disp_drv.draw_buf = &draw_buf;
+    /*!< LVGL renders in place in the frame and flushes only the dirty areas */
+    disp_drv.direct_mode = (config.buffer_mode == LVGL_FLUSH_BUFFER_DIRECT);
+    disp = lv_disp_drv_register(&disp_drv);
+    ESP_GOTO_ON_FALSE(disp, ESP_ERR_NO_MEM, err, TAG, "Display register failed");
+
+    /*!< coalesce before LVGL's own join and render pass */
+    disp->refr_timer->timer_cb = lvgl_flush_refr_timer;
+    if (strip_queue && xTaskCreatePinnedToCore(lvgl_flush_task, "lvgl_flush", 4096, NULL, config.flush_task_priority, NULL, config.flush_core) != pdPASS)
+    {
+        ESP_LOGW(TAG, "Flush task create failed, flushing from the LVGL task");
+        vQueueDelete(strip_queue);
+        strip_queue = NULL;
+    }
+    stats_start = esp_timer_get_time();
+    lvgl_flush_run_time(idle_start, &run_time_start);
+    ESP_LOGI(TAG, "Display %dx%d, buffer mode %d, %u pixel buffers, pclk %lu Hz, flush core %d", config.hres, config.vres, config.buffer_mode, (unsigned)pixels, (unsigned long)config.pclk_hz, config.flush_core);
+
+    return disp;
+
+err:
+    ESP_LOGE(TAG, "Add display failed: %s", esp_err_to_name(ret));
+    if (strip_queue)
+    {
+        vQueueDelete(strip_queue);
+        strip_queue = NULL;
+    }
+    if (buffer_free)
+    {
+        vSemaphoreDelete(buffer_free);
+        buffer_free = NULL;
+    }
+    if (bounce_free)
+    {
+        vQueueDelete(bounce_free);
+        bounce_free = NULL;
+    }
+    for (int i = 0; i < LVGL_FLUSH_BOUNCE_NUM; i++)
+    {
+        heap_caps_free(bounce[i].buf);
+        bounce[i].buf = NULL;
+    }
+    heap_caps_free(buf1);
+    heap_caps_free(buf2);
+    return NULL;
+}
+
+void lvgl_flush_get_stats(lvgl_flush_stats_t *stats)
+{
+    uint32_t idle[portNUM_PROCESSORS];
+    uint32_t total = 0;
+
+    lvgl_flush_run_time(idle, &total);
+    portENTER_CRITICAL(&stats_lock);
+    *stats = flush_stats;
+    stats->elapsed_us = esp_timer_get_time() - stats_start;
+    total -= run_time_start;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        idle[core] -= idle_start[core];
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    if (stats->elapsed_us)
+    {
+        stats->render_busy_permille = stats->render_us * 1000 / stats->elapsed_us;
+        stats->flush_busy_permille = stats->flush_us * 1000 / stats->elapsed_us;
+    }
+    for (int core = 0; core < portNUM_PROCESSORS && total; core++)
+    {
+        /*!< the counters are read one after the other, an idle core may come out a little over the window */
+        uint64_t idle_permille = (uint64_t)idle[core] * 1000 / total;
+        stats->core_load_permille[core] = idle_permille < 1000 ? 1000 - idle_permille : 0;
+    }
+}
+
+void lvgl_flush_reset_stats(void)
+{
+    uint32_t idle[portNUM_PROCESSORS];
+    uint32_t total = 0;
+
+    lvgl_flush_run_time(idle, &total);
+    portENTER_CRITICAL(&stats_lock);
+    flush_stats = (lvgl_flush_stats_t){0};
+    stats_start = esp_timer_get_time();
+    memcpy(idle_start, idle, sizeof(idle_start));
+    run_time_start = total;
+    portEXIT_CRITICAL(&stats_lock);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "esp_err.h"
+#include "lvgl.h"
+#include "freertos/FreeRTOS.h"
+
+typedef struct
+{
+    uint8_t task_priority;
+    uint32_t task_stack;
+    int task_core;
+    uint32_t max_sleep_ms; /*!< upper bound on a sleep with nothing scheduled, 0 sleeps until an event */
+} lvgl_sched_config_t;
+
+typedef struct
+{
+    uint32_t wakes;
+    uint32_t event_wakes; /*!< woken by an unlock or lvgl_sched_wake, the rest are LVGL timer deadlines */
+    uint64_t busy_us;     /*!< time spent in lv_timer_handler */
+    uint64_t elapsed_us;
+    uint32_t wakes_per_sec;
+    uint32_t us_per_wake;
+} lvgl_sched_stats_t;
+
+/**
+ * @brief start the LVGL task, it sleeps until the next LVGL timer is due or it is woken
+ *
+ * Replaces esp_lvgl_port's task and tick timer: the tick is caught up from esp_timer on every
+ * wake and lock, so nothing runs periodically while the screen is static.
+ *
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t lvgl_sched_init(lvgl_sched_config_t config);
+
+/**
+ * @brief take the LVGL lock, required for any LVGL call outside the LVGL task
+ *
+ * @param timeout_ms 0 waits forever
+ * @return true locked
+ */
+bool lvgl_sched_lock(uint32_t timeout_ms);
+
+/**
+ * @brief release the LVGL lock and wake the LVGL task to handle whatever was changed
+ */
+void lvgl_sched_unlock(void);
+
+/**
+ * @brief wake the LVGL task, e.g. from an input driver when new data is ready
+ */
+void lvgl_sched_wake(void);
+
+/**
+ * @brief wake the LVGL task from an ISR
+ */
+void lvgl_sched_wake_from_isr(void);
+
+/**
+ * @brief get scheduler counters
+ *
+ * @param stats
+ */
+void lvgl_sched_get_stats(lvgl_sched_stats_t *stats);
+
+/**
+ * @brief clear scheduler counters and restart the measuring window
+ */
+void lvgl_sched_reset_stats(void);
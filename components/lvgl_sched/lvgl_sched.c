@@ -0,0 +1,146 @@
+#include "lvgl_sched.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "LVGL_SCHED";
+
+static lvgl_sched_config_t sched_cfg;
+static lvgl_sched_stats_t sched_stats;
+static SemaphoreHandle_t lvgl_mux = NULL;
+static TaskHandle_t lvgl_task = NULL;
+static int64_t tick_us = 0; /*!< esp_timer time LVGL's tick was last brought up to */
+static int64_t stats_start = 0;
+
+/**
+ * @brief advance the LVGL tick by the whole milliseconds since the last call, the lock must be held
+ */
+static void lvgl_sched_tick(void)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t ms = (now - tick_us) / 1000;
+
+    if (ms)
+    {
+        lv_tick_inc(ms);
+        tick_us += ms * 1000LL;
+    }
+}
+
+static void lvgl_sched_task(void *arg)
+{
+    TickType_t sleep = 0;
+
+    while (1)
+    {
+        /*!< a notification means an unlock or a wake, a timeout means a timer is due */
+        if (ulTaskNotifyTake(pdTRUE, sleep))
+        {
+            sched_stats.event_wakes++;
+        }
+        sched_stats.wakes++;
+
+        xSemaphoreTakeRecursive(lvgl_mux, portMAX_DELAY);
+        int64_t start = esp_timer_get_time();
+        lvgl_sched_tick();
+        uint32_t next_ms = lv_timer_handler();
+        sched_stats.busy_us += esp_timer_get_time() - start;
+        xSemaphoreGiveRecursive(lvgl_mux);
+
+        if (next_ms == LV_NO_TIMER_READY)
+        {
+            sleep = sched_cfg.max_sleep_ms ? pdMS_TO_TICKS(sched_cfg.max_sleep_ms) : portMAX_DELAY;
+            continue;
+        }
+        if (sched_cfg.max_sleep_ms && next_ms > sched_cfg.max_sleep_ms)
+        {
+            next_ms = sched_cfg.max_sleep_ms;
+        }
+        /*!< round up, a wake before the deadline only finds nothing to do */
+        sleep = pdMS_TO_TICKS(next_ms + portTICK_PERIOD_MS - 1);
+        if (sleep == 0)
+        {
+            sleep = 1;
+        }
+    }
+}
+
+esp_err_t lvgl_sched_init(lvgl_sched_config_t config)
+{
+    ESP_RETURN_ON_FALSE(lvgl_task == NULL, ESP_ERR_INVALID_STATE, TAG, "Already initialized");
+    sched_cfg = config;
+
+    lv_init();
+    lvgl_mux = xSemaphoreCreateRecursiveMutex();
+    ESP_RETURN_ON_FALSE(lvgl_mux, ESP_ERR_NO_MEM, TAG, "Mutex create failed");
+    tick_us = esp_timer_get_time();
+    stats_start = tick_us;
+
+    if (xTaskCreatePinnedToCore(lvgl_sched_task, "lvgl", config.task_stack, NULL, config.task_priority, &lvgl_task, config.task_core) != pdPASS)
+    {
+        vSemaphoreDelete(lvgl_mux);
+        lvgl_mux = NULL;
+        ESP_LOGE(TAG, "LVGL task create failed");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "LVGL task on core %d, max sleep %lu ms", config.task_core, (unsigned long)config.max_sleep_ms);
+
+    return ESP_OK;
+}
+
+bool lvgl_sched_lock(uint32_t timeout_ms)
+{
+    TickType_t ticks = timeout_ms ? pdMS_TO_TICKS(timeout_ms) : portMAX_DELAY;
+    if (xSemaphoreTakeRecursive(lvgl_mux, ticks) != pdTRUE)
+    {
+        return false;
+    }
+    /*!< animations started under the lock read the tick, it must not be as old as the last sleep */
+    lvgl_sched_tick();
+
+    return true;
+}
+
+void lvgl_sched_unlock(void)
+{
+    xSemaphoreGiveRecursive(lvgl_mux);
+    /*!< the caller may have invalidated something or started a timer, let the task pick it up */
+    if (xTaskGetCurrentTaskHandle() != lvgl_task)
+    {
+        xTaskNotifyGive(lvgl_task);
+    }
+}
+
+void lvgl_sched_wake(void)
+{
+    xTaskNotifyGive(lvgl_task);
+}
+
+void lvgl_sched_wake_from_isr(void)
+{
+    BaseType_t need_yield = pdFALSE;
+    vTaskNotifyGiveFromISR(lvgl_task, &need_yield);
+    portYIELD_FROM_ISR(need_yield);
+}
+
+void lvgl_sched_get_stats(lvgl_sched_stats_t *stats)
+{
+    *stats = sched_stats;
+    stats->elapsed_us = esp_timer_get_time() - stats_start;
+    if (stats->elapsed_us)
+    {
+        stats->wakes_per_sec = (uint64_t)stats->wakes * 1000000 / stats->elapsed_us;
+    }
+    if (stats->wakes)
+    {
+        stats->us_per_wake = stats->busy_us / stats->wakes;
+    }
+}
+
+void lvgl_sched_reset_stats(void)
+{
+    sched_stats = (lvgl_sched_stats_t){0};
+    stats_start = esp_timer_get_time();
+}
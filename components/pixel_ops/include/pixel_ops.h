@@ -0,0 +1,197 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * RGB565 pixel kernels. Copy style kernels move two pixels per 32 bit word
+ * when the buffers are word aligned and fall back to one pixel at a time
+ * otherwise; rotation walks 16x16 tiles to stay in cache. On the ESP32-S3
+ * swap_bytes, fill, blend, mirror_h and rotate90 go through the PIE vector
+ * unit, the _scalar versions are the reference they are checked against.
+ * mirror_h and rotate90 need 16 byte aligned buffers and sides that are a
+ * multiple of 8 for that, they stay scalar otherwise.
+ */
+
+/**
+ * @brief swap the two bytes of every pixel, dst may equal src
+ *
+ * @param dst
+ * @param src
+ * @param count pixels
+ */
+void pixel_ops_swap_bytes(uint16_t *dst, const uint16_t *src, size_t count);
+
+/**
+ * @brief pixel_ops_swap_bytes without the vector path
+ *
+ * @param dst
+ * @param src
+ * @param count pixels
+ */
+void pixel_ops_swap_bytes_scalar(uint16_t *dst, const uint16_t *src, size_t count);
+
+/**
+ * @brief mirror an image left to right in place
+ *
+ * @param buf
+ * @param width
+ * @param height
+ */
+void pixel_ops_mirror_h(uint16_t *buf, uint16_t width, uint16_t height);
+
+/**
+ * @brief pixel_ops_mirror_h without the vector path
+ *
+ * @param buf
+ * @param width
+ * @param height
+ */
+void pixel_ops_mirror_h_scalar(uint16_t *buf, uint16_t width, uint16_t height);
+
+/**
+ * @brief mirror an image top to bottom in place
+ *
+ * @param buf
+ * @param width
+ * @param height
+ */
+void pixel_ops_mirror_v(uint16_t *buf, uint16_t width, uint16_t height);
+
+/**
+ * @brief rotate by 90 degrees, dst is height pixels wide and width pixels high
+ *
+ * @param dst must not overlap src
+ * @param src
+ * @param width of src
+ * @param height of src
+ * @param clockwise
+ */
+void pixel_ops_rotate90(uint16_t *dst, const uint16_t *src, uint16_t width, uint16_t height, bool clockwise);
+
+/**
+ * @brief pixel_ops_rotate90 without the vector path
+ *
+ * @param dst must not overlap src
+ * @param src
+ * @param width of src
+ * @param height of src
+ * @param clockwise
+ */
+void pixel_ops_rotate90_scalar(uint16_t *dst, const uint16_t *src, uint16_t width, uint16_t height, bool clockwise);
+
+/**
+ * @brief rotate by 180 degrees, i.e. reverse the pixel order of the whole image
+ *
+ * @param dst must not overlap src
+ * @param src
+ * @param count pixels
+ */
+void pixel_ops_rotate180(uint16_t *dst, const uint16_t *src, size_t count);
+
+/**
+ * @brief dst = src * alpha + dst * (255 - alpha), pixels in native byte order
+ *
+ * @param dst
+ * @param src
+ * @param count pixels
+ * @param alpha 0-255
+ */
+void pixel_ops_blend(uint16_t *dst, const uint16_t *src, size_t count, uint8_t alpha);
+
+/**
+ * @brief pixel_ops_blend without the vector path
+ *
+ * @param dst
+ * @param src
+ * @param count pixels
+ * @param alpha 0-255
+ */
+void pixel_ops_blend_scalar(uint16_t *dst, const uint16_t *src, size_t count, uint8_t alpha);
+
+/**
+ * @brief fill count pixels with color
+ *
+ * @param dst
+ * @param color
+ * @param count
+ */
+void pixel_ops_fill(uint16_t *dst, uint16_t color, size_t count);
+
+/**
+ * @brief pixel_ops_fill without the vector path
+ *
+ * @param dst
+ * @param color
+ * @param count
+ */
+void pixel_ops_fill_scalar(uint16_t *dst, uint16_t color, size_t count);
+
+typedef enum
+{
+    PIXEL_OPS_SCALE_NEAREST,
+    PIXEL_OPS_SCALE_BILINEAR,
+} pixel_ops_scale_mode_t;
+
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+} pixel_ops_rect_t;
+
+typedef struct
+{
+    const uint16_t *src;
+    uint16_t src_stride;   /*!< pixels per source row */
+    pixel_ops_rect_t crop; /*!< source area mapped onto the whole destination */
+    uint16_t dst_width;
+    uint16_t dst_height;
+    pixel_ops_scale_mode_t mode;
+    bool swapped;        /*!< pixels are byte swapped, as sent to the panel */
+    uint16_t *col_x;     /*!< set by pixel_ops_scale_init, source column of every destination column */
+    uint8_t *col_weight; /*!< set by pixel_ops_scale_init, bilinear weight of the next source column, 0-31 */
+} pixel_ops_scale_t;
+
+/**
+ * @brief largest centred crop of a src_width x src_height image with the aspect ratio of dst
+ *
+ * @param src_width
+ * @param src_height
+ * @param dst_width
+ * @param dst_height
+ * @return pixel_ops_rect_t
+ */
+pixel_ops_rect_t pixel_ops_crop_to_fill(uint16_t src_width, uint16_t src_height, uint16_t dst_width, uint16_t dst_height);
+
+/**
+ * @brief check a scale config and build its column tables
+ *
+ * The tables depend on crop, dst_width and mode only, src may change between calls
+ * to pixel_ops_scale_rows. Call pixel_ops_scale_deinit before changing anything else.
+ *
+ * @param scale
+ * @return esp_err_t ESP_ERR_INVALID_ARG for an empty crop or destination, or a crop wider than src_stride
+ */
+esp_err_t pixel_ops_scale_init(pixel_ops_scale_t *scale);
+
+/**
+ * @brief free the column tables
+ *
+ * @param scale
+ */
+void pixel_ops_scale_deinit(pixel_ops_scale_t *scale);
+
+/**
+ * @brief resample destination rows [y1, y2) into dst, using 16.16 fixed point source steps
+ *
+ * @param scale initialized with pixel_ops_scale_init
+ * @param dst dst_width pixels per row, holds y2 - y1 rows
+ * @param y1
+ * @param y2
+ * @return esp_err_t ESP_ERR_INVALID_STATE if the tables were not built, ESP_ERR_INVALID_ARG for rows outside dst_height
+ */
+esp_err_t pixel_ops_scale_rows(const pixel_ops_scale_t *scale, uint16_t *dst, uint16_t y1, uint16_t y2);
@@ -0,0 +1,315 @@
+#include "pixel_ops.h"
+#include "sdkconfig.h"
+
+#define PIXEL_OPS_BLOCK 16 /*!< 16x16 pixel tiles keep both rotate source and destination rows in cache */
+#define PIXEL_OPS_BLEND_MASK 0x07E0F81F
+
+#define pixel_ops_aligned(p) ((((uintptr_t)(p)) & 0x3) == 0)
+#define pixel_ops_swap16(hex) ((uint16_t)((((hex) & 0xFF) << 8) | (((hex) >> 8) & 0xFF)))
+#define pixel_ops_swap32(w) ((((w) & 0x00FF00FF) << 8) | (((w) >> 8) & 0x00FF00FF))
+#define pixel_ops_rot16(w) (((w) << 16) | ((w) >> 16))
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#define PIXEL_OPS_PIE 1
+#define PIXEL_OPS_PIE_BLOCK 16 /*!< pixels per iteration of the vector loops, two Q registers */
+#define PIXEL_OPS_PIE_TILE 8   /*!< pixels per Q register, the transpose and mirror unit */
+#define pixel_ops_aligned16(p) ((((uintptr_t)(p)) & 0xF) == 0)
+
+/*!< pixel_ops_s3.S, whole blocks only, buffers 16 byte aligned */
+void pixel_ops_s3_swap_bytes(uint16_t *dst, const uint16_t *src, size_t blocks);
+void pixel_ops_s3_fill(uint16_t *dst, const uint16_t *color, size_t blocks);
+void pixel_ops_s3_blend(uint16_t *dst, const uint16_t *src, size_t blocks, const uint16_t *param);
+/*!< 8 pixel blocks, rows 16 byte aligned */
+void pixel_ops_s3_mirror_row(uint16_t *row, size_t blocks);
+void pixel_ops_s3_transpose(uint16_t *dst, int dst_stride, const uint16_t *src, int src_stride);
+
+/**
+ * @brief pixels to handle one by one before dst reaches a 16 byte boundary
+ */
+static inline size_t pixel_ops_pie_head(const uint16_t *dst, size_t count)
+{
+    size_t head = ((16 - ((uintptr_t)dst & 0xF)) & 0xF) / sizeof(uint16_t);
+    return head < count ? head : count;
+}
+#else
+#define PIXEL_OPS_PIE 0
+#endif
+
+void pixel_ops_swap_bytes_scalar(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    /*!< word access needs src and dst on the same alignment */
+    if (((uintptr_t)dst & 0x3) == ((uintptr_t)src & 0x3))
+    {
+        if (count && !pixel_ops_aligned(dst))
+        {
+            *dst++ = pixel_ops_swap16(*src);
+            src++;
+            count--;
+        }
+        uint32_t *d = (uint32_t *)dst;
+        const uint32_t *s = (const uint32_t *)src;
+        for (size_t i = 0; i < count / 2; i++)
+        {
+            d[i] = pixel_ops_swap32(s[i]);
+        }
+        dst += count & ~1;
+        src += count & ~1;
+        count &= 1;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = pixel_ops_swap16(src[i]);
+    }
+}
+
+void pixel_ops_swap_bytes(uint16_t *dst, const uint16_t *src, size_t count)
+{
+#if PIXEL_OPS_PIE
+    /*!< the vector loads need src and dst on the same 16 byte alignment */
+    if (count >= 2 * PIXEL_OPS_PIE_BLOCK && (((uintptr_t)dst ^ (uintptr_t)src) & 0xF) == 0 && ((uintptr_t)dst & 0x1) == 0)
+    {
+        size_t head = pixel_ops_pie_head(dst, count);
+        pixel_ops_swap_bytes_scalar(dst, src, head);
+        size_t blocks = (count - head) / PIXEL_OPS_PIE_BLOCK;
+        pixel_ops_s3_swap_bytes(dst + head, src + head, blocks);
+        size_t done = head + blocks * PIXEL_OPS_PIE_BLOCK;
+        pixel_ops_swap_bytes_scalar(dst + done, src + done, count - done);
+        return;
+    }
+#endif
+    pixel_ops_swap_bytes_scalar(dst, src, count);
+}
+
+void pixel_ops_mirror_h_scalar(uint16_t *buf, uint16_t width, uint16_t height)
+{
+    for (uint16_t y = 0; y < height; y++)
+    {
+        uint16_t *row = buf + y * width;
+        if (width % 2 == 0 && pixel_ops_aligned(row))
+        {
+            /*!< swap words end to end and exchange the two pixels inside each word */
+            uint32_t *w = (uint32_t *)row;
+            uint16_t n = width / 2;
+            for (uint16_t i = 0; i < n / 2; i++)
+            {
+                uint32_t l = w[i];
+                uint32_t r = w[n - 1 - i];
+                w[i] = pixel_ops_rot16(r);
+                w[n - 1 - i] = pixel_ops_rot16(l);
+            }
+            if (n % 2)
+            {
+                w[n / 2] = pixel_ops_rot16(w[n / 2]);
+            }
+            continue;
+        }
+        for (uint16_t i = 0; i < width / 2; i++)
+        {
+            uint16_t t = row[i];
+            row[i] = row[width - 1 - i];
+            row[width - 1 - i] = t;
+        }
+    }
+}
+
+void pixel_ops_mirror_h(uint16_t *buf, uint16_t width, uint16_t height)
+{
+#if PIXEL_OPS_PIE
+    /*!< every row starts 16 byte aligned and is whole registers */
+    if (width % PIXEL_OPS_PIE_TILE == 0 && pixel_ops_aligned16(buf))
+    {
+        for (uint16_t y = 0; y < height; y++)
+        {
+            pixel_ops_s3_mirror_row(buf + y * width, width / PIXEL_OPS_PIE_TILE);
+        }
+        return;
+    }
+#endif
+    pixel_ops_mirror_h_scalar(buf, width, height);
+}
+
+void pixel_ops_mirror_v(uint16_t *buf, uint16_t width, uint16_t height)
+{
+    for (uint16_t y = 0; y < height / 2; y++)
+    {
+        uint16_t *top = buf + y * width;
+        uint16_t *bottom = buf + (height - 1 - y) * width;
+        uint16_t x = 0;
+        if (width % 2 == 0 && pixel_ops_aligned(top) && pixel_ops_aligned(bottom))
+        {
+            uint32_t *t = (uint32_t *)top;
+            uint32_t *b = (uint32_t *)bottom;
+            for (; x < width / 2; x++)
+            {
+                uint32_t w = t[x];
+                t[x] = b[x];
+                b[x] = w;
+            }
+            continue;
+        }
+        for (; x < width; x++)
+        {
+            uint16_t p = top[x];
+            top[x] = bottom[x];
+            bottom[x] = p;
+        }
+    }
+}
+
+void pixel_ops_rotate90_scalar(uint16_t *dst, const uint16_t *src, uint16_t width, uint16_t height, bool clockwise)
+{
+    for (uint16_t by = 0; by < height; by += PIXEL_OPS_BLOCK)
+    {
+        uint16_t ey = (by + PIXEL_OPS_BLOCK < height) ? by + PIXEL_OPS_BLOCK : height;
+        for (uint16_t bx = 0; bx < width; bx += PIXEL_OPS_BLOCK)
+        {
+            uint16_t ex = (bx + PIXEL_OPS_BLOCK < width) ? bx + PIXEL_OPS_BLOCK : width;
+            for (uint16_t y = by; y < ey; y++)
+            {
+                const uint16_t *s = src + y * width;
+                if (clockwise)
+                {
+                    for (uint16_t x = bx; x < ex; x++)
+                    {
+                        dst[x * height + (height - 1 - y)] = s[x];
+                    }
+                }
+                else
+                {
+                    for (uint16_t x = bx; x < ex; x++)
+                    {
+                        dst[(width - 1 - x) * height + y] = s[x];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void pixel_ops_rotate90(uint16_t *dst, const uint16_t *src, uint16_t width, uint16_t height, bool clockwise)
+{
+#if PIXEL_OPS_PIE
+    /*!< 8x8 tiles, every source and destination tile row 16 byte aligned */
+    if (width % PIXEL_OPS_PIE_TILE == 0 && height % PIXEL_OPS_PIE_TILE == 0 && pixel_ops_aligned16(src) && pixel_ops_aligned16(dst))
+    {
+        int src_stride = width * sizeof(uint16_t);
+        int dst_stride = height * sizeof(uint16_t);
+        for (uint16_t by = 0; by < height; by += PIXEL_OPS_BLOCK)
+        {
+            uint16_t ey = (by + PIXEL_OPS_BLOCK < height) ? by + PIXEL_OPS_BLOCK : height;
+            for (uint16_t bx = 0; bx < width; bx += PIXEL_OPS_BLOCK)
+            {
+                uint16_t ex = (bx + PIXEL_OPS_BLOCK < width) ? bx + PIXEL_OPS_BLOCK : width;
+                for (uint16_t y = by; y < ey; y += PIXEL_OPS_PIE_TILE)
+                {
+                    for (uint16_t x = bx; x < ex; x += PIXEL_OPS_PIE_TILE)
+                    {
+                        if (clockwise)
+                        {
+                            /*!< source rows bottom up, column x becomes destination row x read from the right */
+                            pixel_ops_s3_transpose(dst + x * height + (height - PIXEL_OPS_PIE_TILE - y), dst_stride,
+                                                   src + (y + PIXEL_OPS_PIE_TILE - 1) * width + x, -src_stride);
+                        }
+                        else
+                        {
+                            /*!< column x becomes destination row width - 1 - x, written bottom up */
+                            pixel_ops_s3_transpose(dst + (width - 1 - x) * height + y, -dst_stride, src + y * width + x, src_stride);
+                        }
+                    }
+                }
+            }
+        }
+        return;
+    }
+#endif
+    pixel_ops_rotate90_scalar(dst, src, width, height, clockwise);
+}
+
+void pixel_ops_rotate180(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    /*!< the last source word is the first destination word with its two pixels exchanged */
+    if (count % 2 == 0 && pixel_ops_aligned(dst) && pixel_ops_aligned(src))
+    {
+        uint32_t *d = (uint32_t *)dst;
+        const uint32_t *w = (const uint32_t *)src;
+        size_t n = count / 2;
+        for (size_t i = 0; i < n; i++)
+        {
+            d[i] = pixel_ops_rot16(w[n - 1 - i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = src[count - 1 - i];
+    }
+}
+
+void pixel_ops_blend_scalar(uint16_t *dst, const uint16_t *src, size_t count, uint8_t alpha)
+{
+    /*!< spread r, g and b apart so one multiply blends all three channels */
+    uint32_t a = (alpha + 4) >> 3;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t fg = (src[i] | ((uint32_t)src[i] << 16)) & PIXEL_OPS_BLEND_MASK;
+        uint32_t bg = (dst[i] | ((uint32_t)dst[i] << 16)) & PIXEL_OPS_BLEND_MASK;
+        uint32_t result = ((((fg - bg) * a) >> 5) + bg) & PIXEL_OPS_BLEND_MASK;
+        dst[i] = (uint16_t)((result >> 16) | result);
+    }
+}
+
+void pixel_ops_blend(uint16_t *dst, const uint16_t *src, size_t count, uint8_t alpha)
+{
+#if PIXEL_OPS_PIE
+    if (count >= 2 * PIXEL_OPS_PIE_BLOCK && (((uintptr_t)dst ^ (uintptr_t)src) & 0xF) == 0 && ((uintptr_t)dst & 0x1) == 0)
+    {
+        /*!< the same weight and channel masks as the scalar version, broadcast by the kernel */
+        const uint16_t param[4] = {(alpha + 4) >> 3, 0x001F, 0x07E0, 0x7C00};
+        size_t head = pixel_ops_pie_head(dst, count);
+        pixel_ops_blend_scalar(dst, src, head, alpha);
+        size_t blocks = (count - head) / PIXEL_OPS_PIE_BLOCK;
+        pixel_ops_s3_blend(dst + head, src + head, blocks, param);
+        size_t done = head + blocks * PIXEL_OPS_PIE_BLOCK;
+        pixel_ops_blend_scalar(dst + done, src + done, count - done, alpha);
+        return;
+    }
+#endif
+    pixel_ops_blend_scalar(dst, src, count, alpha);
+}
+
+void pixel_ops_fill_scalar(uint16_t *dst, uint16_t color, size_t count)
+{
+    if (count && !pixel_ops_aligned(dst))
+    {
+        *dst++ = color;
+        count--;
+    }
+    uint32_t *d = (uint32_t *)dst;
+    uint32_t pair = ((uint32_t)color << 16) | color;
+    for (size_t i = 0; i < count / 2; i++)
+    {
+        d[i] = pair;
+    }
+    if (count & 1)
+    {
+        dst[count - 1] = color;
+    }
+}
+
+void pixel_ops_fill(uint16_t *dst, uint16_t color, size_t count)
+{
+#if PIXEL_OPS_PIE
+    if (count >= 2 * PIXEL_OPS_PIE_BLOCK && ((uintptr_t)dst & 0x1) == 0)
+    {
+        size_t head = pixel_ops_pie_head(dst, count);
+        pixel_ops_fill_scalar(dst, color, head);
+        size_t blocks = (count - head) / PIXEL_OPS_PIE_BLOCK;
+        pixel_ops_s3_fill(dst + head, &color, blocks);
+        size_t done = head + blocks * PIXEL_OPS_PIE_BLOCK;
+        pixel_ops_fill_scalar(dst + done, color, count - done);
+        return;
+    }
+#endif
+    pixel_ops_fill_scalar(dst, color, count);
+}
@@ -0,0 +1,160 @@
+#include "pixel_ops.h"
+#include "stdlib.h"
+
+#define PIXEL_OPS_SPREAD_MASK 0x07E0F81F
+
+#define pixel_ops_swap16(hex) ((uint16_t)((((hex) & 0xFF) << 8) | (((hex) >> 8) & 0xFF)))
+
+static inline uint32_t pixel_ops_spread(uint16_t c)
+{
+    return (c | ((uint32_t)c << 16)) & PIXEL_OPS_SPREAD_MASK;
+}
+
+static inline uint32_t pixel_ops_lerp(uint32_t a, uint32_t b, uint32_t w)
+{
+    return ((((b - a) * w) >> 5) + a) & PIXEL_OPS_SPREAD_MASK;
+}
+
+static inline uint16_t pixel_ops_read(const pixel_ops_scale_t *scale, const uint16_t *p)
+{
+    return scale->swapped ? pixel_ops_swap16(*p) : *p;
+}
+
+/**
+ * @brief source position of the centre of destination pixel i, 16.16 fixed point
+ */
+static inline int32_t pixel_ops_center(uint32_t step, uint16_t i)
+{
+    int32_t pos = (int32_t)(i * step + step / 2) - (1 << 15);
+    return pos < 0 ? 0 : pos;
+}
+
+pixel_ops_rect_t pixel_ops_crop_to_fill(uint16_t src_width, uint16_t src_height, uint16_t dst_width, uint16_t dst_height)
+{
+    pixel_ops_rect_t crop = {
+        .x = 0,
+        .y = 0,
+        .width = src_width,
+        .height = src_height,
+    };
+
+    if ((uint32_t)src_width * dst_height > (uint32_t)src_height * dst_width)
+    {
+        crop.width = (uint32_t)src_height * dst_width / dst_height;
+        crop.x = (src_width - crop.width) / 2;
+    }
+    else
+    {
+        crop.height = (uint32_t)src_width * dst_height / dst_width;
+        crop.y = (src_height - crop.height) / 2;
+    }
+    return crop;
+}
+
+esp_err_t pixel_ops_scale_init(pixel_ops_scale_t *scale)
+{
+    if (scale->dst_width == 0 || scale->dst_height == 0 || scale->crop.width == 0 || scale->crop.height == 0 ||
+        scale->crop.x + scale->crop.width > scale->src_stride)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    scale->col_x = malloc(scale->dst_width * sizeof(uint16_t));
+    scale->col_weight = scale->mode == PIXEL_OPS_SCALE_BILINEAR ? malloc(scale->dst_width) : NULL;
+    if (scale->col_x == NULL || (scale->mode == PIXEL_OPS_SCALE_BILINEAR && scale->col_weight == NULL))
+    {
+        pixel_ops_scale_deinit(scale);
+        return ESP_ERR_NO_MEM;
+    }
+
+    /*!< the source column of every destination column only depends on the crop and the width */
+    uint32_t x_step = ((uint32_t)scale->crop.width << 16) / scale->dst_width;
+    for (uint16_t x = 0; x < scale->dst_width; x++)
+    {
+        if (scale->mode == PIXEL_OPS_SCALE_BILINEAR)
+        {
+            int32_t pos = pixel_ops_center(x_step, x);
+            scale->col_x[x] = scale->crop.x + (pos >> 16);
+            scale->col_weight[x] = (pos >> 11) & 0x1F;
+        }
+        else
+        {
+            scale->col_x[x] = scale->crop.x + ((x * x_step + x_step / 2) >> 16);
+        }
+    }
+    return ESP_OK;
+}
+
+void pixel_ops_scale_deinit(pixel_ops_scale_t *scale)
+{
+    free(scale->col_x);
+    free(scale->col_weight);
+    scale->col_x = NULL;
+    scale->col_weight = NULL;
+}
+
+static void pixel_ops_scale_nearest(const pixel_ops_scale_t *scale, uint16_t *dst, uint16_t y1, uint16_t y2)
+{
+    uint32_t y_step = ((uint32_t)scale->crop.height << 16) / scale->dst_height;
+    const uint16_t *sx = scale->col_x;
+
+    for (uint16_t y = y1; y < y2; y++)
+    {
+        uint16_t sy = scale->crop.y + ((y * y_step + y_step / 2) >> 16);
+        const uint16_t *row = scale->src + sy * scale->src_stride;
+        /*!< byte order is preserved, no swap needed */
+        for (uint16_t x = 0; x < scale->dst_width; x++)
+        {
+            *dst++ = row[sx[x]];
+        }
+    }
+}
+
+static void pixel_ops_scale_bilinear(const pixel_ops_scale_t *scale, uint16_t *dst, uint16_t y1, uint16_t y2)
+{
+    uint32_t y_step = ((uint32_t)scale->crop.height << 16) / scale->dst_height;
+    const uint16_t *sx = scale->col_x;
+    const uint8_t *fx = scale->col_weight;
+    uint16_t last_x = scale->crop.x + scale->crop.width - 1;
+    uint16_t last_y = scale->crop.y + scale->crop.height - 1;
+
+    for (uint16_t y = y1; y < y2; y++)
+    {
+        int32_t pos = pixel_ops_center(y_step, y);
+        uint16_t sy = scale->crop.y + (pos >> 16);
+        uint32_t fy = (pos >> 11) & 0x1F;
+        const uint16_t *r0 = scale->src + sy * scale->src_stride;
+        const uint16_t *r1 = scale->src + (sy < last_y ? sy + 1 : sy) * scale->src_stride;
+
+        for (uint16_t x = 0; x < scale->dst_width; x++)
+        {
+            uint16_t x0 = sx[x];
+            uint16_t x1 = x0 < last_x ? x0 + 1 : x0;
+            uint32_t top = pixel_ops_lerp(pixel_ops_spread(pixel_ops_read(scale, r0 + x0)), pixel_ops_spread(pixel_ops_read(scale, r0 + x1)), fx[x]);
+            uint32_t bottom = pixel_ops_lerp(pixel_ops_spread(pixel_ops_read(scale, r1 + x0)), pixel_ops_spread(pixel_ops_read(scale, r1 + x1)), fx[x]);
+            uint32_t v = pixel_ops_lerp(top, bottom, fy);
+            uint16_t c = (uint16_t)((v >> 16) | v);
+            *dst++ = scale->swapped ? pixel_ops_swap16(c) : c;
+        }
+    }
+}
+
+esp_err_t pixel_ops_scale_rows(const pixel_ops_scale_t *scale, uint16_t *dst, uint16_t y1, uint16_t y2)
+{
+    if (scale->col_x == NULL || (scale->mode == PIXEL_OPS_SCALE_BILINEAR && scale->col_weight == NULL))
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (scale->src == NULL || y1 > y2 || y2 > scale->dst_height)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (scale->mode == PIXEL_OPS_SCALE_BILINEAR)
+    {
+        pixel_ops_scale_bilinear(scale, dst, y1, y2);
+    }
+    else
+    {
+        pixel_ops_scale_nearest(scale, dst, y1, y2);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+#define SD_BUS_SECTOR_SIZE 512
+
+typedef struct
+{
+    uint32_t freq_khz;
+    uint8_t width; /*!< data lines, 1 or 4 */
+} sd_bus_mode_t;
+
+/**
+ * @brief what the negotiation needs from the host driver, sd_card has the SDMMC one
+ */
+typedef struct
+{
+    esp_err_t (*attach)(void *ctx, sd_bus_mode_t *mode, uint32_t *card_id); /*!< host and card up in mode, freq_khz is lowered to what the card took */
+    esp_err_t (*read)(void *ctx, uint32_t sector, void *buf, uint32_t count);
+    esp_err_t (*write)(void *ctx, uint32_t sector, const void *buf, uint32_t count);
+    void (*detach)(void *ctx);
+} sd_bus_driver_t;
+
+typedef struct
+{
+    const sd_bus_mode_t *modes;  /*!< fastest first, the first one that passes is taken */
+    size_t mode_count;
+    uint32_t scratch_sector;     /*!< the pattern is written here, nothing of value may live there */
+    uint32_t scratch_sectors;
+    uint32_t rounds;             /*!< write and read back the scratch area this often per mode */
+} sd_bus_probe_config_t;
+
+typedef enum
+{
+    SD_BUS_STAGE_ATTACH,
+    SD_BUS_STAGE_WRITE,
+    SD_BUS_STAGE_READ,
+    SD_BUS_STAGE_VERIFY,
+    SD_BUS_STAGE_DONE, /*!< the mode passed */
+} sd_bus_stage_t;
+
+typedef struct
+{
+    sd_bus_mode_t mode;
+    sd_bus_stage_t stage; /*!< reached, where it failed unless SD_BUS_STAGE_DONE */
+    esp_err_t err;        /*!< ESP_ERR_INVALID_CRC, ESP_ERR_TIMEOUT, ... from the driver */
+    uint32_t bad_sectors; /*!< read back without an error but different */
+    uint32_t read_kb_per_sec;
+    uint32_t write_kb_per_sec;
+} sd_bus_probe_result_t;
+
+/**
+ * @brief the negotiated mode, stored in NVS
+ */
+typedef struct
+{
+    sd_bus_mode_t mode;
+    uint32_t card_id; /*!< a different card is probed again */
+    uint32_t read_kb_per_sec;
+    uint32_t write_kb_per_sec;
+} sd_bus_params_t;
+
+/**
+ * @brief called after every mode tried, e.g. to log or plot the fallbacks
+ */
+typedef void (*sd_bus_probe_cb_t)(const sd_bus_probe_result_t *result, void *user_ctx);
+
+/**
+ * @brief try the modes in order until one writes and reads back the scratch area cleanly
+ *
+ * The card is attached and detached for every mode. A CRC error, a timeout or a sector
+ * that reads back different moves on to the next mode.
+ *
+ * @param driver
+ * @param ctx passed to the driver
+ * @param config
+ * @param cb may be NULL
+ * @param user_ctx
+ * @param best the chosen mode with its measured speed
+ * @return esp_err_t ESP_ERR_NOT_FOUND if no mode passed
+ */
+esp_err_t sd_bus_negotiate(const sd_bus_driver_t *driver, void *ctx, const sd_bus_probe_config_t *config, sd_bus_probe_cb_t cb, void *user_ctx, sd_bus_params_t *best);
+
+/**
+ * @brief read the negotiated mode, nvs_flash_init must have been called
+ *
+ * @param params
+ * @return esp_err_t ESP_ERR_NOT_FOUND if no card was negotiated yet
+ */
+esp_err_t sd_bus_params_load(sd_bus_params_t *params);
+
+/**
+ * @brief store the negotiated mode for the next boot
+ *
+ * @param params
+ * @return esp_err_t
+ */
+esp_err_t sd_bus_params_save(const sd_bus_params_t *params);
@@ -0,0 +1,186 @@
+#include "sd_bus.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "string.h"
+
+#define SD_BUS_NVS_NAMESPACE "sd"
+#define SD_BUS_NVS_KEY_BUS "bus"
+#define SD_BUS_ALIGN 64
+
+static const char *TAG = "SD_BUS";
+
+/**
+ * @brief differs per mode and round, so data left over from an earlier try never passes
+ */
+static inline uint32_t sd_bus_pattern(uint32_t index, uint32_t seed)
+{
+    return (index * 2654435761u) ^ (seed * 0x9e3779b9u) ^ 0xa5a5a5a5u;
+}
+
+static uint32_t sd_bus_kb_per_sec(uint64_t bytes, int64_t us)
+{
+    return us > 0 ? bytes * 1000000 / 1024 / us : 0;
+}
+
+/**
+ * @brief one mode through attach, write, read and verify, stops at the first failing stage
+ */
+static void sd_bus_probe(const sd_bus_driver_t *driver, void *ctx, const sd_bus_probe_config_t *config, uint32_t seed, uint32_t *buf, sd_bus_probe_result_t *result,
+                         uint32_t *card_id)
+{
+    uint32_t words = config->scratch_sectors * SD_BUS_SECTOR_SIZE / sizeof(uint32_t);
+    uint64_t bytes = 0;
+    int64_t write_us = 0;
+    int64_t read_us = 0;
+
+    result->stage = SD_BUS_STAGE_ATTACH;
+    result->err = driver->attach(ctx, &result->mode, card_id);
+    if (result->err != ESP_OK)
+    {
+        return;
+    }
+
+    for (uint32_t round = 0; round < config->rounds; round++)
+    {
+        for (uint32_t i = 0; i < words; i++)
+        {
+            buf[i] = sd_bus_pattern(i, seed + round);
+        }
+        result->stage = SD_BUS_STAGE_WRITE;
+        int64_t start = esp_timer_get_time();
+        result->err = driver->write(ctx, config->scratch_sector, buf, config->scratch_sectors);
+        write_us += esp_timer_get_time() - start;
+        if (result->err != ESP_OK)
+        {
+            break;
+        }
+
+        /*!< a failed read must not leave the pattern behind to pass the check */
+        memset(buf, 0, words * sizeof(uint32_t));
+        result->stage = SD_BUS_STAGE_READ;
+        start = esp_timer_get_time();
+        result->err = driver->read(ctx, config->scratch_sector, buf, config->scratch_sectors);
+        read_us += esp_timer_get_time() - start;
+        if (result->err != ESP_OK)
+        {
+            break;
+        }
+
+        result->stage = SD_BUS_STAGE_VERIFY;
+        for (uint32_t s = 0; s < config->scratch_sectors; s++)
+        {
+            uint32_t first = s * SD_BUS_SECTOR_SIZE / sizeof(uint32_t);
+            for (uint32_t i = first; i < first + SD_BUS_SECTOR_SIZE / sizeof(uint32_t); i++)
+            {
+                if (buf[i] != sd_bus_pattern(i, seed + round))
+                {
+                    result->bad_sectors++;
+                    break;
+                }
+            }
+        }
+        if (result->bad_sectors)
+        {
+            result->err = ESP_ERR_INVALID_CRC;
+            break;
+        }
+        bytes += config->scratch_sectors * SD_BUS_SECTOR_SIZE;
+    }
+    driver->detach(ctx);
+
+    if (result->err == ESP_OK)
+    {
+        result->stage = SD_BUS_STAGE_DONE;
+        result->read_kb_per_sec = sd_bus_kb_per_sec(bytes, read_us);
+        result->write_kb_per_sec = sd_bus_kb_per_sec(bytes, write_us);
+    }
+}
+
+esp_err_t sd_bus_negotiate(const sd_bus_driver_t *driver, void *ctx, const sd_bus_probe_config_t *config, sd_bus_probe_cb_t cb, void *user_ctx, sd_bus_params_t *best)
+{
+    static const char *const stage_name[] = {"attach", "write", "read", "verify", "done"};
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    ESP_RETURN_ON_FALSE(driver && config && best && config->modes && config->mode_count && config->scratch_sectors && config->rounds, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid argument");
+
+    /*!< DMA capable, the driver would bounce it sector by sector and the speed would be off */
+    uint32_t *buf = heap_caps_aligned_alloc(SD_BUS_ALIGN, config->scratch_sectors * SD_BUS_SECTOR_SIZE, MALLOC_CAP_DMA);
+    ESP_RETURN_ON_FALSE(buf, ESP_ERR_NO_MEM, TAG, "No mem for %lu scratch sectors", (unsigned long)config->scratch_sectors);
+
+    for (size_t m = 0; m < config->mode_count; m++)
+    {
+        uint32_t card_id = 0;
+        sd_bus_probe_result_t result = {
+            .mode = config->modes[m],
+        };
+
+        sd_bus_probe(driver, ctx, config, m * config->rounds + 1, buf, &result, &card_id);
+        ESP_LOGI(TAG, "%lu kHz %d bit: %s, %s, %lu bad sectors, read %lu KB/s, write %lu KB/s", (unsigned long)result.mode.freq_khz, result.mode.width,
+                 stage_name[result.stage], esp_err_to_name(result.err), (unsigned long)result.bad_sectors, (unsigned long)result.read_kb_per_sec,
+                 (unsigned long)result.write_kb_per_sec);
+        if (cb)
+        {
+            cb(&result, user_ctx);
+        }
+        if (result.stage == SD_BUS_STAGE_DONE)
+        {
+            *best = (sd_bus_params_t){
+                .mode = result.mode,
+                .card_id = card_id,
+                .read_kb_per_sec = result.read_kb_per_sec,
+                .write_kb_per_sec = result.write_kb_per_sec,
+            };
+            ret = ESP_OK;
+            break;
+        }
+    }
+    heap_caps_free(buf);
+    ESP_RETURN_ON_ERROR(ret, TAG, "No mode passed");
+
+    return ESP_OK;
+}
+
+esp_err_t sd_bus_params_load(sd_bus_params_t *params)
+{
+    nvs_handle_t nvs = 0;
+    size_t size = sizeof(sd_bus_params_t);
+    ESP_RETURN_ON_FALSE(params, ESP_ERR_INVALID_ARG, TAG, "Params is NULL");
+
+    esp_err_t ret = nvs_open(SD_BUS_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK)
+    {
+        return (ret == ESP_ERR_NVS_NOT_FOUND) ? ESP_ERR_NOT_FOUND : ret;
+    }
+    ret = nvs_get_blob(nvs, SD_BUS_NVS_KEY_BUS, params, &size);
+    nvs_close(nvs);
+    if (ret == ESP_ERR_NVS_NOT_FOUND)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "Read bus params failed");
+    ESP_RETURN_ON_FALSE(size == sizeof(sd_bus_params_t) && params->mode.freq_khz && (params->mode.width == 1 || params->mode.width == 4), ESP_ERR_INVALID_SIZE, TAG,
+                        "Stored bus params are invalid");
+
+    return ESP_OK;
+}
+
+esp_err_t sd_bus_params_save(const sd_bus_params_t *params)
+{
+    nvs_handle_t nvs = 0;
+    ESP_RETURN_ON_FALSE(params, ESP_ERR_INVALID_ARG, TAG, "Params is NULL");
+
+    ESP_RETURN_ON_ERROR(nvs_open(SD_BUS_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "Open NVS failed");
+    esp_err_t ret = nvs_set_blob(nvs, SD_BUS_NVS_KEY_BUS, params, sizeof(sd_bus_params_t));
+    if (ret == ESP_OK)
+    {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Write bus params failed");
+    ESP_LOGI(TAG, "Saved %lu kHz %d bit for card %08lx", (unsigned long)params->mode.freq_khz, params->mode.width, (unsigned long)params->card_id);
+
+    return ESP_OK;
+}
@@ -3,15 +3,18 @@
 #include "driver/sdmmc_host.h"
 #include "esp_vfs_fat.h"
 #include "sdmmc_cmd.h"
+#include "sd_stream.h"
 
 typedef struct
 {
     gpio_num_t clk;
     gpio_num_t d0;
-    gpio_num_t d1;
+    gpio_num_t d1; /*!< GPIO_NUM_NC for a card wired with one data line */
     gpio_num_t d2;
     gpio_num_t d3;
     gpio_num_t cmd;
+    uint8_t index_task_priority; /*!< of the background directory walk, see sd_index */
+    bool probe_bus;              /*!< negotiate clock and width once per card and keep it in NVS, see sd_bus */
 } sd_card_config_t;
 
 extern sdmmc_card_t *card;
@@ -19,8 +22,27 @@ extern sdmmc_card_t *card;
 /**
  * @brief sd card init
  *
+ * Mounts the card and starts sd_index on the root, mount_path must stay valid.
+ * With probe_bus the first boot with a card writes a pattern to SDPROBE.BIN in every mode.
+ *
  * @param config
  * @param mount_path
  * @return esp_err_t
  */
-esp_err_t sd_card_init(sd_card_config_t config, char *mount_path);
\ No newline at end of file
+esp_err_t sd_card_init(sd_card_config_t config, char *mount_path);
+
+/**
+ * @brief reserve a contiguous file on the card for raw sector access, e.g. by sd_raw_log
+ *
+ * The file is created and allocated in one piece the first time, later calls find the same
+ * sectors again. A file of that name in more than one piece is allocated again, its contents
+ * are lost. Delete the file through FATFS to give the space back.
+ *
+ * @param name in the root, e.g. "RAWLOG.BIN"
+ * @param size bytes, whole sectors
+ * @param align_sectors first_sector is a multiple of it, e.g. sd_raw_log's chunk_sectors, the file is larger by up to this
+ * @param first_sector on the card
+ * @param sector_count
+ * @return esp_err_t
+ */
+esp_err_t sd_card_reserve_region(const char *name, uint32_t size, uint32_t align_sectors, uint32_t *first_sector, uint32_t *sector_count);
\ No newline at end of file
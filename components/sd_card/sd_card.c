@@ -1,11 +1,20 @@
 #include <stdio.h>
 #include "esp_log.h"
+#include "esp_check.h"
 #include "sd_card.h"
 #include "string.h"
-#include "dirent.h"
+#include "stdlib.h"
+#include "diskio_sdmmc.h"
+#include "ff.h"
+#include "sd_index.h"
+#include "sd_bus.h"
+
+#define SD_CARD_PROBE_FILE "SDPROBE.BIN"
+#define SD_CARD_PROBE_SIZE (32 * 1024)
 
 static const char *TAG = "SD_CARD";
 sdmmc_card_t *card = NULL;
+static char fatfs_path[4];
 
 esp_err_t sd_read_file(const char *path)
 {
@@ -31,30 +40,183 @@ esp_err_t sd_read_file(const char *path)
     return ESP_OK;
 }
 
-esp_err_t sd_card_init(sd_card_config_t config, char *mount_path)
+static sdmmc_slot_config_t sd_card_slot_config(const sd_card_config_t *config, uint8_t width)
+{
+    sdmmc_slot_config_t slot_config = SDMMC_SLOT_CONFIG_DEFAULT();
+    slot_config.width = width;
+    slot_config.clk = config->clk;
+    slot_config.cmd = config->cmd;
+    slot_config.d0 = config->d0;
+    slot_config.d1 = config->d1;
+    slot_config.d2 = config->d2;
+    slot_config.d3 = config->d3;
+    slot_config.flags |= SDMMC_SLOT_FLAG_INTERNAL_PULLUP;
+    return slot_config;
+}
+
+static esp_err_t sd_card_mount(const sd_card_config_t *config, const char *mount_path, sd_bus_mode_t mode)
 {
-    esp_err_t ret = ESP_FAIL;
     esp_vfs_fat_sdmmc_mount_config_t mount_config = {
         .format_if_mount_failed = false,
         .allocation_unit_size = 16 * 1024,
         .max_files = 5,
     };
-
-    ESP_LOGI(TAG, "Initializing sd card");
     sdmmc_host_t host = SDMMC_HOST_DEFAULT();
-    sdmmc_slot_config_t slot_config = SDMMC_SLOT_CONFIG_DEFAULT();
-    slot_config.width = 4;
-    slot_config.clk = config.clk;
-    slot_config.cmd = config.cmd;
-    slot_config.d0 = config.d0;
-    slot_config.d1 = config.d1;
-    slot_config.d2 = config.d2;
-    slot_config.d3 = config.d3;
-    slot_config.flags |= SDMMC_SLOT_FLAG_INTERNAL_PULLUP;
+    host.max_freq_khz = mode.freq_khz;
+    sdmmc_slot_config_t slot_config = sd_card_slot_config(config, mode.width);
+
+    ESP_LOGI(TAG, "Mount filesystem, %lu kHz %d bit", (unsigned long)mode.freq_khz, mode.width);
+    ESP_RETURN_ON_ERROR(esp_vfs_fat_sdmmc_mount(mount_path, &host, &slot_config, &mount_config, &card), TAG, "Mount failed");
+    snprintf(fatfs_path, sizeof(fatfs_path), "%d:/", ff_diskio_get_pdrv_card(card));
+
+    return ESP_OK;
+}
+
+static void sd_card_unmount(const char *mount_path)
+{
+    esp_vfs_fat_sdcard_unmount(mount_path, card);
+    card = NULL;
+}
+
+typedef struct
+{
+    const sd_card_config_t *config;
+    sdmmc_host_t host;
+    sdmmc_card_t card; /*!< the probe brings the card up without FATFS */
+} sd_card_probe_t;
+
+static esp_err_t sd_card_probe_attach(void *ctx, sd_bus_mode_t *mode, uint32_t *card_id)
+{
+    esp_err_t ret = ESP_OK;
+    sd_card_probe_t *probe = (sd_card_probe_t *)ctx;
+    probe->host = (sdmmc_host_t)SDMMC_HOST_DEFAULT();
+    probe->host.max_freq_khz = mode->freq_khz;
+    sdmmc_slot_config_t slot_config = sd_card_slot_config(probe->config, mode->width);
+
+    ESP_RETURN_ON_ERROR(sdmmc_host_init(), TAG, "Host init failed");
+    ESP_GOTO_ON_ERROR(sdmmc_host_init_slot(probe->host.slot, &slot_config), err, TAG, "Slot init failed");
+    ESP_GOTO_ON_ERROR(sdmmc_card_init(&probe->host, &probe->card), err, TAG, "Card init failed");
+    /*!< a card without high speed support stays at the default clock */
+    mode->freq_khz = probe->card.max_freq_khz;
+    *card_id = probe->card.cid.serial;
+    return ESP_OK;
+
+err:
+    sdmmc_host_deinit();
+    return ret;
+}
+
+static esp_err_t sd_card_probe_read(void *ctx, uint32_t sector, void *buf, uint32_t count)
+{
+    sd_card_probe_t *probe = (sd_card_probe_t *)ctx;
+    return sdmmc_read_sectors(&probe->card, buf, sector, count);
+}
+
+static esp_err_t sd_card_probe_write(void *ctx, uint32_t sector, const void *buf, uint32_t count)
+{
+    sd_card_probe_t *probe = (sd_card_probe_t *)ctx;
+    return sdmmc_write_sectors(&probe->card, buf, sector, count);
+}
+
+static void sd_card_probe_detach(void *ctx)
+{
+    sdmmc_host_deinit();
+}
+
+/**
+ * @brief 4 bit needs all of d1-d3, a slot wired for 1 bit leaves them GPIO_NUM_NC
+ */
+static uint8_t sd_card_max_width(const sd_card_config_t *config)
+{
+    return (config->d1 == GPIO_NUM_NC || config->d2 == GPIO_NUM_NC || config->d3 == GPIO_NUM_NC) ? 1 : 4;
+}
+
+/**
+ * @brief find the fastest mode that works with this card and wiring and store it
+ */
+static esp_err_t sd_card_negotiate(const sd_card_config_t *config, const char *mount_path, sd_bus_params_t *params)
+{
+    static const sd_bus_mode_t modes[] = {
+        {SDMMC_FREQ_HIGHSPEED, 4},
+        {SDMMC_FREQ_DEFAULT, 4},
+        {SDMMC_FREQ_HIGHSPEED, 1},
+        {SDMMC_FREQ_DEFAULT, 1},
+    };
+    size_t first = 0;
+    uint32_t scratch_sector = 0;
+    uint32_t scratch_sectors = 0;
+    sd_card_probe_t probe = {
+        .config = config,
+    };
+    sd_bus_driver_t driver = {
+        .attach = sd_card_probe_attach,
+        .read = sd_card_probe_read,
+        .write = sd_card_probe_write,
+        .detach = sd_card_probe_detach,
+    };
+
+    /*!< the pattern goes into a file of its own, mounted in the slowest mode to find it */
+    ESP_RETURN_ON_ERROR(sd_card_mount(config, mount_path, modes[sizeof(modes) / sizeof(modes[0]) - 1]), TAG, "Card not usable");
+    esp_err_t ret = sd_card_reserve_region(SD_CARD_PROBE_FILE, SD_CARD_PROBE_SIZE, 1, &scratch_sector, &scratch_sectors);
+    sd_card_unmount(mount_path);
+    ESP_RETURN_ON_ERROR(ret, TAG, "No scratch area for the probe");
+
+    /*!< modes are widest first, skip those the wiring cannot carry */
+    while (modes[first].width > sd_card_max_width(config))
+    {
+        first++;
+    }
+    sd_bus_probe_config_t probe_config = {
+        .modes = modes + first,
+        .mode_count = sizeof(modes) / sizeof(modes[0]) - first,
+        .scratch_sector = scratch_sector,
+        .scratch_sectors = scratch_sectors,
+        .rounds = 4,
+    };
+    ESP_RETURN_ON_ERROR(sd_bus_negotiate(&driver, &probe, &probe_config, NULL, NULL, params), TAG, "Negotiation failed");
+    if (sd_bus_params_save(params) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Bus mode not stored, the next boot probes again");
+    }
+
+    return ESP_OK;
+}
 
-    ESP_LOGI(TAG, "Mount filesystem");
+esp_err_t sd_card_init(sd_card_config_t config, char *mount_path)
+{
+    esp_err_t ret = ESP_FAIL;
+    sd_bus_params_t params = {
+        .mode = {SDMMC_FREQ_DEFAULT, sd_card_max_width(&config)},
+    };
 
-    ret = esp_vfs_fat_sdmmc_mount(mount_path, &host, &slot_config, &mount_config, &card);
+    ESP_LOGI(TAG, "Initializing sd card");
+    if (!config.probe_bus)
+    {
+        ret = sd_card_mount(&config, mount_path, params.mode);
+    }
+    else
+    {
+        /*!< the stored mode is trusted for the card it was measured with, unless the wiring is narrower now */
+        bool probed = false;
+        if (sd_bus_params_load(&params) == ESP_OK && params.mode.width <= sd_card_max_width(&config))
+        {
+            ret = sd_card_mount(&config, mount_path, params.mode);
+            if (ret == ESP_OK && (uint32_t)card->cid.serial != params.card_id)
+            {
+                ESP_LOGI(TAG, "Another card, probe the bus again");
+                sd_card_unmount(mount_path);
+                ret = ESP_FAIL;
+            }
+        }
+        if (ret != ESP_OK)
+        {
+            ESP_RETURN_ON_ERROR(sd_card_negotiate(&config, mount_path, &params), TAG, "No working bus mode");
+            probed = true;
+            ret = sd_card_mount(&config, mount_path, params.mode);
+        }
+        ESP_LOGI(TAG, "Bus %lu kHz %d bit, read %lu KB/s, write %lu KB/s%s", (unsigned long)params.mode.freq_khz, params.mode.width,
+                 (unsigned long)params.read_kb_per_sec, (unsigned long)params.write_kb_per_sec, probed ? ", probed" : "");
+    }
 
     if (ret != ESP_OK)
     {
@@ -63,16 +225,83 @@ esp_err_t sd_card_init(sd_card_config_t config, char *mount_path)
     ESP_LOGI(TAG, "Filesystem mounted");
     sdmmc_card_print_info(stdout, card);
 
-    /*!< scan files */
-    DIR *dir = opendir(mount_path);
-    if (!dir)
+    /*!< the root is indexed in the background, the boot only reads the cached index */
+    sd_index_config_t index_config = {
+        .path = mount_path,
+        .fatfs_path = fatfs_path,
+        .task_priority = config.index_task_priority,
+        .task_core = tskNO_AFFINITY,
+    };
+    ret = sd_index_start(index_config);
+    if (ret != ESP_OK)
     {
-        return ESP_FAIL;
+        ESP_LOGW(TAG, "No file index, lookups go to the card");
     }
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL)
+
+    return ESP_OK;
+}
+
+/**
+ * @brief the file is one run of clusters from its first, as f_expand allocates it
+ *
+ * Another FAT writer, e.g. the host over USB, may have recreated it in pieces under the same name.
+ */
+static bool sd_card_file_contiguous(FIL *fil)
+{
+    FSIZE_t cluster_bytes = (FSIZE_t)fil->obj.fs->csize * card->csd.sector_size;
+    FSIZE_t last = (f_size(fil) - 1) / cluster_bytes;
+
+    for (FSIZE_t i = 1; i <= last; i++)
     {
-        ESP_LOGI(TAG, "%s has file:%s", mount_path, entry->d_name);
+        /*!< FatFs follows the chain one cluster on from where it is, clust is then the one holding the offset */
+        if (f_lseek(fil, i * cluster_bytes + 1) != FR_OK || fil->clust != fil->obj.sclust + i)
+        {
+            return false;
+        }
     }
+    return f_lseek(fil, 0) == FR_OK;
+}
+
+esp_err_t sd_card_reserve_region(const char *name, uint32_t size, uint32_t align_sectors, uint32_t *first_sector, uint32_t *sector_count)
+{
+    esp_err_t ret = ESP_OK;
+    char path[32];
+    bool created = false;
+    ESP_RETURN_ON_FALSE(card && name && first_sector && sector_count, ESP_ERR_INVALID_STATE, TAG, "Card not mounted");
+    ESP_RETURN_ON_FALSE(size && size % card->csd.sector_size == 0 && align_sectors, ESP_ERR_INVALID_SIZE, TAG, "Size must be whole sectors");
+    /*!< the start is rounded up to the alignment inside the file, so it is larger by up to one alignment */
+    uint32_t file_size = size + (align_sectors - 1) * card->csd.sector_size;
+
+    FIL *fil = calloc(1, sizeof(FIL));
+    ESP_RETURN_ON_FALSE(fil, ESP_ERR_NO_MEM, TAG, "No mem for file");
+    snprintf(path, sizeof(path), "%s%s", fatfs_path, name);
+    ESP_GOTO_ON_FALSE(f_open(fil, path, FA_READ | FA_WRITE | FA_OPEN_ALWAYS) == FR_OK, ESP_FAIL, out, TAG, "Open %s failed", path);
+
+    if (f_size(fil) == file_size && !sd_card_file_contiguous(fil))
+    {
+        ESP_LOGW(TAG, "%s is in pieces, allocating it again", path);
+        ESP_GOTO_ON_FALSE(f_lseek(fil, 0) == FR_OK && f_truncate(fil) == FR_OK, ESP_FAIL, close, TAG, "Truncate %s failed", path);
+    }
+    /*!< allocated in one piece, FAT is not touched again while the region is written */
+    created = f_size(fil) == 0;
+    if (created)
+    {
+        ESP_GOTO_ON_FALSE(f_expand(fil, file_size, 1) == FR_OK, ESP_ERR_NO_MEM, close, TAG, "No %lu contiguous bytes free", (unsigned long)file_size);
+    }
+    ESP_GOTO_ON_FALSE(f_size(fil) == file_size, ESP_ERR_INVALID_SIZE, close, TAG, "%s exists with another size", path);
+    uint32_t file_sector = fil->obj.fs->database + (fil->obj.sclust - 2) * fil->obj.fs->csize;
+    *first_sector = (file_sector + align_sectors - 1) / align_sectors * align_sectors;
+    *sector_count = size / card->csd.sector_size;
+    ESP_LOGI(TAG, "%s is sectors %lu..%lu", path, (unsigned long)*first_sector, (unsigned long)(*first_sector + *sector_count - 1));
+
+close:
+    f_close(fil);
+    if (created)
+    {
+        /*!< new to the directory, or at least grown, the index walks again */
+        sd_index_invalidate();
+    }
+out:
+    free(fil);
     return ret;
-}
\ No newline at end of file
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "freertos/FreeRTOS.h"
+
+#define SD_INDEX_MAGIC 0x31584453 /*!< "SDX1" */
+#define SD_INDEX_FILE "SDINDEX.BIN" /*!< 8.3, FATFS may be built without long names */
+#define SD_INDEX_FLAG_DIR 0x01
+
+/**
+ * @brief index file layout: header, entries sorted by hash, then the NUL terminated names
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint32_t serial;   /*!< volume serial number the index was built on */
+    uint32_t checksum; /*!< over every name, size, time and flag in directory order */
+    uint32_t count;
+    uint32_t names_size;
+    uint32_t file_sum; /*!< over the entries and names, catches a torn write */
+} sd_index_header_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t hash; /*!< of the lower case name */
+    uint32_t size;
+    uint32_t mtime; /*!< FAT date << 16 | FAT time on the card, seconds on the host */
+    uint32_t name_offset;
+    uint8_t flags;
+    uint8_t reserved[3];
+} sd_index_entry_t;
+
+typedef struct
+{
+    const char *path;       /*!< mounted directory, the index file is kept in it */
+    const char *fatfs_path; /*!< the same directory as a FATFS path, e.g. "0:/", not used on the host */
+    uint8_t task_priority;  /*!< of the background walk, keep it below everything that matters at boot */
+    int task_core;
+} sd_index_config_t;
+
+typedef struct
+{
+    uint32_t size;
+    uint32_t mtime;
+    bool is_dir;
+} sd_index_info_t;
+
+typedef struct
+{
+    bool loaded;  /*!< the index file was valid for this card */
+    bool rebuilt; /*!< the walk found changes and rewrote the index file */
+    bool current; /*!< the index matches the last walk and was not invalidated since */
+    uint32_t entries;
+    uint32_t load_us; /*!< reading the index file, i.e. the boot cost */
+    uint32_t scan_us; /*!< last background walk */
+    uint32_t lookups;
+    uint32_t hits;
+    uint32_t fallbacks; /*!< answered by stat because the index was not current */
+} sd_index_stats_t;
+
+/**
+ * @brief called for every indexed entry, return false to stop
+ */
+typedef bool (*sd_index_visit_cb_t)(const char *name, const sd_index_info_t *info, void *user_ctx);
+
+/**
+ * @brief load the index file if it belongs to this card, then check it with a walk in the background
+ *
+ * Only the top level of path is indexed. The walk rewrites the index file when its checksum
+ * differs from the loaded one.
+ *
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t sd_index_start(sd_index_config_t config);
+
+/**
+ * @brief look a name up, case insensitive as on FAT
+ *
+ * Answered from the index while it is current, a miss then means the file does not exist.
+ * Otherwise names missing from the index are checked with stat. The index stays current only
+ * if everything that creates, removes or finishes a file in path calls sd_index_invalidate,
+ * sizes and times of a file that is still being written are those of the last walk.
+ *
+ * @param name relative to path
+ * @param info may be NULL
+ * @return esp_err_t ESP_ERR_NOT_FOUND if there is no such entry
+ */
+esp_err_t sd_index_lookup(const char *name, sd_index_info_t *info);
+
+/**
+ * @brief call cb for every entry of the index
+ *
+ * @param cb
+ * @param user_ctx
+ * @return esp_err_t
+ */
+esp_err_t sd_index_foreach(sd_index_visit_cb_t cb, void *user_ctx);
+
+/**
+ * @brief wait until the background walk has checked the index
+ *
+ * @param ticks_to_wait
+ * @return esp_err_t ESP_ERR_TIMEOUT if it is still walking
+ */
+esp_err_t sd_index_wait(TickType_t ticks_to_wait);
+
+/**
+ * @brief the directory was changed, e.g. a file was written or the host wrote over USB, walk it again
+ *
+ * Call it after the change, misses go to stat until the next walk has finished. Does nothing
+ * before sd_index_start.
+ */
+void sd_index_invalidate(void);
+
+/**
+ * @brief get index counters
+ *
+ * @param stats
+ */
+void sd_index_get_stats(sd_index_stats_t *stats);
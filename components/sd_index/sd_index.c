@@ -0,0 +1,501 @@
+#include "sd_index.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "string.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "strings.h"
+#include "ctype.h"
+#include "sys/stat.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "dirent.h"
+#include "sys/statvfs.h"
+#else
+#include "ff.h"
+#endif
+
+#define SD_INDEX_TMP_FILE "SDINDEX.TMP"
+#define SD_INDEX_PATH_MAX 300
+#define SD_INDEX_CHECKED_BIT BIT0
+#define SD_INDEX_FNV_BASIS 2166136261u
+#define SD_INDEX_FNV_PRIME 16777619u
+
+typedef struct
+{
+    sd_index_entry_t *entries;
+    char *names;
+    uint32_t count;
+    uint32_t names_size;
+    uint32_t entries_cap;
+    uint32_t names_cap;
+    uint32_t checksum;
+} sd_index_table_t;
+
+static const char *TAG = "SD_INDEX";
+
+static sd_index_config_t index_cfg;
+static sd_index_stats_t index_stats;
+static sd_index_table_t table;
+static uint32_t volume_serial = 0;
+static uint32_t index_generation = 0; /*!< bumped by sd_index_invalidate, a walk is current only if it did not move */
+static SemaphoreHandle_t table_lock = NULL;
+static EventGroupHandle_t index_event = NULL;
+static TaskHandle_t index_task = NULL;
+
+static uint32_t sd_index_fnv(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ p[i]) * SD_INDEX_FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint32_t sd_index_name_hash(const char *name)
+{
+    uint32_t hash = SD_INDEX_FNV_BASIS;
+    for (; *name; name++)
+    {
+        hash = (hash ^ (uint8_t)tolower((unsigned char)*name)) * SD_INDEX_FNV_PRIME;
+    }
+    return hash;
+}
+
+static void sd_index_table_free(sd_index_table_t *t)
+{
+    free(t->entries);
+    free(t->names);
+    memset(t, 0, sizeof(sd_index_table_t));
+}
+
+static esp_err_t sd_index_table_add(sd_index_table_t *t, const char *name, uint32_t size, uint32_t mtime, uint8_t flags)
+{
+    size_t len = strlen(name) + 1;
+
+    /*!< the index file and its temporary copy are not part of the directory */
+    if (strcasecmp(name, SD_INDEX_FILE) == 0 || strcasecmp(name, SD_INDEX_TMP_FILE) == 0 || strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+    {
+        return ESP_OK;
+    }
+    if (t->count == t->entries_cap)
+    {
+        uint32_t cap = t->entries_cap ? t->entries_cap * 2 : 64;
+        sd_index_entry_t *entries = realloc(t->entries, cap * sizeof(sd_index_entry_t));
+        ESP_RETURN_ON_FALSE(entries, ESP_ERR_NO_MEM, TAG, "No mem for entries");
+        t->entries = entries;
+        t->entries_cap = cap;
+    }
+    if (t->names_size + len > t->names_cap)
+    {
+        uint32_t cap = t->names_cap ? t->names_cap * 2 : 1024;
+        while (cap < t->names_size + len)
+        {
+            cap *= 2;
+        }
+        char *names = realloc(t->names, cap);
+        ESP_RETURN_ON_FALSE(names, ESP_ERR_NO_MEM, TAG, "No mem for names");
+        t->names = names;
+        t->names_cap = cap;
+    }
+
+    sd_index_entry_t *entry = &t->entries[t->count++];
+    *entry = (sd_index_entry_t){
+        .hash = sd_index_name_hash(name),
+        .size = size,
+        .mtime = mtime,
+        .name_offset = t->names_size,
+        .flags = flags,
+    };
+    memcpy(t->names + t->names_size, name, len);
+    t->names_size += len;
+
+    /*!< in directory order, so a rename or a reorder changes it too */
+    t->checksum = sd_index_fnv(t->checksum, name, len);
+    t->checksum = sd_index_fnv(t->checksum, &entry->size, sizeof(uint32_t) * 2);
+    t->checksum = sd_index_fnv(t->checksum, &flags, 1);
+
+    return ESP_OK;
+}
+
+static int sd_index_entry_cmp(const void *a, const void *b)
+{
+    uint32_t ha = ((const sd_index_entry_t *)a)->hash;
+    uint32_t hb = ((const sd_index_entry_t *)b)->hash;
+    return (ha > hb) - (ha < hb);
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+static uint32_t sd_index_volume_serial(void)
+{
+    struct statvfs vfs;
+    if (statvfs(index_cfg.path, &vfs) != 0)
+    {
+        return 0;
+    }
+    return (uint32_t)vfs.f_fsid;
+}
+
+static esp_err_t sd_index_walk(sd_index_table_t *t)
+{
+    char path[SD_INDEX_PATH_MAX];
+    struct dirent *entry;
+    struct stat st;
+    esp_err_t ret = ESP_OK;
+
+    DIR *dir = opendir(index_cfg.path);
+    ESP_RETURN_ON_FALSE(dir, ESP_FAIL, TAG, "Open %s failed", index_cfg.path);
+    while (ret == ESP_OK && (entry = readdir(dir)) != NULL)
+    {
+        snprintf(path, sizeof(path), "%s/%s", index_cfg.path, entry->d_name);
+        if (stat(path, &st) != 0)
+        {
+            continue;
+        }
+        ret = sd_index_table_add(t, entry->d_name, st.st_size, st.st_mtime, S_ISDIR(st.st_mode) ? SD_INDEX_FLAG_DIR : 0);
+    }
+    closedir(dir);
+
+    return ret;
+}
+#else
+static uint32_t sd_index_volume_serial(void)
+{
+    DWORD vsn = 0;
+    if (f_getlabel(index_cfg.fatfs_path, NULL, &vsn) != FR_OK)
+    {
+        return 0;
+    }
+    return vsn;
+}
+
+static esp_err_t sd_index_walk(sd_index_table_t *t)
+{
+    esp_err_t ret = ESP_OK;
+    FF_DIR *dir = calloc(1, sizeof(FF_DIR));
+    FILINFO *info = calloc(1, sizeof(FILINFO));
+    ESP_GOTO_ON_FALSE(dir && info, ESP_ERR_NO_MEM, out, TAG, "No mem for walk");
+
+    /*!< f_readdir hands out size and time with the name, a stat per entry would search the directory again */
+    ESP_GOTO_ON_FALSE(f_opendir(dir, index_cfg.fatfs_path) == FR_OK, ESP_FAIL, out, TAG, "Open %s failed", index_cfg.fatfs_path);
+    while (ret == ESP_OK && f_readdir(dir, info) == FR_OK && info->fname[0])
+    {
+        ret = sd_index_table_add(t, info->fname, info->fsize, ((uint32_t)info->fdate << 16) | info->ftime, (info->fattrib & AM_DIR) ? SD_INDEX_FLAG_DIR : 0);
+    }
+    f_closedir(dir);
+
+out:
+    free(dir);
+    free(info);
+    return ret;
+}
+#endif
+
+static uint32_t sd_index_file_sum(const sd_index_table_t *t)
+{
+    uint32_t sum = sd_index_fnv(SD_INDEX_FNV_BASIS, t->entries, t->count * sizeof(sd_index_entry_t));
+    return sd_index_fnv(sum, t->names, t->names_size);
+}
+
+/**
+ * @brief every name is inside the names and terminated, and sits under its own hash in sorted order
+ *
+ * The file sum only catches torn writes, lookups trust these fields.
+ */
+static bool sd_index_table_check(sd_index_table_t *t)
+{
+    /*!< names were allocated one byte longer, a last name without its NUL stops there */
+    t->names[t->names_size] = '\0';
+    if (t->names_size && t->names[t->names_size - 1] != '\0')
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < t->count; i++)
+    {
+        if (t->entries[i].name_offset >= t->names_size || sd_index_name_hash(t->names + t->entries[i].name_offset) != t->entries[i].hash ||
+            (i && t->entries[i].hash < t->entries[i - 1].hash))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static esp_err_t sd_index_load(sd_index_table_t *t)
+{
+    char path[SD_INDEX_PATH_MAX];
+    sd_index_header_t header;
+    long file_len = 0;
+    esp_err_t ret = ESP_OK;
+
+    snprintf(path, sizeof(path), "%s/%s", index_cfg.path, SD_INDEX_FILE);
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_GOTO_ON_FALSE(fseek(f, 0, SEEK_END) == 0 && (file_len = ftell(f)) >= (long)sizeof(header) && fseek(f, 0, SEEK_SET) == 0, ESP_ERR_INVALID_SIZE, out, TAG,
+                      "Index file is short");
+    ESP_GOTO_ON_FALSE(fread(&header, sizeof(header), 1, f) == 1 && header.magic == SD_INDEX_MAGIC, ESP_ERR_INVALID_VERSION, out, TAG, "Not an index file");
+    ESP_GOTO_ON_FALSE(header.serial == volume_serial, ESP_ERR_INVALID_STATE, out, TAG, "Index belongs to another card");
+    /*!< the sizes come from the card, nothing is allocated that the file does not hold */
+    size_t body = file_len - sizeof(header);
+    ESP_GOTO_ON_FALSE(header.count <= body / sizeof(sd_index_entry_t) && header.names_size == body - header.count * sizeof(sd_index_entry_t),
+                      ESP_ERR_INVALID_SIZE, out, TAG, "Index file size does not match its header");
+
+    t->entries = malloc(header.count * sizeof(sd_index_entry_t) + 1);
+    t->names = malloc(header.names_size + 1);
+    ESP_GOTO_ON_FALSE(t->entries && t->names, ESP_ERR_NO_MEM, out, TAG, "No mem for index");
+    t->count = t->entries_cap = header.count;
+    t->names_size = t->names_cap = header.names_size;
+    ESP_GOTO_ON_FALSE(fread(t->entries, sizeof(sd_index_entry_t), header.count, f) == header.count &&
+                          fread(t->names, 1, header.names_size, f) == header.names_size,
+                      ESP_ERR_INVALID_SIZE, out, TAG, "Index file is short");
+    ESP_GOTO_ON_FALSE(sd_index_file_sum(t) == header.file_sum, ESP_ERR_INVALID_CRC, out, TAG, "Index file is corrupt");
+    ESP_GOTO_ON_FALSE(sd_index_table_check(t), ESP_ERR_INVALID_CRC, out, TAG, "Index file entries are inconsistent");
+    t->checksum = header.checksum;
+
+out:
+    fclose(f);
+    if (ret != ESP_OK)
+    {
+        sd_index_table_free(t);
+    }
+    return ret;
+}
+
+static esp_err_t sd_index_save(const sd_index_table_t *t)
+{
+    char path[SD_INDEX_PATH_MAX];
+    char tmp[SD_INDEX_PATH_MAX];
+    sd_index_header_t header = {
+        .magic = SD_INDEX_MAGIC,
+        .serial = volume_serial,
+        .checksum = t->checksum,
+        .count = t->count,
+        .names_size = t->names_size,
+        .file_sum = sd_index_file_sum(t),
+    };
+
+    snprintf(path, sizeof(path), "%s/%s", index_cfg.path, SD_INDEX_FILE);
+    snprintf(tmp, sizeof(tmp), "%s/%s", index_cfg.path, SD_INDEX_TMP_FILE);
+    FILE *f = fopen(tmp, "wb");
+    ESP_RETURN_ON_FALSE(f, ESP_FAIL, TAG, "Create %s failed", tmp);
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(t->entries, sizeof(sd_index_entry_t), t->count, f) == t->count &&
+              fwrite(t->names, 1, t->names_size, f) == t->names_size;
+    fclose(f);
+    ESP_RETURN_ON_FALSE(ok, ESP_FAIL, TAG, "Write %s failed", tmp);
+
+    /*!< FATFS does not rename over an existing file */
+    remove(path);
+    ESP_RETURN_ON_FALSE(rename(tmp, path) == 0, ESP_FAIL, TAG, "Rename %s failed", tmp);
+
+    return ESP_OK;
+}
+
+static void sd_index_task(void *arg)
+{
+    while (1)
+    {
+        sd_index_table_t walked = {.checksum = SD_INDEX_FNV_BASIS};
+        int64_t start = esp_timer_get_time();
+
+        xSemaphoreTake(table_lock, portMAX_DELAY);
+        uint32_t generation = index_generation;
+        xSemaphoreGive(table_lock);
+
+        if (sd_index_walk(&walked) != ESP_OK)
+        {
+            sd_index_table_free(&walked);
+            ESP_LOGW(TAG, "Walk failed, lookups go to the card");
+        }
+        else
+        {
+            qsort(walked.entries, walked.count, sizeof(sd_index_entry_t), sd_index_entry_cmp);
+            index_stats.scan_us = esp_timer_get_time() - start;
+
+            xSemaphoreTake(table_lock, portMAX_DELAY);
+            bool changed = !index_stats.loaded || walked.checksum != table.checksum || walked.count != table.count;
+            if (changed)
+            {
+                sd_index_table_free(&table);
+                table = walked;
+                walked = (sd_index_table_t){0};
+            }
+            index_stats.entries = table.count;
+            /*!< a change during the walk may have been missed, the pending notification walks again */
+            index_stats.current = generation == index_generation;
+            xSemaphoreGive(table_lock);
+
+            if (changed)
+            {
+                index_stats.rebuilt = sd_index_save(&table) == ESP_OK;
+            }
+            sd_index_table_free(&walked);
+            ESP_LOGI(TAG, "Walked %lu entries in %lu us, index %s", (unsigned long)index_stats.entries, (unsigned long)index_stats.scan_us, changed ? "rebuilt" : "up to date");
+        }
+        xEventGroupSetBits(index_event, SD_INDEX_CHECKED_BIT);
+
+        /*!< sleep until the directory is known to have changed */
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+esp_err_t sd_index_start(sd_index_config_t config)
+{
+    ESP_RETURN_ON_FALSE(config.path && config.fatfs_path, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(index_task == NULL, ESP_ERR_INVALID_STATE, TAG, "Already started");
+    index_cfg = config;
+
+    table_lock = xSemaphoreCreateMutex();
+    index_event = xEventGroupCreate();
+    ESP_RETURN_ON_FALSE(table_lock && index_event, ESP_ERR_NO_MEM, TAG, "Lock create failed");
+
+    int64_t start = esp_timer_get_time();
+    volume_serial = sd_index_volume_serial();
+    index_stats.loaded = sd_index_load(&table) == ESP_OK;
+    index_stats.load_us = esp_timer_get_time() - start;
+    index_stats.entries = table.count;
+    ESP_LOGI(TAG, "Serial %08lx, %s index with %lu entries in %lu us", (unsigned long)volume_serial, index_stats.loaded ? "loaded" : "no", (unsigned long)table.count,
+             (unsigned long)index_stats.load_us);
+
+    ESP_RETURN_ON_FALSE(xTaskCreatePinnedToCore(sd_index_task, "sd_index", 4096, NULL, config.task_priority, &index_task, config.task_core) == pdPASS,
+                        ESP_ERR_NO_MEM, TAG, "Index task create failed");
+
+    return ESP_OK;
+}
+
+/*!< table_lock must be held */
+static const sd_index_entry_t *sd_index_find(const char *name)
+{
+    uint32_t hash = sd_index_name_hash(name);
+    uint32_t lo = 0;
+    uint32_t hi = table.count;
+
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (table.entries[mid].hash < hash)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    /*!< names that share a hash sit next to each other */
+    for (; lo < table.count && table.entries[lo].hash == hash; lo++)
+    {
+        if (strcasecmp(table.names + table.entries[lo].name_offset, name) == 0)
+        {
+            return &table.entries[lo];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t sd_index_lookup(const char *name, sd_index_info_t *info)
+{
+    char path[SD_INDEX_PATH_MAX];
+    struct stat st;
+    ESP_RETURN_ON_FALSE(name && table_lock, ESP_ERR_INVALID_STATE, TAG, "Index not started");
+
+    xSemaphoreTake(table_lock, portMAX_DELAY);
+    index_stats.lookups++;
+    const sd_index_entry_t *entry = sd_index_find(name);
+    if (entry)
+    {
+        index_stats.hits++;
+        if (info)
+        {
+            *info = (sd_index_info_t){
+                .size = entry->size,
+                .mtime = entry->mtime,
+                .is_dir = entry->flags & SD_INDEX_FLAG_DIR,
+            };
+        }
+        xSemaphoreGive(table_lock);
+        return ESP_OK;
+    }
+    bool current = index_stats.current;
+    if (!current)
+    {
+        index_stats.fallbacks++;
+    }
+    xSemaphoreGive(table_lock);
+
+    /*!< a current index knows every name, an old one may miss new files */
+    if (current)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    snprintf(path, sizeof(path), "%s/%s", index_cfg.path, name);
+    if (stat(path, &st) != 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (info)
+    {
+        *info = (sd_index_info_t){
+            .size = st.st_size,
+            .mtime = st.st_mtime,
+            .is_dir = S_ISDIR(st.st_mode),
+        };
+    }
+    return ESP_OK;
+}
+
+esp_err_t sd_index_foreach(sd_index_visit_cb_t cb, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(cb && table_lock, ESP_ERR_INVALID_STATE, TAG, "Index not started");
+
+    xSemaphoreTake(table_lock, portMAX_DELAY);
+    for (uint32_t i = 0; i < table.count; i++)
+    {
+        sd_index_info_t info = {
+            .size = table.entries[i].size,
+            .mtime = table.entries[i].mtime,
+            .is_dir = table.entries[i].flags & SD_INDEX_FLAG_DIR,
+        };
+        if (!cb(table.names + table.entries[i].name_offset, &info, user_ctx))
+        {
+            break;
+        }
+    }
+    xSemaphoreGive(table_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t sd_index_wait(TickType_t ticks_to_wait)
+{
+    ESP_RETURN_ON_FALSE(index_event, ESP_ERR_INVALID_STATE, TAG, "Index not started");
+    EventBits_t bits = xEventGroupWaitBits(index_event, SD_INDEX_CHECKED_BIT, pdFALSE, pdTRUE, ticks_to_wait);
+
+    return (bits & SD_INDEX_CHECKED_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void sd_index_invalidate(void)
+{
+    if (index_task == NULL)
+    {
+        return;
+    }
+    xSemaphoreTake(table_lock, portMAX_DELAY);
+    index_stats.current = false;
+    index_generation++;
+    xSemaphoreGive(table_lock);
+    xEventGroupClearBits(index_event, SD_INDEX_CHECKED_BIT);
+    xTaskNotifyGive(index_task);
+}
+
+void sd_index_get_stats(sd_index_stats_t *stats)
+{
+    *stats = index_stats;
+}
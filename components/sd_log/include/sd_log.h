@@ -0,0 +1,95 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "stdarg.h"
+#include "stddef.h"
+#include "freertos/FreeRTOS.h"
+
+#define SD_LOG_BLOCK_SIZE (16 * 1024) /*!< one FAT cluster with the 16 KB allocation unit sd_card mounts with */
+#define SD_LOG_LINE_MAX 256           /*!< longest sd_log_printf record, longer ones are cut */
+
+typedef enum
+{
+    SD_LOG_OVERFLOW_DROP,  /*!< a record that does not fit is dropped and counted */
+    SD_LOG_OVERFLOW_BLOCK, /*!< the writer sleeps until the flush task made room */
+} sd_log_overflow_t;
+
+typedef struct
+{
+    const char *path;           /*!< appended to, e.g. "/data/LOG.TXT" */
+    size_t ring_size;           /*!< power of two, in PSRAM when there is some */
+    sd_log_overflow_t overflow;
+    uint32_t poll_ms;           /*!< how often the flush task looks for a full block */
+    uint32_t sync_ms;           /*!< a partial block is written and synced at least this often */
+    bool capture_esp_log;       /*!< route ESP_LOGx into the ring as well as to the console */
+    uint8_t task_priority;      /*!< keep it low, nothing waits on the card but the ring */
+    int task_core;
+} sd_log_config_t;
+
+typedef struct
+{
+    uint32_t records;     /*!< accepted */
+    uint32_t dropped;     /*!< rejected by SD_LOG_OVERFLOW_DROP or too long */
+    uint32_t blocked;     /*!< writes that had to wait with SD_LOG_OVERFLOW_BLOCK */
+    uint32_t high_water;  /*!< most bytes ever queued in the ring, headers included */
+    uint32_t ring_size;
+    uint64_t flushed;     /*!< bytes handed to the card */
+    uint32_t writes;      /*!< block writes, a partial block rewritten later counts again */
+    uint32_t max_write_us; /*!< slowest write plus sync, the stall the writers no longer see */
+} sd_log_stats_t;
+
+/**
+ * @brief allocate the ring, open the file and start the flush task
+ *
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t sd_log_start(sd_log_config_t config);
+
+/**
+ * @brief queue one record, lock free and safe from any task on either core
+ *
+ * Producers only touch two atomic counters and the ring, the card is never waited on
+ * unless the ring is full and the policy is SD_LOG_OVERFLOW_BLOCK. Not for ISRs.
+ *
+ * @param data
+ * @param len at most a quarter of the ring
+ * @return esp_err_t ESP_ERR_NO_MEM if the record was dropped
+ */
+esp_err_t sd_log_write(const void *data, size_t len);
+
+/**
+ * @brief format into a record, up to SD_LOG_LINE_MAX bytes
+ *
+ * @return int the formatted length, or -1 if the record was dropped
+ */
+int sd_log_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief same as sd_log_printf, in the signature of esp_log_set_vprintf
+ */
+int sd_log_vprintf(const char *fmt, va_list args);
+
+/**
+ * @brief have everything queued so far written and synced
+ *
+ * @param ticks_to_wait
+ * @return esp_err_t ESP_ERR_TIMEOUT if the flush task did not get there in time
+ */
+esp_err_t sd_log_flush(TickType_t ticks_to_wait);
+
+/**
+ * @brief drain the ring, close the file and stop the flush task, later writes are dropped
+ *
+ * @return esp_err_t
+ */
+esp_err_t sd_log_stop(void);
+
+/**
+ * @brief counters since sd_log_start, the ring high water mark included
+ *
+ * @param stats
+ */
+void sd_log_get_stats(sd_log_stats_t *stats);
@@ -0,0 +1,440 @@
+#include "sd_log.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "string.h"
+#include "stdio.h"
+#include "stdatomic.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "freertos/task.h"
+#include "sd_index.h"
+
+#define SD_LOG_HEADER_SIZE sizeof(uint32_t)
+#define SD_LOG_ALIGN4(x) (((x) + 3) & ~3u)
+/*!< room for the NUL vsnprintf writes after the data, it must not land on the next header */
+#define SD_LOG_RECORD_SIZE(len) (SD_LOG_HEADER_SIZE + SD_LOG_ALIGN4((len) + 1))
+#define SD_LOG_ALIGN 64
+
+static const char *TAG = "SD_LOG";
+
+static sd_log_config_t log_cfg;
+static sd_log_stats_t log_stats;
+static int log_fd = -1;
+static uint8_t *ring = NULL; /*!< SD_LOG_LINE_MAX spare bytes past the end for a line formatted over the wrap */
+static uint32_t ring_mask = 0;
+static uint8_t *block = NULL; /*!< internal DMA RAM, the cluster being filled */
+static uint32_t block_fill = 0;
+static off_t block_offset = 0;
+static bool dirty = false; /*!< appended to since the last sync */
+static int64_t last_sync_us = 0;
+static TaskHandle_t flush_task = NULL;
+static vprintf_like_t console_vprintf = NULL;
+
+/*!< in internal RAM, compare and swap does not work on PSRAM */
+static atomic_uint reserve_pos = 0; /*!< producers claim from here */
+static atomic_uint tail_pos = 0;    /*!< the flush task has drained up to here */
+static atomic_uint records = 0;
+static atomic_uint dropped = 0;
+static atomic_uint blocked = 0;
+static atomic_uint high_water = 0;
+static atomic_uint writers = 0;
+static atomic_bool stopping = false;
+static atomic_bool stopped = false;
+static atomic_uint flush_req = 0;
+static atomic_uint flush_done = 0;
+
+/**
+ * @brief a record is a length word, the data and padding to a word, the length is stored last
+ *
+ * A zero length word means the record is reserved but not written yet, the flush task stops there.
+ */
+static inline atomic_uint *sd_log_header(uint32_t pos)
+{
+    return (atomic_uint *)&ring[pos & ring_mask];
+}
+
+static void sd_log_ring_copy_in(uint32_t pos, const void *data, size_t len)
+{
+    uint32_t start = pos & ring_mask;
+    size_t first = ring_mask + 1 - start;
+    if (first >= len)
+    {
+        memcpy(ring + start, data, len);
+        return;
+    }
+    memcpy(ring + start, data, first);
+    memcpy(ring, (const uint8_t *)data + first, len - first);
+}
+
+static void sd_log_wait_for_room(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    /*!< the host stress test writes from plain pthreads, which must not call into FreeRTOS */
+    usleep(1000);
+#else
+    vTaskDelay(1);
+#endif
+}
+
+/**
+ * @brief claim room for a record of len bytes, the caller fills it and publishes the length
+ *
+ * Counted as accepted once claimed. The caller holds writers across both steps.
+ */
+static esp_err_t sd_log_reserve(size_t len, uint32_t *pos)
+{
+    uint32_t size = ring_mask + 1;
+    uint32_t need = SD_LOG_RECORD_SIZE(len);
+    bool waited = false;
+
+    if (ring == NULL || atomic_load(&stopping) || len == 0 || need > size / 4)
+    {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t head = atomic_load_explicit(&reserve_pos, memory_order_relaxed);
+    uint32_t used;
+    while (1)
+    {
+        used = head - atomic_load_explicit(&tail_pos, memory_order_acquire);
+        if (used + need > size)
+        {
+            /*!< the flush task logging its own errors would wait for itself */
+            if (log_cfg.overflow == SD_LOG_OVERFLOW_DROP || xTaskGetCurrentTaskHandle() == flush_task)
+            {
+                atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+                return ESP_ERR_NO_MEM;
+            }
+            waited = true;
+            sd_log_wait_for_room();
+            head = atomic_load_explicit(&reserve_pos, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&reserve_pos, &head, head + need, memory_order_relaxed, memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    atomic_fetch_add_explicit(&records, 1, memory_order_relaxed);
+    if (waited)
+    {
+        atomic_fetch_add_explicit(&blocked, 1, memory_order_relaxed);
+    }
+    uint32_t mark = atomic_load_explicit(&high_water, memory_order_relaxed);
+    while (used + need > mark && !atomic_compare_exchange_weak_explicit(&high_water, &mark, used + need, memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+    *pos = head;
+    return ESP_OK;
+}
+
+esp_err_t sd_log_write(const void *data, size_t len)
+{
+    uint32_t pos = 0;
+
+    atomic_fetch_add(&writers, 1);
+    esp_err_t ret = sd_log_reserve(len, &pos);
+    if (ret == ESP_OK)
+    {
+        sd_log_ring_copy_in(pos + SD_LOG_HEADER_SIZE, data, len);
+        /*!< publishes the data to the flush task */
+        atomic_store_explicit(sd_log_header(pos), len, memory_order_release);
+    }
+    atomic_fetch_sub(&writers, 1);
+    return ret;
+}
+
+int sd_log_vprintf(const char *fmt, va_list args)
+{
+    va_list copy;
+
+    if (console_vprintf)
+    {
+        va_copy(copy, args);
+        console_vprintf(fmt, copy);
+        va_end(copy);
+    }
+    /*!< measured first so the line is formatted straight into its record, ESP_LOG callers carry no line buffer */
+    va_copy(copy, args);
+    int len = vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
+    if (len < 0)
+    {
+        return len;
+    }
+    if (len >= SD_LOG_LINE_MAX)
+    {
+        len = SD_LOG_LINE_MAX - 1;
+    }
+
+    uint32_t pos = 0;
+    atomic_fetch_add(&writers, 1);
+    esp_err_t ret = sd_log_reserve(len, &pos);
+    if (ret == ESP_OK)
+    {
+        /*!< a line over the end of the ring runs on into the spare bytes, its tail is moved to the start */
+        uint32_t start = (pos + SD_LOG_HEADER_SIZE) & ring_mask;
+        size_t first = ring_mask + 1 - start;
+        vsnprintf((char *)ring + start, len + 1, fmt, args);
+        if (first < (size_t)len)
+        {
+            memcpy(ring, ring + ring_mask + 1, len - first);
+        }
+        atomic_store_explicit(sd_log_header(pos), len, memory_order_release);
+    }
+    atomic_fetch_sub(&writers, 1);
+    return ret == ESP_OK ? len : -1;
+}
+
+int sd_log_printf(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int len = sd_log_vprintf(fmt, args);
+    va_end(args);
+
+    return len;
+}
+
+/**
+ * @brief write the cluster being filled at its place in the file, sync is the expensive part
+ */
+static void sd_log_write_block(bool sync)
+{
+    int64_t start = esp_timer_get_time();
+
+    if (block_fill)
+    {
+        if (pwrite(log_fd, block, block_fill, block_offset) != (ssize_t)block_fill)
+        {
+            ESP_LOGE(TAG, "Write at %ld failed", (long)block_offset);
+        }
+        log_stats.writes++;
+        log_stats.flushed += block_fill;
+    }
+    if (sync)
+    {
+        fsync(log_fd);
+        last_sync_us = esp_timer_get_time();
+        dirty = false;
+    }
+    uint32_t us = esp_timer_get_time() - start;
+    if (us > log_stats.max_write_us)
+    {
+        log_stats.max_write_us = us;
+    }
+}
+
+static void sd_log_append(const uint8_t *data, size_t len)
+{
+    dirty = true;
+    while (len)
+    {
+        size_t chunk = SD_LOG_BLOCK_SIZE - block_fill;
+        chunk = chunk < len ? chunk : len;
+        memcpy(block + block_fill, data, chunk);
+        block_fill += chunk;
+        data += chunk;
+        len -= chunk;
+
+        if (block_fill == SD_LOG_BLOCK_SIZE)
+        {
+            sd_log_write_block(false);
+            block_offset += SD_LOG_BLOCK_SIZE;
+            block_fill = 0;
+        }
+    }
+}
+
+/**
+ * @brief move every published record from the ring into clusters, full ones are written on the way
+ */
+static void sd_log_drain(void)
+{
+    uint32_t tail = atomic_load_explicit(&tail_pos, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&reserve_pos, memory_order_acquire);
+
+    while (tail != head)
+    {
+        uint32_t len = atomic_load_explicit(sd_log_header(tail), memory_order_acquire);
+        if (len == 0)
+        {
+            break;
+        }
+        uint32_t size = SD_LOG_RECORD_SIZE(len);
+        uint32_t start = (tail + SD_LOG_HEADER_SIZE) & ring_mask;
+        size_t first = ring_mask + 1 - start;
+        if (first >= len)
+        {
+            sd_log_append(ring + start, len);
+        }
+        else
+        {
+            sd_log_append(ring + start, first);
+            sd_log_append(ring, len - first);
+        }
+
+        /*!< any word of a record may be a header on a later lap, so all of it is cleared */
+        uint32_t clear = tail & ring_mask;
+        first = ring_mask + 1 - clear;
+        memset(ring + clear, 0, first >= size ? size : first);
+        if (first < size)
+        {
+            memset(ring, 0, size - first);
+        }
+        tail += size;
+        atomic_store_explicit(&tail_pos, tail, memory_order_release);
+    }
+}
+
+static void sd_log_task(void *arg)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(log_cfg.poll_ms));
+        bool stop = atomic_load(&stopping) && atomic_load(&writers) == 0;
+        uint32_t req = atomic_load(&flush_req);
+
+        sd_log_drain();
+        if (dirty && (stop || req != atomic_load(&flush_done) || esp_timer_get_time() - last_sync_us >= log_cfg.sync_ms * 1000LL))
+        {
+            sd_log_write_block(true);
+        }
+        atomic_store(&flush_done, req);
+        if (stop)
+        {
+            break;
+        }
+    }
+
+    close(log_fd);
+    log_fd = -1;
+    atomic_store(&stopped, true);
+    vTaskDelete(NULL);
+}
+
+esp_err_t sd_log_start(sd_log_config_t config)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config.path && config.ring_size >= 4 * SD_LOG_LINE_MAX && (config.ring_size & (config.ring_size - 1)) == 0, ESP_ERR_INVALID_ARG, TAG,
+                        "Ring size must be a power of two");
+    ESP_RETURN_ON_FALSE(ring == NULL, ESP_ERR_INVALID_STATE, TAG, "Already started");
+    log_cfg = config;
+    log_cfg.poll_ms = config.poll_ms ? config.poll_ms : 20;
+    log_cfg.sync_ms = config.sync_ms ? config.sync_ms : 1000;
+
+    ring = heap_caps_calloc(1, config.ring_size + SD_LOG_LINE_MAX, MALLOC_CAP_SPIRAM);
+    if (ring == NULL)
+    {
+        ring = heap_caps_calloc(1, config.ring_size + SD_LOG_LINE_MAX, MALLOC_CAP_INTERNAL);
+    }
+    block = heap_caps_aligned_alloc(SD_LOG_ALIGN, SD_LOG_BLOCK_SIZE, MALLOC_CAP_DMA);
+    ESP_GOTO_ON_FALSE(ring && block, ESP_ERR_NO_MEM, err, TAG, "No mem for ring");
+
+    log_fd = open(config.path, O_RDWR | O_CREAT, 0644);
+    ESP_GOTO_ON_FALSE(log_fd >= 0, ESP_ERR_NOT_FOUND, err, TAG, "Open %s failed", config.path);
+    /*!< the file may be new to the directory index */
+    sd_index_invalidate();
+
+    /*!< appending carries on in the last cluster, so every write stays cluster aligned */
+    off_t end = lseek(log_fd, 0, SEEK_END);
+    block_offset = end & ~(off_t)(SD_LOG_BLOCK_SIZE - 1);
+    block_fill = end - block_offset;
+    ESP_GOTO_ON_FALSE(block_fill == 0 || pread(log_fd, block, block_fill, block_offset) == (ssize_t)block_fill, ESP_FAIL, err, TAG, "Read the tail failed");
+
+    memset(&log_stats, 0, sizeof(log_stats));
+    atomic_store(&reserve_pos, 0);
+    atomic_store(&tail_pos, 0);
+    atomic_store(&records, 0);
+    atomic_store(&dropped, 0);
+    atomic_store(&blocked, 0);
+    atomic_store(&high_water, 0);
+    atomic_store(&stopping, false);
+    atomic_store(&stopped, false);
+    dirty = false;
+    last_sync_us = esp_timer_get_time();
+    ring_mask = config.ring_size - 1;
+
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(sd_log_task, "sd_log", 3072, NULL, config.task_priority, &flush_task, config.task_core) == pdPASS, ESP_ERR_NO_MEM, err,
+                      TAG, "Flush task create failed");
+    if (config.capture_esp_log)
+    {
+        console_vprintf = esp_log_set_vprintf(sd_log_vprintf);
+    }
+    ESP_LOGI(TAG, "Logging to %s from %ld, %u byte ring", config.path, (long)end, (unsigned)config.ring_size);
+
+    return ESP_OK;
+
+err:
+    if (log_fd >= 0)
+    {
+        close(log_fd);
+        log_fd = -1;
+    }
+    heap_caps_free(ring);
+    heap_caps_free(block);
+    ring = NULL;
+    block = NULL;
+    return ret;
+}
+
+esp_err_t sd_log_flush(TickType_t ticks_to_wait)
+{
+    ESP_RETURN_ON_FALSE(flush_task, ESP_ERR_INVALID_STATE, TAG, "Not started");
+    uint32_t req = atomic_fetch_add(&flush_req, 1) + 1;
+    TickType_t start = xTaskGetTickCount();
+
+    xTaskNotifyGive(flush_task);
+    while ((int32_t)(atomic_load(&flush_done) - req) < 0)
+    {
+        if (xTaskGetTickCount() - start >= ticks_to_wait)
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t sd_log_stop(void)
+{
+    ESP_RETURN_ON_FALSE(flush_task, ESP_ERR_INVALID_STATE, TAG, "Not started");
+
+    if (console_vprintf)
+    {
+        esp_log_set_vprintf(console_vprintf);
+        console_vprintf = NULL;
+    }
+    atomic_store(&stopping, true);
+    /*!< the flush task waits for writers that got in before the flag, then drains once more */
+    while (!atomic_load(&stopped))
+    {
+        xTaskNotifyGive(flush_task);
+        vTaskDelay(1);
+    }
+    flush_task = NULL;
+    /*!< the index walks again for the final size */
+    sd_index_invalidate();
+
+    heap_caps_free(ring);
+    heap_caps_free(block);
+    ring = NULL;
+    block = NULL;
+
+    return ESP_OK;
+}
+
+void sd_log_get_stats(sd_log_stats_t *stats)
+{
+    *stats = log_stats;
+    stats->records = atomic_load(&records);
+    stats->dropped = atomic_load(&dropped);
+    stats->blocked = atomic_load(&blocked);
+    stats->high_water = atomic_load(&high_water);
+    stats->ring_size = ring_mask + 1;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "sdmmc_cmd.h"
+#endif
+
+#define SD_RAW_SECTOR_SIZE 512
+
+typedef struct sd_raw_dev_t sd_raw_dev_t;
+
+/**
+ * @brief a range of sectors, sector 0 is the first sector of the range
+ */
+struct sd_raw_dev_t
+{
+    esp_err_t (*read)(sd_raw_dev_t *dev, uint32_t sector, void *buf, uint32_t count);
+    esp_err_t (*write)(sd_raw_dev_t *dev, uint32_t sector, const void *buf, uint32_t count);
+    esp_err_t (*del)(sd_raw_dev_t *dev);
+    uint32_t sector_count;
+    uint32_t first_sector; /*!< where sector 0 is on the card, 0 for a file */
+};
+
+typedef sd_raw_dev_t *sd_raw_dev_handle_t;
+
+#if !CONFIG_IDF_TARGET_LINUX
+/**
+ * @brief sectors of the card itself, e.g. a spare partition or a region from sd_card_reserve_region
+ *
+ * Buffers should be DMA capable and word aligned, otherwise the driver copies every sector.
+ *
+ * @param card
+ * @param first_sector on the card, a multiple of the chunk_sectors of a log on it
+ * @param sector_count
+ * @param ret_dev
+ * @return esp_err_t
+ */
+esp_err_t sd_raw_dev_new_sdmmc(sdmmc_card_t *card, uint32_t first_sector, uint32_t sector_count, sd_raw_dev_handle_t *ret_dev);
+#endif
+
+/**
+ * @brief a file that stands in for the card, for host tests and for images pulled off a card
+ *
+ * @param path created and extended to sector_count sectors if needed
+ * @param sector_count
+ * @param ret_dev
+ * @return esp_err_t
+ */
+esp_err_t sd_raw_dev_new_file(const char *path, uint32_t sector_count, sd_raw_dev_handle_t *ret_dev);
+
+static inline esp_err_t sd_raw_dev_read(sd_raw_dev_handle_t dev, uint32_t sector, void *buf, uint32_t count)
+{
+    return (sector + count <= dev->sector_count) ? dev->read(dev, sector, buf, count) : ESP_ERR_INVALID_SIZE;
+}
+
+static inline esp_err_t sd_raw_dev_write(sd_raw_dev_handle_t dev, uint32_t sector, const void *buf, uint32_t count)
+{
+    return (sector + count <= dev->sector_count) ? dev->write(dev, sector, buf, count) : ESP_ERR_INVALID_SIZE;
+}
+
+static inline esp_err_t sd_raw_dev_del(sd_raw_dev_handle_t dev)
+{
+    return dev->del(dev);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "sd_raw_dev.h"
+
+#define SD_RAW_LOG_MAGIC 0x474c5752 /*!< "RWLG" */
+
+/**
+ * @brief on the card every record starts with this header, records never cross a chunk
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint32_t log_id; /*!< picked at format, records of an older log are ignored */
+    uint32_t seq;    /*!< consecutive over the whole log */
+    uint32_t len;
+    uint64_t time_us;
+    uint32_t data_crc;
+    uint32_t header_crc; /*!< over the fields above */
+} sd_raw_log_header_t;
+
+typedef struct
+{
+    uint32_t chunk_sectors; /*!< write unit, a multiple of the card's erase block, e.g. 128 for 64 KB, the device starts on one */
+} sd_raw_log_config_t;
+
+typedef struct
+{
+    uint32_t log_id;
+    uint32_t first_seq; /*!< oldest record still on the card */
+    uint32_t next_seq;
+    uint32_t chunks;
+    uint32_t head_chunk;     /*!< the chunk being filled */
+    uint32_t recovery_reads; /*!< sector reads the mount scan needed */
+    uint32_t recovery_us;
+    uint32_t dropped;        /*!< torn records thrown away by the mount scan */
+    uint32_t chunk_writes;   /*!< a partial chunk rewritten by sd_raw_log_sync counts again */
+    uint64_t sectors_written;
+} sd_raw_log_stats_t;
+
+typedef struct sd_raw_log_t *sd_raw_log_handle_t;
+
+/**
+ * @brief called for every record, oldest first, return false to stop
+ */
+typedef bool (*sd_raw_log_visit_cb_t)(const sd_raw_log_header_t *header, const void *data, void *user_ctx);
+
+/**
+ * @brief start an empty log on the device, what was logged before is gone
+ *
+ * @param dev
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t sd_raw_log_format(sd_raw_dev_handle_t dev, sd_raw_log_config_t config);
+
+/**
+ * @brief find the end of the log and carry on from there
+ *
+ * The first record of every chunk is enough to find the newest chunk by bisection, only
+ * that chunk is read whole. Records after a torn or corrupt one in it are dropped.
+ *
+ * @param dev stays owned by the caller and must outlive the log
+ * @param config the same as at format
+ * @param ret_log
+ * @return esp_err_t ESP_ERR_NOT_FOUND if the device holds no log, format it first
+ */
+esp_err_t sd_raw_log_open(sd_raw_dev_handle_t dev, sd_raw_log_config_t config, sd_raw_log_handle_t *ret_log);
+
+/**
+ * @brief add one record, full chunks are written as one multi-sector transfer
+ *
+ * When the log is full the oldest chunk is overwritten.
+ *
+ * @param log
+ * @param data
+ * @param len at most a chunk less one header
+ * @return esp_err_t
+ */
+esp_err_t sd_raw_log_append(sd_raw_log_handle_t log, const void *data, size_t len);
+
+/**
+ * @brief write the sectors of the current chunk filled so far, the chunk is written again when it fills
+ *
+ * @param log
+ * @return esp_err_t
+ */
+esp_err_t sd_raw_log_sync(sd_raw_log_handle_t log);
+
+/**
+ * @brief read every record back from the card, oldest first
+ *
+ * @param log
+ * @param cb
+ * @param user_ctx
+ * @return esp_err_t
+ */
+esp_err_t sd_raw_log_foreach(sd_raw_log_handle_t log, sd_raw_log_visit_cb_t cb, void *user_ctx);
+
+/**
+ * @brief copy the data of every record, oldest first, into a file, e.g. on the FAT mount
+ *
+ * @param log
+ * @param path created or truncated
+ * @param with_headers keep sd_raw_log_header_t in front of every record
+ * @return esp_err_t
+ */
+esp_err_t sd_raw_log_export(sd_raw_log_handle_t log, const char *path, bool with_headers);
+
+/**
+ * @brief sync and free the log, the device is left alone
+ *
+ * @param log
+ * @return esp_err_t
+ */
+esp_err_t sd_raw_log_close(sd_raw_log_handle_t log);
+
+/**
+ * @brief counters since open, with what the mount scan found
+ *
+ * @param log
+ * @param stats
+ */
+void sd_raw_log_get_stats(sd_raw_log_handle_t log, sd_raw_log_stats_t *stats);
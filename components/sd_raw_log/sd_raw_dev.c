@@ -0,0 +1,121 @@
+#include "sd_raw_dev.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "stdlib.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "stddef.h"
+#include "sys/cdefs.h"
+
+#ifndef __containerof
+/*!< newlib has it, the glibc of the linux target does not */
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
+
+typedef struct
+{
+    sd_raw_dev_t base;
+    int fd;
+} sd_raw_file_dev_t;
+
+static const char *TAG = "SD_RAW_DEV";
+
+#if !CONFIG_IDF_TARGET_LINUX
+typedef struct
+{
+    sd_raw_dev_t base;
+    sdmmc_card_t *card;
+    uint32_t first_sector;
+} sd_raw_sdmmc_dev_t;
+
+static esp_err_t sd_raw_sdmmc_read(sd_raw_dev_t *dev, uint32_t sector, void *buf, uint32_t count)
+{
+    sd_raw_sdmmc_dev_t *sdmmc = __containerof(dev, sd_raw_sdmmc_dev_t, base);
+    return sdmmc_read_sectors(sdmmc->card, buf, sdmmc->first_sector + sector, count);
+}
+
+static esp_err_t sd_raw_sdmmc_write(sd_raw_dev_t *dev, uint32_t sector, const void *buf, uint32_t count)
+{
+    sd_raw_sdmmc_dev_t *sdmmc = __containerof(dev, sd_raw_sdmmc_dev_t, base);
+    /*!< one CMD25 for the whole range */
+    return sdmmc_write_sectors(sdmmc->card, buf, sdmmc->first_sector + sector, count);
+}
+
+static esp_err_t sd_raw_sdmmc_del(sd_raw_dev_t *dev)
+{
+    free(__containerof(dev, sd_raw_sdmmc_dev_t, base));
+    return ESP_OK;
+}
+
+esp_err_t sd_raw_dev_new_sdmmc(sdmmc_card_t *card, uint32_t first_sector, uint32_t sector_count, sd_raw_dev_handle_t *ret_dev)
+{
+    ESP_RETURN_ON_FALSE(card && ret_dev && sector_count, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(card->csd.sector_size == SD_RAW_SECTOR_SIZE, ESP_ERR_NOT_SUPPORTED, TAG, "Sector size %d", card->csd.sector_size);
+    ESP_RETURN_ON_FALSE((uint64_t)first_sector + sector_count <= (uint64_t)card->csd.capacity, ESP_ERR_INVALID_SIZE, TAG, "Past the end of the card");
+
+    sd_raw_sdmmc_dev_t *sdmmc = calloc(1, sizeof(sd_raw_sdmmc_dev_t));
+    ESP_RETURN_ON_FALSE(sdmmc, ESP_ERR_NO_MEM, TAG, "No mem for device");
+    sdmmc->card = card;
+    sdmmc->first_sector = first_sector;
+    sdmmc->base.read = sd_raw_sdmmc_read;
+    sdmmc->base.write = sd_raw_sdmmc_write;
+    sdmmc->base.del = sd_raw_sdmmc_del;
+    sdmmc->base.sector_count = sector_count;
+    sdmmc->base.first_sector = first_sector;
+    *ret_dev = &sdmmc->base;
+
+    ESP_LOGI(TAG, "Card sectors %lu..%lu", (unsigned long)first_sector, (unsigned long)(first_sector + sector_count - 1));
+    return ESP_OK;
+}
+#endif
+
+static esp_err_t sd_raw_file_read(sd_raw_dev_t *dev, uint32_t sector, void *buf, uint32_t count)
+{
+    sd_raw_file_dev_t *file = __containerof(dev, sd_raw_file_dev_t, base);
+    size_t len = (size_t)count * SD_RAW_SECTOR_SIZE;
+    return pread(file->fd, buf, len, (off_t)sector * SD_RAW_SECTOR_SIZE) == (ssize_t)len ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t sd_raw_file_write(sd_raw_dev_t *dev, uint32_t sector, const void *buf, uint32_t count)
+{
+    sd_raw_file_dev_t *file = __containerof(dev, sd_raw_file_dev_t, base);
+    size_t len = (size_t)count * SD_RAW_SECTOR_SIZE;
+    return pwrite(file->fd, buf, len, (off_t)sector * SD_RAW_SECTOR_SIZE) == (ssize_t)len ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t sd_raw_file_del(sd_raw_dev_t *dev)
+{
+    sd_raw_file_dev_t *file = __containerof(dev, sd_raw_file_dev_t, base);
+    close(file->fd);
+    free(file);
+    return ESP_OK;
+}
+
+esp_err_t sd_raw_dev_new_file(const char *path, uint32_t sector_count, sd_raw_dev_handle_t *ret_dev)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(path && ret_dev && sector_count, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    sd_raw_file_dev_t *file = calloc(1, sizeof(sd_raw_file_dev_t));
+    ESP_RETURN_ON_FALSE(file, ESP_ERR_NO_MEM, TAG, "No mem for device");
+    file->fd = open(path, O_RDWR | O_CREAT, 0644);
+    ESP_GOTO_ON_FALSE(file->fd >= 0, ESP_ERR_NOT_FOUND, err, TAG, "Open %s failed", path);
+    /*!< a fresh image reads back as zeros, like an erased card */
+    off_t size = (off_t)sector_count * SD_RAW_SECTOR_SIZE;
+    ESP_GOTO_ON_FALSE(lseek(file->fd, 0, SEEK_END) >= size || ftruncate(file->fd, size) == 0, ESP_FAIL, err, TAG, "Extend %s failed", path);
+
+    file->base.read = sd_raw_file_read;
+    file->base.write = sd_raw_file_write;
+    file->base.del = sd_raw_file_del;
+    file->base.sector_count = sector_count;
+    *ret_dev = &file->base;
+    return ESP_OK;
+
+err:
+    if (file->fd >= 0)
+    {
+        close(file->fd);
+    }
+    free(file);
+    return ret;
+}
@@ -0,0 +1,403 @@
+#include "sd_raw_log.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "string.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "sd_index.h"
+
+#define SD_RAW_LOG_ALIGN 64
+#define SD_RAW_LOG_ALIGN4(x) (((x) + 3) & ~3u)
+#define SD_RAW_LOG_HEADER_SIZE sizeof(sd_raw_log_header_t)
+#define SD_RAW_LOG_EXPORT_BUF (16 * 1024)
+
+typedef struct sd_raw_log_t
+{
+    sd_raw_dev_handle_t dev;
+    sd_raw_log_config_t config;
+    uint32_t chunk_bytes;
+    uint8_t *chunk;      /*!< the head chunk, DMA capable */
+    uint32_t fill;       /*!< bytes of it in use */
+    uint32_t tail_chunk; /*!< holds the oldest record */
+    bool wrapped;        /*!< every chunk has been written, the next one holds the oldest records */
+    uint32_t reads;      /*!< single sector header reads */
+    sd_raw_log_stats_t stats;
+} sd_raw_log_t;
+
+static const char *TAG = "SD_RAW_LOG";
+
+static uint32_t crc_table[256];
+
+static void sd_raw_log_crc_init(void)
+{
+    if (crc_table[1])
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320 : 0);
+        }
+        crc_table[i] = crc;
+    }
+}
+
+static uint32_t sd_raw_log_crc(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = 0xffffffff;
+    while (len--)
+    {
+        crc = (crc >> 8) ^ crc_table[(crc ^ *p++) & 0xff];
+    }
+    return ~crc;
+}
+
+/**
+ * @brief a header that could have been written by this log, log_id 0 takes any log
+ */
+static bool sd_raw_log_header_ok(const sd_raw_log_t *log, const sd_raw_log_header_t *header, uint32_t log_id)
+{
+    return header->magic == SD_RAW_LOG_MAGIC && (log_id == 0 || header->log_id == log_id) && header->len <= log->chunk_bytes - SD_RAW_LOG_HEADER_SIZE &&
+           header->header_crc == sd_raw_log_crc(header, offsetof(sd_raw_log_header_t, header_crc));
+}
+
+/**
+ * @brief read the header that starts a chunk, one sector
+ */
+static bool sd_raw_log_chunk_first(sd_raw_log_t *log, uint32_t chunk, uint32_t log_id, sd_raw_log_header_t *header)
+{
+    /*!< the head chunk buffer is free while this is used */
+    log->reads++;
+    if (sd_raw_dev_read(log->dev, chunk * log->config.chunk_sectors, log->chunk, 1) != ESP_OK)
+    {
+        return false;
+    }
+    memcpy(header, log->chunk, SD_RAW_LOG_HEADER_SIZE);
+    return sd_raw_log_header_ok(log, header, log_id);
+}
+
+/**
+ * @brief walk the records of one chunk in memory, stops at the first one that does not follow
+ *
+ * @return uint32_t bytes of the chunk taken by good records
+ */
+static uint32_t sd_raw_log_scan(sd_raw_log_t *log, const uint8_t *chunk, uint32_t *seq, sd_raw_log_visit_cb_t cb, void *user_ctx, bool *stop)
+{
+    uint32_t offset = 0;
+    bool any_seq = true; /*!< a chunk after a corrupt one is still read */
+    sd_raw_log_header_t header;
+
+    while (offset + SD_RAW_LOG_HEADER_SIZE <= log->chunk_bytes)
+    {
+        memcpy(&header, chunk + offset, SD_RAW_LOG_HEADER_SIZE);
+        uint32_t size = SD_RAW_LOG_HEADER_SIZE + SD_RAW_LOG_ALIGN4(header.len);
+        if (!sd_raw_log_header_ok(log, &header, log->stats.log_id) || (!any_seq && header.seq != *seq) || offset + size > log->chunk_bytes)
+        {
+            break;
+        }
+        const uint8_t *data = chunk + offset + SD_RAW_LOG_HEADER_SIZE;
+        if (header.data_crc != sd_raw_log_crc(data, header.len))
+        {
+            log->stats.dropped += cb == NULL;
+            break;
+        }
+        /*!< the empty record sd_raw_log_format starts with is not handed out */
+        if (cb && header.len && !cb(&header, data, user_ctx))
+        {
+            *stop = true;
+            return offset + size;
+        }
+        *seq = header.seq + 1;
+        any_seq = false;
+        offset += size;
+    }
+    return offset;
+}
+
+static esp_err_t sd_raw_log_write_chunk(sd_raw_log_t *log, uint32_t sectors)
+{
+    log->stats.chunk_writes++;
+    log->stats.sectors_written += sectors;
+    return sd_raw_dev_write(log->dev, log->stats.head_chunk * log->config.chunk_sectors, log->chunk, sectors);
+}
+
+/**
+ * @brief the head chunk is on the card, start filling the next one
+ */
+static void sd_raw_log_advance(sd_raw_log_t *log)
+{
+    sd_raw_log_header_t header;
+
+    log->stats.head_chunk = (log->stats.head_chunk + 1) % log->stats.chunks;
+    if (log->stats.head_chunk == 0)
+    {
+        log->wrapped = true;
+    }
+    if (log->wrapped)
+    {
+        /*!< the new head is given up, the chunk after it is the oldest now */
+        log->tail_chunk = (log->stats.head_chunk + 1) % log->stats.chunks;
+        if (sd_raw_log_chunk_first(log, log->tail_chunk, log->stats.log_id, &header))
+        {
+            log->stats.first_seq = header.seq;
+        }
+    }
+    memset(log->chunk, 0, log->chunk_bytes);
+    log->fill = 0;
+}
+
+static void sd_raw_log_put(sd_raw_log_t *log, const void *data, size_t len)
+{
+    sd_raw_log_header_t header = {
+        .magic = SD_RAW_LOG_MAGIC,
+        .log_id = log->stats.log_id,
+        .seq = log->stats.next_seq++,
+        .len = len,
+        .time_us = esp_timer_get_time(),
+        .data_crc = sd_raw_log_crc(data, len),
+    };
+    header.header_crc = sd_raw_log_crc(&header, offsetof(sd_raw_log_header_t, header_crc));
+
+    memcpy(log->chunk + log->fill, &header, SD_RAW_LOG_HEADER_SIZE);
+    if (len)
+    {
+        memcpy(log->chunk + log->fill + SD_RAW_LOG_HEADER_SIZE, data, len);
+    }
+    log->fill += SD_RAW_LOG_HEADER_SIZE + SD_RAW_LOG_ALIGN4(len);
+}
+
+static esp_err_t sd_raw_log_new(sd_raw_dev_handle_t dev, sd_raw_log_config_t config, sd_raw_log_t **ret_log)
+{
+    ESP_RETURN_ON_FALSE(dev && config.chunk_sectors, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(dev->sector_count / config.chunk_sectors >= 2, ESP_ERR_INVALID_SIZE, TAG, "Room for less than two chunks");
+    /*!< chunks are counted from the first sector, they only line up with erase blocks if it does */
+    ESP_RETURN_ON_FALSE(dev->first_sector % config.chunk_sectors == 0, ESP_ERR_INVALID_SIZE, TAG, "Sector %lu is not on a chunk boundary",
+                        (unsigned long)dev->first_sector);
+    sd_raw_log_crc_init();
+
+    sd_raw_log_t *log = calloc(1, sizeof(sd_raw_log_t));
+    ESP_RETURN_ON_FALSE(log, ESP_ERR_NO_MEM, TAG, "No mem for log");
+    log->dev = dev;
+    log->config = config;
+    log->chunk_bytes = config.chunk_sectors * SD_RAW_SECTOR_SIZE;
+    log->stats.chunks = dev->sector_count / config.chunk_sectors;
+    /*!< the SDMMC driver copies sector by sector through a bounce buffer otherwise */
+    log->chunk = heap_caps_aligned_alloc(SD_RAW_LOG_ALIGN, log->chunk_bytes, MALLOC_CAP_DMA);
+    if (log->chunk == NULL)
+    {
+        free(log);
+        ESP_LOGE(TAG, "No mem for %lu byte chunk", (unsigned long)(config.chunk_sectors * SD_RAW_SECTOR_SIZE));
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_log = log;
+    return ESP_OK;
+}
+
+static void sd_raw_log_free(sd_raw_log_t *log)
+{
+    heap_caps_free(log->chunk);
+    free(log);
+}
+
+esp_err_t sd_raw_log_format(sd_raw_dev_handle_t dev, sd_raw_log_config_t config)
+{
+    sd_raw_log_t *log = NULL;
+    sd_raw_log_header_t header;
+    ESP_RETURN_ON_ERROR(sd_raw_log_new(dev, config, &log), TAG, "Format failed");
+
+    /*!< a new id makes every record already on the card foreign, nothing has to be erased */
+    log->stats.log_id = sd_raw_log_chunk_first(log, 0, 0, &header) ? header.log_id + 1 : (uint32_t)esp_timer_get_time();
+    if (log->stats.log_id == 0)
+    {
+        log->stats.log_id = 1;
+    }
+    memset(log->chunk, 0, log->chunk_bytes);
+    sd_raw_log_put(log, NULL, 0);
+    esp_err_t ret = sd_raw_log_write_chunk(log, config.chunk_sectors);
+    ESP_LOGI(TAG, "Formatted log %08lx, %lu chunks of %lu sectors", (unsigned long)log->stats.log_id, (unsigned long)log->stats.chunks,
+             (unsigned long)config.chunk_sectors);
+    sd_raw_log_free(log);
+
+    return ret;
+}
+
+esp_err_t sd_raw_log_open(sd_raw_dev_handle_t dev, sd_raw_log_config_t config, sd_raw_log_handle_t *ret_log)
+{
+    esp_err_t ret = ESP_OK;
+    sd_raw_log_t *log = NULL;
+    sd_raw_log_header_t ref;
+    sd_raw_log_header_t header;
+    ESP_RETURN_ON_FALSE(ret_log, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_ERROR(sd_raw_log_new(dev, config, &log), TAG, "Open failed");
+    int64_t start = esp_timer_get_time();
+
+    /*!< chunk 0 may have been torn by the first write of a new lap, chunk 1 then holds the oldest records */
+    uint32_t ref_chunk = 0;
+    if (!sd_raw_log_chunk_first(log, 0, 0, &ref))
+    {
+        ref_chunk = 1;
+        ESP_GOTO_ON_FALSE(sd_raw_log_chunk_first(log, 1, 0, &ref), ESP_ERR_NOT_FOUND, err, TAG, "No log on the device");
+    }
+    log->stats.log_id = ref.log_id;
+
+    /*!< first seqs rise from ref_chunk up to the head, then drop to an older lap or to nothing */
+    sd_raw_log_header_t head = ref;
+    uint32_t lo = ref_chunk;
+    uint32_t hi = log->stats.chunks;
+    while (hi - lo > 1)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (sd_raw_log_chunk_first(log, mid, ref.log_id, &header) && (int32_t)(header.seq - ref.seq) >= 0)
+        {
+            lo = mid;
+            head = header;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    log->stats.head_chunk = lo;
+    log->tail_chunk = ref_chunk;
+    log->stats.first_seq = ref.seq;
+    if (sd_raw_log_chunk_first(log, (lo + 1) % log->stats.chunks, ref.log_id, &header) && (int32_t)(header.seq - head.seq) < 0)
+    {
+        log->wrapped = true;
+        log->tail_chunk = (lo + 1) % log->stats.chunks;
+        log->stats.first_seq = header.seq;
+    }
+
+    /*!< the head chunk is read whole and carried on in RAM */
+    log->stats.recovery_reads = log->reads + config.chunk_sectors;
+    ESP_GOTO_ON_ERROR(sd_raw_dev_read(dev, lo * config.chunk_sectors, log->chunk, config.chunk_sectors), err, TAG, "Read chunk %lu failed", (unsigned long)lo);
+    bool stop = false;
+    uint32_t seq = head.seq; /*!< taken again if the first record of the chunk is torn */
+    log->fill = sd_raw_log_scan(log, log->chunk, &seq, NULL, NULL, &stop);
+    memset(log->chunk + log->fill, 0, log->chunk_bytes - log->fill);
+    log->stats.next_seq = seq;
+    log->stats.recovery_us = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "Log %08lx: records %lu..%lu, head chunk %lu of %lu, %lu reads in %lu us", (unsigned long)log->stats.log_id, (unsigned long)log->stats.first_seq,
+             (unsigned long)(log->stats.next_seq - 1), (unsigned long)lo, (unsigned long)log->stats.chunks, (unsigned long)log->stats.recovery_reads,
+             (unsigned long)log->stats.recovery_us);
+    *ret_log = log;
+    return ESP_OK;
+
+err:
+    sd_raw_log_free(log);
+    return ret;
+}
+
+esp_err_t sd_raw_log_append(sd_raw_log_handle_t log, const void *data, size_t len)
+{
+    ESP_RETURN_ON_FALSE(log && data && len, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    uint32_t size = SD_RAW_LOG_HEADER_SIZE + SD_RAW_LOG_ALIGN4(len);
+    ESP_RETURN_ON_FALSE(size <= log->chunk_bytes, ESP_ERR_INVALID_SIZE, TAG, "Record longer than a chunk");
+
+    if (log->fill + size > log->chunk_bytes)
+    {
+        /*!< the rest of the chunk stays zero, a zero magic ends it */
+        ESP_RETURN_ON_ERROR(sd_raw_log_write_chunk(log, log->config.chunk_sectors), TAG, "Write chunk %lu failed", (unsigned long)log->stats.head_chunk);
+        sd_raw_log_advance(log);
+    }
+    sd_raw_log_put(log, data, len);
+
+    return ESP_OK;
+}
+
+esp_err_t sd_raw_log_sync(sd_raw_log_handle_t log)
+{
+    ESP_RETURN_ON_FALSE(log, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    uint32_t sectors = (log->fill + SD_RAW_SECTOR_SIZE - 1) / SD_RAW_SECTOR_SIZE;
+
+    return sectors ? sd_raw_log_write_chunk(log, sectors) : ESP_OK;
+}
+
+esp_err_t sd_raw_log_foreach(sd_raw_log_handle_t log, sd_raw_log_visit_cb_t cb, void *user_ctx)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(log && cb, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    uint8_t *chunk = heap_caps_aligned_alloc(SD_RAW_LOG_ALIGN, log->chunk_bytes, MALLOC_CAP_DMA);
+    ESP_RETURN_ON_FALSE(chunk, ESP_ERR_NO_MEM, TAG, "No mem for chunk");
+    uint32_t seq = 0;
+    bool stop = false;
+
+    for (uint32_t c = log->tail_chunk; !stop; c = (c + 1) % log->stats.chunks)
+    {
+        if (c == log->stats.head_chunk)
+        {
+            /*!< includes what was not synced yet */
+            sd_raw_log_scan(log, log->chunk, &seq, cb, user_ctx, &stop);
+            break;
+        }
+        ESP_GOTO_ON_ERROR(sd_raw_dev_read(log->dev, c * log->config.chunk_sectors, chunk, log->config.chunk_sectors), out, TAG, "Read chunk %lu failed",
+                          (unsigned long)c);
+        sd_raw_log_scan(log, chunk, &seq, cb, user_ctx, &stop);
+    }
+
+out:
+    heap_caps_free(chunk);
+    return ret;
+}
+
+typedef struct
+{
+    FILE *f;
+    bool with_headers;
+    bool failed;
+} sd_raw_log_export_t;
+
+static bool sd_raw_log_export_cb(const sd_raw_log_header_t *header, const void *data, void *user_ctx)
+{
+    sd_raw_log_export_t *ctx = (sd_raw_log_export_t *)user_ctx;
+
+    if ((ctx->with_headers && fwrite(header, SD_RAW_LOG_HEADER_SIZE, 1, ctx->f) != 1) || fwrite(data, 1, header->len, ctx->f) != header->len)
+    {
+        ctx->failed = true;
+        return false;
+    }
+    return true;
+}
+
+esp_err_t sd_raw_log_export(sd_raw_log_handle_t log, const char *path, bool with_headers)
+{
+    ESP_RETURN_ON_FALSE(log && path, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    sd_raw_log_export_t ctx = {
+        .f = fopen(path, "wb"),
+        .with_headers = with_headers,
+    };
+    ESP_RETURN_ON_FALSE(ctx.f, ESP_ERR_NOT_FOUND, TAG, "Create %s failed", path);
+    /*!< whole clusters to FATFS */
+    setvbuf(ctx.f, NULL, _IOFBF, SD_RAW_LOG_EXPORT_BUF);
+
+    esp_err_t ret = sd_raw_log_foreach(log, sd_raw_log_export_cb, &ctx);
+    if (fclose(ctx.f) != 0 || ctx.failed)
+    {
+        ret = ESP_FAIL;
+    }
+    sd_index_invalidate();
+    ESP_RETURN_ON_ERROR(ret, TAG, "Export to %s failed", path);
+
+    return ESP_OK;
+}
+
+esp_err_t sd_raw_log_close(sd_raw_log_handle_t log)
+{
+    ESP_RETURN_ON_FALSE(log, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    esp_err_t ret = sd_raw_log_sync(log);
+    sd_raw_log_free(log);
+
+    return ret;
+}
+
+void sd_raw_log_get_stats(sd_raw_log_handle_t log, sd_raw_log_stats_t *stats)
+{
+    *stats = log->stats;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "esp_err.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "sys/types.h"
+#include "freertos/FreeRTOS.h"
+
+#define SD_STREAM_SECTOR_SIZE 512
+#define SD_STREAM_BUFFER_NUM 2 /*!< one with the caller, one with the I/O task */
+
+typedef enum
+{
+    SD_STREAM_SEQUENTIAL, /*!< the next block is read ahead while the caller works on the current one */
+    SD_STREAM_RANDOM,     /*!< no read ahead, every read goes to the given offset */
+} sd_stream_access_t;
+
+typedef struct
+{
+    size_t block_size;         /*!< bytes per transfer, a multiple of SD_STREAM_SECTOR_SIZE */
+    sd_stream_access_t access;
+    uint8_t task_priority;     /*!< of the shared I/O task, taken from the first open */
+    int task_core;
+} sd_stream_config_t;
+
+typedef struct
+{
+    uint64_t bytes;
+    uint32_t transfers;
+    uint64_t io_us;   /*!< spent in read and write by the I/O task */
+    uint64_t wait_us; /*!< the caller blocked on the I/O task, the rest overlapped */
+} sd_stream_stats_t;
+
+typedef struct sd_stream_t *sd_stream_handle_t;
+
+/**
+ * @brief open a file for streaming, the buffers are DMA capable and cache line aligned
+ *
+ * Blocks that start on a sector boundary go to the card as one multi-sector transfer
+ * without a copy through the FATFS sector buffer.
+ *
+ * @param path
+ * @param write true to create or truncate the file for writing
+ * @param config
+ * @param ret_stream
+ * @return esp_err_t
+ */
+esp_err_t sd_stream_open(const char *path, bool write, sd_stream_config_t config, sd_stream_handle_t *ret_stream);
+
+/**
+ * @brief get the next block, the previous one goes back to the I/O task
+ *
+ * @param stream
+ * @param data valid until the next call
+ * @param len 0 at the end of the file
+ * @return esp_err_t
+ */
+esp_err_t sd_stream_read(sd_stream_handle_t stream, const void **data, size_t *len);
+
+/**
+ * @brief move the read or write position, waits for the transfers in flight
+ *
+ * @param stream
+ * @param offset a multiple of SD_STREAM_SECTOR_SIZE keeps the fast path
+ * @return esp_err_t
+ */
+esp_err_t sd_stream_seek(sd_stream_handle_t stream, off_t offset);
+
+/**
+ * @brief get an empty block_size buffer to fill, waits while both are being written
+ *
+ * @param stream
+ * @param buf
+ * @return esp_err_t the error of an earlier write, if any
+ */
+esp_err_t sd_stream_get_buffer(sd_stream_handle_t stream, void **buf);
+
+/**
+ * @brief hand the buffer from sd_stream_get_buffer to the I/O task and return at once
+ *
+ * @param stream
+ * @param len at most block_size, only the last block should be short
+ * @return esp_err_t
+ */
+esp_err_t sd_stream_write(sd_stream_handle_t stream, size_t len);
+
+/**
+ * @brief finish the transfers in flight, flush and close
+ *
+ * @param stream
+ * @param stats may be NULL
+ * @return esp_err_t the first error of the stream
+ */
+esp_err_t sd_stream_close(sd_stream_handle_t stream, sd_stream_stats_t *stats);
+
+typedef struct
+{
+    size_t block_size;
+    bool write;
+    uint64_t bytes;
+    uint64_t time_us;
+    uint32_t kb_per_sec;
+    uint32_t wait_pct; /*!< share of the time the caller waited on the card */
+} sd_stream_bench_result_t;
+
+/**
+ * @brief called after every block size and direction
+ */
+typedef void (*sd_stream_bench_cb_t)(const sd_stream_bench_result_t *result, void *user_ctx);
+
+/**
+ * @brief write then read back file_size bytes at every power of two block size from 512 B to 64 KB
+ *
+ * The data is checked on the way back, the file is removed at the end.
+ *
+ * @param path file to create
+ * @param file_size
+ * @param config block_size is swept, the rest is used as given
+ * @param cb may be NULL, every result is logged as well
+ * @param user_ctx
+ * @return esp_err_t ESP_ERR_INVALID_CRC if data did not read back
+ */
+esp_err_t sd_stream_bench(const char *path, size_t file_size, sd_stream_config_t config, sd_stream_bench_cb_t cb, void *user_ctx);
@@ -0,0 +1,299 @@
+#include "sd_stream.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "string.h"
+#include "stdlib.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "sd_index.h"
+
+#define SD_STREAM_ALIGN 64
+#define SD_STREAM_IO_QUEUE_LEN 8
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t len; /*!< requested, then what was transferred */
+    off_t offset;
+    esp_err_t err;
+} sd_stream_block_t;
+
+typedef struct sd_stream_t
+{
+    int fd;
+    bool write;
+    bool eof; /*!< a read came back short, stop reading ahead */
+    sd_stream_config_t config;
+    sd_stream_block_t blocks[SD_STREAM_BUFFER_NUM];
+    QueueHandle_t done; /*!< blocks back from the I/O task, the free list when writing */
+    sd_stream_block_t *held; /*!< with the caller */
+    int pending;             /*!< blocks that will arrive in done */
+    off_t offset;            /*!< of the next block handed to the I/O task */
+    esp_err_t err;           /*!< first error, sticky */
+    sd_stream_stats_t stats;
+} sd_stream_t;
+
+typedef struct
+{
+    sd_stream_t *stream;
+    sd_stream_block_t *block;
+} sd_stream_req_t;
+
+static const char *TAG = "SD_STREAM";
+
+static QueueHandle_t io_queue = NULL;
+static TaskHandle_t io_task = NULL;
+
+static void sd_stream_io_task(void *arg)
+{
+    sd_stream_req_t req;
+
+    while (1)
+    {
+        xQueueReceive(io_queue, &req, portMAX_DELAY);
+        sd_stream_t *stream = req.stream;
+        sd_stream_block_t *block = req.block;
+
+        int64_t start = esp_timer_get_time();
+        /*!< positioned transfers, the caller may move the offset of the next block meanwhile */
+        ssize_t n = stream->write ? pwrite(stream->fd, block->buf, block->len, block->offset) : pread(stream->fd, block->buf, block->len, block->offset);
+        stream->stats.io_us += esp_timer_get_time() - start;
+
+        if (n < 0 || (stream->write && (size_t)n != block->len))
+        {
+            block->err = ESP_FAIL;
+            n = 0;
+        }
+        block->len = n;
+        stream->stats.bytes += n;
+        stream->stats.transfers++;
+        xQueueSend(stream->done, &block, portMAX_DELAY);
+    }
+}
+
+static void sd_stream_submit(sd_stream_t *stream, sd_stream_block_t *block, size_t len)
+{
+    sd_stream_req_t req = {
+        .stream = stream,
+        .block = block,
+    };
+    block->offset = stream->offset;
+    block->len = len;
+    block->err = ESP_OK;
+    stream->offset += len;
+    stream->pending++;
+    xQueueSend(io_queue, &req, portMAX_DELAY);
+}
+
+static sd_stream_block_t *sd_stream_wait(sd_stream_t *stream)
+{
+    sd_stream_block_t *block = NULL;
+    int64_t start = esp_timer_get_time();
+
+    xQueueReceive(stream->done, &block, portMAX_DELAY);
+    stream->stats.wait_us += esp_timer_get_time() - start;
+    stream->pending--;
+    if (block->err != ESP_OK && stream->err == ESP_OK)
+    {
+        stream->err = block->err;
+    }
+    return block;
+}
+
+/**
+ * @brief wait for everything in flight, then prime the buffers for the current offset
+ */
+static void sd_stream_restart(sd_stream_t *stream)
+{
+    while (stream->pending)
+    {
+        sd_stream_wait(stream);
+    }
+    stream->held = NULL;
+    stream->eof = false;
+
+    for (int i = 0; i < SD_STREAM_BUFFER_NUM; i++)
+    {
+        sd_stream_block_t *block = &stream->blocks[i];
+        if (stream->write)
+        {
+            block->err = ESP_OK;
+            stream->pending++;
+            xQueueSend(stream->done, &block, portMAX_DELAY);
+        }
+        else if (stream->config.access == SD_STREAM_SEQUENTIAL)
+        {
+            sd_stream_submit(stream, block, stream->config.block_size);
+        }
+    }
+}
+
+static void sd_stream_free(sd_stream_t *stream)
+{
+    for (int i = 0; i < SD_STREAM_BUFFER_NUM; i++)
+    {
+        heap_caps_free(stream->blocks[i].buf);
+    }
+    if (stream->done)
+    {
+        vQueueDelete(stream->done);
+    }
+    if (stream->fd >= 0)
+    {
+        close(stream->fd);
+    }
+    free(stream);
+}
+
+esp_err_t sd_stream_open(const char *path, bool write, sd_stream_config_t config, sd_stream_handle_t *ret_stream)
+{
+    esp_err_t ret = ESP_OK;
+    sd_stream_t *stream = NULL;
+    ESP_RETURN_ON_FALSE(path && ret_stream, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(config.block_size && config.block_size % SD_STREAM_SECTOR_SIZE == 0, ESP_ERR_INVALID_SIZE, TAG, "Block size must be whole sectors");
+
+    /*!< one I/O task for every stream, the card serves one transfer at a time anyway */
+    if (io_task == NULL)
+    {
+        io_queue = xQueueCreate(SD_STREAM_IO_QUEUE_LEN, sizeof(sd_stream_req_t));
+        ESP_RETURN_ON_FALSE(io_queue, ESP_ERR_NO_MEM, TAG, "I/O queue create failed");
+        ESP_RETURN_ON_FALSE(xTaskCreatePinnedToCore(sd_stream_io_task, "sd_stream", 3072, NULL, config.task_priority, &io_task, config.task_core) == pdPASS,
+                            ESP_ERR_NO_MEM, TAG, "I/O task create failed");
+    }
+
+    stream = calloc(1, sizeof(sd_stream_t));
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_NO_MEM, TAG, "No mem for stream");
+    stream->fd = -1;
+    stream->write = write;
+    stream->config = config;
+    stream->done = xQueueCreate(SD_STREAM_BUFFER_NUM, sizeof(sd_stream_block_t *));
+    ESP_GOTO_ON_FALSE(stream->done, ESP_ERR_NO_MEM, err, TAG, "Queue create failed");
+    for (int i = 0; i < SD_STREAM_BUFFER_NUM; i++)
+    {
+        /*!< the SDMMC driver bounces buffers that are not DMA capable one sector at a time */
+        stream->blocks[i].buf = heap_caps_aligned_alloc(SD_STREAM_ALIGN, config.block_size, MALLOC_CAP_DMA);
+        ESP_GOTO_ON_FALSE(stream->blocks[i].buf, ESP_ERR_NO_MEM, err, TAG, "No mem for %u byte buffer", (unsigned)config.block_size);
+    }
+
+    stream->fd = open(path, write ? O_WRONLY | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+    ESP_GOTO_ON_FALSE(stream->fd >= 0, ESP_ERR_NOT_FOUND, err, TAG, "Open %s failed", path);
+    if (write)
+    {
+        /*!< created or truncated, the directory index is out of date */
+        sd_index_invalidate();
+    }
+
+    sd_stream_restart(stream);
+    *ret_stream = stream;
+    return ESP_OK;
+
+err:
+    sd_stream_free(stream);
+    return ret;
+}
+
+esp_err_t sd_stream_read(sd_stream_handle_t stream, const void **data, size_t *len)
+{
+    ESP_RETURN_ON_FALSE(stream && !stream->write && data && len, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    *data = NULL;
+    *len = 0;
+
+    if (stream->config.access == SD_STREAM_RANDOM)
+    {
+        sd_stream_submit(stream, &stream->blocks[0], stream->config.block_size);
+    }
+    else if (stream->held && !stream->eof)
+    {
+        /*!< the block the caller is done with reads ahead next */
+        sd_stream_submit(stream, stream->held, stream->config.block_size);
+    }
+    stream->held = NULL;
+    if (stream->pending == 0)
+    {
+        return ESP_OK;
+    }
+
+    sd_stream_block_t *block = sd_stream_wait(stream);
+    ESP_RETURN_ON_ERROR(block->err, TAG, "Read at %ld failed", (long)block->offset);
+    if (block->len < stream->config.block_size)
+    {
+        stream->eof = true;
+    }
+    stream->held = block;
+    *data = block->buf;
+    *len = block->len;
+
+    return ESP_OK;
+}
+
+esp_err_t sd_stream_seek(sd_stream_handle_t stream, off_t offset)
+{
+    ESP_RETURN_ON_FALSE(stream && offset >= 0, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    /*!< blocks read ahead for the old position are dropped, a buffer held for writing is discarded */
+    stream->offset = offset;
+    sd_stream_restart(stream);
+
+    return stream->err;
+}
+
+esp_err_t sd_stream_get_buffer(sd_stream_handle_t stream, void **buf)
+{
+    ESP_RETURN_ON_FALSE(stream && stream->write && buf, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(stream->held == NULL, ESP_ERR_INVALID_STATE, TAG, "Buffer not written yet");
+
+    stream->held = sd_stream_wait(stream);
+    *buf = stream->held->buf;
+
+    return stream->err;
+}
+
+esp_err_t sd_stream_write(sd_stream_handle_t stream, size_t len)
+{
+    ESP_RETURN_ON_FALSE(stream && stream->write, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(stream->held, ESP_ERR_INVALID_STATE, TAG, "No buffer taken");
+    ESP_RETURN_ON_FALSE(len <= stream->config.block_size, ESP_ERR_INVALID_SIZE, TAG, "Longer than a block");
+
+    sd_stream_block_t *block = stream->held;
+    stream->held = NULL;
+    if (len == 0)
+    {
+        stream->pending++;
+        xQueueSend(stream->done, &block, portMAX_DELAY);
+        return stream->err;
+    }
+    sd_stream_submit(stream, block, len);
+
+    return stream->err;
+}
+
+esp_err_t sd_stream_close(sd_stream_handle_t stream, sd_stream_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    while (stream->pending)
+    {
+        sd_stream_wait(stream);
+    }
+    esp_err_t ret = stream->err;
+    if (stream->write && fsync(stream->fd) != 0 && ret == ESP_OK)
+    {
+        ret = ESP_FAIL;
+    }
+    if (stats)
+    {
+        *stats = stream->stats;
+    }
+    bool written = stream->write;
+    sd_stream_free(stream);
+    if (written)
+    {
+        sd_index_invalidate();
+    }
+
+    return ret;
+}
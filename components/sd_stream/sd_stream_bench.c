@@ -0,0 +1,127 @@
+#include "sd_stream.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "stdio.h"
+#include "sd_index.h"
+
+#define SD_STREAM_BENCH_MIN_BLOCK 512
+#define SD_STREAM_BENCH_MAX_BLOCK (64 * 1024)
+
+static const char *TAG = "SD_STREAM_BENCH";
+
+/**
+ * @brief a word that depends on its position, so misplaced blocks are caught too
+ */
+static inline uint32_t sd_stream_bench_word(size_t offset, size_t block_size)
+{
+    return (offset / sizeof(uint32_t)) * 2654435761u ^ block_size;
+}
+
+static void sd_stream_bench_report(sd_stream_bench_result_t *result, const sd_stream_stats_t *stats, sd_stream_bench_cb_t cb, void *user_ctx)
+{
+    result->bytes = stats->bytes;
+    result->kb_per_sec = result->time_us ? stats->bytes * 1000000 / 1024 / result->time_us : 0;
+    result->wait_pct = result->time_us ? stats->wait_us * 100 / result->time_us : 0;
+    ESP_LOGI(TAG, "%5u B %s: %lu.%02lu MB/s, waited %lu%% of %llu us", (unsigned)result->block_size, result->write ? "write" : "read ",
+             (unsigned long)(result->kb_per_sec / 1024), (unsigned long)(result->kb_per_sec % 1024 * 100 / 1024),
+             (unsigned long)result->wait_pct, (unsigned long long)result->time_us);
+    if (cb)
+    {
+        cb(result, user_ctx);
+    }
+}
+
+static esp_err_t sd_stream_bench_write(const char *path, size_t file_size, sd_stream_config_t config, sd_stream_bench_cb_t cb, void *user_ctx)
+{
+    sd_stream_handle_t stream = NULL;
+    sd_stream_stats_t stats;
+    sd_stream_bench_result_t result = {
+        .block_size = config.block_size,
+        .write = true,
+    };
+    esp_err_t ret = ESP_OK;
+    int64_t start = esp_timer_get_time();
+
+    ESP_RETURN_ON_ERROR(sd_stream_open(path, true, config, &stream), TAG, "Open for writing failed");
+    for (size_t offset = 0; offset < file_size && ret == ESP_OK; offset += config.block_size)
+    {
+        void *buf = NULL;
+        size_t len = file_size - offset < config.block_size ? file_size - offset : config.block_size;
+        ret = sd_stream_get_buffer(stream, &buf);
+        for (size_t i = 0; ret == ESP_OK && i < len / sizeof(uint32_t); i++)
+        {
+            ((uint32_t *)buf)[i] = sd_stream_bench_word(offset + i * sizeof(uint32_t), config.block_size);
+        }
+        if (ret == ESP_OK)
+        {
+            ret = sd_stream_write(stream, len);
+        }
+    }
+    esp_err_t close_ret = sd_stream_close(stream, &stats);
+    ESP_RETURN_ON_ERROR(ret != ESP_OK ? ret : close_ret, TAG, "Write failed");
+    result.time_us = esp_timer_get_time() - start;
+    sd_stream_bench_report(&result, &stats, cb, user_ctx);
+
+    return ESP_OK;
+}
+
+static esp_err_t sd_stream_bench_read(const char *path, size_t file_size, sd_stream_config_t config, sd_stream_bench_cb_t cb, void *user_ctx)
+{
+    sd_stream_handle_t stream = NULL;
+    sd_stream_stats_t stats;
+    sd_stream_bench_result_t result = {
+        .block_size = config.block_size,
+        .write = false,
+    };
+    esp_err_t ret = ESP_OK;
+    size_t offset = 0;
+    uint32_t errors = 0;
+    int64_t start = esp_timer_get_time();
+
+    ESP_RETURN_ON_ERROR(sd_stream_open(path, false, config, &stream), TAG, "Open for reading failed");
+    while (ret == ESP_OK)
+    {
+        const void *data = NULL;
+        size_t len = 0;
+        ret = sd_stream_read(stream, &data, &len);
+        if (ret != ESP_OK || len == 0)
+        {
+            break;
+        }
+        for (size_t i = 0; i < len / sizeof(uint32_t); i++)
+        {
+            errors += ((const uint32_t *)data)[i] != sd_stream_bench_word(offset + i * sizeof(uint32_t), config.block_size);
+        }
+        offset += len;
+    }
+    esp_err_t close_ret = sd_stream_close(stream, &stats);
+    ESP_RETURN_ON_ERROR(ret != ESP_OK ? ret : close_ret, TAG, "Read failed");
+    result.time_us = esp_timer_get_time() - start;
+    sd_stream_bench_report(&result, &stats, cb, user_ctx);
+    ESP_RETURN_ON_FALSE(errors == 0 && offset == file_size, ESP_ERR_INVALID_CRC, TAG, "%lu bad words, %u of %u bytes", (unsigned long)errors, (unsigned)offset,
+                        (unsigned)file_size);
+
+    return ESP_OK;
+}
+
+esp_err_t sd_stream_bench(const char *path, size_t file_size, sd_stream_config_t config, sd_stream_bench_cb_t cb, void *user_ctx)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(path && file_size % sizeof(uint32_t) == 0, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    ESP_LOGI(TAG, "%u bytes to %s, %s", (unsigned)file_size, path, config.access == SD_STREAM_SEQUENTIAL ? "sequential" : "random");
+    for (size_t block_size = SD_STREAM_BENCH_MIN_BLOCK; block_size <= SD_STREAM_BENCH_MAX_BLOCK && ret == ESP_OK; block_size *= 2)
+    {
+        config.block_size = block_size;
+        ret = sd_stream_bench_write(path, file_size, config, cb, user_ctx);
+        if (ret == ESP_OK)
+        {
+            ret = sd_stream_bench_read(path, file_size, config, cb, user_ctx);
+        }
+    }
+    remove(path);
+    sd_index_invalidate();
+
+    return ret;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+/*!< no GPIO or SPI driver on the host, lcd_config_t only carries the pin and host numbers */
+typedef int gpio_num_t;
+typedef int spi_host_device_t;
+
+#define GPIO_NUM_NC (-1)
+#else
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#endif
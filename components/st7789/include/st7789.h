@@ -1,9 +1,9 @@
 #pragma once
-#include "driver/gpio.h"
-#include "driver/spi_master.h"
+#include "lcd_hal.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
+#include "freertos/FreeRTOS.h"
 
 #define rgb565(r, g, b) (((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3))
 #define swap_hex(hex) ((((hex) & 0xFF) << 8) | (((hex) >> 8) & 0xFF))
@@ -22,8 +22,51 @@ typedef struct
     gpio_num_t dc;
     gpio_num_t cs;
     gpio_num_t rst;
+    uint32_t pclk_hz;          /*!< 0 to use the tuned bus parameters from NVS, or the defaults */
+    uint8_t trans_queue_depth; /*!< used when pclk_hz is set, at most LCD_TRANS_QUEUE_DEPTH_MAX */
 } lcd_config_t;
 
+#define LCD_TRANS_QUEUE_DEPTH_MAX 32
+#define LCD_PCLK_MAX_HZ 62500000 /*!< st7789 serial write cycle is at least 16 ns */
+#define LCD_PANEL_MEM_WIDTH 240 /*!< st7789 frame memory, smaller panels show its top left corner */
+#define LCD_PANEL_MEM_HEIGHT 320
+
+typedef enum
+{
+    LCD_ROTATION_0,
+    LCD_ROTATION_90, /*!< clockwise */
+    LCD_ROTATION_180,
+    LCD_ROTATION_270,
+} lcd_rotation_t;
+
+/**
+ * @brief bus parameters found by lcd_tune, stored in NVS
+ */
+typedef struct
+{
+    uint32_t pclk_hz;
+    uint8_t trans_queue_depth;
+    uint16_t draw_buffer_height; /*!< lines per strip, also sets the SPI max_transfer_sz */
+} lcd_bus_params_t;
+
+typedef struct
+{
+    uint16_t x1;
+    uint16_t y1;
+    uint16_t x2; /*!< exclusive, same as esp_lcd_panel_draw_bitmap */
+    uint16_t y2; /*!< exclusive, same as esp_lcd_panel_draw_bitmap */
+} lcd_region_t;
+
+/**
+ * @brief called from ISR context once the DMA has finished reading the buffer
+ */
+typedef void (*lcd_draw_done_cb_t)(void *user_ctx);
+
+/**
+ * @brief fill one strip of pixels before it is sent
+ */
+typedef void (*lcd_strip_fill_cb_t)(uint16_t *strip, lcd_region_t region, void *user_ctx);
+
 extern esp_lcd_panel_io_handle_t lcd_io;
 extern esp_lcd_panel_handle_t lcd_panel;
 
@@ -35,6 +78,68 @@ extern esp_lcd_panel_handle_t lcd_panel;
  */
 esp_err_t lcd_init(lcd_config_t lcd_config);
 
+/**
+ * @brief release the panel, the bus and the strip buffers, waits for queued transfers first
+ *
+ * @return esp_err_t
+ */
+esp_err_t lcd_deinit(void);
+
+/**
+ * @brief config lcd_init ended up with, tuned parameters included
+ *
+ * @return lcd_config_t
+ */
+lcd_config_t lcd_get_config(void);
+
+/**
+ * @brief rotate everything drawn from now on, regions are then given in rotated coordinates
+ *
+ * By default the panel rotates through MADCTL, which costs nothing per frame. With software
+ * set the pixels are rotated in 16x16 tiles into internal DMA buffers on the way out instead,
+ * for panels whose scan order must not change or whose MADCTL is not usable.
+ *
+ * @param rotation
+ * @param software
+ * @return esp_err_t
+ */
+esp_err_t lcd_set_rotation(lcd_rotation_t rotation, bool software);
+
+/**
+ * @brief resolution seen by callers, swapped at 90 and 270 degrees
+ *
+ * @param hres
+ * @param vres
+ */
+void lcd_get_resolution(uint16_t *hres, uint16_t *vres);
+
+/**
+ * @brief read the tuned bus parameters, nvs_flash_init must have been called
+ *
+ * @param params
+ * @return esp_err_t ESP_ERR_NOT_FOUND if the panel was never tuned
+ */
+esp_err_t lcd_bus_params_load(lcd_bus_params_t *params);
+
+/**
+ * @brief store bus parameters for the next lcd_init
+ *
+ * @param params
+ * @return esp_err_t
+ */
+esp_err_t lcd_bus_params_save(const lcd_bus_params_t *params);
+
+/**
+ * @brief fill a region with a solid colour using a single CASET/RASET window
+ *
+ * The transfer is asynchronous, use lcd_draw_wait to wait for it.
+ *
+ * @param region
+ * @param color rgb565
+ * @return esp_err_t
+ */
+esp_err_t lcd_fill_rect(lcd_region_t region, uint16_t color);
+
 /**
  * @brief lcd fullclean
  *
@@ -42,4 +147,69 @@ esp_err_t lcd_init(lcd_config_t lcd_config);
  * @param lcd_config
  * @param color
  */
-void lcd_fullclean(esp_lcd_panel_handle_t lcd_pandel, lcd_config_t lcd_config, uint16_t color);
\ No newline at end of file
+void lcd_fullclean(esp_lcd_panel_handle_t lcd_pandel, lcd_config_t lcd_config, uint16_t color);
+
+/**
+ * @brief queue a bitmap transfer and return without waiting for the DMA
+ *
+ * The buffer must stay valid until cb is called. Do not use together with
+ * esp_lvgl_port on the same panel IO, it registers its own transfer callback.
+ *
+ * @param region
+ * @param buf
+ * @param cb may be NULL
+ * @param user_ctx
+ * @return esp_err_t
+ */
+esp_err_t lcd_draw_async(lcd_region_t region, const void *buf, lcd_draw_done_cb_t cb, void *user_ctx);
+
+/**
+ * @brief like lcd_draw_async, but a region that continues the previous one is appended with RAMWRC
+ *
+ * A new window is opened from region.y1 down to the bottom of the panel, so regions
+ * with the same columns that follow each other row by row are sent without CASET/RASET.
+ *
+ * @param region
+ * @param buf
+ * @param cb may be NULL
+ * @param user_ctx
+ * @param continued set to true when no new window was needed, may be NULL
+ * @return esp_err_t
+ */
+esp_err_t lcd_draw_stream(lcd_region_t region, const void *buf, lcd_draw_done_cb_t cb, void *user_ctx, bool *continued);
+
+/**
+ * @brief wait until every queued transfer has completed
+ *
+ * @param ticks_to_wait
+ * @return esp_err_t ESP_ERR_TIMEOUT if transfers are still pending
+ */
+esp_err_t lcd_draw_wait(TickType_t ticks_to_wait);
+
+/**
+ * @brief take a free DMA strip buffer, lcd_draw_buffer_height rows of the longer panel side
+ *
+ * @param ticks_to_wait
+ * @return uint16_t* NULL on timeout
+ */
+uint16_t *lcd_strip_get(TickType_t ticks_to_wait);
+
+/**
+ * @brief send a strip taken with lcd_strip_get, it goes back to the pool once sent
+ *
+ * @param region at most lcd_draw_buffer_height rows of the longer panel side
+ * @param strip
+ * @return esp_err_t
+ */
+esp_err_t lcd_strip_draw(lcd_region_t region, uint16_t *strip);
+
+/**
+ * @brief draw a region strip by strip, filling the next strip while the previous one is sent
+ *
+ * @param region
+ * @param strip_height clamped to lcd_draw_buffer_height
+ * @param fill_cb
+ * @param user_ctx
+ * @return esp_err_t
+ */
+esp_err_t lcd_draw_strips(lcd_region_t region, uint16_t strip_height, lcd_strip_fill_cb_t fill_cb, void *user_ctx);
@@ -3,15 +3,208 @@
 #include "esp_log.h"
 #include "esp_check.h"
 #include "string.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_lcd_panel_commands.h"
+#include "pixel_ops.h"
+#include "nvs.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "lcd_mock.h"
+#endif
+
+#define LCD_PCLK_HZ (40 * 1000 * 1000) /*!< defaults until lcd_tune has stored better ones */
+#define LCD_TRANS_QUEUE_DEPTH 10
+#define LCD_NVS_NAMESPACE "lcd"
+#define LCD_NVS_KEY_BUS "bus"
+#define LCD_STRIP_BUFFER_NUM 2
+#define LCD_ROTATE_BUFFER_NUM 2 /*!< one chunk is rotated while the other is on the wire */
+#define LCD_DRAW_IDLE_BIT BIT0
+
+typedef struct
+{
+    lcd_draw_done_cb_t cb;
+    void *user_ctx;
+} lcd_pending_t;
+
+typedef struct
+{
+    uint16_t *buf;
+    lcd_draw_done_cb_t cb; /*!< set on the last chunk of a draw */
+    void *user_ctx;
+} lcd_rotate_buf_t;
 
 static const char *TAG = "LCD";
 
 esp_lcd_panel_io_handle_t lcd_io = NULL;
 esp_lcd_panel_handle_t lcd_panel = NULL;
 
+static lcd_config_t lcd_cfg;
+static SemaphoreHandle_t draw_lock = NULL;
+static EventGroupHandle_t draw_event = NULL;
+static SemaphoreHandle_t pending_free = NULL; /*!< one token per transaction queue slot, given back on completion */
+static lcd_pending_t pending[LCD_TRANS_QUEUE_DEPTH_MAX];
+static uint8_t trans_queue_depth = LCD_TRANS_QUEUE_DEPTH;
+static volatile uint32_t pending_head = 0; /*!< popped in ISR */
+static volatile uint32_t pending_tail = 0; /*!< pushed under draw_lock */
+static QueueHandle_t strip_free = NULL;
+static uint16_t *strip_buffer[LCD_STRIP_BUFFER_NUM];
+static uint16_t *fill_pattern = NULL; /*!< one max_transfer_sz chunk of a solid colour */
+static uint32_t fill_pattern_pixels = 0;
+static uint16_t fill_pattern_color = 0;
+static lcd_region_t stream_window;  /*!< window opened by lcd_draw_stream */
+static uint16_t stream_next_y = 0;  /*!< row the panel write pointer is at */
+static bool stream_open = false;    /*!< cleared by every draw that moves the window */
+static lcd_rotation_t rotation = LCD_ROTATION_0;
+static bool rotation_soft = false;
+static uint16_t gap_x = 0; /*!< MADCTL rotation moves the visible area inside the frame memory */
+static uint16_t gap_y = 0;
+static QueueHandle_t rotate_free = NULL;
+static lcd_rotate_buf_t rotate_buffer[LCD_ROTATE_BUFFER_NUM];
+static uint32_t rotate_pixels = 0;
+
+static bool lcd_color_trans_done_cb(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    if (pending_head == pending_tail)
+    {
+        return false;
+    }
+    lcd_pending_t *done = &pending[pending_head % trans_queue_depth];
+    if (done->cb)
+    {
+        done->cb(done->user_ctx);
+    }
+    pending_head++;
+    xSemaphoreGiveFromISR(pending_free, &need_yield);
+    if (pending_head == pending_tail)
+    {
+        xEventGroupSetBitsFromISR(draw_event, LCD_DRAW_IDLE_BIT, &need_yield);
+    }
+    return need_yield == pdTRUE;
+}
+
+/*!< must be called with draw_lock held, before the transfer is queued */
+static void lcd_pending_push(lcd_draw_done_cb_t cb, void *user_ctx)
+{
+    /*!< blocks while every slot is still owned by the DMA, until the oldest transfer completes */
+    xSemaphoreTake(pending_free, portMAX_DELAY);
+    pending[pending_tail % trans_queue_depth] = (lcd_pending_t){
+        .cb = cb,
+        .user_ctx = user_ctx,
+    };
+    xEventGroupClearBits(draw_event, LCD_DRAW_IDLE_BIT);
+    pending_tail++;
+}
+
+/*!< undo the last push when queueing the transfer failed, no completion will pop it */
+static void lcd_pending_cancel(void)
+{
+    pending_tail--;
+    xSemaphoreGive(pending_free);
+    if (pending_head == pending_tail)
+    {
+        xEventGroupSetBits(draw_event, LCD_DRAW_IDLE_BIT);
+    }
+}
+
+esp_err_t lcd_bus_params_load(lcd_bus_params_t *params)
+{
+    nvs_handle_t nvs = 0;
+    size_t size = sizeof(lcd_bus_params_t);
+    ESP_RETURN_ON_FALSE(params, ESP_ERR_INVALID_ARG, TAG, "Params is NULL");
+
+    esp_err_t ret = nvs_open(LCD_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret != ESP_OK)
+    {
+        return (ret == ESP_ERR_NVS_NOT_FOUND) ? ESP_ERR_NOT_FOUND : ret;
+    }
+    ret = nvs_get_blob(nvs, LCD_NVS_KEY_BUS, params, &size);
+    nvs_close(nvs);
+    if (ret == ESP_ERR_NVS_NOT_FOUND)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "Read bus params failed");
+    ESP_RETURN_ON_FALSE(size == sizeof(lcd_bus_params_t) && params->pclk_hz && params->pclk_hz <= LCD_PCLK_MAX_HZ && params->draw_buffer_height &&
+                            params->trans_queue_depth && params->trans_queue_depth <= LCD_TRANS_QUEUE_DEPTH_MAX,
+                        ESP_ERR_INVALID_SIZE, TAG, "Stored bus params are invalid");
+
+    return ESP_OK;
+}
+
+esp_err_t lcd_bus_params_save(const lcd_bus_params_t *params)
+{
+    nvs_handle_t nvs = 0;
+    ESP_RETURN_ON_FALSE(params, ESP_ERR_INVALID_ARG, TAG, "Params is NULL");
+
+    ESP_RETURN_ON_ERROR(nvs_open(LCD_NVS_NAMESPACE, NVS_READWRITE, &nvs), TAG, "Open NVS failed");
+    esp_err_t ret = nvs_set_blob(nvs, LCD_NVS_KEY_BUS, params, sizeof(lcd_bus_params_t));
+    if (ret == ESP_OK)
+    {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Write bus params failed");
+    ESP_LOGI(TAG, "Saved pclk %lu Hz, queue depth %d, strip height %d", (unsigned long)params->pclk_hz, params->trans_queue_depth, params->draw_buffer_height);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief pixels in a strip, rotate buffer or DMA transfer, a full row at 90 or 270 degrees included
+ */
+static uint32_t lcd_chunk_pixels(const lcd_config_t *config)
+{
+    uint16_t width = config->lcd_height_res > config->lcd_vertical_res ? config->lcd_height_res : config->lcd_vertical_res;
+    return width * config->lcd_draw_buffer_height;
+}
+
 esp_err_t lcd_init(lcd_config_t lcd_config)
 {
     esp_err_t ret = ESP_OK;
+    lcd_bus_params_t params;
+    ESP_RETURN_ON_FALSE(lcd_io == NULL, ESP_ERR_INVALID_STATE, TAG, "LCD already initialized");
+
+    if (lcd_config.pclk_hz == 0)
+    {
+        if (lcd_bus_params_load(&params) == ESP_OK)
+        {
+            lcd_config.pclk_hz = params.pclk_hz;
+            lcd_config.trans_queue_depth = params.trans_queue_depth;
+            lcd_config.lcd_draw_buffer_height = params.draw_buffer_height;
+            ESP_LOGI(TAG, "Tuned bus: pclk %lu Hz, queue depth %d, strip height %d", (unsigned long)params.pclk_hz, params.trans_queue_depth, params.draw_buffer_height);
+        }
+        else
+        {
+            lcd_config.pclk_hz = LCD_PCLK_HZ;
+            lcd_config.trans_queue_depth = LCD_TRANS_QUEUE_DEPTH;
+        }
+    }
+    if (lcd_config.trans_queue_depth == 0 || lcd_config.trans_queue_depth > LCD_TRANS_QUEUE_DEPTH_MAX)
+    {
+        lcd_config.trans_queue_depth = LCD_TRANS_QUEUE_DEPTH;
+    }
+    trans_queue_depth = lcd_config.trans_queue_depth;
+    pending_head = 0;
+    pending_tail = 0;
+    rotation = LCD_ROTATION_0;
+    rotation_soft = false;
+    gap_x = 0;
+    gap_y = 0;
+
+#if CONFIG_IDF_TARGET_LINUX
+    /*!< no SPI on the host, the panel memory and the bus cost are modelled in RAM */
+    const lcd_mock_config_t mock_config = {
+        .width = LCD_PANEL_MEM_WIDTH,
+        .height = LCD_PANEL_MEM_HEIGHT,
+        .pclk_hz = lcd_config.pclk_hz,
+        .trans_overhead_ns = 2000,
+        .max_transfer_sz = lcd_chunk_pixels(&lcd_config) * sizeof(uint16_t),
+    };
+    ESP_GOTO_ON_ERROR(lcd_mock_new_panel_io(&mock_config, &lcd_io), err, TAG, "New mock panel IO failed");
+#else
     /*!< backlight */
     gpio_config_t bk_gpio_config = {
         .mode = GPIO_MODE_OUTPUT,
@@ -26,7 +219,7 @@ esp_err_t lcd_init(lcd_config_t lcd_config)
         .miso_io_num = GPIO_NUM_NC,
         .quadwp_io_num = GPIO_NUM_NC,
         .quadhd_io_num = GPIO_NUM_NC,
-        .max_transfer_sz = lcd_config.lcd_height_res * lcd_config.lcd_draw_buffer_height * sizeof(uint16_t),
+        .max_transfer_sz = lcd_chunk_pixels(&lcd_config) * sizeof(uint16_t),
     };
 
     ESP_RETURN_ON_ERROR(spi_bus_initialize(lcd_config.spi_host_device, &buscfg, SPI_DMA_CH_AUTO), TAG, "SPI init failed");
@@ -35,14 +228,26 @@ esp_err_t lcd_init(lcd_config_t lcd_config)
     const esp_lcd_panel_io_spi_config_t io_config = {
         .dc_gpio_num = lcd_config.dc,
         .cs_gpio_num = lcd_config.cs,
-        .pclk_hz = 40 * 1000 * 1000,
+        .pclk_hz = lcd_config.pclk_hz,
         .lcd_cmd_bits = 8,
         .lcd_param_bits = 8,
         .spi_mode = 0,
-        .trans_queue_depth = 10,
+        .trans_queue_depth = lcd_config.trans_queue_depth,
     };
 
     ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)lcd_config.spi_host_device, &io_config, &lcd_io), err, TAG, "New panel IO failed");
+#endif
+
+    draw_lock = xSemaphoreCreateMutex();
+    draw_event = xEventGroupCreate();
+    pending_free = xSemaphoreCreateCounting(trans_queue_depth, trans_queue_depth);
+    ESP_GOTO_ON_FALSE(draw_lock && draw_event && pending_free, ESP_ERR_NO_MEM, err, TAG, "Draw lock create failed");
+    xEventGroupSetBits(draw_event, LCD_DRAW_IDLE_BIT);
+    const esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = lcd_color_trans_done_cb,
+    };
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_io_register_event_callbacks(lcd_io, &cbs, NULL), err, TAG, "Register callback failed");
+    lcd_cfg = lcd_config;
 
     ESP_LOGI(TAG, "Install LCD driver");
     const esp_lcd_panel_dev_config_t panel_config = {
@@ -58,7 +263,9 @@ esp_err_t lcd_init(lcd_config_t lcd_config)
     esp_lcd_panel_disp_on_off(lcd_panel, true);
     esp_lcd_panel_invert_color(lcd_panel, true);
 
+#if !CONFIG_IDF_TARGET_LINUX
     ESP_ERROR_CHECK(gpio_set_level(lcd_config.backlight, 1));
+#endif
 
     return ESP_OK;
 
@@ -66,27 +273,494 @@ err:
     if (lcd_panel)
     {
         esp_lcd_panel_del(lcd_panel);
+        lcd_panel = NULL;
     }
     if (lcd_io)
     {
         esp_lcd_panel_io_del(lcd_io);
+        lcd_io = NULL;
     }
+    if (draw_lock)
+    {
+        vSemaphoreDelete(draw_lock);
+        draw_lock = NULL;
+    }
+    if (draw_event)
+    {
+        vEventGroupDelete(draw_event);
+        draw_event = NULL;
+    }
+    if (pending_free)
+    {
+        vSemaphoreDelete(pending_free);
+        pending_free = NULL;
+    }
+#if !CONFIG_IDF_TARGET_LINUX
     spi_bus_free(lcd_config.spi_host_device);
+#endif
     return ret;
 }
 
+esp_err_t lcd_deinit(void)
+{
+    ESP_RETURN_ON_FALSE(lcd_io && draw_event, ESP_ERR_INVALID_STATE, TAG, "LCD not initialized");
+    ESP_RETURN_ON_ERROR(lcd_draw_wait(pdMS_TO_TICKS(1000)), TAG, "Transfers still pending");
+
+    esp_lcd_panel_del(lcd_panel);
+    esp_lcd_panel_io_del(lcd_io);
+    lcd_panel = NULL;
+    lcd_io = NULL;
+#if !CONFIG_IDF_TARGET_LINUX
+    spi_bus_free(lcd_cfg.spi_host_device);
+#endif
+    if (strip_free)
+    {
+        vQueueDelete(strip_free);
+        strip_free = NULL;
+        for (int i = 0; i < LCD_STRIP_BUFFER_NUM; i++)
+        {
+            heap_caps_free(strip_buffer[i]);
+            strip_buffer[i] = NULL;
+        }
+    }
+    if (rotate_free)
+    {
+        vQueueDelete(rotate_free);
+        rotate_free = NULL;
+        for (int i = 0; i < LCD_ROTATE_BUFFER_NUM; i++)
+        {
+            heap_caps_free(rotate_buffer[i].buf);
+            rotate_buffer[i].buf = NULL;
+        }
+    }
+    heap_caps_free(fill_pattern);
+    fill_pattern = NULL;
+    vSemaphoreDelete(draw_lock);
+    vEventGroupDelete(draw_event);
+    vSemaphoreDelete(pending_free);
+    draw_lock = NULL;
+    draw_event = NULL;
+    pending_free = NULL;
+    stream_open = false;
+
+    return ESP_OK;
+}
+
+lcd_config_t lcd_get_config(void)
+{
+    return lcd_cfg;
+}
+
+void lcd_get_resolution(uint16_t *hres, uint16_t *vres)
+{
+    bool swap = (rotation == LCD_ROTATION_90 || rotation == LCD_ROTATION_270);
+    *hres = swap ? lcd_cfg.lcd_vertical_res : lcd_cfg.lcd_height_res;
+    *vres = swap ? lcd_cfg.lcd_height_res : lcd_cfg.lcd_vertical_res;
+}
+
+static esp_err_t lcd_rotate_pool_init(void)
+{
+    if (rotate_free)
+    {
+        return ESP_OK;
+    }
+    rotate_pixels = lcd_chunk_pixels(&lcd_cfg);
+    rotate_free = xQueueCreate(LCD_ROTATE_BUFFER_NUM, sizeof(lcd_rotate_buf_t *));
+    ESP_RETURN_ON_FALSE(rotate_free, ESP_ERR_NO_MEM, TAG, "Rotate queue create failed");
+    for (int i = 0; i < LCD_ROTATE_BUFFER_NUM; i++)
+    {
+        rotate_buffer[i].buf = heap_caps_malloc(rotate_pixels * sizeof(uint16_t), MALLOC_CAP_DMA);
+        ESP_RETURN_ON_FALSE(rotate_buffer[i].buf, ESP_ERR_NO_MEM, TAG, "Rotate buffer alloc failed");
+        lcd_rotate_buf_t *rb = &rotate_buffer[i];
+        xQueueSend(rotate_free, &rb, 0);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t lcd_set_rotation(lcd_rotation_t rotation_new, bool software)
+{
+    esp_err_t ret = ESP_OK;
+    bool swap_xy = false;
+    bool mirror_x = false;
+    bool mirror_y = false;
+    uint16_t gx = 0;
+    uint16_t gy = 0;
+    ESP_RETURN_ON_FALSE(lcd_panel && draw_lock, ESP_ERR_INVALID_STATE, TAG, "LCD not initialized");
+    ESP_RETURN_ON_FALSE(rotation_new <= LCD_ROTATION_270, ESP_ERR_INVALID_ARG, TAG, "Invalid rotation");
+
+    if (!software)
+    {
+        /*!< MX and MY mirror the physical axes after the MV exchange, a mirrored axis counts from the
+         * far end of the frame memory and the gap skips the part the panel does not show */
+        switch (rotation_new)
+        {
+        case LCD_ROTATION_90:
+            swap_xy = true;
+            mirror_x = true;
+            gy = LCD_PANEL_MEM_WIDTH - lcd_cfg.lcd_height_res;
+            break;
+        case LCD_ROTATION_180:
+            mirror_x = true;
+            mirror_y = true;
+            gx = LCD_PANEL_MEM_WIDTH - lcd_cfg.lcd_height_res;
+            gy = LCD_PANEL_MEM_HEIGHT - lcd_cfg.lcd_vertical_res;
+            break;
+        case LCD_ROTATION_270:
+            swap_xy = true;
+            mirror_y = true;
+            gx = LCD_PANEL_MEM_HEIGHT - lcd_cfg.lcd_vertical_res;
+            break;
+        default:
+            break;
+        }
+    }
+
+    xSemaphoreTake(draw_lock, portMAX_DELAY);
+    /*!< queued transfers were set up for the old orientation */
+    xEventGroupWaitBits(draw_event, LCD_DRAW_IDLE_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    if (software && rotation_new != LCD_ROTATION_0)
+    {
+        ESP_GOTO_ON_ERROR(lcd_rotate_pool_init(), out, TAG, "Rotate pool init failed");
+    }
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_swap_xy(lcd_panel, swap_xy), out, TAG, "Swap xy failed");
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_mirror(lcd_panel, mirror_x, mirror_y), out, TAG, "Mirror failed");
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_set_gap(lcd_panel, gx, gy), out, TAG, "Set gap failed");
+    rotation = rotation_new;
+    rotation_soft = software;
+    gap_x = gx;
+    gap_y = gy;
+    stream_open = false;
+    ESP_LOGI(TAG, "Rotation %d degrees, %s", rotation * 90, software ? "software" : "MADCTL");
+
+out:
+    xSemaphoreGive(draw_lock);
+    return ret;
+}
+
+/**
+ * @brief panel memory region that a region in rotated coordinates lands on, software rotation only
+ */
+static lcd_region_t lcd_rotate_region(lcd_region_t region)
+{
+    uint16_t hres = lcd_cfg.lcd_height_res;
+    uint16_t vres = lcd_cfg.lcd_vertical_res;
+
+    switch (rotation)
+    {
+    case LCD_ROTATION_90:
+        return (lcd_region_t){.x1 = hres - region.y2, .y1 = region.x1, .x2 = hres - region.y1, .y2 = region.x2};
+    case LCD_ROTATION_180:
+        return (lcd_region_t){.x1 = hres - region.x2, .y1 = vres - region.y2, .x2 = hres - region.x1, .y2 = vres - region.y1};
+    case LCD_ROTATION_270:
+        return (lcd_region_t){.x1 = region.y1, .y1 = vres - region.x2, .x2 = region.y2, .y2 = vres - region.x1};
+    default:
+        return region;
+    }
+}
+
+static void lcd_rotate_done_cb(void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    lcd_rotate_buf_t *rb = (lcd_rotate_buf_t *)user_ctx;
+
+    if (rb->cb)
+    {
+        rb->cb(rb->user_ctx);
+    }
+    xQueueSendFromISR(rotate_free, &rb, &need_yield);
+    portYIELD_FROM_ISR(need_yield);
+}
+
+/*!< must be called with draw_lock held, the region is cut into chunks that fit a rotate buffer */
+static esp_err_t lcd_draw_rotated(lcd_region_t region, const uint16_t *buf, lcd_draw_done_cb_t cb, void *user_ctx)
+{
+    esp_err_t ret = ESP_OK;
+    uint16_t width = region.x2 - region.x1;
+    uint16_t rows = rotate_pixels / width;
+    ESP_RETURN_ON_FALSE(rows, ESP_ERR_INVALID_SIZE, TAG, "Region wider than the rotate buffer");
+
+    for (uint16_t y = region.y1; y < region.y2; y += rows)
+    {
+        lcd_rotate_buf_t *rb = NULL;
+        lcd_region_t chunk = {
+            .x1 = region.x1,
+            .y1 = y,
+            .x2 = region.x2,
+            .y2 = (y + rows < region.y2) ? y + rows : region.y2,
+        };
+        const uint16_t *src = buf + (y - region.y1) * width;
+
+        xQueueReceive(rotate_free, &rb, portMAX_DELAY);
+        if (rotation == LCD_ROTATION_180)
+        {
+            pixel_ops_rotate180(rb->buf, src, width * (chunk.y2 - chunk.y1));
+        }
+        else
+        {
+            pixel_ops_rotate90(rb->buf, src, width, chunk.y2 - chunk.y1, rotation == LCD_ROTATION_90);
+        }
+        /*!< the caller's buffer was copied, but its callback still waits for the last chunk on the wire */
+        rb->cb = (chunk.y2 == region.y2) ? cb : NULL;
+        rb->user_ctx = user_ctx;
+
+        lcd_region_t target = lcd_rotate_region(chunk);
+        lcd_pending_push(lcd_rotate_done_cb, rb);
+        ret = esp_lcd_panel_draw_bitmap(lcd_panel, target.x1, target.y1, target.x2, target.y2, rb->buf);
+        if (ret != ESP_OK)
+        {
+            lcd_pending_cancel();
+            xQueueSend(rotate_free, &rb, 0);
+            ESP_LOGE(TAG, "Rotated transfer failed");
+            return ret;
+        }
+    }
+
+    return ESP_OK;
+}
+
 void lcd_fullclean(esp_lcd_panel_handle_t lcd_pandel, lcd_config_t lcd_config, uint16_t color)
 {
-    uint16_t *buffer = heap_caps_malloc(lcd_config.lcd_height_res * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+    lcd_region_t region = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = lcd_config.lcd_height_res,
+        .y2 = lcd_config.lcd_vertical_res,
+    };
 
-    for (int i = 0; i < lcd_config.lcd_height_res; i++)
+    lcd_fill_rect(region, color);
+    lcd_draw_wait(portMAX_DELAY);
+}
+
+esp_err_t lcd_draw_async(lcd_region_t region, const void *buf, lcd_draw_done_cb_t cb, void *user_ctx)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(lcd_panel && draw_lock, ESP_ERR_INVALID_STATE, TAG, "LCD not initialized");
+
+    xSemaphoreTake(draw_lock, portMAX_DELAY);
+    stream_open = false;
+    if (rotation_soft && rotation != LCD_ROTATION_0)
     {
-        buffer[i] = swap_hex(color);
+        ret = lcd_draw_rotated(region, buf, cb, user_ctx);
+        xSemaphoreGive(draw_lock);
+        return ret;
     }
-    for (int i = 0; i < lcd_config.lcd_vertical_res; i++)
+    lcd_pending_push(cb, user_ctx);
+    ret = esp_lcd_panel_draw_bitmap(lcd_panel, region.x1, region.y1, region.x2, region.y2, buf);
+    if (ret != ESP_OK)
     {
-        esp_lcd_panel_draw_bitmap(lcd_pandel, 0, i, lcd_config.lcd_height_res + 1, i + 1, buffer);
+        lcd_pending_cancel();
     }
+    xSemaphoreGive(draw_lock);
+
+    return ret;
+}
+
+esp_err_t lcd_draw_stream(lcd_region_t region, const void *buf, lcd_draw_done_cb_t cb, void *user_ctx, bool *continued)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(lcd_io && draw_lock, ESP_ERR_INVALID_STATE, TAG, "LCD not initialized");
+    uint16_t hres = 0;
+    uint16_t vres = 0;
+    lcd_get_resolution(&hres, &vres);
+    ESP_RETURN_ON_FALSE(region.x2 > region.x1 && region.y2 > region.y1 && region.x2 <= hres && region.y2 <= vres, ESP_ERR_INVALID_ARG, TAG, "Invalid region");
+
+    xSemaphoreTake(draw_lock, portMAX_DELAY);
+    if (rotation_soft && rotation != LCD_ROTATION_0)
+    {
+        /*!< rotated chunks are not consecutive rows of one window, each one opens its own */
+        stream_open = false;
+        ret = lcd_draw_rotated(region, buf, cb, user_ctx);
+        if (continued)
+        {
+            *continued = false;
+        }
+        goto out;
+    }
+    bool cont = stream_open && region.x1 == stream_window.x1 && region.x2 == stream_window.x2 && region.y1 == stream_next_y;
+    if (!cont)
+    {
+        /*!< leave the window open to the last row, the next region may carry on below this one */
+        uint16_t x1 = region.x1 + gap_x;
+        uint16_t x2 = region.x2 - 1 + gap_x;
+        uint16_t y1 = region.y1 + gap_y;
+        uint16_t y2 = vres - 1 + gap_y;
+        uint8_t caset[] = {x1 >> 8, x1 & 0xFF, x2 >> 8, x2 & 0xFF};
+        uint8_t raset[] = {y1 >> 8, y1 & 0xFF, y2 >> 8, y2 & 0xFF};
+        stream_open = false;
+        ESP_GOTO_ON_ERROR(esp_lcd_panel_io_tx_param(lcd_io, LCD_CMD_CASET, caset, sizeof(caset)), out, TAG, "CASET failed");
+        ESP_GOTO_ON_ERROR(esp_lcd_panel_io_tx_param(lcd_io, LCD_CMD_RASET, raset, sizeof(raset)), out, TAG, "RASET failed");
+        stream_window = region;
+    }
+
+    lcd_pending_push(cb, user_ctx);
+    ret = esp_lcd_panel_io_tx_color(lcd_io, cont ? LCD_CMD_RAMWRC : LCD_CMD_RAMWR, buf, (region.x2 - region.x1) * (region.y2 - region.y1) * sizeof(uint16_t));
+    if (ret != ESP_OK)
+    {
+        lcd_pending_cancel();
+        stream_open = false;
+        ESP_LOGE(TAG, "Stream transfer failed");
+        goto out;
+    }
+    stream_next_y = region.y2;
+    stream_open = true;
+    if (continued)
+    {
+        *continued = cont;
+    }
+
+out:
+    xSemaphoreGive(draw_lock);
+    return ret;
+}
+
+esp_err_t lcd_draw_wait(TickType_t ticks_to_wait)
+{
+    ESP_RETURN_ON_FALSE(draw_event, ESP_ERR_INVALID_STATE, TAG, "LCD not initialized");
+    EventBits_t bits = xEventGroupWaitBits(draw_event, LCD_DRAW_IDLE_BIT, pdFALSE, pdTRUE, ticks_to_wait);
+
+    return (bits & LCD_DRAW_IDLE_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+static void lcd_strip_done_cb(void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    xQueueSendFromISR(strip_free, &user_ctx, &need_yield);
+    portYIELD_FROM_ISR(need_yield);
+}
 
-    heap_caps_free(buffer);
-}
\ No newline at end of file
+static esp_err_t lcd_strip_pool_init(void)
+{
+    if (strip_free)
+    {
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_FALSE(lcd_panel, ESP_ERR_INVALID_STATE, TAG, "LCD not initialized");
+    strip_free = xQueueCreate(LCD_STRIP_BUFFER_NUM, sizeof(uint16_t *));
+    ESP_RETURN_ON_FALSE(strip_free, ESP_ERR_NO_MEM, TAG, "Strip queue create failed");
+    for (int i = 0; i < LCD_STRIP_BUFFER_NUM; i++)
+    {
+        strip_buffer[i] = heap_caps_malloc(lcd_chunk_pixels(&lcd_cfg) * sizeof(uint16_t), MALLOC_CAP_DMA);
+        ESP_RETURN_ON_FALSE(strip_buffer[i], ESP_ERR_NO_MEM, TAG, "Strip buffer alloc failed");
+        xQueueSend(strip_free, &strip_buffer[i], 0);
+    }
+
+    return ESP_OK;
+}
+
+uint16_t *lcd_strip_get(TickType_t ticks_to_wait)
+{
+    uint16_t *strip = NULL;
+    if (lcd_strip_pool_init() != ESP_OK)
+    {
+        return NULL;
+    }
+    xQueueReceive(strip_free, &strip, ticks_to_wait);
+
+    return strip;
+}
+
+esp_err_t lcd_strip_draw(lcd_region_t region, uint16_t *strip)
+{
+    esp_err_t ret = lcd_draw_async(region, strip, lcd_strip_done_cb, strip);
+    if (ret != ESP_OK)
+    {
+        xQueueSend(strip_free, &strip, 0);
+        ESP_LOGE(TAG, "Draw strip failed");
+    }
+
+    return ret;
+}
+
+esp_err_t lcd_draw_strips(lcd_region_t region, uint16_t strip_height, lcd_strip_fill_cb_t fill_cb, void *user_ctx)
+{
+    uint16_t *strip = NULL;
+    ESP_RETURN_ON_FALSE(fill_cb && region.x2 > region.x1 && region.y2 > region.y1, ESP_ERR_INVALID_ARG, TAG, "Invalid region");
+    uint16_t hres = 0;
+    uint16_t vres = 0;
+    lcd_get_resolution(&hres, &vres);
+    ESP_RETURN_ON_FALSE(region.x2 - region.x1 <= hres, ESP_ERR_INVALID_ARG, TAG, "Region wider than panel");
+    ESP_RETURN_ON_ERROR(lcd_strip_pool_init(), TAG, "Strip pool init failed");
+
+    if (strip_height == 0 || strip_height > lcd_cfg.lcd_draw_buffer_height)
+    {
+        strip_height = lcd_cfg.lcd_draw_buffer_height;
+    }
+
+    for (uint16_t y = region.y1; y < region.y2; y += strip_height)
+    {
+        lcd_region_t strip_region = {
+            .x1 = region.x1,
+            .y1 = y,
+            .x2 = region.x2,
+            .y2 = (y + strip_height < region.y2) ? y + strip_height : region.y2,
+        };
+
+        /*!< one strip is on the wire while the other one is being filled */
+        strip = lcd_strip_get(portMAX_DELAY);
+        fill_cb(strip, strip_region, user_ctx);
+        ESP_RETURN_ON_ERROR(lcd_strip_draw(strip_region, strip), TAG, "Draw strips failed");
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t lcd_fill_rect(lcd_region_t region, uint16_t color)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t remain = (region.x2 - region.x1) * (region.y2 - region.y1);
+    uint8_t cmd = LCD_CMD_RAMWR;
+    ESP_RETURN_ON_FALSE(lcd_io && draw_lock, ESP_ERR_INVALID_STATE, TAG, "LCD not initialized");
+    ESP_RETURN_ON_FALSE(region.x2 > region.x1 && region.y2 > region.y1, ESP_ERR_INVALID_ARG, TAG, "Invalid region");
+
+    xSemaphoreTake(draw_lock, portMAX_DELAY);
+    stream_open = false;
+    if (fill_pattern == NULL)
+    {
+        fill_pattern_pixels = lcd_chunk_pixels(&lcd_cfg);
+        fill_pattern = heap_caps_malloc(fill_pattern_pixels * sizeof(uint16_t), MALLOC_CAP_DMA);
+        ESP_GOTO_ON_FALSE(fill_pattern, ESP_ERR_NO_MEM, out, TAG, "Fill pattern alloc failed");
+        fill_pattern_color = ~color;
+    }
+    if (fill_pattern_color != color)
+    {
+        /*!< queued chunks of the previous fill may still be reading the pattern */
+        xEventGroupWaitBits(draw_event, LCD_DRAW_IDLE_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+        pixel_ops_fill(fill_pattern, swap_hex(color), fill_pattern_pixels);
+        fill_pattern_color = color;
+    }
+
+    /*!< a solid colour only needs its region rotated */
+    if (rotation_soft)
+    {
+        region = lcd_rotate_region(region);
+    }
+    region.x1 += gap_x;
+    region.x2 += gap_x;
+    region.y1 += gap_y;
+    region.y2 += gap_y;
+
+    /*!< open the window once, then stream the pattern with RAMWR followed by RAMWRC */
+    uint8_t caset[] = {region.x1 >> 8, region.x1 & 0xFF, (region.x2 - 1) >> 8, (region.x2 - 1) & 0xFF};
+    uint8_t raset[] = {region.y1 >> 8, region.y1 & 0xFF, (region.y2 - 1) >> 8, (region.y2 - 1) & 0xFF};
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_io_tx_param(lcd_io, LCD_CMD_CASET, caset, sizeof(caset)), out, TAG, "CASET failed");
+    ESP_GOTO_ON_ERROR(esp_lcd_panel_io_tx_param(lcd_io, LCD_CMD_RASET, raset, sizeof(raset)), out, TAG, "RASET failed");
+    while (remain > 0)
+    {
+        uint32_t chunk = remain < fill_pattern_pixels ? remain : fill_pattern_pixels;
+        lcd_pending_push(NULL, NULL);
+        ret = esp_lcd_panel_io_tx_color(lcd_io, cmd, fill_pattern, chunk * sizeof(uint16_t));
+        if (ret != ESP_OK)
+        {
+            lcd_pending_cancel();
+            ESP_LOGE(TAG, "Fill transfer failed");
+            goto out;
+        }
+        cmd = LCD_CMD_RAMWRC;
+        remain -= chunk;
+    }
+
+out:
+    xSemaphoreGive(draw_lock);
+    return ret;
+}
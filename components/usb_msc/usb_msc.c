@@ -1,6 +1,7 @@
 #include "usb_msc.h"
 #include "esp_log.h"
 #include "tusb_msc_storage.h"
+#include "sd_index.h"
 
 static const char *TAG = "USB MSC";
 
@@ -74,6 +75,11 @@ const uint8_t usb_msc_configuration[] = {
 static void usb_msc_mount_changed_cb(tinyusb_msc_event_t *event)
 {
     ESP_LOGI(TAG, "Storage mounted to application: %s", event->mount_changed_data.is_mounted ? "Yes" : "No");
+    if (event->mount_changed_data.is_mounted)
+    {
+        /*!< back from the host, which may have changed anything */
+        sd_index_invalidate();
+    }
 }
 
 esp_err_t usb_msc_init(sdmmc_card_t **card)
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "tinyusb.h"
+#include "esp_err.h"
+#include "camera.h"
+#include "usb_uvc_payload.h"
+
+#define USB_UVC_WIDTH 240
+#define USB_UVC_HEIGHT 240
+#define USB_UVC_FPS 15     /*!< MJPEG */
+#define USB_UVC_YUY2_FPS 8 /*!< 115200 byte frames, 15 fps would be 1.7 MB/s, more than full speed bulk carries */
+#define USB_UVC_EP_IN 0x81
+
+#define USB_UVC_FORMAT_MJPEG 1 /*!< bFormatIndex in the configuration descriptor */
+#define USB_UVC_FORMAT_YUY2 2
+
+extern const char *usb_uvc_string_descriptor[5];
+extern tusb_desc_device_t usb_uvc_device_descriptor;
+extern const uint8_t usb_uvc_configuration_descriptor[];
+
+typedef struct
+{
+    uint8_t task_priority;
+    int task_core;
+} usb_uvc_config_t;
+
+typedef struct
+{
+    uint32_t frames_sent;
+    uint32_t fps;                /*!< frames sent during the last second */
+    uint32_t bytes_per_sec;      /*!< payload bytes sent during the last second */
+    uint32_t bandwidth_permille; /*!< bytes_per_sec against the full speed bulk limit */
+} usb_uvc_stats_t;
+
+/**
+ * @brief install tinyusb with the uvc descriptors and start the frame pump
+ *
+ * @param config
+ * @return esp_err_t
+ */
+esp_err_t usb_uvc_init(usb_uvc_config_t config);
+
+/**
+ * @brief get streaming counters
+ *
+ * @param stats
+ */
+void usb_uvc_get_stats(usb_uvc_stats_t *stats);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+
+#define USB_UVC_PACKET_SIZE 64 /*!< full speed bulk */
+#define USB_UVC_HEADER_SIZE 12
+#define USB_UVC_XFER_MAX (UINT16_MAX / USB_UVC_PACKET_SIZE * USB_UVC_PACKET_SIZE) /*!< usbd_edpt_xfer takes a 16 bit length */
+
+/**
+ * @brief one UVC payload: a packet holding the header and the first bytes of the frame,
+ *        followed by the rest of the frame sent straight from the frame buffer
+ */
+typedef struct
+{
+    uint8_t head[USB_UVC_PACKET_SIZE];
+    size_t head_len;
+    const uint8_t *body;
+    size_t body_len;
+    size_t body_sent; /*!< advanced by usb_uvc_payload_next */
+    bool zlp;         /*!< payload ends on a packet boundary and needs a zero length packet */
+} usb_uvc_payload_t;
+
+/**
+ * @brief fill the 12 byte payload header
+ *
+ * @param header
+ * @param fid frame id, toggles every frame
+ * @param eof
+ * @param pts presentation time in us
+ * @return size_t header length
+ */
+size_t usb_uvc_payload_header(uint8_t *header, uint8_t fid, bool eof, uint32_t pts);
+
+/**
+ * @brief split a frame into one payload, only the first packet is copied
+ *
+ * @param payload
+ * @param frame
+ * @param len
+ * @param fid
+ * @param pts
+ */
+void usb_uvc_payload_prepare(usb_uvc_payload_t *payload, const uint8_t *frame, size_t len, uint8_t fid, uint32_t pts);
+
+/**
+ * @brief take the next body transfer, at most USB_UVC_XFER_MAX bytes and whole packets except the last one
+ *
+ * Transfers that end on a packet boundary do not end the payload on the bus, so the host
+ * sees one payload however many transfers the body takes.
+ *
+ * @param payload
+ * @param data start of the transfer
+ * @return size_t transfer length, 0 once the whole body was taken
+ */
+size_t usb_uvc_payload_next(usb_uvc_payload_t *payload, const uint8_t **data);
@@ -0,0 +1,657 @@
+#include "usb_uvc.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "string.h"
+#include "device/usbd_pvt.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define USB_UVC_ITF_VC 0
+#define USB_UVC_ITF_VS 1
+#define USB_UVC_FRAME_SIZE (USB_UVC_WIDTH * USB_UVC_HEIGHT * 2)
+#define USB_UVC_FRAME_INTERVAL (10000000 / USB_UVC_FPS) /*!< 100 ns units */
+#define USB_UVC_BITRATE (USB_UVC_FRAME_SIZE * 8 * USB_UVC_FPS)
+#define USB_UVC_YUY2_FRAME_INTERVAL (10000000 / USB_UVC_YUY2_FPS)
+#define USB_UVC_YUY2_BITRATE (USB_UVC_FRAME_SIZE * 8 * USB_UVC_YUY2_FPS)
+#define USB_UVC_BULK_LIMIT 1216000 /*!< 19 bulk packets of 64 bytes per 1 ms frame */
+
+#define USB_UVC_VS_PROBE_CONTROL 0x01
+#define USB_UVC_VS_COMMIT_CONTROL 0x02
+#define USB_UVC_SET_CUR 0x01
+#define USB_UVC_GET_CUR 0x81
+#define USB_UVC_GET_MIN 0x82
+#define USB_UVC_GET_MAX 0x83
+#define USB_UVC_GET_LEN 0x85
+#define USB_UVC_GET_INFO 0x86
+#define USB_UVC_GET_DEF 0x87
+
+#define USB_UVC_VC_TOTAL_LEN (13 + 18 + 9)
+#define USB_UVC_VS_TOTAL_LEN (15 + 11 + 30 + 6 + 27 + 30 + 6)
+#define USB_UVC_DESC_TOTAL_LEN (9 + 8 + 9 + USB_UVC_VC_TOTAL_LEN + 9 + USB_UVC_VS_TOTAL_LEN + 7)
+
+typedef struct __attribute__((packed))
+{
+    uint16_t bmHint;
+    uint8_t bFormatIndex;
+    uint8_t bFrameIndex;
+    uint32_t dwFrameInterval;
+    uint16_t wKeyFrameRate;
+    uint16_t wPFrameRate;
+    uint16_t wCompQuality;
+    uint16_t wCompWindowSize;
+    uint16_t wDelay;
+    uint32_t dwMaxVideoFrameSize;
+    uint32_t dwMaxPayloadTransferSize;
+    uint32_t dwClockFrequency;
+    uint8_t bmFramingInfo;
+    uint8_t bPreferedVersion;
+    uint8_t bMinVersion;
+    uint8_t bMaxVersion;
+} usb_uvc_probe_t;
+
+typedef enum
+{
+    USB_UVC_XFER_IDLE,
+    USB_UVC_XFER_HEAD,
+    USB_UVC_XFER_BODY,
+    USB_UVC_XFER_ZLP,
+} usb_uvc_xfer_state_t;
+
+static const char *TAG = "USB UVC";
+
+const char *usb_uvc_string_descriptor[] = {
+    // array of pointer to string descriptors
+    (char[]){0x09, 0x04}, /*!< support language is english */
+    "TinyUSB",            /*!< manufacturer */
+    "TinyUSB Device",     /*!< product */
+    "123456",             /*!< chip id */
+    "Example UVC",
+};
+
+tusb_desc_device_t usb_uvc_device_descriptor = {
+    .bLength = sizeof(usb_uvc_device_descriptor),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0200,
+    .bDeviceClass = TUSB_CLASS_MISC, // IAD groups the control and streaming interfaces into one function
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = 0x303A, // This is Espressif VID. This needs to be changed according to Users / Customers
+    .idProduct = 0x4002,
+    .bcdDevice = 0x100,
+    .iManufacturer = 0x01,
+    .iProduct = 0x02,
+    .iSerialNumber = 0x03,
+    .bNumConfigurations = 0x01,
+};
+
+const uint8_t usb_uvc_configuration_descriptor[] = {
+    // configuration descriptor
+    0x09,                                  // bLength
+    0x02,                                  // bDescriptorType: configuration
+    U16_TO_U8S_LE(USB_UVC_DESC_TOTAL_LEN), // wTotalLength
+    2,                                     // bNumInterfaces: video control and video streaming
+    1,                                     // bConfigurationValue
+    0,                                     // iConfiguration
+    0xA0,                                  // bmAttributes: bus powered, remote wakeup
+    0x32,                                  // bMaxPower: 100 mA
+
+    // interface association descriptor
+    0x08, // bLength
+    0x0B, // bDescriptorType: IAD
+    USB_UVC_ITF_VC, // bFirstInterface
+    2,    // bInterfaceCount
+    0x0E, // bFunctionClass: video
+    0x03, // bFunctionSubClass: video interface collection
+    0x00, // bFunctionProtocol
+    0x02, // iFunction
+
+    // standard video control interface
+    0x09, // bLength
+    0x04, // bDescriptorType: interface
+    USB_UVC_ITF_VC, // bInterfaceNumber
+    0x00, // bAlternateSetting
+    0x00, // bNumEndpoints: no status interrupt endpoint
+    0x0E, // bInterfaceClass: video
+    0x01, // bInterfaceSubClass: video control
+    0x00, // bInterfaceProtocol
+    0x02, // iInterface
+
+    // class specific video control header
+    0x0D,                                 // bLength
+    0x24,                                 // bDescriptorType: CS_INTERFACE
+    0x01,                                 // bDescriptorSubType: VC_HEADER
+    U16_TO_U8S_LE(0x0110),                // bcdUVC 1.1
+    U16_TO_U8S_LE(USB_UVC_VC_TOTAL_LEN),  // wTotalLength
+    U32_TO_U8S_LE(48000000),              // dwClockFrequency, unused
+    0x01,                                 // bInCollection: one streaming interface
+    USB_UVC_ITF_VS,                       // baInterfaceNr
+
+    // camera input terminal
+    0x12,                 // bLength
+    0x24,                 // bDescriptorType: CS_INTERFACE
+    0x02,                 // bDescriptorSubType: VC_INPUT_TERMINAL
+    0x01,                 // bTerminalID
+    U16_TO_U8S_LE(0x0201), // wTerminalType: ITT_CAMERA
+    0x00,                 // bAssocTerminal
+    0x00,                 // iTerminal
+    U16_TO_U8S_LE(0),     // wObjectiveFocalLengthMin
+    U16_TO_U8S_LE(0),     // wObjectiveFocalLengthMax
+    U16_TO_U8S_LE(0),     // wOcularFocalLength
+    0x03,                 // bControlSize
+    0x00, 0x00, 0x00,     // bmControls: none
+
+    // output terminal
+    0x09,                 // bLength
+    0x24,                 // bDescriptorType: CS_INTERFACE
+    0x03,                 // bDescriptorSubType: VC_OUTPUT_TERMINAL
+    0x02,                 // bTerminalID
+    U16_TO_U8S_LE(0x0101), // wTerminalType: TT_STREAMING
+    0x00,                 // bAssocTerminal
+    0x01,                 // bSourceID: camera terminal
+    0x00,                 // iTerminal
+
+    // standard video streaming interface, bulk so there is a single alternate setting
+    0x09, // bLength
+    0x04, // bDescriptorType: interface
+    USB_UVC_ITF_VS, // bInterfaceNumber
+    0x00, // bAlternateSetting
+    0x01, // bNumEndpoints
+    0x0E, // bInterfaceClass: video
+    0x02, // bInterfaceSubClass: video streaming
+    0x00, // bInterfaceProtocol
+    0x00, // iInterface
+
+    // class specific video streaming input header
+    0x0F,                                // bLength
+    0x24,                                // bDescriptorType: CS_INTERFACE
+    0x01,                                // bDescriptorSubType: VS_INPUT_HEADER
+    0x02,                                // bNumFormats
+    U16_TO_U8S_LE(USB_UVC_VS_TOTAL_LEN), // wTotalLength
+    USB_UVC_EP_IN,                       // bEndpointAddress
+    0x00,                                // bmInfo
+    0x02,                                // bTerminalLink: output terminal
+    0x00,                                // bStillCaptureMethod
+    0x00,                                // bTriggerSupport
+    0x00,                                // bTriggerUsage
+    0x01,                                // bControlSize
+    0x00,                                // bmaControls, format 1
+    0x00,                                // bmaControls, format 2
+
+    // MJPEG format
+    0x0B,                 // bLength
+    0x24,                 // bDescriptorType: CS_INTERFACE
+    0x06,                 // bDescriptorSubType: VS_FORMAT_MJPEG
+    USB_UVC_FORMAT_MJPEG, // bFormatIndex
+    0x01,                 // bNumFrameDescriptors
+    0x01,                 // bmFlags: fixed size samples
+    0x01,                 // bDefaultFrameIndex
+    0x00,                 // bAspectRatioX
+    0x00,                 // bAspectRatioY
+    0x00,                 // bmInterlaceFlags
+    0x00,                 // bCopyProtect
+
+    // MJPEG frame
+    0x1E,                                  // bLength
+    0x24,                                  // bDescriptorType: CS_INTERFACE
+    0x07,                                  // bDescriptorSubType: VS_FRAME_MJPEG
+    0x01,                                  // bFrameIndex
+    0x00,                                  // bmCapabilities
+    U16_TO_U8S_LE(USB_UVC_WIDTH),          // wWidth
+    U16_TO_U8S_LE(USB_UVC_HEIGHT),         // wHeight
+    U32_TO_U8S_LE(USB_UVC_BITRATE),        // dwMinBitRate
+    U32_TO_U8S_LE(USB_UVC_BITRATE),        // dwMaxBitRate
+    U32_TO_U8S_LE(USB_UVC_FRAME_SIZE),     // dwMaxVideoFrameBufferSize
+    U32_TO_U8S_LE(USB_UVC_FRAME_INTERVAL), // dwDefaultFrameInterval
+    0x01,                                  // bFrameIntervalType: one discrete interval
+    U32_TO_U8S_LE(USB_UVC_FRAME_INTERVAL), // dwFrameInterval
+
+    // color matching
+    0x06, // bLength
+    0x24, // bDescriptorType: CS_INTERFACE
+    0x0D, // bDescriptorSubType: VS_COLORFORMAT
+    0x01, // bColorPrimaries: BT.709, sRGB
+    0x01, // bTransferCharacteristics: BT.709
+    0x04, // bMatrixCoefficients: SMPTE 170M
+
+    // uncompressed YUY2 format
+    0x1B,                                                                                           // bLength
+    0x24,                                                                                           // bDescriptorType: CS_INTERFACE
+    0x04,                                                                                           // bDescriptorSubType: VS_FORMAT_UNCOMPRESSED
+    USB_UVC_FORMAT_YUY2,                                                                            // bFormatIndex
+    0x01,                                                                                           // bNumFrameDescriptors
+    'Y', 'U', 'Y', '2', 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71,     // guidFormat
+    0x10,                                                                                           // bBitsPerPixel
+    0x01,                                                                                           // bDefaultFrameIndex
+    0x00,                                                                                           // bAspectRatioX
+    0x00,                                                                                           // bAspectRatioY
+    0x00,                                                                                           // bmInterlaceFlags
+    0x00,                                                                                           // bCopyProtect
+
+    // uncompressed frame
+    0x1E,                                  // bLength
+    0x24,                                  // bDescriptorType: CS_INTERFACE
+    0x05,                                  // bDescriptorSubType: VS_FRAME_UNCOMPRESSED
+    0x01,                                  // bFrameIndex
+    0x00,                                  // bmCapabilities
+    U16_TO_U8S_LE(USB_UVC_WIDTH),               // wWidth
+    U16_TO_U8S_LE(USB_UVC_HEIGHT),              // wHeight
+    U32_TO_U8S_LE(USB_UVC_YUY2_BITRATE),        // dwMinBitRate
+    U32_TO_U8S_LE(USB_UVC_YUY2_BITRATE),        // dwMaxBitRate
+    U32_TO_U8S_LE(USB_UVC_FRAME_SIZE),          // dwMaxVideoFrameBufferSize
+    U32_TO_U8S_LE(USB_UVC_YUY2_FRAME_INTERVAL), // dwDefaultFrameInterval
+    0x01,                                       // bFrameIntervalType: one discrete interval, what the bus carries
+    U32_TO_U8S_LE(USB_UVC_YUY2_FRAME_INTERVAL), // dwFrameInterval
+
+    // color matching
+    0x06, // bLength
+    0x24, // bDescriptorType: CS_INTERFACE
+    0x0D, // bDescriptorSubType: VS_COLORFORMAT
+    0x01, // bColorPrimaries
+    0x01, // bTransferCharacteristics
+    0x04, // bMatrixCoefficients
+
+    // bulk in endpoint
+    0x07,              // bLength
+    0x05,              // bDescriptorType: endpoint
+    USB_UVC_EP_IN,     // bEndpointAddress
+    0x02,              // bmAttributes: bulk
+    U16_TO_U8S_LE(USB_UVC_PACKET_SIZE), // wMaxPacketSize
+    0x00,              // bInterval
+};
+
+static usb_uvc_config_t uvc_cfg;
+static usb_uvc_stats_t uvc_stats;
+static usb_uvc_probe_t probe;
+static usb_uvc_probe_t commit;
+static volatile bool streaming = false;
+static uint8_t uvc_rhport = 0;
+static tusb_desc_endpoint_t const *ep_in_desc = NULL; /*!< to open the endpoint again after an abort */
+static usb_uvc_payload_t payload;
+static usb_uvc_xfer_state_t xfer_state = USB_UVC_XFER_IDLE;
+static SemaphoreHandle_t frame_sent = NULL;
+
+static void usb_uvc_probe_default(usb_uvc_probe_t *p, uint8_t format_index)
+{
+    memset(p, 0, sizeof(usb_uvc_probe_t));
+    p->bmHint = 1; /*!< dwFrameInterval is fixed */
+    p->bFormatIndex = format_index;
+    p->bFrameIndex = 1;
+    p->dwFrameInterval = (format_index == USB_UVC_FORMAT_YUY2) ? USB_UVC_YUY2_FRAME_INTERVAL : USB_UVC_FRAME_INTERVAL;
+    p->dwMaxVideoFrameSize = USB_UVC_FRAME_SIZE;
+    /*!< every frame is sent as a single payload */
+    p->dwMaxPayloadTransferSize = USB_UVC_FRAME_SIZE + USB_UVC_HEADER_SIZE;
+    p->dwClockFrequency = 1000000; /*!< PTS and SCR are in us */
+    p->bmFramingInfo = 0x03;
+    p->bPreferedVersion = 1;
+    p->bMinVersion = 1;
+    p->bMaxVersion = 1;
+}
+
+/**
+ * @brief clamp a probe or commit the host proposed to what this device can do
+ *
+ * The format and the compression fields the host asked for are kept. There is one frame and
+ * one interval per format, the sizes and the clock are the device's.
+ */
+static void usb_uvc_probe_negotiate(usb_uvc_probe_t *p)
+{
+    usb_uvc_probe_t proposed = *p;
+    uint8_t format = (proposed.bFormatIndex == USB_UVC_FORMAT_YUY2) ? USB_UVC_FORMAT_YUY2 : USB_UVC_FORMAT_MJPEG;
+
+    usb_uvc_probe_default(p, format);
+    p->bmHint = proposed.bmHint;
+    p->wKeyFrameRate = proposed.wKeyFrameRate;
+    p->wPFrameRate = proposed.wPFrameRate;
+    p->wCompQuality = proposed.wCompQuality;
+    p->wCompWindowSize = proposed.wCompWindowSize;
+    if (proposed.dwFrameInterval != 0 && proposed.dwFrameInterval != p->dwFrameInterval)
+    {
+        ESP_LOGI(TAG, "Frame interval %lu requested, %lu is the only one", (unsigned long)proposed.dwFrameInterval, (unsigned long)p->dwFrameInterval);
+    }
+}
+
+static bool usb_uvc_xfer_start(uint8_t rhport, const uint8_t *data, size_t len)
+{
+    if (usbd_edpt_xfer(rhport, USB_UVC_EP_IN, (uint8_t *)data, len))
+    {
+        return true;
+    }
+    /*!< the payload can not continue, release the pump */
+    xfer_state = USB_UVC_XFER_IDLE;
+    xSemaphoreGive(frame_sent);
+    return false;
+}
+
+/**
+ * @brief move the current payload forward by one transfer, called from the tinyusb task
+ */
+static bool usb_uvc_xfer_next(uint8_t rhport)
+{
+    const uint8_t *data = NULL;
+    size_t len = 0;
+
+    switch (xfer_state)
+    {
+    case USB_UVC_XFER_HEAD:
+        xfer_state = USB_UVC_XFER_BODY;
+        /* fall through */
+    case USB_UVC_XFER_BODY:
+        /*!< the rest of the frame goes out straight from the camera buffer, in transfers the 16 bit length can hold */
+        len = usb_uvc_payload_next(&payload, &data);
+        if (len)
+        {
+            return usb_uvc_xfer_start(rhport, data, len);
+        }
+        if (payload.zlp)
+        {
+            xfer_state = USB_UVC_XFER_ZLP;
+            return usb_uvc_xfer_start(rhport, NULL, 0);
+        }
+        /* fall through */
+    default:
+        xfer_state = USB_UVC_XFER_IDLE;
+        xSemaphoreGive(frame_sent);
+        return true;
+    }
+}
+
+/**
+ * @brief the host stopped the stream, drop the payload in flight and release the pump
+ *
+ * A cleared halt does not complete the pending transfer, so the endpoint is closed and opened
+ * again, which also lets usbd ack the request.
+ */
+static void usb_uvc_stream_stop(uint8_t rhport)
+{
+    streaming = false;
+    if (xfer_state != USB_UVC_XFER_IDLE)
+    {
+        usbd_edpt_close(rhport, USB_UVC_EP_IN);
+        usbd_edpt_open(rhport, ep_in_desc);
+        xfer_state = USB_UVC_XFER_IDLE;
+        xSemaphoreGive(frame_sent);
+    }
+    ESP_LOGI(TAG, "Streaming stopped");
+}
+
+static void usb_uvc_driver_init(void)
+{
+    usb_uvc_probe_default(&probe, USB_UVC_FORMAT_MJPEG);
+    commit = probe;
+}
+
+static void usb_uvc_driver_reset(uint8_t rhport)
+{
+    streaming = false;
+    if (xfer_state != USB_UVC_XFER_IDLE)
+    {
+        /*!< the transfer was aborted by the reset, release the pump */
+        xfer_state = USB_UVC_XFER_IDLE;
+        xSemaphoreGive(frame_sent);
+    }
+}
+
+static uint16_t usb_uvc_driver_open(uint8_t rhport, tusb_desc_interface_t const *desc_intf, uint16_t max_len)
+{
+    TU_VERIFY(desc_intf->bInterfaceClass == 0x0E && desc_intf->bInterfaceSubClass == 0x01, 0);
+
+    /*!< claim the control and the streaming interface together, as grouped by the IAD */
+    uint8_t const *p = (uint8_t const *)desc_intf;
+    uint8_t const *end = p + max_len;
+    uint16_t len = 0;
+    while (p < end)
+    {
+        if (tu_desc_type(p) == TUSB_DESC_INTERFACE_ASSOCIATION)
+        {
+            break;
+        }
+        if (tu_desc_type(p) == TUSB_DESC_INTERFACE && ((tusb_desc_interface_t const *)p)->bInterfaceNumber > USB_UVC_ITF_VS)
+        {
+            break;
+        }
+        if (tu_desc_type(p) == TUSB_DESC_ENDPOINT)
+        {
+            TU_ASSERT(usbd_edpt_open(rhport, (tusb_desc_endpoint_t const *)p), 0);
+            if (((tusb_desc_endpoint_t const *)p)->bEndpointAddress == USB_UVC_EP_IN)
+            {
+                ep_in_desc = (tusb_desc_endpoint_t const *)p;
+            }
+        }
+        len += tu_desc_len(p);
+        p = tu_desc_next(p);
+    }
+    uvc_rhport = rhport;
+
+    return len;
+}
+
+static bool usb_uvc_driver_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request)
+{
+    uint8_t itf = tu_u16_low(request->wIndex);
+    uint8_t selector = tu_u16_high(request->wValue);
+
+    if (request->bmRequestType_bit.type == TUSB_REQ_TYPE_STANDARD)
+    {
+        /*!< with bulk streaming the host stops the stream by clearing the halt of the video endpoint, usbd sends the status */
+        if (request->bmRequestType_bit.recipient == TUSB_REQ_RCPT_ENDPOINT && request->bRequest == TUSB_REQ_CLEAR_FEATURE &&
+            request->wValue == TUSB_REQ_FEATURE_EDPT_HALT && tu_u16_low(request->wIndex) == USB_UVC_EP_IN)
+        {
+            if (stage == CONTROL_STAGE_SETUP)
+            {
+                usb_uvc_stream_stop(rhport);
+            }
+            return true;
+        }
+        /*!< bulk streaming has a single alternate setting */
+        if (request->bRequest == TUSB_REQ_SET_INTERFACE && stage == CONTROL_STAGE_SETUP)
+        {
+            return tud_control_status(rhport, request);
+        }
+        return false;
+    }
+    TU_VERIFY(request->bmRequestType_bit.type == TUSB_REQ_TYPE_CLASS && itf == USB_UVC_ITF_VS);
+    TU_VERIFY(selector == USB_UVC_VS_PROBE_CONTROL || selector == USB_UVC_VS_COMMIT_CONTROL);
+    usb_uvc_probe_t *ctrl = (selector == USB_UVC_VS_PROBE_CONTROL) ? &probe : &commit;
+
+    if (stage == CONTROL_STAGE_SETUP)
+    {
+        static uint16_t len = sizeof(usb_uvc_probe_t);
+        static uint8_t info = 0x03; /*!< supports GET and SET */
+        static usb_uvc_probe_t limit;
+        switch (request->bRequest)
+        {
+        case USB_UVC_SET_CUR:
+            return tud_control_xfer(rhport, request, ctrl, sizeof(usb_uvc_probe_t));
+        case USB_UVC_GET_CUR:
+            return tud_control_xfer(rhport, request, ctrl, sizeof(usb_uvc_probe_t));
+        case USB_UVC_GET_MIN:
+        case USB_UVC_GET_MAX:
+        case USB_UVC_GET_DEF:
+            /*!< one frame and one interval per format, so minimum, maximum and default are the same */
+            usb_uvc_probe_default(&limit, ctrl->bFormatIndex);
+            return tud_control_xfer(rhport, request, &limit, sizeof(usb_uvc_probe_t));
+        case USB_UVC_GET_LEN:
+            return tud_control_xfer(rhport, request, &len, sizeof(len));
+        case USB_UVC_GET_INFO:
+            return tud_control_xfer(rhport, request, &info, sizeof(info));
+        default:
+            return false;
+        }
+    }
+    if (stage == CONTROL_STAGE_DATA && request->bRequest == USB_UVC_SET_CUR)
+    {
+        /*!< GET_CUR after this returns what was granted */
+        usb_uvc_probe_negotiate(ctrl);
+        if (selector == USB_UVC_VS_COMMIT_CONTROL)
+        {
+            probe = commit;
+            streaming = true;
+            ESP_LOGI(TAG, "Streaming %s, %lu us per frame", commit.bFormatIndex == USB_UVC_FORMAT_MJPEG ? "MJPEG" : "YUY2", (unsigned long)(commit.dwFrameInterval / 10));
+        }
+    }
+    return true;
+}
+
+static bool usb_uvc_driver_xfer_cb(uint8_t rhport, uint8_t ep_addr, xfer_result_t result, uint32_t xferred_bytes)
+{
+    if (result != XFER_RESULT_SUCCESS)
+    {
+        /*!< the transfer failed, e.g. stalled, the host has to start the stream again */
+        streaming = false;
+        xfer_state = USB_UVC_XFER_IDLE;
+        xSemaphoreGive(frame_sent);
+        return true;
+    }
+    return usb_uvc_xfer_next(rhport);
+}
+
+static usbd_class_driver_t const usb_uvc_driver = {
+#if CFG_TUSB_DEBUG >= 2
+    .name = "UVC",
+#endif
+    .init = usb_uvc_driver_init,
+    .reset = usb_uvc_driver_reset,
+    .open = usb_uvc_driver_open,
+    .control_xfer_cb = usb_uvc_driver_control_xfer_cb,
+    .xfer_cb = usb_uvc_driver_xfer_cb,
+    .sof = NULL,
+};
+
+usbd_class_driver_t const *usbd_app_driver_get_cb(uint8_t *driver_count)
+{
+    *driver_count = 1;
+    return &usb_uvc_driver;
+}
+
+/**
+ * @brief make the sensor output match the format the host committed
+ */
+static esp_err_t usb_uvc_camera_format(uint8_t format_index, pixformat_t *current, bool *ready)
+{
+    pixformat_t wanted = (format_index == USB_UVC_FORMAT_YUY2) ? PIXFORMAT_YUV422 : PIXFORMAT_JPEG;
+    if (*ready && wanted == *current)
+    {
+        return ESP_OK;
+    }
+    if (*ready)
+    {
+        esp_camera_deinit();
+        *ready = false;
+    }
+    ESP_RETURN_ON_ERROR(camera_init(wanted, FRAMESIZE_240X240), TAG, "Camera init failed");
+    *current = wanted;
+    *ready = true;
+
+    return ESP_OK;
+}
+
+static void usb_uvc_pump_task(void *arg)
+{
+    pixformat_t format = PIXFORMAT_JPEG;
+    bool camera_ready = false; /*!< the camera is started once the host commits a format */
+    uint8_t fid = 0;
+    int64_t last_frame = 0;
+    uint32_t window_frames = 0;
+    uint32_t window_bytes = 0;
+    int64_t window_start = esp_timer_get_time();
+
+    while (1)
+    {
+        if (!streaming)
+        {
+            /*!< the sensor stops while nobody watches, the next stream starts with a fresh frame */
+            if (camera_ready)
+            {
+                esp_camera_deinit();
+                camera_ready = false;
+            }
+            vTaskDelay(pdMS_TO_TICKS(20));
+            continue;
+        }
+        if (usb_uvc_camera_format(commit.bFormatIndex, &format, &camera_ready) != ESP_OK)
+        {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+        /*!< no faster than the committed interval, the sensor runs at its own rate */
+        int64_t due = last_frame + commit.dwFrameInterval / 10 - esp_timer_get_time();
+        if (due > 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(due / 1000) + 1);
+        }
+        camera_fb_t *pic = esp_camera_fb_get();
+        if (!pic)
+        {
+            continue;
+        }
+        last_frame = esp_timer_get_time();
+
+        usb_uvc_payload_prepare(&payload, pic->buf, pic->len, fid, (uint32_t)esp_timer_get_time());
+        if (usbd_edpt_claim(uvc_rhport, USB_UVC_EP_IN))
+        {
+            xfer_state = USB_UVC_XFER_HEAD;
+            if (usbd_edpt_xfer(uvc_rhport, USB_UVC_EP_IN, payload.head, payload.head_len))
+            {
+                /*!< the camera buffer is read by the USB stack until the payload completes */
+                xSemaphoreTake(frame_sent, portMAX_DELAY);
+                fid ^= 1;
+                uvc_stats.frames_sent++;
+                window_frames++;
+                window_bytes += pic->len + USB_UVC_HEADER_SIZE;
+            }
+            else
+            {
+                xfer_state = USB_UVC_XFER_IDLE;
+            }
+            usbd_edpt_release(uvc_rhport, USB_UVC_EP_IN);
+        }
+        esp_camera_fb_return(pic);
+
+        int64_t now = esp_timer_get_time();
+        if (now - window_start >= 1000000)
+        {
+            uvc_stats.fps = window_frames * 1000000 / (now - window_start);
+            uvc_stats.bytes_per_sec = (uint64_t)window_bytes * 1000000 / (now - window_start);
+            uvc_stats.bandwidth_permille = (uint64_t)uvc_stats.bytes_per_sec * 1000 / USB_UVC_BULK_LIMIT;
+            window_frames = 0;
+            window_bytes = 0;
+            window_start = now;
+        }
+    }
+}
+
+esp_err_t usb_uvc_init(usb_uvc_config_t config)
+{
+    esp_err_t ret = ESP_FAIL;
+    uvc_cfg = config;
+
+    frame_sent = xSemaphoreCreateBinary();
+    ESP_RETURN_ON_FALSE(frame_sent, ESP_ERR_NO_MEM, TAG, "Semaphore create failed");
+
+    // config descriptor
+    const tinyusb_config_t tusb_cfg = {
+        .device_descriptor = &usb_uvc_device_descriptor,
+        .string_descriptor = usb_uvc_string_descriptor,
+        .string_descriptor_count = sizeof(usb_uvc_string_descriptor) / sizeof(usb_uvc_string_descriptor[0]),
+        .external_phy = false,
+        .configuration_descriptor = usb_uvc_configuration_descriptor,
+    };
+
+    ret = tinyusb_driver_install(&tusb_cfg);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    ESP_RETURN_ON_FALSE(xTaskCreatePinnedToCore(usb_uvc_pump_task, "uvc_pump", 4096, NULL, config.task_priority, NULL, config.task_core) == pdPASS,
+                        ESP_ERR_NO_MEM, TAG, "Pump task create failed");
+    return ESP_OK;
+}
+
+void usb_uvc_get_stats(usb_uvc_stats_t *stats)
+{
+    *stats = uvc_stats;
+}
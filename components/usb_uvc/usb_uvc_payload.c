@@ -0,0 +1,50 @@
+#include "usb_uvc_payload.h"
+#include "esp_bit_defs.h"
+#include "string.h"
+
+#define USB_UVC_HEADER_EOH BIT(7)
+#define USB_UVC_HEADER_SCR BIT(3)
+#define USB_UVC_HEADER_PTS BIT(2)
+#define USB_UVC_HEADER_EOF BIT(1)
+#define USB_UVC_HEADER_FID BIT(0)
+
+size_t usb_uvc_payload_header(uint8_t *header, uint8_t fid, bool eof, uint32_t pts)
+{
+    header[0] = USB_UVC_HEADER_SIZE;
+    header[1] = USB_UVC_HEADER_EOH | USB_UVC_HEADER_PTS | USB_UVC_HEADER_SCR | (fid & USB_UVC_HEADER_FID) | (eof ? USB_UVC_HEADER_EOF : 0);
+    /*!< PTS, then SCR as source clock and a zero SOF counter */
+    for (int i = 0; i < 4; i++)
+    {
+        header[2 + i] = (pts >> (8 * i)) & 0xFF;
+        header[6 + i] = (pts >> (8 * i)) & 0xFF;
+    }
+    header[10] = 0;
+    header[11] = 0;
+
+    return USB_UVC_HEADER_SIZE;
+}
+
+void usb_uvc_payload_prepare(usb_uvc_payload_t *payload, const uint8_t *frame, size_t len, uint8_t fid, uint32_t pts)
+{
+    /*!< the whole frame is one payload, so every payload carries EOF */
+    size_t head = usb_uvc_payload_header(payload->head, fid, true, pts);
+    size_t copy = USB_UVC_PACKET_SIZE - head;
+    copy = copy < len ? copy : len;
+
+    memcpy(payload->head + head, frame, copy);
+    payload->head_len = head + copy;
+    payload->body = frame + copy;
+    payload->body_len = len - copy;
+    payload->body_sent = 0;
+    payload->zlp = ((head + len) % USB_UVC_PACKET_SIZE) == 0;
+}
+
+size_t usb_uvc_payload_next(usb_uvc_payload_t *payload, const uint8_t **data)
+{
+    size_t len = payload->body_len - payload->body_sent;
+    len = len < USB_UVC_XFER_MAX ? len : USB_UVC_XFER_MAX;
+
+    *data = payload->body + payload->body_sent;
+    payload->body_sent += len;
+    return len;
+}
@@ -13,19 +13,30 @@
 #include "hid_device_mouse.h"
 #include "hid_device_audio_ctrl.h"
 #include "sd_card.h"
+#include "sd_log.h"
 #include "st7789.h"
-#include "esp_lvgl_port.h"
+#include "lcd_tune.h"
+#include "nvs_flash.h"
+#include "lvgl_sched.h"
+#include "lvgl_flush.h"
+#include "img_rle.h"
+#include "asset_store.h"
 #include "ui.h"
 #include "usb_msc.h"
 #include "camera.h"
+#include "camera_pipeline.h"
+#include "usb_uvc.h"
+#include "avi_recorder.h"
 
 #define APP_BUTTON (GPIO_NUM_0) // Use BOOT signal by default
+#define CAMERA_AVI_FPS 25u
+#define CAMERA_AVI_FRAME_BUDGET (32u * 1024u) // about twice a 240x240 frame at the default quality
 lv_disp_t *lvgl_disp = NULL;
 
 #ifdef CONFIG_ESP32_S3_EYE
 static const char *TAG = "ESP_EYE";
 #else
-static const char *TAG ="USB_OTG"
+static const char *TAG = "USB_OTG";
 #endif
 
 #ifdef CONFIG_ESP32_S3_EYE
@@ -43,6 +54,18 @@ lcd_config_t lcd_config = {
     .lcd_vertical_res = 240,
     .lcd_draw_buffer_height = 50,
 };
+
+#ifdef CONFIG_CAMERA_AVI_RECORD
+sd_card_config_t sd_card_config = {
+    .clk = GPIO_NUM_39,
+    .cmd = GPIO_NUM_38,
+    .d0 = GPIO_NUM_40,
+    .d1 = GPIO_NUM_NC, /* one data line on the ESP32-S3-EYE */
+    .d2 = GPIO_NUM_NC,
+    .d3 = GPIO_NUM_NC,
+    .index_task_priority = 1,
+};
+#endif
 #else
 lcd_config_t lcd_config = {
     .spi_host_device = SPI3_HOST,
@@ -66,6 +89,10 @@ sd_card_config_t sd_card_config = {
     .d1 = GPIO_NUM_38,
     .d2 = GPIO_NUM_33,
     .d3 = GPIO_NUM_34,
+    .index_task_priority = 1,
+#ifdef CONFIG_SD_BUS_PROBE
+    .probe_bus = true,
+#endif
 };
 #endif
 
@@ -91,36 +118,68 @@ void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_
 
 esp_err_t lvgl_init()
 {
-    const lvgl_port_cfg_t lvgl_cfg = {
-        .task_priority = 4,       /* LVGL task priority */
-        .task_stack = 4096,       /* LVGL task stack size */
-        .task_affinity = -1,      /* LVGL task pinned to core (-1 is no affinity) */
-        .task_max_sleep_ms = 500, /* Maximum sleep in LVGL task */
-        .timer_period_ms = 5      /* LVGL timer tick period in ms */
+    const lvgl_sched_config_t lvgl_cfg = {
+        .task_priority = 4, /* LVGL task priority */
+        .task_stack = 4096, /* LVGL task stack size */
+        .task_core = 0,     /* LVGL renders on core 0, the flush task queues strips and bounce copies from core 1 */
+        .max_sleep_ms = 0,  /* sleep until a timer is due or the UI is touched */
     };
-    ESP_RETURN_ON_ERROR(lvgl_port_init(&lvgl_cfg), TAG, "LVGL port initialization failed");
+    ESP_RETURN_ON_ERROR(lvgl_sched_init(lvgl_cfg), TAG, "LVGL task initialization failed");
 
     /* Add LCD screen */
     ESP_LOGI(TAG, "Add LCD screen");
-    const lvgl_port_display_cfg_t disp_cfg = {
-        .io_handle = lcd_io,
-        .panel_handle = lcd_panel,
-        .buffer_size = lcd_config.lcd_height_res * lcd_config.lcd_draw_buffer_height * sizeof(uint16_t),
-        .double_buffer = 1,
-        .hres = lcd_config.lcd_height_res,
-        .vres = lcd_config.lcd_vertical_res,
-        .monochrome = false,
-        /* Rotation values must be same as used in esp_lcd for initial settings of the screen */
-        .rotation = {
-            .swap_xy = false,
-            .mirror_x = false,
-            .mirror_y = false,
-        },
-        .flags = {
-            .buff_dma = true,
-        }};
-
-    lvgl_disp = lvgl_port_add_disp(&disp_cfg);
+    uint16_t hres = 0;
+    uint16_t vres = 0;
+    lcd_get_resolution(&hres, &vres);
+    const lvgl_flush_config_t disp_cfg = {
+        .hres = hres, /* after rotation */
+        .vres = vres,
+#if CONFIG_LVGL_BUFFER_DIRECT
+        .buffer_mode = LVGL_FLUSH_BUFFER_DIRECT,
+        .bounce_lines = CONFIG_LVGL_BOUNCE_LINES,
+#elif CONFIG_LVGL_BUFFER_HYBRID
+        .buffer_mode = LVGL_FLUSH_BUFFER_HYBRID,
+        .bounce_lines = CONFIG_LVGL_BOUNCE_LINES,
+#else
+        .buffer_mode = LVGL_FLUSH_BUFFER_STRIPS,
+#endif
+        .draw_buffer_height = lcd_get_config().lcd_draw_buffer_height, /* tuned strip height if there is one */
+        .double_buffer = true,
+        .buff_dma = true,
+        .pclk_hz = lcd_get_config().pclk_hz, /* same as the panel IO */
+        .trans_overhead_ns = 2000,
+        .render_ns_per_pixel = 20,
+        .flush_core = 1,
+        .flush_task_priority = 4,
+    };
+
+    lvgl_sched_lock(0);
+    lvgl_disp = lvgl_flush_add_disp(disp_cfg);
+    esp_err_t ret = img_rle_decoder_init();
+    lvgl_sched_unlock();
+    ESP_RETURN_ON_FALSE(lvgl_disp, ESP_FAIL, TAG, "Add LCD screen failed");
+    ESP_RETURN_ON_ERROR(ret, TAG, "Image decoder init failed");
+
+    /* the background is taken from the pack and stays in flash, the built-in copy is the fallback
+       for boards flashed without the storage partition */
+    static lv_img_dsc_t background;
+    bool packed = false;
+    if (asset_store_init("storage") == ESP_OK)
+    {
+        packed = asset_store_get_img("ui_img_9460735_png", &background) == ESP_OK;
+    }
+    else
+    {
+        ESP_LOGW(TAG, "No asset pack, only built-in images are available");
+    }
+
+    lvgl_sched_lock(0);
+    ui_init();
+    if (packed)
+    {
+        lv_img_set_src(ui_Image1, &background);
+    }
+    lvgl_sched_unlock();
     return ESP_OK;
 }
 
@@ -136,18 +195,171 @@ void app_main(void)
     };
     ESP_ERROR_CHECK(gpio_config(&boot_button_config));
 
+    /* tuned LCD bus parameters live in NVS */
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+
 #ifdef CONFIG_ESP32_S3_EYE
     ESP_LOGI(TAG, "ESP32 S3 EYE");
-    ESP_ERROR_CHECK(camera_init());
+#ifdef CONFIG_CAMERA_USB_UVC
+    usb_uvc_config_t uvc_config = {
+        .task_priority = 5,
+        .task_core = 1,
+    };
+    ESP_ERROR_CHECK(usb_uvc_init(uvc_config));
+    return;
+#endif
+#if CONFIG_CAMERA_FRAMESIZE_QVGA
+    framesize_t frame_size = FRAMESIZE_QVGA;
+#elif CONFIG_CAMERA_FRAMESIZE_HVGA
+    framesize_t frame_size = FRAMESIZE_HVGA;
+#elif CONFIG_CAMERA_FRAMESIZE_VGA
+    framesize_t frame_size = FRAMESIZE_VGA;
+#else
+    framesize_t frame_size = FRAMESIZE_240X240;
+#endif
+#ifdef CONFIG_LCD_TUNE
+    /* 80 MHz divided by 4, 3 and 2, the SPI clocks at or below LCD_PCLK_MAX_HZ */
+    const uint32_t pclk_hz[] = {20 * 1000 * 1000, 80 * 1000 * 1000 / 3, 40 * 1000 * 1000};
+    const uint8_t queue_depth[] = {4, 10, 20};
+    const uint16_t strip_height[] = {20, 50, 80};
+    const lcd_tune_config_t tune_config = {
+        .pclk_hz = pclk_hz,
+        .pclk_count = sizeof(pclk_hz) / sizeof(pclk_hz[0]),
+        .queue_depth = queue_depth,
+        .queue_depth_count = sizeof(queue_depth) / sizeof(queue_depth[0]),
+        .strip_height = strip_height,
+        .strip_height_count = sizeof(strip_height) / sizeof(strip_height[0]),
+        .frames = 30,
+    };
+    if (lcd_tune_run(lcd_config, &tune_config, NULL) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "LCD tuning failed, keeping the defaults");
+    }
+#endif
     ESP_ERROR_CHECK(lcd_init(lcd_config));
-    while (1)
+#ifdef CONFIG_LCD_ROTATION_SOFTWARE
+    const bool rotate_in_software = true;
+#else
+    const bool rotate_in_software = false;
+#endif
+#if CONFIG_LCD_ROTATION_90
+    ESP_ERROR_CHECK(lcd_set_rotation(LCD_ROTATION_90, rotate_in_software));
+#elif CONFIG_LCD_ROTATION_180
+    ESP_ERROR_CHECK(lcd_set_rotation(LCD_ROTATION_180, rotate_in_software));
+#elif CONFIG_LCD_ROTATION_270
+    ESP_ERROR_CHECK(lcd_set_rotation(LCD_ROTATION_270, rotate_in_software));
+#else
+    (void)rotate_in_software;
+#endif
+#ifdef CONFIG_LVGL_UI
+    /* the panel belongs to LVGL, the camera is not started */
+    ESP_ERROR_CHECK(lvgl_init());
+    return;
+#endif
+#ifdef CONFIG_CAMERA_JPEG
+    ESP_ERROR_CHECK(camera_init(PIXFORMAT_JPEG, frame_size));
+#else
+    ESP_ERROR_CHECK(camera_init(PIXFORMAT_RGB565, frame_size));
+#endif
+    uint16_t panel_width = 0;
+    uint16_t panel_height = 0;
+    lcd_get_resolution(&panel_width, &panel_height);
+#ifdef CONFIG_CAMERA_JPEG
+    /*!< JPEG frames are decoded strip by strip and never compared, no reference frame or span buffers */
+    const bool delta_update = false;
+#else
+    const bool delta_update = true;
+    frame_diff_config_t diff_config = {
+        .width = panel_width,
+        .height = panel_height,
+        .tile_size = 16,
+        .ignore_bits = 1,
+        .tile_threshold = 8,
+    };
+    ESP_ERROR_CHECK(frame_diff_init(diff_config));
+#endif
+    camera_pipeline_config_t pipeline_config = {
+        .panel_width = panel_width,
+        .panel_height = panel_height,
+        .queue_depth = 1,
+        .drop_policy = CAMERA_PIPELINE_DROP_OLDEST,
+        .task_priority = 5,
+        .capture_core = 0,
+        .display_core = 1,
+        .delta_update = delta_update,
+        .jpeg_scale = JPG_SCALE_NONE,
+        .scale_mode = PIXEL_OPS_SCALE_BILINEAR,
+        .crop_to_fill = true,
+    };
+#ifdef CONFIG_CAMERA_AVI_RECORD
+    const avi_recorder_config_t avi_config = {
+        .base_path = "/data",
+        .path = "/data/REC.AVI",
+        .width = resolution[frame_size].width, /* esp32-camera frame size table */
+        .height = resolution[frame_size].height,
+        .fps = CAMERA_AVI_FPS,
+        .max_frames = (uint32_t)CONFIG_CAMERA_AVI_SECONDS * CAMERA_AVI_FPS,
+        .prealloc_size = (uint32_t)CONFIG_CAMERA_AVI_SECONDS * CAMERA_AVI_FPS * CAMERA_AVI_FRAME_BUDGET,
+        .queue_depth = 2,
+        .task_priority = 3,
+        .task_core = 0,
+    };
+    if (sd_card_init(sd_card_config, "/data") == ESP_OK && avi_recorder_start(avi_config) == ESP_OK)
     {
-        camera_fb_t *pic = esp_camera_fb_get();
-        esp_lcd_panel_draw_bitmap(lcd_panel, 0, 0, 240 + 1, 240 + 1, pic->buf);
-        esp_camera_fb_return(pic);
+        pipeline_config.record = avi_recorder_add_frame;
+        ESP_ERROR_CHECK(camera_pipeline_start(pipeline_config));
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_CAMERA_AVI_SECONDS * 1000));
+        /* no frame may reach the recorder once it stops */
+        ESP_ERROR_CHECK(camera_pipeline_stop());
+        if (avi_recorder_stop() != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Recording failed");
+        }
+        pipeline_config.record = NULL;
     }
+    else
+    {
+        ESP_LOGW(TAG, "No SD card, not recording");
+    }
+#endif
+    ESP_ERROR_CHECK(camera_pipeline_start(pipeline_config));
 #else
     ESP_LOGI(TAG, "ESP32 USB OTG");
     ESP_ERROR_CHECK(sd_card_init(sd_card_config, "/data"));
+#ifdef CONFIG_SD_LOG
+    sd_log_config_t log_config = {
+        .path = "/data/LOG.TXT",
+        .ring_size = CONFIG_SD_LOG_RING_KB * 1024,
+#ifdef CONFIG_SD_LOG_DROP
+        .overflow = SD_LOG_OVERFLOW_DROP,
+#else
+        .overflow = SD_LOG_OVERFLOW_BLOCK,
+#endif
+        .capture_esp_log = true,
+        .task_priority = 1,
+        .task_core = tskNO_AFFINITY,
+    };
+    if (sd_log_start(log_config) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "No log on the card");
+    }
+#endif
+#ifdef CONFIG_SD_STREAM_BENCH
+    sd_stream_config_t stream_config = {
+        .access = SD_STREAM_SEQUENTIAL,
+        .task_priority = 5,
+        .task_core = tskNO_AFFINITY,
+    };
+    if (sd_stream_bench("/data/BENCH.BIN", 4 * 1024 * 1024, stream_config, NULL, NULL) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "SD stream benchmark failed");
+    }
+#endif
 #endif
 }
\ No newline at end of file
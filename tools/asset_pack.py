@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# Build an asset pack for components/asset_store.
+#
+#   asset_pack.py -o assets.bin [--size 0xF0000] [--rle] ui_img_9460735_png.c hello.txt
+#
+# LVGL image C files become images named after their descriptor, optionally RLE coded,
+# any other file is stored as raw data under its file name.
+
+import argparse
+import os
+import struct
+import sys
+
+import img_rle
+
+MAGIC = 0x314B5041
+VERSION = 1
+NAME_LEN = 24
+ALIGN = 16
+HEADER = '<IHHII'
+ENTRY = '<%dsIIHHB3x' % NAME_LEN
+FORMAT_RAW, FORMAT_TRUE_COLOR, FORMAT_TRUE_COLOR_ALPHA, FORMAT_RLE = range(4)
+
+
+def load(path, rle):
+    if path.endswith('.c'):
+        with open(path) as f:
+            name, width, height, pixel_size, pixels = img_rle.parse(f.read())
+        pixels = pixels[:width * height * pixel_size]
+        if rle:
+            return name, img_rle.encode(width, height, pixel_size, pixels), width, height, FORMAT_RLE
+        fmt = FORMAT_TRUE_COLOR if pixel_size == 2 else FORMAT_TRUE_COLOR_ALPHA
+        return name, pixels, width, height, fmt
+    with open(path, 'rb') as f:
+        return os.path.basename(path), f.read(), 0, 0, FORMAT_RAW
+
+
+def align(n):
+    return (n + ALIGN - 1) // ALIGN * ALIGN
+
+
+def main():
+    parser = argparse.ArgumentParser(description='pack assets for esp_partition_mmap')
+    parser.add_argument('-o', '--output', required=True)
+    parser.add_argument('--size', type=lambda v: int(v, 0), help='partition size, the pack must fit')
+    parser.add_argument('--rle', action='store_true', help='RLE code images')
+    parser.add_argument('inputs', nargs='+')
+    args = parser.parse_args()
+
+    assets = [load(path, args.rle) for path in args.inputs]
+    names = set()
+    for name, *_ in assets:
+        if len(name.encode()) >= NAME_LEN:
+            sys.exit('asset name too long: %s' % name)
+        if name in names:
+            sys.exit('duplicate asset: %s' % name)
+        names.add(name)
+
+    offset = align(struct.calcsize(HEADER) + struct.calcsize(ENTRY) * len(assets))
+    index = b''
+    blob = b''
+    for name, data, width, height, fmt in assets:
+        index += struct.pack(ENTRY, name.encode(), offset + len(blob), len(data), width, height, fmt)
+        blob += data + b'\0' * (align(len(data)) - len(data))
+    body = index + b'\0' * (offset - struct.calcsize(HEADER) - len(index)) + blob
+    size = struct.calcsize(HEADER) + len(body)
+    if args.size and size > args.size:
+        sys.exit('pack is %d bytes, partition holds %d' % (size, args.size))
+
+    with open(args.output, 'wb') as f:
+        f.write(struct.pack(HEADER, MAGIC, VERSION, len(assets), size, 0) + body)
+    print('%d assets, %d bytes' % (len(assets), size))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+# Convert an LVGL image C file (as written by SquareLine Studio or the LVGL image converter)
+# into an RLE coded image that is decoded line by line by components/img_rle.
+#
+#   img_rle.py ui_img_9460735_png.c ui_img_9460735_png_rle.c
+#
+# The descriptor keeps its name, so the UI code does not change, unless --name gives another.
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = 0x31454C52
+MAX_RUN = 128
+PIXEL_SIZE = {'LV_IMG_CF_TRUE_COLOR': 2, 'LV_IMG_CF_TRUE_COLOR_ALPHA': 3}
+
+
+def parse(text):
+    dsc = re.search(r'const\s+lv_img_dsc_t\s+(\w+)\s*=', text)
+    data = re.search(r'uint8_t\s+\w+\s*\[\s*\]\s*=\s*\{(.*?)\}\s*;', text, re.S)
+    width = re.search(r'\.header\.w\s*=\s*(\d+)', text)
+    height = re.search(r'\.header\.h\s*=\s*(\d+)', text)
+    cf = re.search(r'\.header\.cf\s*=\s*(\w+)', text)
+    if not (dsc and data and width and height and cf):
+        sys.exit('not an LVGL image file')
+    if cf.group(1) not in PIXEL_SIZE:
+        sys.exit('unsupported colour format %s' % cf.group(1))
+    pixels = bytes(int(v, 0) for v in re.findall(r'0x[0-9a-fA-F]+|\d+', data.group(1)))
+    return dsc.group(1), int(width.group(1)), int(height.group(1)), PIXEL_SIZE[cf.group(1)], pixels
+
+
+def run_length(line, x, width, pixel_size):
+    px = line[x * pixel_size:(x + 1) * pixel_size]
+    run = 1
+    while run < width - x and run < MAX_RUN and line[(x + run) * pixel_size:(x + run + 1) * pixel_size] == px:
+        run += 1
+    return run
+
+
+def encode_line(line, width, pixel_size):
+    # same coding as img_rle_encode_line
+    out = bytearray()
+    x = 0
+    while x < width:
+        run = run_length(line, x, width, pixel_size)
+        if run >= 2:
+            out.append(0x80 | (run - 1))
+            out += line[x * pixel_size:(x + 1) * pixel_size]
+            x += run
+            continue
+        count = 1
+        while x + count < width and count < MAX_RUN and run_length(line, x + count, width, pixel_size) < 2:
+            count += 1
+        out.append(count - 1)
+        out += line[x * pixel_size:(x + count) * pixel_size]
+        x += count
+    return bytes(out)
+
+
+def encode(width, height, pixel_size, pixels):
+    stride = width * pixel_size
+    if len(pixels) < stride * height:
+        sys.exit('image data is shorter than %dx%d' % (width, height))
+    lines = [encode_line(pixels[y * stride:(y + 1) * stride], width, pixel_size) for y in range(height)]
+    header_size = 12 + 4 * height
+    offsets = []
+    offset = header_size
+    for line in lines:
+        offsets.append(offset)
+        offset += len(line)
+    header = struct.pack('<IHHB3x', MAGIC, width, height, pixel_size) + struct.pack('<%dI' % height, *offsets)
+    return header + b''.join(lines)
+
+
+def write(path, name, source, width, height, coded, raw_size):
+    with open(path, 'w') as f:
+        f.write('// Generated by tools/img_rle.py from %s, do not edit\n' % source)
+        f.write('// %d bytes of pixels coded into %d bytes\n\n' % (raw_size, len(coded)))
+        f.write('#include "lvgl.h"\n#include "img_rle.h"\n\n')
+        f.write('static const uint8_t %s_rle[] __attribute__((aligned(4))) = {\n' % name)
+        for i in range(0, len(coded), 32):
+            f.write('    ' + ','.join('0x%02X' % b for b in coded[i:i + 32]) + ',\n')
+        f.write('};\n\n')
+        f.write('const lv_img_dsc_t %s = {\n' % name)
+        f.write('    .header.always_zero = 0,\n')
+        f.write('    .header.w = %d,\n' % width)
+        f.write('    .header.h = %d,\n' % height)
+        f.write('    .data_size = sizeof(%s_rle),\n' % name)
+        f.write('    .header.cf = IMG_RLE_CF,\n')
+        f.write('    .data = %s_rle,\n' % name)
+        f.write('};\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='RLE code an LVGL image C file')
+    parser.add_argument('input')
+    parser.add_argument('output')
+    parser.add_argument('--name', help='descriptor name, defaults to the one of the input')
+    args = parser.parse_args()
+
+    with open(args.input) as f:
+        name, width, height, pixel_size, pixels = parse(f.read())
+    name = args.name or name
+    coded = encode(width, height, pixel_size, pixels)
+    write(args.output, name, args.input.split('/')[-1], width, height, coded, width * height * pixel_size)
+
+
+if __name__ == '__main__':
+    main()